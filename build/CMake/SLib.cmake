@@ -81,6 +81,7 @@ set (SLIB_CORE_FILES
  "${SLIB_PATH}/src/slib/core/asset.cpp"
  "${SLIB_PATH}/src/slib/core/async.cpp"
  "${SLIB_PATH}/src/slib/core/async_epoll.cpp"
+ "${SLIB_PATH}/src/slib/core/async_io_uring.cpp"
  "${SLIB_PATH}/src/slib/core/async_unix.cpp"
  "${SLIB_PATH}/src/slib/core/atomic.cpp"
  "${SLIB_PATH}/src/slib/core/base.cpp"
@@ -173,6 +174,7 @@ set (SLIB_CORE_FILES
  "${SLIB_PATH}/src/slib/network/http_common.cpp"
  "${SLIB_PATH}/src/slib/network/http_io.cpp"
  "${SLIB_PATH}/src/slib/network/http_server.cpp"
+ "${SLIB_PATH}/src/slib/network/web_socket.cpp"
  "${SLIB_PATH}/src/slib/network/icmp.cpp"
  "${SLIB_PATH}/src/slib/network/ip_address.cpp"
  "${SLIB_PATH}/src/slib/network/mac_address.cpp"
@@ -189,6 +191,9 @@ set (SLIB_CORE_FILES
  "${SLIB_PATH}/src/slib/network/socket_event_unix.cpp"
  "${SLIB_PATH}/src/slib/network/stun.cpp"
  "${SLIB_PATH}/src/slib/network/tcpip.cpp"
+ "${SLIB_PATH}/src/slib/network/tcp_relay.cpp"
+ "${SLIB_PATH}/src/slib/network/tcp_pool.cpp"
+ "${SLIB_PATH}/src/slib/network/rpc.cpp"
  "${SLIB_PATH}/src/slib/network/url.cpp"
  "${SLIB_PATH}/src/slib/network/url_request.cpp"
  "${SLIB_PATH}/src/slib/network/url_request_curl.cpp"
@@ -208,6 +213,7 @@ endif()
 set (SLIB_EXTRA_FILES
  "${SLIB_PATH}/src/slib/graphics/bitmap.cpp"
  "${SLIB_PATH}/src/slib/graphics/bitmap_data.cpp"
+ "${SLIB_PATH}/src/slib/graphics/bitmap_data_simd.cpp"
  "${SLIB_PATH}/src/slib/graphics/bitmap_ext.cpp"
  "${SLIB_PATH}/src/slib/graphics/bitmap_format.cpp"
  "${SLIB_PATH}/src/slib/graphics/brush.cpp"
@@ -224,9 +230,11 @@ set (SLIB_EXTRA_FILES
  "${SLIB_PATH}/src/slib/graphics/graphics_text.cpp"
  "${SLIB_PATH}/src/slib/graphics/graphics_util.cpp"
  "${SLIB_PATH}/src/slib/graphics/image.cpp"
+ "${SLIB_PATH}/src/slib/graphics/image_resample.cpp"
  "${SLIB_PATH}/src/slib/graphics/image_jpeg.cpp"
  "${SLIB_PATH}/src/slib/graphics/image_png.cpp"
  "${SLIB_PATH}/src/slib/graphics/image_stb.cpp"
+ "${SLIB_PATH}/src/slib/graphics/image_stream.cpp"
  "${SLIB_PATH}/src/slib/graphics/pen.cpp"
  "${SLIB_PATH}/src/slib/graphics/yuv.cpp"
  "${SLIB_PATH}/src/slib/graphics/zxing.cpp"
@@ -253,6 +261,7 @@ set (SLIB_EXTRA_FILES
  "${SLIB_PATH}/src/slib/media/audio_recorder_dsound.cpp"
  "${SLIB_PATH}/src/slib/media/audio_recorder_opensl_es.cpp"
  "${SLIB_PATH}/src/slib/media/audio_util.cpp"
+ "${SLIB_PATH}/src/slib/media/audio_resampler.cpp"
  "${SLIB_PATH}/src/slib/media/camera.cpp"
  "${SLIB_PATH}/src/slib/media/camera_dshow.cpp"
  "${SLIB_PATH}/src/slib/media/codec_opus.cpp"
@@ -268,7 +277,9 @@ set (SLIB_EXTRA_FILES
  "${SLIB_PATH}/src/slib/device/vibrator.cpp"
  
  "${SLIB_PATH}/src/slib/db/database.cpp"
+ "${SLIB_PATH}/src/slib/db/database_column_batch.cpp"
  "${SLIB_PATH}/src/slib/db/database_cursor.cpp"
+ "${SLIB_PATH}/src/slib/db/database_pool.cpp"
  "${SLIB_PATH}/src/slib/db/database_statement.cpp"
  "${SLIB_PATH}/src/slib/db/mysql.cpp"
  "${SLIB_PATH}/src/slib/db/redis.cpp"
@@ -0,0 +1,116 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#include <slib.h>
+
+using namespace slib;
+
+#define WIDTH 1920
+#define HEIGHT 1080
+#define DURATION 300
+
+struct FormatEntry
+{
+	BitmapFormat format;
+	const char* name;
+};
+
+static const FormatEntry g_sources[] = {
+	{BitmapFormat::YUV_I420, "I420"},
+	{BitmapFormat::YUV_NV12, "NV12"},
+	{BitmapFormat::YUV_NV21, "NV21"},
+	{BitmapFormat::RGBA, "RGBA"},
+	{BitmapFormat::BGRA, "BGRA"},
+	{BitmapFormat::ARGB, "ARGB"},
+	{BitmapFormat::RGB, "RGB"}
+};
+
+static const FormatEntry g_targets[] = {
+	{BitmapFormat::RGBA, "RGBA"},
+	{BitmapFormat::BGRA, "BGRA"},
+	{BitmapFormat::ARGB, "ARGB"},
+	{BitmapFormat::ABGR, "ABGR"},
+	{BitmapFormat::RGBA_PA, "RGBA_PA"},
+	{BitmapFormat::RGB, "RGB"},
+	{BitmapFormat::YUV_I420, "I420"}
+};
+
+static sl_bool createBitmapData(BitmapFormat format, BitmapData& bd)
+{
+	bd.width = WIDTH;
+	bd.height = HEIGHT;
+	bd.format = format;
+	Memory mem = Memory::create(bd.getTotalSize());
+	if (mem.isNull()) {
+		return sl_false;
+	}
+	sl_uint8* p = (sl_uint8*)(mem.getData());
+	sl_size n = mem.getSize();
+	for (sl_size i = 0; i < n; i++) {
+		p[i] = (sl_uint8)(i * 7 + (i >> 8));
+	}
+	bd.data = p;
+	bd.ref = mem.ref;
+	bd.fillDefaultValues();
+	return sl_true;
+}
+
+// megapixels per second
+static double measure(const BitmapData& src, const BitmapData& dst)
+{
+	sl_uint32 nFrames = 0;
+	sl_uint32 timeStart = System::getTickCount();
+	sl_uint32 dt;
+	do {
+		dst.copyPixelsFrom(src);
+		nFrames++;
+		dt = System::getTickCount() - timeStart;
+	} while (dt < DURATION);
+	return (double)nFrames * WIDTH * HEIGHT / dt / 1000.0;
+}
+
+int main(int argc, const char * argv[])
+{
+	Println("BitmapData::copyPixelsFrom %dx%d, megapixels/s (AVX2: %s)", WIDTH, HEIGHT, System::isAVX2Supported() ? "yes" : "no");
+	String header = String::format("%-8s", "src\\dst");
+	for (auto& target : g_targets) {
+		header += String::format("%10s", target.name);
+	}
+	Println("%s", header);
+	for (auto& source : g_sources) {
+		BitmapData src;
+		if (!(createBitmapData(source.format, src))) {
+			return -1;
+		}
+		String line = String::format("%-8s", source.name);
+		for (auto& target : g_targets) {
+			BitmapData dst;
+			if (!(createBitmapData(target.format, dst))) {
+				return -1;
+			}
+			line += String::format("%10.1f", measure(src, dst));
+		}
+		Println("%s", line);
+	}
+	return 0;
+}
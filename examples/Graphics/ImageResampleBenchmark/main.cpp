@@ -0,0 +1,85 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+#include <slib.h>
+
+using namespace slib;
+
+#define SRC_WIDTH 3840
+#define SRC_HEIGHT 2160
+#define DST_WIDTH 256
+#define DST_HEIGHT 144
+#define DURATION 1000
+
+struct StretchEntry
+{
+	StretchMode mode;
+	const char* name;
+};
+
+static const StretchEntry g_modes[] = {
+	{StretchMode::Nearest, "Nearest"},
+	{StretchMode::Linear, "Linear"},
+	{StretchMode::Box, "Box"},
+	{StretchMode::Bicubic, "Bicubic"},
+	{StretchMode::Lanczos, "Lanczos"}
+};
+
+// milliseconds per image
+static double measure(const Ref<Image>& image, StretchMode mode, const Ref<ThreadPool>& threadPool)
+{
+	sl_uint32 nImages = 0;
+	sl_uint32 timeStart = System::getTickCount();
+	sl_uint32 dt;
+	do {
+		image->scale(DST_WIDTH, DST_HEIGHT, mode, threadPool);
+		nImages++;
+		dt = System::getTickCount() - timeStart;
+	} while (dt < DURATION);
+	return (double)dt / nImages;
+}
+
+int main(int argc, const char * argv[])
+{
+	Ref<Image> image = Image::create(SRC_WIDTH, SRC_HEIGHT);
+	if (image.isNull()) {
+		return -1;
+	}
+	for (sl_uint32 y = 0; y < SRC_HEIGHT; y++) {
+		Color* colors = image->getColorsAt(0, y);
+		for (sl_uint32 x = 0; x < SRC_WIDTH; x++) {
+			colors[x] = Color((sl_uint8)(x * 7 + y), (sl_uint8)(x ^ y), (sl_uint8)(y * 3), 255);
+		}
+	}
+	Ref<ThreadPool> threadPool = ThreadPool::create(0, 8);
+	if (threadPool.isNull()) {
+		return -1;
+	}
+	Println("Image::scale %dx%d -> %dx%d, ms/image", SRC_WIDTH, SRC_HEIGHT, DST_WIDTH, DST_HEIGHT);
+	Println("%-10s%12s%12s", "mode", "1 thread", "pool(8)");
+	for (auto& entry : g_modes) {
+		double t1 = measure(image, entry.mode, sl_null);
+		double t2 = measure(image, entry.mode, threadPool);
+		Println("%-10s%12.2f%12.2f", entry.name, t1, t2);
+	}
+	return 0;
+}
@@ -0,0 +1,245 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+#include <slib.h>
+#include <slib/render.h>
+
+using namespace slib;
+
+#define CANVAS_WIDTH 1280
+#define CANVAS_HEIGHT 720
+#define LINES_PER_FRAME 40
+#define DURATION 1000
+
+// Records the calls of RenderCanvas without a graphics device
+class RecordingRenderEngine : public RenderEngine
+{
+public:
+	class ProgramInstance : public RenderProgramInstance
+	{
+	public:
+		Ref<RenderProgramState> state;
+	};
+	
+	class VertexBufferInstanceImpl : public VertexBufferInstance
+	{
+	public:
+		RecordingRenderEngine* engine;
+		
+	public:
+		void notifyUpdated(sl_size offset, sl_size size) override
+		{
+			engine->countUploadedBytes += size;
+			VertexBufferInstance::notifyUpdated(offset, size);
+		}
+	};
+	
+	class IndexBufferInstanceImpl : public IndexBufferInstance
+	{
+	};
+	
+	class TextureInstanceImpl : public TextureInstance
+	{
+	};
+	
+public:
+	sl_uint64 countDrawCalls;
+	sl_uint64 countElements;
+	sl_uint64 countUploadedBytes;
+	sl_uint32 countVertexBuffers;
+	
+public:
+	RecordingRenderEngine()
+	{
+		countVertexBuffers = 0;
+		reset();
+	}
+	
+public:
+	void reset()
+	{
+		countDrawCalls = 0;
+		countElements = 0;
+		countUploadedBytes = 0;
+	}
+	
+	RenderEngineType getEngineType() override
+	{
+		return RenderEngineType::OpenGL;
+	}
+	
+protected:
+	Ref<RenderProgramInstance> _createProgramInstance(RenderProgram* program) override
+	{
+		Ref<ProgramInstance> ret = new ProgramInstance;
+		if (ret.isNotNull()) {
+			ret->state = program->onCreate(this);
+			if (ret->state.isNotNull()) {
+				ret->link(this, program);
+				return ret;
+			}
+		}
+		return sl_null;
+	}
+	
+	Ref<VertexBufferInstance> _createVertexBufferInstance(VertexBuffer* buffer) override
+	{
+		Ref<VertexBufferInstanceImpl> ret = new VertexBufferInstanceImpl;
+		if (ret.isNotNull()) {
+			ret->engine = this;
+			ret->link(this, buffer);
+			countVertexBuffers++;
+		}
+		return ret;
+	}
+	
+	Ref<IndexBufferInstance> _createIndexBufferInstance(IndexBuffer* buffer) override
+	{
+		Ref<IndexBufferInstanceImpl> ret = new IndexBufferInstanceImpl;
+		if (ret.isNotNull()) {
+			ret->link(this, buffer);
+		}
+		return ret;
+	}
+	
+	Ref<TextureInstance> _createTextureInstance(Texture* texture) override
+	{
+		Ref<TextureInstanceImpl> ret = new TextureInstanceImpl;
+		if (ret.isNotNull()) {
+			ret->link(this, texture);
+		}
+		return ret;
+	}
+	
+	sl_bool _beginScene() override
+	{
+		return sl_true;
+	}
+	
+	void _endScene() override
+	{
+	}
+	
+	void _setViewport(sl_uint32 x, sl_uint32 y, sl_uint32 width, sl_uint32 height) override
+	{
+	}
+	
+	void _clear(const RenderClearParam& param) override
+	{
+	}
+	
+	void _setDepthTest(sl_bool flagEnableDepthTest) override
+	{
+	}
+	
+	void _setDepthWriteEnabled(sl_bool flagEnableDepthWrite) override
+	{
+	}
+	
+	void _setDepthFunction(RenderFunctionOperation op) override
+	{
+	}
+	
+	void _setCullFace(sl_bool flagEnableCull, sl_bool flagCullCCW) override
+	{
+	}
+	
+	void _setBlending(sl_bool flagEnableBlending, const RenderBlendingParam& param) override
+	{
+	}
+	
+	sl_bool _beginProgram(RenderProgram* program, RenderProgramInstance* instance, RenderProgramState** ppState) override
+	{
+		*ppState = ((ProgramInstance*)instance)->state.get();
+		return sl_true;
+	}
+	
+	void _endProgram() override
+	{
+	}
+	
+	void _resetCurrentBuffers() override
+	{
+	}
+	
+	void _drawPrimitive(EnginePrimitive* primitive) override
+	{
+		countDrawCalls++;
+		countElements += primitive->countElements;
+	}
+	
+	void _applyTexture(Texture* texture, TextureInstance* instance, sl_reg sampler) override
+	{
+	}
+	
+	void _setLineWidth(sl_real width) override
+	{
+	}
+	
+};
+
+static void drawFrame(RecordingRenderEngine* engine, const Ref<Font>& font, const String& text)
+{
+	// canvases are created for every frame, same as RenderView
+	Ref<RenderCanvas> canvas = RenderCanvas::create(engine, CANVAS_WIDTH, CANVAS_HEIGHT);
+	if (canvas.isNull()) {
+		return;
+	}
+	sl_real lineHeight = font->getFontHeight();
+	for (sl_uint32 i = 0; i < LINES_PER_FRAME; i++) {
+		canvas->drawText(text, 0, (sl_real)i * lineHeight, font, Color::Black);
+	}
+}
+
+int main(int argc, const char * argv[])
+{
+	Ref<RecordingRenderEngine> engine = new RecordingRenderEngine;
+	if (engine.isNull()) {
+		return -1;
+	}
+	Ref<Font> font = Font::create("Arial", 20);
+	if (font.isNull()) {
+		return -1;
+	}
+	String text = "The quick brown fox jumps over the lazy dog. 0123456789";
+	
+	drawFrame(engine.get(), font, text);
+	engine->reset();
+	sl_uint32 countVertexBuffers = engine->countVertexBuffers;
+	
+	sl_uint32 nFrames = 0;
+	sl_uint32 timeStart = System::getTickCount();
+	sl_uint32 dt;
+	do {
+		drawFrame(engine.get(), font, text);
+		nFrames++;
+		dt = System::getTickCount() - timeStart;
+	} while (dt < DURATION);
+	
+	sl_uint64 nGlyphs = engine->countElements / 6;
+	Println("RenderCanvas::drawText, %d lines of %d characters per frame", LINES_PER_FRAME, (sl_uint32)(text.getLength()));
+	Println("frames: %d, ms/frame: %.3f", nFrames, (double)dt / nFrames);
+	Println("draw calls/frame: %.1f, glyphs/draw call: %.1f", (double)(engine->countDrawCalls) / nFrames, engine->countDrawCalls ? (double)nGlyphs / (double)(engine->countDrawCalls) : 0.0);
+	Println("uploaded vertex bytes/frame: %.0f", (double)(engine->countUploadedBytes) / nFrames);
+	Println("vertex buffers created after the first frame: %d", engine->countVertexBuffers - countVertexBuffers);
+	return 0;
+}
@@ -0,0 +1,109 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#include <slib.h>
+
+using namespace slib;
+
+#define COUNT_IMAGES 64
+#define DOC_WIDTH 2480
+#define DOC_HEIGHT 3508
+#define CODE_SIZE 600
+#define THREADS_COUNT 8
+
+// scanned page with a QR code
+static Ref<Image> generateFixture(sl_uint32 index)
+{
+	ZXingGenerateParam param;
+	param.text = String::format("DOC-%08d", index);
+	param.width = CODE_SIZE;
+	param.height = CODE_SIZE;
+	param.margin = 2;
+	Ref<Image> code = ZXing::generate(param);
+	if (code.isNull()) {
+		return sl_null;
+	}
+	Ref<Image> image = Image::create(DOC_WIDTH, DOC_HEIGHT);
+	if (image.isNull()) {
+		return sl_null;
+	}
+	for (sl_uint32 y = 0; y < DOC_HEIGHT; y++) {
+		Color* colors = image->getColorsAt(0, y);
+		for (sl_uint32 x = 0; x < DOC_WIDTH; x++) {
+			sl_uint8 v = (sl_uint8)(230 + ((x * 7 + y * 3 + index) % 25));
+			colors[x] = Color(v, v, v, 255);
+		}
+	}
+	sl_int32 x = (sl_int32)((index * 131) % (DOC_WIDTH - CODE_SIZE));
+	sl_int32 y = (sl_int32)((index * 277) % (DOC_HEIGHT - CODE_SIZE));
+	image->drawImage(x, y, code->getWidth(), code->getHeight(), code, 0, 0, code->getWidth(), code->getHeight());
+	return image;
+}
+
+static void measure(const char* name, const List< Ref<Image> >& images, sl_uint32 preDetectSize, const Ref<ThreadPool>& threadPool)
+{
+	ZXingBatchScanParam param;
+	param.images = images;
+	param.preDetectSize = preDetectSize;
+	param.threadPool = threadPool;
+	param.threadsCount = 1;
+	sl_uint32 timeStart = System::getTickCount();
+	List<ZXingScanResult> results = ZXing::scanBatch(param);
+	sl_uint32 dt = System::getTickCount() - timeStart;
+	sl_uint32 nDetected = 0;
+	sl_uint64 timeMax = 0;
+	ListElements<ZXingScanResult> items(results);
+	for (sl_size i = 0; i < items.count; i++) {
+		if (items[i].text == String::format("DOC-%08d", i)) {
+			nDetected++;
+		}
+		if (items[i].elapsedMicroseconds > timeMax) {
+			timeMax = items[i].elapsedMicroseconds;
+		}
+	}
+	double throughput = dt ? (double)(items.count) * 1000 / dt : 0;
+	Println("%-24s%10.1f%10d/%d%12.1f", name, throughput, nDetected, (sl_uint32)(items.count), (double)timeMax / 1000);
+}
+
+int main(int argc, const char * argv[])
+{
+	List< Ref<Image> > images;
+	for (sl_uint32 i = 0; i < COUNT_IMAGES; i++) {
+		Ref<Image> image = generateFixture(i);
+		if (image.isNull()) {
+			return -1;
+		}
+		images.add_NoLock(image);
+	}
+	Ref<ThreadPool> threadPool = ThreadPool::create(0, THREADS_COUNT);
+	if (threadPool.isNull()) {
+		return -1;
+	}
+	Println("ZXing::scanBatch %d images of %dx%d", COUNT_IMAGES, DOC_WIDTH, DOC_HEIGHT);
+	Println("%-24s%10s%12s%12s", "mode", "images/s", "detected", "max ms");
+	measure("1 thread", images, 0, sl_null);
+	measure("1 thread, pre-detect", images, 1024, sl_null);
+	measure("pool(8)", images, 0, threadPool);
+	measure("pool(8), pre-detect", images, 1024, threadPool);
+	return 0;
+}
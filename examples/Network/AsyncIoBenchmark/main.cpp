@@ -0,0 +1,261 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#include <slib.h>
+
+using namespace slib;
+
+#define CLIENT_COUNT 64
+#define ROUND_TRIP_COUNT 2000
+#define MESSAGE_SIZE 64
+
+#define FILE_COUNT 4
+#define FILE_SIZE (64 << 20)
+#define FILE_CHUNK_SIZE 0x10000
+
+static const char* getBackendName(AsyncIoLoopBackend backend)
+{
+	if (backend == AsyncIoLoopBackend::IoUring) {
+		return "io_uring";
+	}
+	return "epoll";
+}
+
+class EchoBenchmark : public Referable
+{
+public:
+	Ref<AsyncIoLoop> loopServer;
+	Ref<AsyncIoLoop> loopClient;
+	Ref<AsyncTcpServer> server;
+	CList< Ref<AsyncTcpSocket> > sockets;
+	Ref<Event> eventCompleted;
+	sl_int32 nRunningClients;
+
+public:
+	sl_bool run(AsyncIoLoopBackend backend, sl_uint16 port)
+	{
+		loopServer = AsyncIoLoop::create(backend);
+		loopClient = AsyncIoLoop::create(backend);
+		if (loopServer.isNull() || loopClient.isNull()) {
+			return sl_false;
+		}
+		eventCompleted = Event::create();
+		nRunningClients = CLIENT_COUNT;
+
+		AsyncTcpServerParam serverParam;
+		serverParam.bindAddress.port = port;
+		serverParam.ioLoop = loopServer;
+		serverParam.onAccept = [this](AsyncTcpServer*, Socket* socket, const SocketAddress&) {
+			AsyncTcpSocketParam param;
+			param.socket = socket;
+			param.ioLoop = loopServer;
+			Ref<AsyncTcpSocket> connection = AsyncTcpSocket::create(param);
+			if (connection.isNotNull()) {
+				sockets.add(connection);
+				echo(connection.get(), Memory::create(FILE_CHUNK_SIZE));
+			}
+		};
+		server = AsyncTcpServer::create(serverParam);
+		if (server.isNull()) {
+			return sl_false;
+		}
+
+		sl_uint32 timeStart = System::getTickCount();
+		for (sl_uint32 i = 0; i < CLIENT_COUNT; i++) {
+			AsyncTcpSocketParam param;
+			param.connectAddress = SocketAddress(IPv4Address(127, 0, 0, 1), port);
+			param.ioLoop = loopClient;
+			param.onConnect = [this](AsyncTcpSocket* socket, const SocketAddress&, sl_bool flagError) {
+				if (flagError) {
+					Println("Failed to connect");
+					finishClient();
+					return;
+				}
+				request(socket, Memory::create(MESSAGE_SIZE), 0, 0);
+			};
+			Ref<AsyncTcpSocket> socket = AsyncTcpSocket::create(param);
+			if (socket.isNull()) {
+				return sl_false;
+			}
+			sockets.add(socket);
+		}
+		eventCompleted->wait();
+		sl_uint32 dt = System::getTickCount() - timeStart;
+		sl_uint32 n = CLIENT_COUNT * ROUND_TRIP_COUNT;
+		Println("[%s] TCP echo: %d round trips in %dms (%d/s)", getBackendName(loopClient->getBackend()), n, dt, (sl_uint32)((sl_uint64)n * 1000 / (dt ? dt : 1)));
+
+		for (auto& socket : sockets) {
+			socket->close();
+		}
+		sockets.removeAll();
+		server->close();
+		loopClient->release();
+		loopServer->release();
+		return sl_true;
+	}
+
+	void echo(AsyncTcpSocket* socket, const Memory& buf)
+	{
+		Ref<EchoBenchmark> thiz = this;
+		socket->receive(buf, [thiz, buf](AsyncStreamResult* result) {
+			AsyncTcpSocket* socket = (AsyncTcpSocket*)(result->stream);
+			if (result->flagError) {
+				return;
+			}
+			socket->send(result->data, result->size, [thiz, buf](AsyncStreamResult* result) {
+				if (!(result->flagError)) {
+					thiz->echo((AsyncTcpSocket*)(result->stream), buf);
+				}
+			}, buf.ref.get());
+		});
+	}
+
+	void request(AsyncTcpSocket* socket, const Memory& buf, sl_uint32 nTrips, sl_uint32 sizeReceived)
+	{
+		if (nTrips >= ROUND_TRIP_COUNT) {
+			finishClient();
+			return;
+		}
+		Ref<EchoBenchmark> thiz = this;
+		if (!sizeReceived) {
+			socket->send(buf, [](AsyncStreamResult*) {});
+		}
+		socket->receive(buf, [thiz, buf, nTrips, sizeReceived](AsyncStreamResult* result) {
+			if (result->flagError) {
+				thiz->finishClient();
+				return;
+			}
+			sl_uint32 size = sizeReceived + result->size;
+			if (size >= MESSAGE_SIZE) {
+				thiz->request((AsyncTcpSocket*)(result->stream), buf, nTrips + 1, 0);
+			} else {
+				thiz->request((AsyncTcpSocket*)(result->stream), buf, nTrips, size);
+			}
+		});
+	}
+
+	void finishClient()
+	{
+		if (!(Base::interlockedDecrement32(&nRunningClients))) {
+			eventCompleted->set();
+		}
+	}
+
+};
+
+class FileBenchmark : public Referable
+{
+public:
+	Ref<AsyncIoLoop> loop;
+	Ref<Event> eventCompleted;
+	sl_int32 nRunningFiles;
+	sl_bool flagError;
+
+public:
+	sl_bool run(AsyncIoLoopBackend backend)
+	{
+		loop = AsyncIoLoop::create(backend);
+		if (loop.isNull()) {
+			return sl_false;
+		}
+		eventCompleted = Event::create();
+		flagError = sl_false;
+
+		String dir = System::getTempDirectory();
+		for (sl_uint32 step = 0; step < 2; step++) {
+			sl_bool flagWrite = step == 0;
+			nRunningFiles = FILE_COUNT;
+			sl_uint32 timeStart = System::getTickCount();
+			for (sl_uint32 i = 0; i < FILE_COUNT; i++) {
+				String path = String::format("%s/slib_async_benchmark_%d", dir, i);
+				Ref<AsyncStream> file = AsyncFile::openIoUring(path, flagWrite ? FileMode::Write : FileMode::Read, loop);
+				if (file.isNull()) {
+					return sl_false;
+				}
+				Memory buf = Memory::create(FILE_CHUNK_SIZE);
+				Base::resetMemory(buf.getData(), (sl_uint8)i, FILE_CHUNK_SIZE);
+				process(file, buf, flagWrite, 0);
+			}
+			eventCompleted->wait();
+			sl_uint32 dt = System::getTickCount() - timeStart;
+			sl_uint64 size = (sl_uint64)FILE_SIZE * FILE_COUNT;
+			Println("[%s] File %s: %dMB in %dms (%dMB/s)%s", getBackendName(loop->getBackend()), flagWrite ? "write" : "read", (sl_uint32)(size >> 20), dt, (sl_uint32)((size >> 20) * 1000 / (dt ? dt : 1)), flagError ? " ERROR" : "");
+		}
+		for (sl_uint32 i = 0; i < FILE_COUNT; i++) {
+			File::deleteFile(String::format("%s/slib_async_benchmark_%d", dir, i));
+		}
+		loop->release();
+		return sl_true;
+	}
+
+	void process(const Ref<AsyncStream>& file, const Memory& buf, sl_bool flagWrite, sl_uint64 offset)
+	{
+		if (offset >= FILE_SIZE) {
+			file->close();
+			if (!(Base::interlockedDecrement32(&nRunningFiles))) {
+				eventCompleted->set();
+			}
+			return;
+		}
+		Ref<FileBenchmark> thiz = this;
+		auto callback = [thiz, file, buf, flagWrite, offset](AsyncStreamResult* result) {
+			if (result->flagError) {
+				thiz->flagError = sl_true;
+				thiz->process(file, buf, flagWrite, FILE_SIZE);
+				return;
+			}
+			thiz->process(file, buf, flagWrite, offset + result->size);
+		};
+		if (flagWrite) {
+			file->writeFromMemory(buf, callback);
+		} else {
+			file->readToMemory(buf, callback);
+		}
+	}
+
+};
+
+int main(int argc, const char * argv[])
+{
+	AsyncIoLoopBackend backends[] = {AsyncIoLoopBackend::Default, AsyncIoLoopBackend::IoUring};
+	for (sl_uint32 i = 0; i < 2; i++) {
+		Ref<AsyncIoLoop> loop = AsyncIoLoop::create(backends[i], sl_false);
+		if (loop.isNull()) {
+			continue;
+		}
+		if (loop->getBackend() != backends[i]) {
+			Println("io_uring is not supported on this system");
+			continue;
+		}
+		loop->release();
+		Ref<EchoBenchmark> echo = new EchoBenchmark;
+		if (!(echo->run(backends[i], (sl_uint16)(23000 + i)))) {
+			Println("Failed to run TCP echo benchmark");
+		}
+		Ref<FileBenchmark> file = new FileBenchmark;
+		if (!(file->run(backends[i]))) {
+			Println("Failed to run file benchmark");
+		}
+	}
+	return 0;
+}
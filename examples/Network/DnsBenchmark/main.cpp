@@ -0,0 +1,133 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#include <slib.h>
+
+using namespace slib;
+
+#define DURATION 2000
+#define SEND_WINDOW 256
+#define COUNT_NAMES 256
+#define COUNT_CLIENTS 4
+
+class DnsBenchmark : public Referable
+{
+public:
+	sl_int64 nSent;
+	sl_int64 nReceived;
+
+public:
+	sl_bool run(sl_uint16 port, sl_bool flagCache, sl_uint32 countSockets)
+	{
+		nSent = 0;
+		nReceived = 0;
+
+		DnsServerParam serverParam;
+		serverParam.portDns = port;
+		serverParam.countDnsSockets = countSockets;
+		serverParam.flagCacheAnswers = flagCache;
+		serverParam.onResolve = [](DnsServer*, DnsResolveHostParam& param) {
+			param.hostAddress = IPv4Address(10, 0, 0, 1);
+			param.forwardAddress.setNone();
+		};
+		Ref<DnsServer> server = DnsServer::create(serverParam);
+		if (server.isNull()) {
+			return sl_false;
+		}
+
+		Memory questions[COUNT_NAMES];
+		for (sl_uint32 i = 0; i < COUNT_NAMES; i++) {
+			questions[i] = DnsPacket::buildQuestionPacket((sl_uint16)i, String::format("host%d.benchmark.test", i));
+		}
+
+		Ref<AsyncIoLoop> loopClient = AsyncIoLoop::create();
+		if (loopClient.isNull()) {
+			return sl_false;
+		}
+		Ref<AsyncUdpSocket> clients[COUNT_CLIENTS];
+		for (sl_uint32 i = 0; i < COUNT_CLIENTS; i++) {
+			AsyncUdpSocketParam clientParam;
+			clientParam.ioLoop = loopClient;
+			clientParam.onReceiveBatch = [this](AsyncUdpSocket*, SocketDatagram*, sl_uint32 count) {
+				Base::interlockedAdd64(&nReceived, count);
+			};
+			clients[i] = AsyncUdpSocket::create(clientParam);
+			if (clients[i].isNull()) {
+				return sl_false;
+			}
+		}
+
+		SocketAddress addressTo(IPv4Address(127, 0, 0, 1), port);
+		sl_uint32 index = 0;
+		sl_uint32 timeStart = System::getTickCount();
+		sl_uint32 timeStall = 0;
+		while (System::getTickCount() - timeStart < DURATION) {
+			// lost queries are forgiven after 1ms
+			if (nSent - nReceived > SEND_WINDOW) {
+				if (!timeStall) {
+					timeStall = System::getTickCount();
+				} else if (System::getTickCount() - timeStall > 1) {
+					nSent = nReceived;
+					timeStall = 0;
+				}
+				Thread::sleep(0);
+				continue;
+			}
+			timeStall = 0;
+			for (sl_uint32 i = 0; i < COUNT_CLIENTS; i++) {
+				clients[i]->sendTo(addressTo, questions[index % COUNT_NAMES]);
+				index++;
+			}
+			nSent += COUNT_CLIENTS;
+		}
+		sl_uint32 dt = System::getTickCount() - timeStart;
+		Println("cache=%s sockets=%d: %d queries/s", flagCache ? "on" : "off", countSockets, (sl_uint32)(nReceived * 1000 / (dt ? dt : 1)));
+
+		for (sl_uint32 i = 0; i < COUNT_CLIENTS; i++) {
+			clients[i]->close();
+		}
+		loopClient->release();
+		server->release();
+		return sl_true;
+	}
+
+};
+
+int main(int argc, const char * argv[])
+{
+	struct {
+		sl_bool flagCache;
+		sl_uint32 countSockets;
+	} configs[] = {
+		{sl_false, 1},
+		{sl_true, 1},
+		{sl_true, 4}
+	};
+	for (sl_uint32 i = 0; i < sizeof(configs) / sizeof(configs[0]); i++) {
+		Ref<DnsBenchmark> benchmark = new DnsBenchmark;
+		if (!(benchmark->run((sl_uint16)(25300 + i), configs[i].flagCache, configs[i].countSockets))) {
+			Println("Failed to run DNS benchmark");
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,148 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#include <slib.h>
+
+using namespace slib;
+
+#define PACKET_SIZE 1200
+#define DURATION 2000
+#define SEND_WINDOW 2048
+#define SEGMENTS_PER_SEND 32
+
+class UdpBenchmark : public Referable
+{
+public:
+	sl_int64 nSent;
+	sl_int64 nReceived;
+	sl_int64 nSystemCalls;
+
+public:
+	sl_bool run(sl_uint16 port, sl_uint32 batchCount, sl_bool flagGso, sl_bool flagGro)
+	{
+		nSent = 0;
+		nReceived = 0;
+		nSystemCalls = 0;
+
+		Ref<AsyncIoLoop> loopServer = AsyncIoLoop::create();
+		Ref<AsyncIoLoop> loopClient = AsyncIoLoop::create();
+		if (loopServer.isNull() || loopClient.isNull()) {
+			return sl_false;
+		}
+
+		AsyncUdpSocketParam serverParam;
+		serverParam.bindAddress = SocketAddress(IPv4Address(127, 0, 0, 1), port);
+		serverParam.packetSize = PACKET_SIZE * SEGMENTS_PER_SEND;
+		serverParam.receiveBatchCount = batchCount;
+		serverParam.flagGro = flagGro;
+		serverParam.ioLoop = loopServer;
+		serverParam.onReceiveBatch = [this](AsyncUdpSocket*, SocketDatagram* datagrams, sl_uint32 count) {
+			sl_int64 n = 0;
+			for (sl_uint32 i = 0; i < count; i++) {
+				sl_uint32 sizeSegment = datagrams[i].sizeSegment;
+				if (sizeSegment) {
+					n += (datagrams[i].size + sizeSegment - 1) / sizeSegment;
+				} else {
+					n++;
+				}
+			}
+			Base::interlockedAdd64(&nReceived, n);
+			Base::interlockedIncrement64(&nSystemCalls);
+		};
+		Ref<AsyncUdpSocket> server = AsyncUdpSocket::create(serverParam);
+		if (server.isNull()) {
+			return sl_false;
+		}
+		server->getSocket()->setOption_ReceiveBufferSize(8 << 20);
+
+		AsyncUdpSocketParam clientParam;
+		clientParam.ioLoop = loopClient;
+		Ref<AsyncUdpSocket> client = AsyncUdpSocket::create(clientParam);
+		if (client.isNull()) {
+			return sl_false;
+		}
+		client->getSocket()->setOption_SendBufferSize(8 << 20);
+
+		SocketAddress addressTo(IPv4Address(127, 0, 0, 1), port);
+		Memory packet = Memory::create(PACKET_SIZE);
+		Memory packets = Memory::create(PACKET_SIZE * SEGMENTS_PER_SEND);
+		Base::resetMemory(packets.getData(), 0x55, packets.getSize());
+
+		sl_uint32 timeStart = System::getTickCount();
+		sl_uint32 timeStall = 0;
+		while (System::getTickCount() - timeStart < DURATION) {
+			// the sender is paced by the receiver, and lost datagrams are forgiven after 1ms
+			if (nSent - nReceived > SEND_WINDOW) {
+				if (!timeStall) {
+					timeStall = System::getTickCount();
+				} else if (System::getTickCount() - timeStall > 1) {
+					nSent = nReceived;
+					timeStall = 0;
+				}
+				Thread::sleep(0);
+				continue;
+			}
+			timeStall = 0;
+			if (flagGso) {
+				client->sendSegmentsTo(addressTo, packets, PACKET_SIZE);
+			} else {
+				for (sl_uint32 i = 0; i < SEGMENTS_PER_SEND; i++) {
+					client->sendTo(addressTo, packet);
+				}
+			}
+			nSent += SEGMENTS_PER_SEND;
+		}
+		sl_uint32 dt = System::getTickCount() - timeStart;
+		sl_int64 n = nReceived;
+		sl_int64 nCalls = nSystemCalls;
+		Println("batch=%d gso=%s gro=%s: %d packets/s, %d packets per receive call", batchCount, flagGso ? "on" : "off", flagGro ? "on" : "off", (sl_uint32)(n * 1000 / (dt ? dt : 1)), (sl_uint32)(nCalls ? n / nCalls : 0));
+
+		client->close();
+		server->close();
+		loopClient->release();
+		loopServer->release();
+		return sl_true;
+	}
+
+};
+
+int main(int argc, const char * argv[])
+{
+	struct {
+		sl_uint32 batchCount;
+		sl_bool flagGso;
+		sl_bool flagGro;
+	} configs[] = {
+		{1, sl_false, sl_false},
+		{16, sl_false, sl_false},
+		{16, sl_true, sl_false},
+		{16, sl_true, sl_true}
+	};
+	for (sl_uint32 i = 0; i < sizeof(configs) / sizeof(configs[0]); i++) {
+		Ref<UdpBenchmark> benchmark = new UdpBenchmark;
+		if (!(benchmark->run((sl_uint16)(24000 + i), configs[i].batchCount, configs[i].flagGso, configs[i].flagGro))) {
+			Println("Failed to run UDP benchmark");
+		}
+	}
+	return 0;
+}
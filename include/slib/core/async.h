@@ -42,6 +42,12 @@ namespace slib
 		InOut = 3
 	};
 
+	enum class AsyncIoLoopBackend
+	{
+		Default = 0, // epoll (Linux), kqueue (macOS, iOS), IOCP (Windows)
+		IoUring = 1 // Linux 5.13 or later, falls back to `Default` when not supported
+	};
+
 	class AsyncIoLoop;
 	class AsyncIoInstance;
 	class AsyncIoObject;
@@ -64,6 +70,8 @@ namespace slib
 		static void releaseDefault();
 
 		static Ref<AsyncIoLoop> create(sl_bool flagAutoStart = sl_true);
+
+		static Ref<AsyncIoLoop> create(AsyncIoLoopBackend backend, sl_bool flagAutoStart = sl_true);
 	
 	public:
 		void release();
@@ -72,6 +80,8 @@ namespace slib
 
 		sl_bool isRunning();
 
+		AsyncIoLoopBackend getBackend();
+
 
 		sl_bool addTask(const Function<void()>& task);
 	
@@ -90,6 +100,7 @@ namespace slib
 		sl_bool m_flagInit;
 		sl_bool m_flagRunning;
 		void* m_handle;
+		AsyncIoLoopBackend m_backend;
 
 		Ref<Thread> m_thread;
 
@@ -100,7 +111,7 @@ namespace slib
 		LinkedQueue< Ref<AsyncIoInstance> > m_queueInstancesClosed;
 
 	protected:
-		static void* _native_createHandle();
+		static void* _native_createHandle(AsyncIoLoopBackend& backend);
 		static void _native_closeHandle(void* handle);
 		void _native_runLoop();
 		sl_bool _native_attachInstance(AsyncIoInstance* instance, AsyncIoMode mode);
@@ -110,6 +121,8 @@ namespace slib
 	protected:
 		void _stepBegin();
 		void _stepEnd();
+
+		friend class _priv_AsyncIoUring;
 	
 	};
 	
@@ -168,6 +181,9 @@ namespace slib
 			sl_bool flagIn;
 			sl_bool flagOut;
 			sl_bool flagError;
+#endif
+#if defined(SLIB_PLATFORM_IS_LINUX)
+			sl_int32 result; // result of the completed io_uring operation
 #endif
 		};
 		virtual void onEvent(EventDesc* pev) = 0;
@@ -182,7 +198,13 @@ namespace slib
 		sl_bool m_flagOrdering;
 		Mutex m_lockOrdering;
 
+#if defined(SLIB_PLATFORM_IS_LINUX)
+		// io_uring requests referring to this instance, whose completions are not reaped yet
+		sl_uint32 m_nUringRequests;
+#endif
+
 		friend class AsyncIoLoop;
+		friend class _priv_AsyncIoUring;
 	};
 	
 	
@@ -510,6 +532,11 @@ namespace slib
 
 		static Ref<AsyncStream> openIOCP(const String& path, FileMode mode);
 #endif
+
+#if defined(SLIB_PLATFORM_IS_LINUX)
+		// returns simulated stream (`AsyncFile`) when the loop is not running on io_uring backend
+		static Ref<AsyncStream> openIoUring(const String& path, FileMode mode, const Ref<AsyncIoLoop>& loop);
+#endif
 	
 	public:
 		void close() override;
@@ -707,6 +734,9 @@ namespace slib
 	
 	class AsyncOutput;
 	
+// maximum number of memory chunks which are requested to the stream at once
+#define SLIB_ASYNC_OUTPUT_WRITE_CHUNKS_MAX 64
+
 	class AsyncOutputParam
 	{
 	public:
@@ -717,6 +747,8 @@ namespace slib
 		sl_uint32 bufferCount;
 
 		Function<void(AsyncOutput*, sl_bool flagError)> onEnd;
+		// called after some of the pending output is written to the stream
+		Function<void(AsyncOutput*)> onWrite;
 
 	public:
 		AsyncOutputParam();
@@ -743,8 +775,15 @@ namespace slib
 		void startWriting();
 
 		void close();
+		
+		sl_uint64 getWrittenSize();
+		
+		// size of the output which is queued but not written yet
+		sl_uint64 getPendingSize();
 
 	private:
+		void onAsyncCopyWrite(AsyncCopy* task);
+		
 		void onAsyncCopyEnd(AsyncCopy* task, sl_bool flagError);
 		
 		void onWriteStream(AsyncStreamResult* result);
@@ -756,18 +795,24 @@ namespace slib
 
 		void _write(sl_bool flagCompleted);
 
+		void _onWriteRequestComplete(sl_bool flagError);
+
 	protected:
 		Ref<AsyncStream> m_streamOutput;
 		sl_uint32 m_bufferSize;
 		sl_uint32 m_bufferCount;
 	
 		Function<void(AsyncOutput*, sl_bool)> m_onEnd;
+		Function<void(AsyncOutput*)> m_onWrite;
 
 		Ref<AsyncOutputBufferElement> m_elementWriting;
 		Ref<AsyncCopy> m_copy;
-		Memory m_bufWrite;
+		sl_uint32 m_countWritingRequests;
 		sl_bool m_flagWriting;
+		sl_bool m_flagWritingError;
 		sl_bool m_flagClosed;
+		sl_int64 m_sizeWritten;
+		sl_uint64 m_sizeCopyWritten;
 
 	};
 	
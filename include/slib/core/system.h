@@ -55,6 +55,10 @@ namespace slib
 		static sl_uint32 getTickCount();
 	
 
+		// CPU Features
+		static sl_bool isAVX2Supported();
+	
+
 		// Process & Thread
 		static sl_uint32 getProcessId();
 
@@ -27,11 +27,94 @@
 
 #include "../core/object.h"
 #include "../core/variant.h"
+#include "../core/linked_list.h"
+#include "../core/function.h"
 
 namespace slib
 {
 	
 	class Database;
+	class DatabaseCursor;
+	
+	enum class DatabaseColumnType
+	{
+		Int64 = 0,
+		Double = 1,
+		Text = 2
+	};
+	
+	class SLIB_EXPORT DatabaseColumnBuffer
+	{
+	public:
+		DatabaseColumnType type;
+		// sl_int64 or double values, or `sl_size` offsets of text
+		Memory values;
+		Memory nullFlags;
+		Memory text;
+		sl_size sizeText;
+		
+	public:
+		DatabaseColumnBuffer();
+		
+		~DatabaseColumnBuffer();
+		
+	};
+	
+	// column-oriented buffer receiving a block of rows from `DatabaseCursor::fetchBatch()`
+	class SLIB_EXPORT DatabaseColumnBatch
+	{
+	public:
+		DatabaseColumnBatch();
+		
+		~DatabaseColumnBatch();
+		
+	public:
+		// the column `i` of the batch receives the column `i` of the result
+		sl_bool initialize(const DatabaseColumnType* types, sl_uint32 nColumns, sl_uint32 nRowsCapacity);
+		
+		sl_uint32 getColumnsCount() const;
+		
+		sl_uint32 getRowsCapacity() const;
+		
+		sl_uint32 getRowsCount() const;
+		
+		// true if the last `DatabaseCursor::fetchBatch()` stopped at a row which could not be stored. the row is consumed from the cursor and not included in the batch
+		sl_bool isError() const;
+		
+		DatabaseColumnType getColumnType(sl_uint32 column) const;
+		
+		// returns null if the column is not Int64 column
+		sl_int64* getInt64Values(sl_uint32 column) const;
+		
+		// returns null if the column is not Double column
+		double* getDoubleValues(sl_uint32 column) const;
+		
+		// text of row `i` is placed at [offsets[i], offsets[i+1]) of `getTextData()`
+		sl_size* getTextOffsets(sl_uint32 column) const;
+		
+		sl_char8* getTextData(sl_uint32 column) const;
+		
+		String getText(sl_uint32 column, sl_uint32 row) const;
+		
+		// non-zero for NULL values
+		sl_uint8* getNullFlags(sl_uint32 column) const;
+		
+		sl_bool isNull(sl_uint32 column, sl_uint32 row) const;
+		
+		// removes the rows, keeping the buffers
+		void clear();
+		
+	protected:
+		sl_bool _appendText(DatabaseColumnBuffer& column, const void* data, sl_size size);
+		
+	protected:
+		Array<DatabaseColumnBuffer> m_columns;
+		sl_uint32 m_nRowsCapacity;
+		sl_uint32 m_nRows;
+		sl_bool m_flagError;
+		
+		friend class DatabaseCursor;
+	};
 	
 	class SLIB_EXPORT DatabaseCursor : public Object
 	{
@@ -110,8 +193,20 @@ namespace slib
 		virtual Memory getBlob(const String& name);
 	
 
+		virtual sl_bool isNull(sl_uint32 index);
+	
+		// provides the text of current row without copying, valid until `moveNext()`. returns false if not supported
+		virtual sl_bool getTextData(sl_uint32 index, const void*& outData, sl_size& outSize);
+	
+
 		virtual sl_bool moveNext() = 0;
 	
+		// fills up to `batch.getRowsCapacity()` rows, returns the count of fetched rows (0 at the end). check `batch.isError()` to distinguish a failure from the end
+		virtual sl_uint32 fetchBatch(DatabaseColumnBatch& batch);
+	
+		// visits the remaining rows without building row maps, stops when `onRow` returns false. returns the count of visited rows
+		sl_uint64 forEachRow(const Function<sl_bool(DatabaseCursor*)>& onRow);
+	
 	protected:
 		Ref<Database> m_db;
 
@@ -204,6 +299,13 @@ namespace slib
 
 	};
 	
+	class SLIB_EXPORT DatabaseCachedStatement
+	{
+	public:
+		String sql;
+		void* handle;
+	};
+	
 	class SLIB_EXPORT Database : public Object
 	{
 		SLIB_DECLARE_OBJECT
@@ -280,6 +382,15 @@ namespace slib
 		
 		void setLoggingErrors(sl_bool flag);
 		
+		// maximum number of prepared statements kept for reuse. 0 disables the cache (default: 64)
+		sl_uint32 getStatementCacheSize();
+		
+		void setStatementCacheSize(sl_uint32 size);
+		
+		void clearStatementCache();
+		
+		virtual sl_bool ping();
+		
 	protected:
 		virtual sl_int64 _execute(const String& sql);
 		
@@ -296,10 +407,24 @@ namespace slib
 		void _logError(const String& sql);
 		
 		void _logError(const String& sql, const Variant* params, sl_uint32 nParams);
+		
+		// takes out the statement handle prepared for `sql`, returns null if not cached
+		void* _takeCachedStatement(const String& sql);
+		
+		// returns false if the handle is not cached, then the caller should free it
+		sl_bool _putCachedStatement(const String& sql, void* handle);
+		
+		// the backends should call `clearStatementCache()` in their destructors
+		virtual void _freeCachedStatement(void* handle);
 
 	protected:
 		sl_bool m_flagLogSQL;
 		sl_bool m_flagLogErrors;
+		
+		sl_uint32 m_sizeStatementCache;
+		// most recently used statements are placed at front
+		CLinkedList<DatabaseCachedStatement> m_listCachedStatements;
+		CHashMap< String, Link<DatabaseCachedStatement>* > m_mapCachedStatements;
 	
 	};
 
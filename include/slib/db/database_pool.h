@@ -0,0 +1,150 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#ifndef CHECKHEADER_SLIB_DB_DATABASE_POOL
+#define CHECKHEADER_SLIB_DB_DATABASE_POOL
+
+#include "definition.h"
+
+#include "database.h"
+
+#include "../core/event.h"
+#include "../core/function.h"
+
+namespace slib
+{
+	
+	class SLIB_EXPORT DatabasePoolParam
+	{
+	public:
+		sl_uint32 minConnectionsCount; // default: 1
+		sl_uint32 maxConnectionsCount; // default: 8
+		
+		// milliseconds waiting for a connection when all connections are in use, negative means INFINITE (default: 10000)
+		sl_int32 acquireTimeout;
+		
+		// milliseconds. idle connections are checked by `Database::ping()` before being reused (default: 30000)
+		sl_uint32 healthCheckInterval;
+		
+		// milliseconds. idle connections are closed while the pool has more than `minConnectionsCount` connections (default: 600000)
+		sl_uint32 maxIdleTime;
+		
+		Function<Ref<Database>()> onCreateConnection;
+		
+	public:
+		DatabasePoolParam();
+		
+		DatabasePoolParam(const DatabasePoolParam& other);
+		
+		~DatabasePoolParam();
+		
+	public:
+		DatabasePoolParam& operator=(const DatabasePoolParam& other);
+		
+	};
+	
+	class SLIB_EXPORT DatabasePoolItem
+	{
+	public:
+		Ref<Database> db;
+		sl_uint64 threadId;
+		sl_uint32 timeLastUsed;
+	};
+	
+	class SLIB_EXPORT DatabasePool : public Object
+	{
+		SLIB_DECLARE_OBJECT
+		
+	protected:
+		DatabasePool();
+		
+		~DatabasePool();
+		
+	public:
+		static Ref<DatabasePool> create(const DatabasePoolParam& param);
+		
+	public:
+		// prefers the connection which was used by current thread last time
+		Ref<Database> acquire();
+		
+		// connections which are not acquired from this pool, or already released, are ignored
+		void release(Database* db);
+		
+		// the connection is removed from the pool instead of being returned, and closed when its last reference is released
+		void discard(Database* db);
+		
+		sl_uint32 getConnectionsCount();
+		
+		sl_uint32 getIdleConnectionsCount();
+		
+		const DatabasePoolParam& getParam();
+		
+	protected:
+		Ref<Database> _createConnection();
+		
+		sl_bool _checkConnection(DatabasePoolItem& item, sl_uint32 now);
+		
+	protected:
+		DatabasePoolParam m_param;
+		
+		// most recently released connections are placed at back
+		List<DatabasePoolItem> m_listIdle;
+		// connections acquired and not returned yet
+		List< Ref<Database> > m_listAcquired;
+		sl_uint32 m_nConnections;
+		Ref<Event> m_eventRelease;
+		
+	};
+	
+	class SLIB_EXPORT DatabasePoolConnection
+	{
+	public:
+		DatabasePoolConnection(DatabasePool* pool);
+		
+		~DatabasePoolConnection();
+		
+	public:
+		Database* get() const;
+		
+		sl_bool isNull() const;
+		
+		sl_bool isNotNull() const;
+		
+		// returns the connection to the pool before destruction
+		void release();
+		
+		// closes the connection, for example after a fatal error
+		void discard();
+		
+	public:
+		Database* operator->() const;
+		
+	private:
+		Ref<DatabasePool> m_pool;
+		Ref<Database> m_db;
+		
+	};
+
+}
+
+#endif
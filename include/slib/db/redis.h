@@ -27,9 +27,52 @@
 
 #include "../core/object.h"
 #include "../core/variant.h"
+#include "../core/queue.h"
+#include "../network/async.h"
 
 namespace slib
 {
+	
+	class SLIB_EXPORT RedisPipeline
+	{
+	public:
+		RedisPipeline();
+		
+		~RedisPipeline();
+		
+	public:
+		// Memory arguments are sent as raw bytes, and other arguments are sent as strings
+		void appendBy(const Variant* args, sl_uint32 nArgs);
+		
+		template <class... ARGS>
+		SLIB_INLINE void append(ARGS&&... args)
+		{
+			Variant params[] = {Forward<ARGS>(args)...};
+			appendBy(params, sizeof...(args));
+		}
+		
+		void set(const String& key, const Variant& value);
+		
+		void get(const String& key);
+		
+		void del(const String& key);
+		
+		void incr(const String& key);
+		
+		void incrby(const String& key, sl_int64 n);
+		
+		void expire(const String& key, sl_int64 seconds);
+		
+		sl_uint32 getCount() const;
+		
+		const List<VariantList>& getCommands() const;
+		
+		void clear();
+		
+	protected:
+		List<VariantList> m_commands;
+		
+	};
 
 	class SLIB_EXPORT RedisDatabase : public Object
 	{
@@ -47,6 +90,25 @@ namespace slib
 		virtual sl_bool execute(const String& command, Variant* pValue) = 0;
 		
 		Variant execute(const String& key);
+		
+		// binary-safe command: Memory arguments are sent as raw bytes, and other arguments are sent as strings
+		virtual sl_bool executeBy(const Variant* args, sl_uint32 nArgs, Variant* pValue) = 0;
+		
+		template <class... ARGS>
+		SLIB_INLINE Variant command(ARGS&&... args)
+		{
+			Variant params[] = {Forward<ARGS>(args)...};
+			Variant ret;
+			if (executeBy(params, sizeof...(args), &ret)) {
+				return ret;
+			}
+			return sl_null;
+		}
+		
+		// sends all commands of the pipeline at once, and collects the replies in order (error replies are stored as null)
+		virtual sl_bool executePipeline(const RedisPipeline& pipeline, VariantList* pReplies) = 0;
+		
+		VariantList executePipeline(const RedisPipeline& pipeline);
 
 		virtual sl_bool set(const String& key, const Variant& value) = 0;
 		
@@ -58,6 +120,13 @@ namespace slib
 
 		virtual sl_bool del(const String& key) = 0;
 		
+		// values of missing keys are null
+		virtual sl_bool mget(const List<String>& keys, VariantList* pValues) = 0;
+		
+		VariantList mget(const List<String>& keys);
+		
+		virtual sl_bool mset(const HashMap<String, Variant>& values) = 0;
+		
 		virtual sl_bool incr(const String& key, sl_int64* pValue) = 0;
 		
 		sl_int64 incr(const String& key, sl_int64 def = 0);
@@ -117,6 +186,90 @@ namespace slib
 		sl_bool m_flagLogErrors;
 		
 	};
+	
+	class AsyncRedisClient;
+	
+	class SLIB_EXPORT AsyncRedisClientParam
+	{
+	public:
+		SocketAddress address;
+		Ref<AsyncIoLoop> ioLoop;
+		
+		Function<void(AsyncRedisClient*, sl_bool flagError)> onConnect;
+		Function<void(AsyncRedisClient*)> onError;
+		
+	public:
+		AsyncRedisClientParam();
+		
+		AsyncRedisClientParam(const AsyncRedisClientParam& other);
+		
+		~AsyncRedisClientParam();
+		
+	};
+	
+	// Commands are pipelined on one connection, and the replies are delivered on the I/O loop in order
+	class SLIB_EXPORT AsyncRedisClient : public Object
+	{
+		SLIB_DECLARE_OBJECT
+		
+	protected:
+		AsyncRedisClient();
+		
+		~AsyncRedisClient();
+		
+	public:
+		static Ref<AsyncRedisClient> create(const AsyncRedisClientParam& param);
+		
+	public:
+		void close();
+		
+		sl_bool isConnected();
+		
+		// On error, `reply` is the error message of the server, or null when the connection is failed. Memory arguments are sent as raw bytes
+		sl_bool executeBy(const Variant* args, sl_uint32 nArgs, const Function<void(AsyncRedisClient*, sl_bool flagError, Variant& reply)>& callback);
+		
+		template <class... ARGS>
+		SLIB_INLINE sl_bool execute(const Function<void(AsyncRedisClient*, sl_bool flagError, Variant& reply)>& callback, ARGS&&... args)
+		{
+			Variant params[] = {Forward<ARGS>(args)...};
+			return executeBy(params, sizeof...(args), callback);
+		}
+		
+		sl_bool get(const String& key, const Function<void(AsyncRedisClient*, sl_bool flagError, Variant& reply)>& callback);
+		
+		sl_bool set(const String& key, const Variant& value, const Function<void(AsyncRedisClient*, sl_bool flagError, Variant& reply)>& callback = sl_null);
+		
+		sl_bool del(const String& key, const Function<void(AsyncRedisClient*, sl_bool flagError, Variant& reply)>& callback = sl_null);
+		
+		sl_bool mget(const List<String>& keys, const Function<void(AsyncRedisClient*, sl_bool flagError, Variant& reply)>& callback);
+		
+		sl_bool mset(const HashMap<String, Variant>& values, const Function<void(AsyncRedisClient*, sl_bool flagError, Variant& reply)>& callback = sl_null);
+		
+	protected:
+		void _receive(AsyncTcpSocket* socket);
+		
+		void _onConnect(AsyncTcpSocket* socket, const SocketAddress& address, sl_bool flagError);
+		
+		void _onReceive(AsyncStreamResult* result);
+		
+		void _onSend(AsyncStreamResult* result);
+		
+		void _onError();
+		
+	protected:
+		Ref<AsyncTcpSocket> m_socket;
+		void* m_reader;
+		sl_bool m_flagConnected;
+		sl_bool m_flagClosed;
+		Memory m_bufReceive;
+		// commands requested before the connection is established
+		MemoryQueue m_queuePendingCommands;
+		LinkedQueue< Function<void(AsyncRedisClient*, sl_bool flagError, Variant& reply)> > m_queueCallbacks;
+		
+		Function<void(AsyncRedisClient*, sl_bool flagError)> m_onConnect;
+		Function<void(AsyncRedisClient*)> m_onError;
+		
+	};
 
 }
 
@@ -38,6 +38,7 @@
 #include "graphics/drawable.h"
 #include "graphics/bitmap.h"
 #include "graphics/image.h"
+#include "graphics/image_stream.h"
 
 #include "graphics/canvas.h"
 
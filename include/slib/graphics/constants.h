@@ -110,6 +110,8 @@ namespace slib
 		Nearest = 0,
 		Linear = 1,
 		Box = 2,
+		Bicubic = 3, // separable, Catmull-Rom (a = -0.5)
+		Lanczos = 4, // separable, 3 lobes
 		
 		Default = Box
 	};
@@ -30,6 +30,7 @@
 
 #include "../math/rectangle.h"
 #include "../core/hash_map.h"
+#include "../core/list.h"
 
 namespace slib
 {
@@ -40,6 +41,7 @@ namespace slib
 		Ref<Font> font;
 		sl_uint32 planeWidth;
 		sl_uint32 planeHeight;
+		// when all planes are full, the glyphs on the least recently used plane are evicted
 		sl_uint32 maxPlanes;
 
 	public:
@@ -66,6 +68,9 @@ namespace slib
 
 	};
 	
+	class FreeType;
+	class _priv_FontAtlasPlane;
+	
 	class SLIB_EXPORT FontAtlas : public Object
 	{
 		SLIB_DECLARE_OBJECT
@@ -81,20 +86,56 @@ namespace slib
 		static Ref<FontAtlas> getShared(const Ref<Font>& font);
 
 		static void removeAllShared();
+		
+		// signed distance field atlas from the outlines of `face`, drawn at any font size. `face` is resized to `fieldSize`
+		static Ref<FontAtlas> createDistanceField(const Ref<FreeType>& face, sl_uint32 fieldSize = 32, sl_uint32 spread = 4);
+		
+		// RenderCanvas draws the text of the font family with the distance field atlas
+		static void setSharedDistanceField(const String& fontFamily, const Ref<FontAtlas>& atlas, sl_bool flagBold = sl_false);
+		
+		static Ref<FontAtlas> getSharedDistanceField(const Ref<Font>& font);
+		
+		// reads a character at `pos` combining the surrogate pair, and advances `pos`
+		static sl_char32 readChar(const sl_char16* text, sl_size len, sl_size& pos);
 
 	public:
-		sl_bool getChar(sl_char16 ch, FontAtlasChar& _out);
-
-		Size getFontSize(sl_char16 ch);
-
-		Size getFontSize_NoLock(sl_char16 ch);
+		sl_bool isDistanceField();
+		
+		// font size of the glyph metrics
+		sl_real getDistanceFieldSize();
+		
+		// padding of the glyph regions, in pixels of the planes
+		sl_uint32 getDistanceFieldSpread();
+		
+		sl_real getFontHeight();
+		
+		sl_bool getChar(sl_char32 ch, FontAtlasChar& _out);
+
+		Size getFontSize(sl_char32 ch);
+
+		Size getFontSize_NoLock(sl_char32 ch);
 
 		Size measureText(const String16& text, sl_bool flagMultiLine = sl_false);
+		
+		// rasterizes the glyphs of the text which are not cached yet, in one pass
+		void prepareText(const String16& text);
 	
 		void removeAll();
 
 	protected:
-		sl_bool _getChar(sl_char16 ch, sl_bool flagSizeOnly, FontAtlasChar& _out);
+		sl_bool _getChar(sl_char32 ch, sl_bool flagSizeOnly, FontAtlasChar& _out);
+		
+		sl_bool _measureChar(sl_char32 ch, FontAtlasChar& _out);
+		
+		sl_bool _drawChar(sl_char32 ch, FontAtlasChar& _out);
+		
+		Sizei _getCellSize(sl_char32 ch, const FontAtlasChar& fac);
+		
+		_priv_FontAtlasPlane* _allocateRegion(sl_uint32 width, sl_uint32 height, Rectanglei& _out);
+		
+		void _touchPlane(Bitmap* bitmap);
+		
+		void _evictPlane(_priv_FontAtlasPlane* plane);
 
 	protected:
 		Ref<Font> m_fontSource;
@@ -103,14 +144,16 @@ namespace slib
 		sl_uint32 m_planeHeight;
 		sl_uint32 m_maxPlanes;
 		sl_real m_fontSourceHeight;
-
-		CHashMap<sl_char16, FontAtlasChar> m_map;
-		sl_uint32 m_countPlanes;
-		Ref<Bitmap> m_currentPlane;
-		Ref<Canvas> m_currentCanvas;
-		sl_uint32 m_currentPlaneY;
-		sl_uint32 m_currentPlaneX;
-		sl_uint32 m_currentPlaneRowHeight;
+		
+		Ref<FreeType> m_face;
+		sl_bool m_flagDistanceField;
+		sl_uint32 m_distanceFieldSize;
+		sl_uint32 m_distanceFieldSpread;
+		sl_real m_distanceFieldAscent;
+
+		CHashMap<sl_char32, FontAtlasChar> m_map;
+		CList< Ref<_priv_FontAtlasPlane> > m_planes;
+		sl_uint64 m_stampUse;
 
 	};
 
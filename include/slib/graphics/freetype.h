@@ -31,6 +31,7 @@
 #include "../math/size.h"
 
 #include "color.h"
+#include "font.h"
 
 struct FT_LibraryRec_;
 struct FT_FaceRec_;
@@ -41,6 +42,23 @@ namespace slib
 	class Image;
 
 	class _priv_FreeTypeLibrary;
+	
+	class SLIB_EXPORT FreeTypeGlyphField
+	{
+	public:
+		// alpha: 128 on the outline, increasing to the inside
+		Ref<Image> image;
+		// left-top corner of the image from the origin on the baseline (y upward)
+		sl_int32 left;
+		sl_int32 top;
+		sl_real advance;
+		
+	public:
+		FreeTypeGlyphField();
+		
+		~FreeTypeGlyphField();
+		
+	};
 
 	class SLIB_EXPORT FreeType : public Object
 	{
@@ -69,6 +87,14 @@ namespace slib
 		Size getStringExtent(const sl_char16* sz, sl_uint32 len);
 
 		Size getStringExtent(const String16& text);
+		
+		// metrics at current size
+		sl_bool getFontMetrics(FontMetrics& _out);
+		
+		sl_real getCharAdvance(sl_char32 ch);
+		
+		// signed distance field of the glyph outline at current size, `spread`: distance in pixels mapped to the half range
+		sl_bool getGlyphDistanceField(sl_char32 ch, sl_uint32 spread, FreeTypeGlyphField& _out);
 
 		// draw starting at left-bottom corner
 		void drawString(const Ref<Image>& imageOutput, sl_int32 x, sl_int32 y, const sl_char16* sz, sl_uint32 len, const Color& color);
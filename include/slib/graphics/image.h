@@ -36,6 +36,8 @@
 namespace slib
 {
 	
+	class ThreadPool;
+	
 	class SLIB_EXPORT ImageDesc
 	{
 	public:
@@ -53,6 +55,20 @@ namespace slib
 
 	};
 	
+	class SLIB_EXPORT ImageInfo
+	{
+	public:
+		ImageFileType type;
+		sl_uint32 width;
+		sl_uint32 height;
+
+	public:
+		ImageInfo();
+
+		~ImageInfo();
+
+	};
+	
 	class SLIB_EXPORT Image : public Bitmap
 	{
 		SLIB_DECLARE_OBJECT
@@ -122,6 +138,9 @@ namespace slib
 
 		static void draw(ImageDesc& dst, const ImageDesc& src, BlendMode blend = BlendMode::Copy, StretchMode stretch = StretchMode::Default);
 
+		// `threadPool` splits the rows of Bicubic and Lanczos resampling across the threads
+		static void draw(ImageDesc& dst, const ImageDesc& src, BlendMode blend, StretchMode stretch, const Ref<ThreadPool>& threadPool);
+
 		void drawImage(sl_int32 dx, sl_int32 dy, sl_int32 dw, sl_int32 dh,
 					   const Ref<Image>& src, sl_int32 sx, sl_int32 sy, sl_int32 sw, sl_int32 sh,
 					   BlendMode blend = BlendMode::Copy, StretchMode stretch = StretchMode::Default);
@@ -141,13 +160,24 @@ namespace slib
 
 		Ref<Image> scale(sl_uint32 width, sl_uint32 height, StretchMode stretch = StretchMode::Default) const;
 
+		Ref<Image> scale(sl_uint32 width, sl_uint32 height, StretchMode stretch, const Ref<ThreadPool>& threadPool) const;
+
 		Ref<Image> scaleToSmall(sl_uint32 requiredWidth, sl_uint32 requiredHeight, StretchMode stretch = StretchMode::Default) const;
 
+		Ref<Image> scaleToSmall(sl_uint32 requiredWidth, sl_uint32 requiredHeight, StretchMode stretch, const Ref<ThreadPool>& threadPool) const;
+
 
 		static ImageFileType getFileType(const void* mem, sl_size size);
 
 		static ImageFileType getFileType(Memory mem);
 
+		// reads the header only, without decoding the pixels
+		static sl_bool getImageInfo(const void* mem, sl_size size, ImageInfo& info);
+
+		static sl_bool getImageInfo(Memory mem, ImageInfo& info);
+
+		static sl_bool getImageInfoFromFile(const String& filePath, ImageInfo& info);
+
 		static Ref<Image> loadFromMemory(const void* mem, sl_size size, sl_uint32 width = 0, sl_uint32 height = 0);
 
 		static Ref<Image> loadFromMemory(Memory mem, sl_uint32 width = 0, sl_uint32 height = 0);
@@ -172,6 +202,12 @@ namespace slib
 		
 		static Ref<Image> loadPNG(const void* content, sl_size size);
 
+		// decodes row by row, reducing the rows by an integer box filter to the smallest size not less than the required size
+		static Ref<Image> loadPNG(const void* content, sl_size size, sl_uint32 requiredWidth, sl_uint32 requiredHeight);
+
+		// decodes `region` (in source pixels) only, and stops reading after the last row of the region
+		static Ref<Image> loadPNG(const void* content, sl_size size, const Rectanglei& region, sl_uint32 requiredWidth = 0, sl_uint32 requiredHeight = 0);
+
 		static Memory savePNG(const Ref<Image>& image);
 
 		Memory savePNG();
@@ -183,6 +219,12 @@ namespace slib
 
 		static Ref<Image> loadJPEG(const void* content, sl_size size);
 
+		// uses the DCT scaling (N/8) of the decoder to get the smallest size not less than the required size
+		static Ref<Image> loadJPEG(const void* content, sl_size size, sl_uint32 requiredWidth, sl_uint32 requiredHeight);
+
+		// decodes `region` (in source pixels) only, and stops reading after the last row of the region
+		static Ref<Image> loadJPEG(const void* content, sl_size size, const Rectanglei& region, sl_uint32 requiredWidth = 0, sl_uint32 requiredHeight = 0);
+
 		static Memory saveJPEG(const Ref<Image>& image, float quality = 0.5f);
 
 		Memory saveJPEG(float quality = 0.5f);
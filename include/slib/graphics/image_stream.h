@@ -0,0 +1,97 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#ifndef CHECKHEADER_SLIB_GRAPHICS_IMAGE_STREAM
+#define CHECKHEADER_SLIB_GRAPHICS_IMAGE_STREAM
+
+/****************************************
+ 
+	Row-by-row image encoding and decoding.
+	Memory usage is proportional to one row (plus the codec state),
+	instead of the whole bitmap.
+ 
+*****************************************/
+
+#include "definition.h"
+
+#include "constants.h"
+#include "color.h"
+
+#include "../core/io.h"
+#include "../core/object.h"
+
+namespace slib
+{
+	
+	// receives the rows of an image from top to bottom
+	class SLIB_EXPORT IImageRowWriter
+	{
+	public:
+		IImageRowWriter();
+
+		virtual ~IImageRowWriter();
+
+	public:
+		// returns false to stop decoding
+		virtual sl_bool beginImage(sl_uint32 width, sl_uint32 height) = 0;
+
+		// `colors`: `width` non-premultiplied pixels of the next row. returns false to stop decoding
+		virtual sl_bool writeRow(const Color* colors) = 0;
+
+		virtual sl_bool endImage() = 0;
+
+	};
+	
+	class SLIB_EXPORT ImageRowEncoder : public Referable, public IImageRowWriter
+	{
+	public:
+		ImageRowEncoder();
+
+		~ImageRowEncoder();
+
+	public:
+		// `writer` should be alive while encoding
+		static Ref<ImageRowEncoder> createPNG(IWriter* writer);
+
+		static Ref<ImageRowEncoder> createJPEG(IWriter* writer, float quality = 0.5f);
+
+	};
+	
+	class SLIB_EXPORT ImageRowDecoder
+	{
+	public:
+		static sl_bool decodePNG(IReader* reader, IImageRowWriter* output);
+
+		static sl_bool decodeJPEG(IReader* reader, IImageRowWriter* output);
+
+		// detects the file type (JPEG, PNG) from the signature
+		static sl_bool decode(IReader* reader, IImageRowWriter* output);
+
+		// decodes JPEG or PNG from `reader`, and encodes the rows to `encoder`
+		static sl_bool transcode(IReader* reader, const Ref<ImageRowEncoder>& encoder);
+
+	};
+
+}
+
+#endif
@@ -27,6 +27,9 @@
 
 #include "image.h"
 
+#include "../core/list.h"
+#include "../core/thread_pool.h"
+
 namespace slib
 {
 	
@@ -99,6 +102,59 @@ namespace slib
 		
 	};
 	
+	class ZXingBatchScanParam
+	{
+	public:
+		ZXingFormat format;
+		
+		// results are ordered as `images`, followed by `filePaths`
+		List< Ref<Image> > images;
+		List<String> filePaths;
+		
+		sl_bool flagTryHarder;
+		sl_bool flagTryRotate;
+		
+		// images larger than this size are scanned on a downscaled copy at first, 0: disabled, default: 1024
+		sl_uint32 preDetectSize;
+		
+		// when `threadPool` is null, a pool of `threadsCount` threads is created for the batch, 0: number of CPU cores
+		Ref<ThreadPool> threadPool;
+		sl_uint32 threadsCount;
+		
+	public:
+		ZXingBatchScanParam();
+		
+		ZXingBatchScanParam(const ZXingBatchScanParam& other) = default;
+		
+		ZXingBatchScanParam(ZXingBatchScanParam&& other) = default;
+		
+		ZXingBatchScanParam& operator=(const ZXingBatchScanParam& other) = default;
+		
+		ZXingBatchScanParam& operator=(ZXingBatchScanParam&& other) = default;
+		
+	};
+	
+	class ZXingScanResult
+	{
+	public:
+		String text; // null when no code is detected
+		sl_bool flagLoaded; // false when the image is null or the file is failed to load
+		sl_bool flagPreDetected; // detected on the downscaled copy
+		sl_uint64 elapsedMicroseconds; // including file loading
+		
+	public:
+		ZXingScanResult();
+		
+		ZXingScanResult(const ZXingScanResult& other) = default;
+		
+		ZXingScanResult(ZXingScanResult&& other) = default;
+		
+		ZXingScanResult& operator=(const ZXingScanResult& other) = default;
+		
+		ZXingScanResult& operator=(ZXingScanResult&& other) = default;
+		
+	};
+	
 	class ZXing
 	{
 	public:
@@ -106,6 +162,9 @@ namespace slib
 		
 		static String scan(const ZXingScanParam& param);
 		
+		// scans the images in parallel, and waits for completion
+		static List<ZXingScanResult> scanBatch(const ZXingBatchScanParam& param);
+		
 	};
 	
 }
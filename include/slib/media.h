@@ -28,6 +28,7 @@
 #include "media/audio_player.h"
 #include "media/audio_recorder.h"
 #include "media/audio_util.h"
+#include "media/audio_resampler.h"
 
 #include "media/video_frame.h"
 #include "media/video_capture.h"
@@ -0,0 +1,96 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#ifndef CHECKHEADER_SLIB_MEDIA_AUDIO_RESAMPLER
+#define CHECKHEADER_SLIB_MEDIA_AUDIO_RESAMPLER
+
+#include "definition.h"
+
+#include "audio_data.h"
+
+#include "../core/memory.h"
+
+namespace slib
+{
+	
+	// polyphase windowed-sinc sample rate converter
+	class SLIB_EXPORT AudioResampler : public Referable
+	{
+	public:
+		AudioResampler();
+		
+		~AudioResampler();
+		
+	public:
+		// `nChannels` is 1 or 2, `nTaps` (filter length per output sample) is rounded up to a multiple of 4
+		static Ref<AudioResampler> create(sl_uint32 samplesPerSecondInput, sl_uint32 samplesPerSecondOutput, sl_uint32 nChannels, sl_uint32 nTaps = 32);
+		
+	public:
+		sl_uint32 getInputSamplingRate();
+		
+		sl_uint32 getOutputSamplingRate();
+		
+		sl_uint32 getChannelsCount();
+		
+		// output is delayed by (taps / 2) input samples
+		sl_uint32 getDelay();
+		
+		// maximum count of the output samples available after appending `countInput` samples
+		sl_size getOutputSamplesCount(sl_size countInput);
+		
+		// appends all samples of `input` (any format), and writes up to `output.count` samples. Returns the count of written samples. Remaining input samples are kept for the next call.
+		sl_size resample(const AudioData& input, const AudioData& output);
+		
+		void reset();
+		
+	protected:
+		sl_bool _reserve(sl_size count);
+		
+		void _getFilter(float* filter);
+		
+	protected:
+		sl_uint32 m_rateInput;
+		sl_uint32 m_rateOutput;
+		sl_uint32 m_nChannels;
+		sl_uint32 m_nTaps;
+		
+		// output samples are taken at every (m_nDown / m_nUp) input samples
+		sl_uint32 m_nUp;
+		sl_uint32 m_nDown;
+		
+		// (m_nPhases + 1) filters of m_nTaps coefficients. Adjacent filters are interpolated when m_nPhases is less than m_nUp
+		Memory m_filters;
+		sl_uint32 m_nPhases;
+		
+		// planar float samples for each channel
+		Memory m_buffer;
+		sl_size m_capacity;
+		sl_size m_countBuffered;
+		sl_size m_pos;
+		sl_uint32 m_phase;
+		
+	};
+
+}
+
+#endif
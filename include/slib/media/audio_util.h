@@ -173,6 +173,28 @@ namespace slib
 		
 		static void mixSamples(float in1, float in2, float& _out);
 		
+		
+		static void mixSamples(sl_size count, const sl_int8* in1, const sl_int8* in2, sl_int8* _out);
+		
+		static void mixSamples(sl_size count, const sl_uint8* in1, const sl_uint8* in2, sl_uint8* _out);
+		
+		static void mixSamples(sl_size count, const sl_int16* in1, const sl_int16* in2, sl_int16* _out);
+		
+		static void mixSamples(sl_size count, const sl_uint16* in1, const sl_uint16* in2, sl_uint16* _out);
+		
+		static void mixSamples(sl_size count, const float* in1, const float* in2, float* _out);
+		
+		// mixes `count` interleaved frames of `nChannels` channels into mono samples
+		static void mixChannels(sl_size count, sl_uint32 nChannels, const sl_int8* _in, sl_int8* _out);
+		
+		static void mixChannels(sl_size count, sl_uint32 nChannels, const sl_uint8* _in, sl_uint8* _out);
+		
+		static void mixChannels(sl_size count, sl_uint32 nChannels, const sl_int16* _in, sl_int16* _out);
+		
+		static void mixChannels(sl_size count, sl_uint32 nChannels, const sl_uint16* _in, sl_uint16* _out);
+		
+		static void mixChannels(sl_size count, sl_uint32 nChannels, const float* _in, float* _out);
+		
 	};
 	
 }
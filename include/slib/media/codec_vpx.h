@@ -89,6 +89,10 @@ namespace slib
 		
 	};
 	
+	/*
+		If `output.image` of `decode()` has no buffer, the decoded frame is returned by reference to a pooled buffer, without copying into the caller's memory.
+		The pooled buffer is reused after the caller releases `output.image`. The pixels should be treated as read-only, because VP9 decoder keeps referencing them for the following frames.
+	*/
 	class SLIB_EXPORT VpxDecoder : public VideoDecoder
 	{
 	public:
@@ -32,6 +32,9 @@
 #include "network/os.h"
 #include "network/socket.h"
 #include "network/async.h"
+#include "network/tcp_relay.h"
+#include "network/tcp_pool.h"
+#include "network/rpc.h"
 #include "network/io.h"
 #include "network/event.h"
 #include "network/capture.h"
@@ -42,6 +42,7 @@ namespace slib
 		Ref<Socket> socket;
 		SocketAddress bindAddress;
 		SocketAddress connectAddress;
+		String connectHostAddress; // "hostname:port", used when `connectAddress` is not valid. resolved by `DnsResolver::getDefault()`
 		sl_bool flagIPv6; // default: false
 		sl_bool flagLogError; // default: true
 		Ref<AsyncIoLoop> ioLoop;
@@ -73,6 +74,9 @@ namespace slib
 		
 		sl_bool connect(const SocketAddress& address);
 		
+		// resolves the host name asynchronously by `DnsResolver::getDefault()`, fails if there is no default resolver
+		sl_bool connect(const String& hostName, sl_uint16 port);
+		
 		sl_bool receive(void* data, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject = sl_null);
 		
 		sl_bool receive(const Memory& mem, const Function<void(AsyncStreamResult*)>& callback);
@@ -185,9 +189,14 @@ namespace slib
 		sl_bool flagAutoStart; // default: true
 		sl_bool flagLogError; // default: true
 		sl_uint32 packetSize; // default: 65536
+		sl_uint32 receiveBatchCount; // maximum number of datagrams received by one system call (`recvmmsg` on Linux). The receive buffer is allocated for `packetSize * receiveBatchCount` bytes, default: 1
+		sl_bool flagGro; // receives the datagrams of same flow coalesced (UDP GRO on Linux), default: false
 		Ref<AsyncIoLoop> ioLoop;
 		
+		// coalesced datagrams are delivered one by one
 		Function<void(AsyncUdpSocket*, const SocketAddress&, void* data, sl_uint32 sizeReceived)> onReceiveFrom;
+		// called instead of `onReceiveFrom` with all datagrams received by one system call
+		Function<void(AsyncUdpSocket*, SocketDatagram* datagrams, sl_uint32 count)> onReceiveBatch;
 		
 	public:
 		AsyncUdpSocketParam();
@@ -230,16 +239,22 @@ namespace slib
 		
 		sl_bool sendTo(const SocketAddress& addressTo, const Memory& mem);
 		
+		// sends `mem` as the datagrams of `sizeSegment` bytes (the last one can be shorter), by one system call where UDP GSO is supported
+		sl_bool sendSegmentsTo(const SocketAddress& addressTo, const Memory& mem, sl_uint32 sizeSegment);
+		
 	protected:
 		Ref<AsyncUdpSocketInstance> _getIoInstance();
 		
 		void _onReceive(const SocketAddress& address, void* data, sl_uint32 sizeReceived);
 		
+		void _onReceive(SocketDatagram* datagrams, sl_uint32 count);
+		
 	protected:
-		static Ref<AsyncUdpSocketInstance> _createInstance(const Ref<Socket>& socket, sl_uint32 packetSize);
+		static Ref<AsyncUdpSocketInstance> _createInstance(const Ref<Socket>& socket, sl_uint32 packetSize, sl_uint32 batchCount);
 		
 	protected:
 		Function<void(AsyncUdpSocket*, const SocketAddress&, void* data, sl_uint32 sizeReceived)> m_onReceiveFrom;
+		Function<void(AsyncUdpSocket*, SocketDatagram* datagrams, sl_uint32 count)> m_onReceiveBatch;
 		
 		friend class AsyncUdpSocketInstance;
 		
@@ -90,8 +90,17 @@ namespace slib
 		
 		NetworkLinkDeviceType preferedLinkDeviceType; // NetworkLinkDeviceType, used in Packet Socket mode. now supported Ethernet and Raw
 		
+		// size of TPACKET_V3 memory-mapped receive ring (per thread), used in Packet Socket mode (linux). 0 for one packet per system call. default: 0
+		sl_uint32 sizeRing;
+		sl_uint32 sizeRingBlock; // default: 1MB, used in ring mode
+		sl_uint32 timeoutRingBlock; // milliseconds to retire a partially filled block, used in ring mode. default: 10
+		// number of capturing threads sharing the packets by flow hash (PACKET_FANOUT), used in ring mode. default: 1
+		sl_uint32 countFanoutThreads;
+		
 		sl_bool flagAutoStart; // default: true
 		
+		// In ring mode, `packet->data` points into the ring and is valid only during the callback.
+		// With multiple fanout threads, the callback is called concurrently.
 		Function<void(NetCapture*, NetCapturePacket*)> onCapturePacket;
 		
 	public:
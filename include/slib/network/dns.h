@@ -30,6 +30,8 @@
 
 #include "../core/string.h"
 #include "../core/hash_map.h"
+#include "../core/array.h"
+#include "../core/spin_lock.h"
 #include "../core/json.h"
 #include "../crypto/aes.h"
 
@@ -405,6 +407,8 @@ namespace slib
 		
 		sl_uint16 id;
 		
+		DnsResponseCode responseCode;
+		
 		struct Question
 		{
 			String name;
@@ -416,6 +420,7 @@ namespace slib
 		{
 			String name;
 			IPAddress address;
+			sl_uint32 TTL;
 		};
 		List<Address> addresses;
 		
@@ -423,6 +428,7 @@ namespace slib
 		{
 			String name;
 			String alias;
+			sl_uint32 TTL;
 		};
 		List<Alias> aliases;
 		
@@ -445,6 +451,8 @@ namespace slib
 		
 		static Memory buildQuestionPacket(sl_uint16 id, const String& host);
 		
+		static Memory buildQuestionPacket(sl_uint16 id, const String& host, DnsRecordType type);
+		
 		static Memory buildHostAddressAnswerPacket(sl_uint16 id, const String& hostName, const IPv4Address& hostAddress);
 		
 	};
@@ -479,9 +487,13 @@ namespace slib
 		static Ref<DnsClient> create(const DnsClientParam& param);
 		
 	public:
-		void sendQuestion(const SocketAddress& serverAddress, const String& hostName);
+		// returns the id of the question
+		sl_uint16 sendQuestion(const SocketAddress& serverAddress, const String& hostName, DnsRecordType type = DnsRecordType::A);
 		
-		void sendQuestion(const IPv4Address& serverIp, const String& hostName);
+		sl_uint16 sendQuestion(const IPv4Address& serverIp, const String& hostName);
+		
+		// sends the question with the id chosen by the caller
+		void sendQuestion(sl_uint16 id, const SocketAddress& serverAddress, const String& hostName, DnsRecordType type = DnsRecordType::A);
 		
 	protected:
 		void _onReceiveFrom(AsyncUdpSocket* socket, const SocketAddress& address, void* data, sl_uint32 sizeReceive);
@@ -496,6 +508,94 @@ namespace slib
 
 	};
 	
+	class DnsResolver;
+	
+	class SLIB_EXPORT DnsResolverParam
+	{
+	public:
+		// upstream name servers, tried in turn on timeout or server failure. default: name servers of the system
+		List<SocketAddress> serverAddresses;
+		
+		sl_uint32 timeout; // milliseconds for each attempt, default: 2000
+		sl_uint32 retryCount; // default: 2
+		
+		sl_uint32 maxCacheTTL; // seconds, default: 3600
+		sl_uint32 negativeCacheTTL; // seconds, default: 30
+		
+		sl_bool flagUseHostsFile; // loads static entries from hosts file, default: true
+		
+		Ref<AsyncIoLoop> ioLoop;
+		
+	public:
+		DnsResolverParam();
+		
+		~DnsResolverParam();
+		
+	};
+	
+	// resolves IPv4 addresses (A records)
+	class SLIB_EXPORT DnsResolver : public Object
+	{
+		SLIB_DECLARE_OBJECT
+		
+	protected:
+		DnsResolver();
+		
+		~DnsResolver();
+		
+	public:
+		static Ref<DnsResolver> create(const DnsResolverParam& param);
+		
+		// created on first use from the name servers of the system, returns null if no name server is found
+		static Ref<DnsResolver> getDefault();
+		
+		static void setDefault(const Ref<DnsResolver>& resolver);
+		
+		static List<SocketAddress> getSystemServerAddresses();
+		
+	public:
+		// `callback` is called with empty list on failure. It is called immediately for cached entries, or else asynchronously.
+		void resolve(const String& hostName, const Function<void(const List<IPAddress>& addresses)>& callback);
+		
+		// should not be called on the I/O loop of the resolver
+		List<IPAddress> resolveAndWait(const String& hostName);
+		
+		sl_bool getCachedAddresses(const String& hostName, List<IPAddress>* addresses = sl_null);
+		
+		// static entries never expire
+		void addStaticAddresses(const String& hostName, const List<IPAddress>& addresses);
+		
+		void clearCache();
+		
+	protected:
+		class Lookup;
+		
+		void _send(Lookup* lookup);
+		
+		void _complete(Lookup* lookup, const List<IPAddress>& addresses, sl_uint32 TTL);
+		
+		void _onTimeout(Lookup* lookup, sl_uint32 attempt);
+		
+		void _onAnswer(DnsClient* client, const SocketAddress& serverAddress, const DnsPacket& packet);
+		
+	protected:
+		DnsResolverParam m_param;
+		Ref<DnsClient> m_client;
+		Ref<AsyncIoLoop> m_ioLoop;
+		
+		struct CacheEntry
+		{
+			List<IPAddress> addresses;
+			sl_uint32 timeExpire; // tick count in milliseconds
+			sl_bool flagStatic;
+		};
+		CHashMap<String, CacheEntry> m_cache;
+		
+		CHashMap< String, Ref<Lookup> > m_lookupsByName;
+		CHashMap< sl_uint16, Ref<Lookup> > m_lookupsById;
+		
+	};
+	
 	class DnsServer;
 	
 	class SLIB_EXPORT DnsResolveHostParam
@@ -543,6 +643,14 @@ namespace slib
 		
 		Ref<AsyncIoLoop> ioLoop;
 		
+		// sockets bound to `portDns` with SO_REUSEPORT, other than the first one run on their own I/O loops. default: 1
+		sl_uint32 countDnsSockets;
+		
+		// cached answers are shared by all clients, and `onResolve` is not called for the cached questions. default: false
+		sl_bool flagCacheAnswers;
+		sl_uint32 cacheTTL; // maximum seconds to keep an answer, default: 60
+		sl_uint32 cacheSize; // maximum number of cached answers, default: 4096
+		
 		Function<void(DnsServer*, DnsResolveHostParam&)> onResolve;
 		Function<void(DnsServer*, const String& hostName, const IPAddress& hostAddress)> onCache;
 
@@ -590,6 +698,10 @@ namespace slib
 		
 		Memory _buildHostAddressAnswerPacket(sl_uint16 id, const String& hostName, const IPv4Address& hostAddress, sl_bool flagEncrypt);
 		
+		sl_bool _processCachedQuestion(AsyncUdpSocket* socket, const SocketAddress& clientAddress, const void* data, sl_uint32 size);
+		
+		void _putCache(const Memory& packet, sl_uint32 TTL);
+		
 	protected:
 		void _onReceiveFrom(AsyncUdpSocket* socket, const SocketAddress& address, void* data, sl_uint32 sizeReceive);
 		
@@ -602,6 +714,8 @@ namespace slib
 		sl_bool m_flagRunning;
 		
 		Ref<AsyncUdpSocket> m_udpDns;
+		List< Ref<AsyncUdpSocket> > m_listUdpDns;
+		List< Ref<AsyncIoLoop> > m_listIoLoops;
 		
 		Ref<AsyncUdpSocket> m_udpEncrypt;
 		AES m_encrypt;
@@ -611,7 +725,7 @@ namespace slib
 		SocketAddress m_defaultForwardAddress;
 		sl_bool m_flagEncryptDefaultForward;
 		
-		sl_uint16 m_lastForwardId;
+		sl_int32 m_lastForwardId;
 		
 		struct ForwardElement
 		{
@@ -622,6 +736,19 @@ namespace slib
 		};
 		CHashMap<sl_uint16, ForwardElement> m_mapForward;
 		
+		struct CacheSlot
+		{
+			sl_uint32 hash;
+			sl_uint32 timeExpire; // tick count in milliseconds
+			sl_uint32 sizeQuestion;
+			Memory packet; // the question follows the header
+		};
+		sl_bool m_flagCacheAnswers;
+		sl_uint32 m_cacheTTL;
+		Array<CacheSlot> m_cache;
+		sl_uint32 m_nCacheBuckets;
+		SpinLock m_lockCache;
+		
 		Function<void(DnsServer*, DnsResolveHostParam&)> m_onResolve;
 		Function<void(DnsServer*, const String& hostName, const IPAddress& hostAddress)> m_onCache;
 
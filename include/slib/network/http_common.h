@@ -161,6 +161,7 @@ namespace slib
 		static const String& Connection;
 		static const String& CacheControl;
 		static const String& ContentDisposition;
+		static const String& Upgrade;
 		
 		// Entity Headers
 		static const String& ContentLength;
@@ -174,6 +175,8 @@ namespace slib
 		static const String& Cookie;
 		static const String& Range;
 		static const String& IfModifiedSince;
+		static const String& SecWebSocketKey;
+		static const String& SecWebSocketVersion;
 		
 		// Response Headers
 		static const String& TransferEncoding;
@@ -182,6 +185,11 @@ namespace slib
 		static const String& AcceptRanges;
 		static const String& ContentRange;
 		static const String& LastModified;
+		static const String& SecWebSocketAccept;
+		
+		// Request/Response Headers
+		static const String& SecWebSocketExtensions;
+		static const String& SecWebSocketProtocol;
 		
 	public:
 		
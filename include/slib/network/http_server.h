@@ -28,8 +28,15 @@
 #include "http_common.h"
 #include "http_io.h"
 #include "socket_address.h"
+#include "web_socket.h"
+#include "tcp_relay.h"
 
 #include "../core/thread_pool.h"
+#include "../core/timer.h"
+#include "../core/spin_lock.h"
+
+// number of slots in the timer wheel for the timeouts of the connections
+#define SLIB_HTTP_SERVER_TIMER_WHEEL_SIZE 256
 
 namespace slib
 {
@@ -90,6 +97,9 @@ namespace slib
 		AtomicMemory m_requestBody;
 		sl_bool m_flagAsynchronousResponse;
 		
+		Memory m_responseHeader;
+		sl_bool m_flagResponseCompleted;
+		
 	private:
 		WeakRef<HttpServerConnection> m_connection;
 		
@@ -146,12 +156,44 @@ namespace slib
 		Ref<AsyncOutput> m_output;
 		
 		AtomicRef<HttpServerContext> m_contextCurrent;
+		// requests waiting for their responses, in the order of receiving
+		LinkedQueue< Ref<HttpServerContext> > m_queueContexts;
 		
 		sl_bool m_flagClosed;
 		Memory m_bufRead;
 		sl_bool m_flagReading;
 		sl_bool m_flagKeepAlive;
 		
+		// pipelined input which is not parsed yet
+		Memory m_bufPipelined;
+		sl_bool m_flagInputPaused;
+		// no more requests are read, because the connection is closed or taken over after the pending responses
+		sl_bool m_flagInputEnded;
+		
+		// the connection is taken over after upgrading to WebSocket
+		AtomicRef<WebSocketConnection> m_webSocket;
+		
+		// the connection is taken over by the tunnel after accepting CONNECT request
+		AtomicRef<AsyncTcpRelay> m_relay;
+		AtomicRef<AsyncTcpSocket> m_socketTunnel;
+		Memory m_dataTunnel;
+		// CONNECT request waiting for the connection to the target, answered after the pending responses
+		AtomicRef<HttpServerContext> m_contextTunnel;
+		// set when the successful CONNECT response is written to the output
+		sl_int32 m_flagTunnelResponded; // changed by atomic operations
+		
+		// reading is paused while the pending output is over the high watermark
+		sl_int32 m_flagOutputPaused; // changed by atomic operations
+		sl_bool m_flagReadDeferred;
+		
+		// deadlines in the ticks of the timer wheel (0: none), protected by the lock of the wheel
+		sl_uint64 m_tickInputExpire;
+		sl_uint32 m_typeInputTimeout;
+		sl_uint64 m_tickOutputExpire;
+		sl_uint64 m_tickTimerSlot;
+		HttpServerConnection* m_timerPrev;
+		HttpServerConnection* m_timerNext;
+		
 	protected:
 		void _read();
 		
@@ -161,12 +203,43 @@ namespace slib
 		
 		void _completeResponse(HttpServerContext* context);
 		
+		void _flushResponses();
+		
+		// queues the raw response after the pending responses. `context` is the pending request answered by the response, or null
+		void _sendRawResponse(HttpServerContext* context, const Memory& response, sl_bool flagClose);
+		
+		void _resumeInput();
+		
+		void _processConnect(HttpServerContext* context, const void* data, sl_uint32 size);
+		
+		void _onConnectTunnel(AsyncTcpSocket* socket, const SocketAddress& address, sl_bool flagError);
+		
+		void _sendConnectFailed(HttpServerContext* context);
+		
+		void _establishTunnelAfterOutput();
+		
+		void _establishTunnel();
+		
+		void _onEndTunnel(AsyncTcpRelay* relay, sl_bool flagError);
+		
+		void _resumeRead();
+		
+		void _resumeOutputPaused(sl_uint64 sizeOutput, sl_uint64 lowWatermark);
+		
+		void _setInputTimeout(sl_uint32 type);
+		
+		void _onTimeout(sl_uint32 type);
+		
 	protected:
 		void onReadStream(AsyncStreamResult* result);
 
 		void onAsyncOutputEnd(AsyncOutput* output, sl_bool flagError);
 		
+		void onAsyncOutputWrite(AsyncOutput* output);
+		
+		friend class HttpServer;
 		friend class HttpServerContext;
+		friend class WebSocketConnection;
 		
 	};
 	
@@ -209,6 +282,28 @@ namespace slib
 		sl_uint64 maxRequestHeadersSize;
 		sl_uint64 maxRequestBodySize;
 		
+		sl_uint32 maxPipelinedRequestsCount;
+		
+		// timeouts in milliseconds, 0 for no timeout
+		sl_uint32 headerTimeout; // to receive the complete request header, default: 20000
+		sl_uint32 bodyTimeout; // maximum idle time while receiving the request body, default: 60000
+		sl_uint32 keepAliveTimeout; // maximum idle time between the requests, default: 15000
+		sl_uint32 sendTimeout; // maximum time without any progress of the pending output, default: 60000
+		
+		// reading the requests is paused while the output pending on a connection is over the high watermark, and resumed when it drains to the low watermark
+		sl_uint32 outputHighWatermark; // default: 1MB
+		sl_uint32 outputLowWatermark; // default: 256KB
+		
+		// new connections are answered by `503 Service Unavailable` over this count, 0 for no limit
+		sl_uint32 maxConnectionsCount; // default: 0
+		
+		sl_bool flagUseWebSocket;
+		WebSocketParam webSocket;
+		
+		// tunnels CONNECT requests to the requested "host:port", only when they are accepted by `onConnect`
+		sl_bool flagProcessConnect; // default: false
+		sl_uint32 tunnelIdleTimeout; // milliseconds, default: 300000
+		
 		sl_bool flagAllowCrossOrigin;
 		
 		List<String> allowedFileExtensions;
@@ -222,6 +317,9 @@ namespace slib
 		
 		Function<sl_bool(HttpServer*, HttpServerContext*)> onRequest;
 		Function<void(HttpServer*, HttpServerContext*, sl_bool flagProcessed)> onPostRequest;
+		// returns true to accept the tunnel. the target can be changed by `setPath()` of the context
+		// without this callback, `HttpServer::onConnect` decides, which rejects all tunnels by default
+		Function<sl_bool(HttpServer*, HttpServerContext*)> onConnect;
 
 	public:
 		HttpServerParam();
@@ -230,6 +328,9 @@ namespace slib
 		
 		~HttpServerParam();
 		
+	public:
+		HttpServerParam& operator=(const HttpServerParam& other);
+		
 	public:
 		void setJson(const Json& json);
 		
@@ -237,6 +338,22 @@ namespace slib
 		
 	};
 	
+	class SLIB_EXPORT HttpServerCounters
+	{
+	public:
+		sl_uint64 connectionsAccepted;
+		sl_uint64 connectionsRejected; // by `maxConnectionsCount`
+		sl_uint64 headerTimeouts;
+		sl_uint64 bodyTimeouts;
+		sl_uint64 keepAliveTimeouts;
+		sl_uint64 sendTimeouts;
+		sl_uint64 inputPauses; // by `outputHighWatermark`
+		
+	public:
+		HttpServerCounters();
+		
+	};
+	
 	class SLIB_EXPORT HttpServer : public Object
 	{
 		SLIB_DECLARE_OBJECT
@@ -260,6 +377,10 @@ namespace slib
 		
 		const HttpServerParam& getParam();
 		
+		sl_size getConnectionsCount();
+		
+		void getCounters(HttpServerCounters& _out);
+		
 	public:
 		// called before processing body, returns true if the server is trying to process the connection itself.
 		virtual sl_bool preprocessRequest(const Ref<HttpServerContext>& context);
@@ -286,6 +407,10 @@ namespace slib
 		
 		void dispatchPostRequest(HttpServerContext* context, sl_bool flagProcessed);
 		
+		virtual sl_bool onConnect(HttpServerContext* context);
+		
+		sl_bool dispatchConnect(HttpServerContext* context);
+		
 	public:
 		void addConnectionProvider(const Ref<HttpServerConnectionProvider>& provider);
 		
@@ -304,6 +429,20 @@ namespace slib
 		
 		void _processCacheControl(const Ref<HttpServerContext>& context);
 		
+		void _setConnectionTimeout(HttpServerConnection* connection, sl_bool flagInput, sl_uint32 timeout, sl_uint32 type = 0);
+		
+		void _removeConnectionTimeout(HttpServerConnection* connection);
+		
+		void _linkTimer(HttpServerConnection* connection);
+		
+		void _unlinkTimer(HttpServerConnection* connection);
+		
+		void _onTimerWheel(Timer* timer);
+		
+		void _processTimerWheel();
+		
+		void _increaseCounter(sl_uint64& counter);
+		
 	protected:
 		AtomicRef<AsyncIoLoop> m_ioLoop;
 		AtomicRef<ThreadPool> m_threadPool;
@@ -315,6 +454,16 @@ namespace slib
 		
 		HttpServerParam m_param;
 		
+		HttpServerConnection* m_timerWheel[SLIB_HTTP_SERVER_TIMER_WHEEL_SIZE];
+		sl_uint64 m_tickTimerWheel;
+		sl_uint32 m_durationTimerTick;
+		SpinLock m_lockTimerWheel;
+		Ref<Timer> m_timer;
+		
+		HttpServerCounters m_counters;
+		
+		friend class HttpServerConnection;
+		
 	};
 
 }
@@ -32,6 +32,7 @@
 
 #include "../core/object.h"
 #include "../core/hash_map.h"
+#include "../core/spin_lock.h"
 
 /*
 	If you are usiing kernel-mode NAT on linux (for example on port range 40000~60000), following configuration will avoid to conflict with kernel-networking.
@@ -43,21 +44,10 @@
 namespace slib
 {
 
-	class _priv_NatTablePort
-	{
-	public:
-		sl_bool flagActive;
-		SocketAddress addressSource;
-		Time timeLastAccess;
-		
-	public:
-		_priv_NatTablePort();
-		
-		~_priv_NatTablePort();
-		
-	};
+	class _priv_NatTableMappingShard;
 	
-	class _priv_NatTableMapping : public Object
+	// external ports are partitioned into shards, and the internal addresses are distributed to the shards by hash, so that the shards can be accessed by multiple threads in parallel
+	class _priv_NatTableMapping
 	{
 	public:
 		_priv_NatTableMapping();
@@ -65,18 +55,18 @@ namespace slib
 		~_priv_NatTableMapping();
 		
 	public:
-		void setup(sl_uint16 portBegin, sl_uint16 portEnd);
+		void setup(sl_uint16 portBegin, sl_uint16 portEnd, sl_uint32 nShards, sl_uint32 timeoutIdle);
 		
 		sl_bool mapToExternalPort(const SocketAddress& address, sl_uint16& port);
 		
 		sl_bool mapToInternalAddress(sl_uint16 port, SocketAddress& address);
 		
 	protected:
-		CHashMap< SocketAddress, sl_uint16 > m_mapPorts;
+		void _free();
 		
-		_priv_NatTablePort* m_ports;
-		sl_uint16 m_nPorts;
-		sl_uint16 m_pos;
+	protected:
+		_priv_NatTableMappingShard* m_shards;
+		sl_uint32 m_nShards;
 		
 		sl_uint16 m_portBegin;
 		sl_uint16 m_portEnd;
@@ -96,6 +86,11 @@ namespace slib
 		
 		sl_uint16 icmpEchoIdentifier;
 		
+		sl_uint32 tcpIdleTimeout; // seconds, default: 3600
+		sl_uint32 udpIdleTimeout; // seconds, default: 300
+		
+		sl_uint32 countShards; // default: 16
+		
 	public:
 		NatTableParam();
 		
@@ -113,9 +108,11 @@ namespace slib
 	public:
 		const NatTableParam& getParam() const;
 		
+		// should be called before translating packets
 		void setup(const NatTableParam& param);
 		
 	public:
+		// can be called by multiple threads in parallel
 		sl_bool translateOutgoingPacket(IPv4Packet* ipHeader, void* ipContent, sl_uint32 sizeContent);
 		
 		sl_bool translateIncomingPacket(IPv4Packet* ipHeader, void* ipContent, sl_uint32 sizeContent);
@@ -130,6 +127,7 @@ namespace slib
 		_priv_NatTableMapping m_mappingUdp;
 		
 		sl_uint16 m_icmpEchoSequenceCurrent;
+		SpinLock m_lockIcmpEcho;
 		
 		struct IcmpEchoElement
 		{
@@ -0,0 +1,240 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#ifndef CHECKHEADER_SLIB_NETWORK_RPC
+#define CHECKHEADER_SLIB_NETWORK_RPC
+
+/****************************************
+ 
+	Length-prefixed framing for request/response protocols
+ 
+	[payload size: 32bit, big endian][request id: 32bit, big endian][payload]
+ 
+	Responses carry the id of the request, so that the requests can be multiplexed over a connection and answered in any order.
+ 
+*****************************************/
+
+#include "definition.h"
+
+#include "tcp_pool.h"
+
+#include "../core/queue.h"
+
+#define SLIB_RPC_FRAME_HEADER_SIZE 8
+
+namespace slib
+{
+	
+	class SLIB_EXPORT RpcFrame
+	{
+	public:
+		sl_uint32 id;
+		Memory payload;
+		
+	public:
+		RpcFrame();
+		
+		~RpcFrame();
+		
+	public:
+		static Memory build(sl_uint32 id, const void* payload, sl_size size);
+		
+		static Memory build(sl_uint32 id, const Memory& payload);
+		
+		static Memory buildHeader(sl_uint32 id, sl_size sizePayload);
+		
+	};
+	
+	// parses the frames from the stream input which can be split at any position
+	class SLIB_EXPORT RpcFrameReader
+	{
+	public:
+		RpcFrameReader();
+		
+		~RpcFrameReader();
+		
+	public:
+		sl_uint32 getMaxPayloadSize();
+		
+		void setMaxPayloadSize(sl_uint32 size); // default: 16MB
+		
+		// returns false if a frame is larger than the max payload size
+		sl_bool add(const void* data, sl_size size);
+		
+		sl_bool pop(RpcFrame& _out);
+		
+		void clear();
+		
+	protected:
+		sl_uint32 m_maxPayloadSize;
+		sl_uint8 m_header[SLIB_RPC_FRAME_HEADER_SIZE];
+		sl_uint32 m_sizeHeader;
+		Memory m_payload;
+		sl_uint32 m_idPayload;
+		sl_size m_sizePayloadReceived;
+		LinkedQueue<RpcFrame> m_queueFrames;
+		
+	};
+	
+	class AsyncTcpRpcClient;
+	
+	class SLIB_EXPORT AsyncTcpRpcClientParam
+	{
+	public:
+		// required, `address` or `hostAddress` ("hostname:port")
+		SocketAddress address;
+		String hostAddress;
+		
+		// optional
+		Ref<AsyncTcpSocketPool> pool; // created by default parameters if not set
+		sl_uint32 maxConnectionsCount; // default: 4
+		sl_uint32 maxPendingCallsPerConnection; // another connection is acquired over this count, default: 32
+		sl_uint32 timeout; // milliseconds for each call, 0 for no timeout. default: 30000
+		sl_uint32 maxPayloadSize; // default: 16MB
+		
+	public:
+		AsyncTcpRpcClientParam();
+		
+		~AsyncTcpRpcClientParam();
+		
+	};
+	
+	// multiplexes the calls over the connections acquired from the pool, and returns the idle connections to the pool
+	class SLIB_EXPORT AsyncTcpRpcClient : public Object
+	{
+		SLIB_DECLARE_OBJECT
+		
+	protected:
+		AsyncTcpRpcClient();
+		
+		~AsyncTcpRpcClient();
+		
+	public:
+		static Ref<AsyncTcpRpcClient> create(const AsyncTcpRpcClientParam& param);
+		
+	public:
+		// `callback` is called on the I/O loop of the pool
+		void call(const Memory& request, const Function<void(const Memory& response, sl_bool flagError)>& callback);
+		
+		void close();
+		
+		sl_uint32 getPendingCallsCount();
+		
+		const AsyncTcpRpcClientParam& getParam();
+		
+	protected:
+		class Connection;
+		class Call;
+		
+		sl_bool _send(Connection* connection, Call* call);
+		
+		void _dispatchWaitingCalls();
+		
+		void _onAcquire(AsyncTcpSocket* socket);
+		
+		sl_bool _read(Connection* connection);
+		
+		void _onRead(Connection* connection, AsyncStreamResult* result);
+		
+		void _onError(Connection* connection);
+		
+		void _failWaitingCalls();
+		
+		void _onTimeout(sl_uint32 id);
+		
+	protected:
+		AsyncTcpRpcClientParam m_param;
+		Ref<AsyncTcpSocketPool> m_pool;
+		sl_bool m_flagClosed;
+		sl_uint32 m_lastId;
+		
+		List< Ref<Connection> > m_connections;
+		sl_uint32 m_nAcquiring;
+		CHashMap< sl_uint32, Ref<Call> > m_calls;
+		LinkedQueue< Ref<Call> > m_queueWaiting;
+		
+	};
+	
+	class AsyncTcpRpcServer;
+	
+	class SLIB_EXPORT AsyncTcpRpcServerParam
+	{
+	public:
+		// required
+		SocketAddress bindAddress;
+		// `respond` can be called on any thread, once for each request
+		Function<void(AsyncTcpRpcServer*, const Memory& request, const Function<void(const Memory& response)>& respond)> onRequest;
+		
+		// optional
+		Ref<AsyncIoLoop> ioLoop;
+		sl_uint32 maxPayloadSize; // default: 16MB
+		
+	public:
+		AsyncTcpRpcServerParam();
+		
+		~AsyncTcpRpcServerParam();
+		
+	};
+	
+	class SLIB_EXPORT AsyncTcpRpcServer : public Object
+	{
+		SLIB_DECLARE_OBJECT
+		
+	protected:
+		AsyncTcpRpcServer();
+		
+		~AsyncTcpRpcServer();
+		
+	public:
+		static Ref<AsyncTcpRpcServer> create(const AsyncTcpRpcServerParam& param);
+		
+	public:
+		void close();
+		
+		sl_bool isOpened();
+		
+		sl_uint32 getConnectionsCount();
+		
+	protected:
+		class Connection;
+		
+		void _onAccept(AsyncTcpServer* server, Socket* socket, const SocketAddress& address);
+		
+		sl_bool _read(Connection* connection);
+		
+		void _onRead(Connection* connection, AsyncStreamResult* result);
+		
+		void _closeConnection(Connection* connection);
+		
+	protected:
+		AsyncTcpRpcServerParam m_param;
+		Ref<AsyncIoLoop> m_ioLoop;
+		Ref<AsyncTcpServer> m_server;
+		sl_bool m_flagClosed;
+		CHashMap< Connection*, Ref<Connection> > m_connections;
+		
+	};
+	
+}
+
+#endif
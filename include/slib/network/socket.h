@@ -65,6 +65,29 @@ namespace slib
 		
 	};
 	
+	// one element of the scatter/gather array passed to `Socket::sendVector`
+	struct SLIB_EXPORT SocketBuffer
+	{
+		const void* data;
+		sl_uint32 size;
+	};
+	
+	// maximum number of datagrams processed by one call of `Socket::sendToBatch` or `Socket::receiveFromBatch`
+#define SLIB_SOCKET_DATAGRAM_BATCH_MAX 64
+	
+	// one element of the array passed to `Socket::sendToBatch` and `Socket::receiveFromBatch`
+	struct SLIB_EXPORT SocketDatagram
+	{
+		SocketAddress address;
+		void* data;
+		// receive: size of the buffer on input, received size on output
+		sl_uint32 size;
+		// send: splits the data into the datagrams of this size (UDP GSO on Linux), 0 to send as one datagram.
+		//       `SendSegmentsIsNotSupported` error is set when the system or the device cannot split the data
+		// receive: size of the coalesced datagrams (UDP GRO on Linux), 0 if not coalesced
+		sl_uint32 sizeSegment;
+	};
+	
 	enum class SocketType
 	{
 		None = 0,
@@ -129,6 +152,7 @@ namespace slib
 		SendPacketIsNotSupported = 113,
 		SendPacketInvalidAddress = 114,
 		ReceivePacketIsNotSupported = 115,
+		SendSegmentsIsNotSupported = 116, /* sendToBatch */
 		
 		Unknown = 10000
 		
@@ -216,12 +240,24 @@ namespace slib
 		
 		sl_int32 send(const void* buf, sl_uint32 size);
 		
+		// gather write: sends the buffers in order by one system call, returns the number of sent bytes
+		sl_int32 sendVector(const SocketBuffer* buffers, sl_uint32 count);
+		
 		sl_int32 receive(void* buf, sl_uint32 size);
 		
+		// receives without removing the data from the queue, the return value is same as `receive()`
+		sl_int32 peek(void* buf, sl_uint32 size);
+		
 		sl_int32 sendTo(const SocketAddress& address, const void* buf, sl_uint32 size);
 		
 		sl_int32 receiveFrom(SocketAddress& address, void* buf, sl_uint32 size);
 		
+		// sends the datagrams by one system call (`sendmmsg` on Linux), returns the number of sent datagrams
+		sl_int32 sendToBatch(const SocketDatagram* datagrams, sl_uint32 count);
+		
+		// receives the datagrams by one system call (`recvmmsg` on Linux), returns the number of received datagrams
+		sl_int32 receiveFromBatch(SocketDatagram* datagrams, sl_uint32 count);
+		
 		sl_int32 sendPacket(const void* buf, sl_uint32 size, const L2PacketInfo& info);
 		
 		sl_int32 receivePacket(const void* buf, sl_uint32 size, L2PacketInfo& info);
@@ -268,6 +304,10 @@ namespace slib
 		
 		sl_bool getOption_TcpNoDelay() const;
 		
+		sl_bool setOption_UdpGro(sl_bool flagEnable); // Linux 5.0 or later
+		
+		sl_bool getOption_UdpGro() const;
+		
 		sl_bool setOption_IpTTL(sl_uint32 ttl); // max - 255
 		
 		sl_uint32 getOption_IpTTL() const;
@@ -0,0 +1,140 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#ifndef CHECKHEADER_SLIB_NETWORK_TCP_POOL
+#define CHECKHEADER_SLIB_NETWORK_TCP_POOL
+
+#include "definition.h"
+
+#include "async.h"
+
+#include "../core/timer.h"
+#include "../core/hash_map.h"
+
+namespace slib
+{
+	
+	class SLIB_EXPORT AsyncTcpSocketPoolParam
+	{
+	public:
+		// optional
+		Ref<AsyncIoLoop> ioLoop;
+		
+		sl_uint32 maxConnectionsPerHost; // `acquire()` waits for a released connection over this count, 0 for no limit. default: 64
+		sl_uint32 maxIdleConnectionsPerHost; // released connections over this count are closed. default: 8
+		sl_uint32 maxIdleTime; // milliseconds, idle connections are closed after this time. default: 60000
+		sl_uint32 connectTimeout; // milliseconds, default: 10000
+		sl_uint32 warmUpCount; // connections opened in background when a host is used at first. default: 0
+		sl_bool flagTcpNoDelay; // default: true
+		
+	public:
+		AsyncTcpSocketPoolParam();
+		
+		~AsyncTcpSocketPoolParam();
+		
+	};
+	
+	// keeps the connected client sockets by the remote hosts, to be reused by the following requests
+	class SLIB_EXPORT AsyncTcpSocketPool : public Object
+	{
+		SLIB_DECLARE_OBJECT
+		
+	protected:
+		AsyncTcpSocketPool();
+		
+		~AsyncTcpSocketPool();
+		
+	public:
+		static Ref<AsyncTcpSocketPool> create(const AsyncTcpSocketPoolParam& param);
+		
+	public:
+		// `callback` is called with null on failure. It is called immediately when a healthy idle connection exists, or else asynchronously.
+		void acquire(const SocketAddress& address, const Function<void(AsyncTcpSocket*)>& callback);
+		
+		// `hostAddress`: "hostname:port"
+		void acquire(const String& hostAddress, const Function<void(AsyncTcpSocket*)>& callback);
+		
+		// the socket should not have pending I/O requests
+		void release(AsyncTcpSocket* socket);
+		
+		// closes the socket instead of keeping it, for example after a protocol error
+		void discard(AsyncTcpSocket* socket);
+		
+		// opens the connections in background, up to `count` idle connections
+		void warmUp(const SocketAddress& address, sl_uint32 count);
+		
+		void warmUp(const String& hostAddress, sl_uint32 count);
+		
+		void close();
+		
+		sl_uint32 getConnectionsCount();
+		
+		sl_uint32 getIdleConnectionsCount();
+		
+		Ref<AsyncIoLoop> getIoLoop();
+		
+		const AsyncTcpSocketPoolParam& getParam();
+		
+	protected:
+		class Host;
+		
+		Ref<Host> _getHost(const String& key, const SocketAddress& address);
+		
+		void _acquire(Host* host, const Function<void(AsyncTcpSocket*)>& callback);
+		
+		void _warmUp(Host* host, sl_uint32 count);
+		
+		void _connect(Host* host, const Function<void(AsyncTcpSocket*)>& callback);
+		
+		void _onConnect(AsyncTcpSocket* socket, const SocketAddress& address, sl_bool flagError);
+		
+		void _onConnectTimeout(const WeakRef<AsyncTcpSocket>& socket);
+		
+		void _processWaiting(Host* host);
+		
+		sl_bool _isHealthy(AsyncTcpSocket* socket);
+		
+		void _onIdleTimer(Timer* timer);
+		
+	protected:
+		AsyncTcpSocketPoolParam m_param;
+		Ref<AsyncIoLoop> m_ioLoop;
+		sl_bool m_flagClosed;
+		
+		CHashMap< String, Ref<Host> > m_hosts;
+		// all connections including the connecting and idle ones
+		struct Connection
+		{
+			Ref<AsyncTcpSocket> socket;
+			Ref<Host> host;
+		};
+		CHashMap<AsyncTcpSocket*, Connection> m_sockets;
+		sl_uint32 m_nIdle;
+		
+		Ref<Timer> m_timerIdle;
+		
+	};
+	
+}
+
+#endif
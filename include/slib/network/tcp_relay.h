@@ -0,0 +1,198 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#ifndef CHECKHEADER_SLIB_NETWORK_TCP_RELAY
+#define CHECKHEADER_SLIB_NETWORK_TCP_RELAY
+
+#include "definition.h"
+
+#include "async.h"
+
+#include "../core/timer.h"
+#include "../core/hash_map.h"
+
+namespace slib
+{
+
+	class AsyncTcpRelay;
+	
+	class SLIB_EXPORT AsyncTcpRelayParam
+	{
+	public:
+		// required, connected streams
+		Ref<AsyncStream> stream1;
+		Ref<AsyncStream> stream2;
+		
+		// optional
+		Memory initialData; // received from `stream1` in advance, sent to `stream2` before relaying
+		sl_uint32 bufferSize; // capacity of each direction: the pipe size for splice, or the size of two buffers for `AsyncCopy`. default: 0x10000
+		sl_uint32 idleTimeout; // milliseconds, closes the relay when no data is transferred, 0 for no timeout. default: 0
+		// on Linux, relays by `splice()` through pipes when both streams are `AsyncTcpSocket` on the same I/O loop, or else by `AsyncCopy`
+		sl_bool flagUseSplice; // default: true
+		sl_bool flagAutoStart; // default: true
+		
+		Function<void(AsyncTcpRelay*, sl_bool flagError)> onEnd;
+		
+	public:
+		AsyncTcpRelayParam();
+		
+		~AsyncTcpRelayParam();
+		
+	};
+	
+	// relays the data between two streams in both directions, until both sides are finished or an error occurs
+	class SLIB_EXPORT AsyncTcpRelay : public Object
+	{
+		SLIB_DECLARE_OBJECT
+		
+	protected:
+		AsyncTcpRelay();
+		
+		~AsyncTcpRelay();
+		
+	public:
+		static Ref<AsyncTcpRelay> create(const AsyncTcpRelayParam& param);
+		
+	public:
+		sl_bool start();
+		
+		void close();
+		
+		sl_bool isRunning();
+		
+		sl_bool isUsingSplice();
+		
+		Ref<AsyncStream> getStream1();
+		
+		Ref<AsyncStream> getStream2();
+		
+		// from `stream1` to `stream2`
+		sl_uint64 getTransferredSize1();
+		
+		// from `stream2` to `stream1`
+		sl_uint64 getTransferredSize2();
+		
+	protected:
+		sl_bool _close();
+		
+		sl_bool _startSplice();
+		
+		sl_bool _startCopy();
+		
+		void _onActive();
+		
+		void _onEnd(sl_bool flagError);
+		
+		void _onCopyWrite(AsyncCopy* copy);
+		
+		void _onCopyEnd(AsyncCopy* copy, sl_bool flagError);
+		
+		void _onIdleTimer(Timer* timer);
+		
+	protected:
+		AsyncTcpRelayParam m_param;
+		sl_bool m_flagStarted;
+		sl_bool m_flagClosed;
+		
+		Ref<Referable> m_splice;
+		Ref<AsyncCopy> m_copy1;
+		Ref<AsyncCopy> m_copy2;
+		sl_int32 m_nCopiesEnded;
+		sl_bool m_flagSplice;
+		sl_uint64 m_sizeTransferred1;
+		sl_uint64 m_sizeTransferred2;
+		
+		Ref<Timer> m_timerIdle;
+		sl_uint32 m_timeLastActive;
+		
+		friend class _priv_AsyncTcpRelay_Splice;
+		
+	};
+	
+	class SLIB_EXPORT AsyncTcpForwarderParam
+	{
+	public:
+		SocketAddress bindAddress;
+		
+		SocketAddress targetAddress;
+		String targetHostAddress; // "hostname:port", used when `targetAddress` is not valid
+		
+		// optional
+		sl_uint32 bufferSize; // default: 0x10000
+		sl_uint32 idleTimeout; // milliseconds, default: 0 (no timeout)
+		sl_bool flagUseSplice; // default: true
+		sl_bool flagAutoStart; // default: true
+		Ref<AsyncIoLoop> ioLoop;
+		
+	public:
+		AsyncTcpForwarderParam();
+		
+		~AsyncTcpForwarderParam();
+		
+	};
+	
+	// accepts TCP connections, and relays each of them to the target address
+	class SLIB_EXPORT AsyncTcpForwarder : public Object
+	{
+		SLIB_DECLARE_OBJECT
+		
+	protected:
+		AsyncTcpForwarder();
+		
+		~AsyncTcpForwarder();
+		
+	public:
+		static Ref<AsyncTcpForwarder> create(const AsyncTcpForwarderParam& param);
+		
+	public:
+		void close();
+		
+		sl_bool isOpened();
+		
+		void start();
+		
+		sl_size getRelaysCount();
+		
+	protected:
+		void _onAccept(AsyncTcpServer* server, Socket* socket, const SocketAddress& address);
+		
+		void _onConnect(AsyncTcpSocket* socket, const SocketAddress& address, sl_bool flagError);
+		
+		void _onEndRelay(AsyncTcpRelay* relay, sl_bool flagError);
+		
+	protected:
+		AsyncTcpForwarderParam m_param;
+		Ref<AsyncIoLoop> m_ioLoop;
+		Ref<AsyncTcpServer> m_server;
+		sl_bool m_flagClosed;
+		
+		// keyed by the upstream sockets being connected
+		CHashMap< AsyncTcpSocket*, Ref<AsyncTcpSocket> > m_socketsConnecting;
+		CHashMap< AsyncTcpSocket*, Ref<AsyncTcpSocket> > m_socketsAccepted;
+		CHashMap< AsyncTcpRelay*, Ref<AsyncTcpRelay> > m_relays;
+		
+	};
+
+}
+
+#endif
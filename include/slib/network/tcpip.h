@@ -134,6 +134,12 @@ namespace slib
 		static sl_uint16 calculateOneComplementSum(const void* data, sl_size size, sl_uint32 add = 0);
 
 		static sl_uint16 calculateChecksum(const void* data, sl_size size);
+		
+		// RFC 1624: returns the checksum updated for a 16-bit field changed from `valueOld` to `valueNew`
+		static sl_uint16 adjustChecksum16(sl_uint16 checksum, sl_uint16 valueOld, sl_uint16 valueNew);
+		
+		// RFC 1624: returns the checksum updated for a 32-bit field changed from `valueOld` to `valueNew`
+		static sl_uint16 adjustChecksum32(sl_uint16 checksum, sl_uint32 valueOld, sl_uint32 valueNew);
 
 	};
 
@@ -248,6 +254,9 @@ public:
 		void updateChecksum();
 		
 		sl_bool checkChecksum() const;
+		
+		// incremental update of header checksum after changing source or destination address
+		void adjustChecksum(const IPv4Address& addressOld, const IPv4Address& addressNew);
 
 		// used in TCP/UDP protocol
 		sl_uint16 getChecksumForContent(const void* content, sl_uint16 size) const;
@@ -448,6 +457,9 @@ public:
 		sl_bool checkChecksum(const IPv4Packet* ipv4, sl_size sizeTcp) const;
 
 		sl_bool check(IPv4Packet* ip, sl_size sizeTcp) const;
+		
+		// incremental update of checksum after changing an IPv4 address (pseudo header) and a port
+		void adjustChecksum(const IPv4Address& addressOld, const IPv4Address& addressNew, sl_uint16 portOld, sl_uint16 portNew);
 
 		void updateChecksum(const IPv6Packet* ipv4, sl_size sizeTcp);
 		
@@ -510,6 +522,9 @@ public:
 		sl_bool checkChecksum(const IPv4Packet* ipv4) const;
 		
 		sl_bool check(IPv4Packet* ipv4, sl_size sizeUdp) const;
+		
+		// incremental update of checksum after changing an IPv4 address (pseudo header) and a port
+		void adjustChecksum(const IPv4Address& addressOld, const IPv4Address& addressNew, sl_uint16 portOld, sl_uint16 portNew);
 
 		void updateChecksum(const IPv6Packet* ipv6);
 		
@@ -26,6 +26,7 @@
 #include "definition.h"
 
 #include "http_common.h"
+#include "dns.h"
 
 #include "../core/string.h"
 #include "../core/function.h"
@@ -64,6 +65,9 @@ namespace slib
 		sl_uint32 timeout; // In milliseconds
 		sl_bool flagAllowInsecureConnection;
 		
+		// used to resolve the host name instead of the system resolver (supported by curl backend)
+		Ref<DnsResolver> dnsResolver;
+		
 	public:
 		UrlRequestParam();
 		
@@ -294,6 +298,7 @@ namespace slib
 		
 		sl_uint32 m_timeout;
 		sl_bool m_flagAllowInsecureConnection;
+		Ref<DnsResolver> m_dnsResolver;
 		
 		sl_uint64 m_sizeBodySent;
 		sl_uint64 m_sizeContentTotal;
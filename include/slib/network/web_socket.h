@@ -0,0 +1,248 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#ifndef CHECKHEADER_SLIB_NETWORK_WEB_SOCKET
+#define CHECKHEADER_SLIB_NETWORK_WEB_SOCKET
+
+/****************************************
+ 
+	The WebSocket Protocol
+	https://tools.ietf.org/html/rfc6455
+ 
+	Compression Extensions for WebSocket
+	https://tools.ietf.org/html/rfc7692
+
+*****************************************/
+
+#include "definition.h"
+
+#include "socket_address.h"
+
+#include "../core/async.h"
+#include "../core/memory.h"
+#include "../core/string.h"
+#include "../core/list.h"
+#include "../core/function.h"
+
+namespace slib
+{
+
+	class HttpServerConnection;
+	class HttpServerContext;
+	
+	enum class WebSocketOpcode
+	{
+		Continuation = 0,
+		Text = 1,
+		Binary = 2,
+		Close = 8,
+		Ping = 9,
+		Pong = 10
+	};
+	
+	enum class WebSocketCloseCode
+	{
+		Normal = 1000,
+		GoingAway = 1001,
+		ProtocolError = 1002,
+		UnsupportedData = 1003,
+		NoStatus = 1005,
+		AbnormalClosure = 1006,
+		InvalidPayload = 1007,
+		PolicyViolation = 1008,
+		MessageTooBig = 1009,
+		InternalError = 1011
+	};
+	
+	class SLIB_EXPORT WebSocketFrame
+	{
+	public:
+		// header of unmasked (server to client) frame
+		static Memory buildHeader(WebSocketOpcode opcode, sl_uint64 sizePayload, sl_bool flagCompressed = sl_false, sl_bool flagFinal = sl_true);
+		
+		// unmasked (server to client) frame
+		static Memory build(WebSocketOpcode opcode, const void* payload, sl_size size, sl_bool flagCompressed = sl_false, sl_bool flagFinal = sl_true);
+		
+		// permessage-deflate without context takeover
+		static Memory compress(const void* data, sl_size size);
+		
+		// permessage-deflate without context takeover. Decompression fails as soon as the output exceeds `maxSize` (0: unlimited)
+		static sl_bool decompress(const void* data, sl_size size, Memory& output, sl_uint64 maxSize = 0, sl_bool* pFlagExceeded = sl_null);
+		
+		static sl_bool isValidUtf8(const void* data, sl_size size);
+		
+		static String getAcceptKey(const String& key);
+		
+	};
+	
+	class SLIB_EXPORT WebSocketMessage
+	{
+	public:
+		WebSocketOpcode opcode; // Text or Binary
+		Memory data;
+		
+	public:
+		WebSocketMessage();
+		
+		~WebSocketMessage();
+		
+	public:
+		sl_bool isText() const;
+		
+		sl_bool isBinary() const;
+		
+		String getText() const;
+		
+	};
+	
+	class WebSocketConnection;
+	
+	class SLIB_EXPORT WebSocketParam
+	{
+	public:
+		sl_bool flagDeflate; // permessage-deflate, default: true
+		sl_uint64 maxMessageSize; // default: 16MB
+		sl_uint32 minCompressSize; // messages smaller than this size are sent without compression, default: 256
+		
+		// returns false to reject the upgrade request
+		Function<sl_bool(WebSocketConnection*, HttpServerContext*)> onAccept;
+		Function<void(WebSocketConnection*)> onOpen;
+		// called on the I/O loop of the connection
+		Function<void(WebSocketConnection*, WebSocketMessage& message)> onMessage;
+		Function<void(WebSocketConnection*, const Memory& payload)> onPong;
+		Function<void(WebSocketConnection*, sl_uint16 code)> onClose;
+		
+	public:
+		WebSocketParam();
+		
+		WebSocketParam(const WebSocketParam& other);
+		
+		~WebSocketParam();
+		
+	public:
+		WebSocketParam& operator=(const WebSocketParam& other);
+		
+	};
+	
+	class SLIB_EXPORT WebSocketConnection : public Object
+	{
+		SLIB_DECLARE_OBJECT
+		
+	protected:
+		WebSocketConnection();
+		
+		~WebSocketConnection();
+		
+	public:
+		static Ref<WebSocketConnection> create(HttpServerConnection* connection, const WebSocketParam& param);
+		
+		static sl_bool isUpgradeRequest(HttpServerContext* context);
+		
+	public:
+		// processes the upgrade request, and starts receiving frames
+		sl_bool accept(HttpServerContext* context, const void* data = sl_null, sl_uint32 size = 0);
+		
+		void close();
+		
+		sl_bool isOpened();
+		
+		Ref<HttpServerConnection> getConnection();
+		
+		Ref<AsyncStream> getIO();
+		
+		sl_bool isDeflateEnabled();
+		
+		sl_bool sendText(const String& text);
+		
+		sl_bool sendBinary(const void* data, sl_size size);
+		
+		sl_bool sendBinary(const Memory& data);
+		
+		sl_bool sendMessage(WebSocketOpcode opcode, const Memory& data);
+		
+		sl_bool sendPing(const Memory& payload = sl_null);
+		
+		// sends Close frame, and closes the connection after the frame is written
+		void sendClose(sl_uint16 code = (sl_uint16)(WebSocketCloseCode::Normal), const String& reason = sl_null);
+		
+		// the frame is serialized (and compressed) once for all connections
+		static void broadcast(const List< Ref<WebSocketConnection> >& connections, WebSocketOpcode opcode, const Memory& data);
+		
+		static void broadcastText(const List< Ref<WebSocketConnection> >& connections, const String& text);
+		
+		static void broadcastBinary(const List< Ref<WebSocketConnection> >& connections, const Memory& data);
+		
+	public:
+		SLIB_PROPERTY(SocketAddress, RemoteAddress)
+		SLIB_PROPERTY(AtomicRef<Referable>, UserObject)
+		
+	protected:
+		void _read();
+		
+		void _processInput(const void* data, sl_uint32 size);
+		
+		sl_bool _processFrameHeader();
+		
+		sl_bool _processFrame();
+		
+		sl_bool _processMessage(WebSocketOpcode opcode, const Memory& data, sl_bool flagCompressed);
+		
+		sl_bool _sendFrame(const Memory& header, const Memory& payload);
+		
+		void _onError(WebSocketCloseCode code);
+		
+		void onReadStream(AsyncStreamResult* result);
+		
+	protected:
+		WeakRef<HttpServerConnection> m_connection;
+		Ref<AsyncStream> m_io;
+		Ref<AsyncOutput> m_output;
+		WebSocketParam m_param;
+		
+		sl_bool m_flagOpened;
+		sl_bool m_flagClosed;
+		sl_bool m_flagCloseSent;
+		sl_bool m_flagDeflate;
+		sl_uint16 m_codeClose;
+		Memory m_bufRead;
+		sl_bool m_flagReading;
+		
+		// frame being parsed
+		sl_uint8 m_frameHeader[14];
+		sl_uint32 m_sizeFrameHeader;
+		sl_uint32 m_sizeFrameHeaderRequired;
+		Memory m_framePayload;
+		sl_uint64 m_sizeFramePayload;
+		sl_uint64 m_sizeFramePayloadReceived;
+		
+		// fragmented message being received
+		sl_bool m_flagMessageStarted;
+		WebSocketOpcode m_messageOpcode;
+		sl_bool m_flagMessageCompressed;
+		MemoryBuffer m_bufMessage;
+		
+	};
+
+}
+
+#endif
@@ -376,6 +376,9 @@ namespace slib
 		
 		Ref<RenderProgram3D_Position> getDefaultRenderProgramForDrawLine3D();
 		
+		// vertex buffer of at least `size` bytes, which is rewritten by every text drawing on this engine
+		Ref<VertexBuffer> getDynamicVertexBufferForDrawText2D(sl_size size);
+		
 	protected:
 		virtual Ref<RenderProgramInstance> _createProgramInstance(RenderProgram* program) = 0;
 		
@@ -437,6 +440,8 @@ namespace slib
 		AtomicRef<RenderProgram2D_Position> m_defaultRenderProgramForDrawLine2D;
 		AtomicRef<RenderProgram3D_Position> m_defaultRenderProgramForDrawLine3D;
 		
+		AtomicRef<VertexBuffer> m_dynamicVertexBufferForDrawText2D;
+		
 	};
 	
 	template <class StateType>
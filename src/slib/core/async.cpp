@@ -38,6 +38,7 @@ namespace slib
 		m_flagInit = sl_false;
 		m_flagRunning = sl_false;
 		m_handle = sl_null;
+		m_backend = AsyncIoLoopBackend::Default;
 	}
 
 	AsyncIoLoop::~AsyncIoLoop()
@@ -64,11 +65,17 @@ namespace slib
 
 	Ref<AsyncIoLoop> AsyncIoLoop::create(sl_bool flagAutoStart)
 	{
-		void* handle = _native_createHandle();
+		return create(AsyncIoLoopBackend::Default, flagAutoStart);
+	}
+
+	Ref<AsyncIoLoop> AsyncIoLoop::create(AsyncIoLoopBackend backend, sl_bool flagAutoStart)
+	{
+		void* handle = _native_createHandle(backend);
 		if (handle) {
 			Ref<AsyncIoLoop> ret = new AsyncIoLoop;
 			if (ret.isNotNull()) {
 				ret->m_handle = handle;
+				ret->m_backend = backend;
 				ret->m_thread = Thread::create(SLIB_FUNCTION_CLASS(AsyncIoLoop, _native_runLoop, ret.get()));
 				if (ret->m_thread.isNotNull()) {
 					ret->m_flagInit = sl_true;
@@ -127,6 +134,11 @@ namespace slib
 		return m_flagRunning;
 	}
 
+	AsyncIoLoopBackend AsyncIoLoop::getBackend()
+	{
+		return m_backend;
+	}
+
 	sl_bool AsyncIoLoop::addTask(const Function<void()>& task)
 	{
 		if (task.isNull()) {
@@ -194,7 +206,7 @@ namespace slib
 			LinkedQueue< Function<void()> > tasks;
 			tasks.merge(&m_queueTasks);
 			Function<void()> task;
-			while (m_queueTasks.pop(&task)) {
+			while (tasks.pop(&task)) {
 				task();
 			}
 		}
@@ -236,6 +248,9 @@ namespace slib
 		m_flagClosing = sl_false;
 		m_flagOrdering = sl_false;
 		m_mode = AsyncIoMode::InOut;
+#if defined(SLIB_PLATFORM_IS_LINUX)
+		m_nUringRequests = 0;
+#endif
 	}
 
 	AsyncIoInstance::~AsyncIoInstance()
@@ -1644,6 +1659,10 @@ namespace slib
 	{
 		m_flagClosed = sl_false;
 		m_flagWriting = sl_false;
+		m_flagWritingError = sl_false;
+		m_countWritingRequests = 0;
+		m_sizeWritten = 0;
+		m_sizeCopyWritten = 0;
 
 		m_bufferCount = 1;
 		m_bufferSize = 0x10000;
@@ -1674,17 +1693,13 @@ namespace slib
 		if (param.stream.isNull()) {
 			return sl_null;
 		}
-		Memory buffer = Memory::create(param.bufferSize);
-		if (buffer.isNull()) {
-			return sl_null;
-		}
 		Ref<AsyncOutput> ret = new AsyncOutput;
 		if (ret.isNotNull()) {
 			ret->m_streamOutput = param.stream;
 			ret->m_bufferSize = param.bufferSize;
 			ret->m_bufferCount = param.bufferCount;
 			ret->m_onEnd = param.onEnd;
-			ret->m_bufWrite = buffer;
+			ret->m_onWrite = param.onWrite;
 			return ret;
 		}
 		return sl_null;
@@ -1693,6 +1708,15 @@ namespace slib
 	void AsyncOutput::mergeBuffer(AsyncOutputBuffer* buffer)
 	{
 		ObjectLocker lock(this);
+		// joins the leading memory chunks of the buffer to the last pending element, so that they can be sent by one gather write
+		Link< Ref<AsyncOutputBufferElement> >* back = m_queueOutput.getBack();
+		if (back && back->value->isEmptyBody()) {
+			Ref<AsyncOutputBufferElement> front;
+			if (buffer->m_queueOutput.pop(&front) && front.isNotNull()) {
+				back->value->getHeader().link(front->getHeader());
+				back->value->setBody(front->getBody().get(), front->getBodySize());
+			}
+		}
 		m_queueOutput.merge(&(buffer->m_queueOutput));
 		m_lengthOutput += buffer->m_lengthOutput;
 	}
@@ -1702,6 +1726,21 @@ namespace slib
 		_write(sl_false);
 	}
 
+	sl_uint64 AsyncOutput::getWrittenSize()
+	{
+		return m_sizeWritten;
+	}
+	
+	sl_uint64 AsyncOutput::getPendingSize()
+	{
+		sl_uint64 sizeWritten = m_sizeWritten;
+		sl_uint64 sizeOutput = m_lengthOutput;
+		if (sizeOutput > sizeWritten) {
+			return sizeOutput - sizeWritten;
+		}
+		return 0;
+	}
+
 	void AsyncOutput::_write(sl_bool flagCompleted)
 	{
 		ObjectLocker lock(this);
@@ -1728,14 +1767,32 @@ namespace slib
 		}
 		MemoryQueue& header = m_elementWriting->getHeader();
 		if (header.getSize() > 0) {
-			sl_uint32 size = (sl_uint32)(header.pop(m_bufWrite.getData(), m_bufWrite.getSize()));
-			if (size > 0) {
-				m_flagWriting = sl_true;
-				if (!(m_streamOutput->write(m_bufWrite.getData(), size, SLIB_FUNCTION_WEAKREF(AsyncOutput, onWriteStream, this), m_bufWrite.ref.get()))) {
-					m_flagWriting = sl_false;
-					_onError();
+			// writes the memory chunks without copying, the stream can gather the queued requests into one system call
+			m_flagWriting = sl_true;
+			m_flagWritingError = sl_false;
+			m_countWritingRequests = 1;
+			sl_uint32 nChunks = 0;
+			MemoryData data;
+			while (nChunks < SLIB_ASYNC_OUTPUT_WRITE_CHUNKS_MAX && header.pop(data)) {
+				char* p = (char*)(data.data);
+				sl_size size = data.size;
+				while (size > 0) {
+					sl_uint32 n = size > 0x40000000 ? 0x40000000 : (sl_uint32)size;
+					m_countWritingRequests++;
+					if (!(m_streamOutput->write(p, n, SLIB_FUNCTION_WEAKREF(AsyncOutput, onWriteStream, this), data.refer.get()))) {
+						m_countWritingRequests--;
+						m_flagWritingError = sl_true;
+						break;
+					}
+					p += n;
+					size -= n;
+				}
+				if (m_flagWritingError) {
+					break;
 				}
+				nChunks++;
 			}
+			_onWriteRequestComplete(m_flagWritingError);
 		} else {
 			sl_uint64 sizeBody = m_elementWriting->getBodySize();
 			Ref<AsyncStream> body = m_elementWriting->getBody();
@@ -1749,6 +1806,9 @@ namespace slib
 				param.bufferSize = m_bufferSize;
 				param.bufferCount = m_bufferCount;
 				param.onEnd = SLIB_FUNCTION_WEAKREF(AsyncOutput, onAsyncCopyEnd, this);
+				// the progress is always counted for `getWrittenSize()`
+				param.onWrite = SLIB_FUNCTION_WEAKREF(AsyncOutput, onAsyncCopyWrite, this);
+				m_sizeCopyWritten = 0;
 				Ref<AsyncCopy> copy = AsyncCopy::create(param);
 				if (copy.isNotNull()) {
 					m_copy = copy;
@@ -1760,8 +1820,37 @@ namespace slib
 		}
 	}
 
+	void AsyncOutput::_onWriteRequestComplete(sl_bool flagError)
+	{
+		if (flagError) {
+			m_flagWritingError = sl_true;
+		}
+		m_countWritingRequests--;
+		if (m_countWritingRequests) {
+			return;
+		}
+		m_flagWriting = sl_false;
+		if (m_flagWritingError) {
+			_onError();
+		} else {
+			_write(sl_true);
+		}
+	}
+
+	void AsyncOutput::onAsyncCopyWrite(AsyncCopy* task)
+	{
+		// called with the lock of the copy, so `m_sizeWritten` is updated without locking this object
+		sl_uint64 size = task->getWrittenSize();
+		Base::interlockedAdd64(&m_sizeWritten, (sl_int64)(size - m_sizeCopyWritten));
+		m_sizeCopyWritten = size;
+		m_onWrite(this);
+	}
+
 	void AsyncOutput::onAsyncCopyEnd(AsyncCopy* task, sl_bool flagError)
 	{
+		sl_uint64 size = task->getWrittenSize();
+		Base::interlockedAdd64(&m_sizeWritten, (sl_int64)(size - m_sizeCopyWritten));
+		m_sizeCopyWritten = size;
 		m_flagWriting = sl_false;
 		if (flagError || !(task->isCompleted())) {
 			_onError();
@@ -1772,12 +1861,13 @@ namespace slib
 
 	void AsyncOutput::onWriteStream(AsyncStreamResult* result)
 	{
-		m_flagWriting = sl_false;
-		if (result->flagError) {
-			_onError();
-			return;
+		ObjectLocker lock(this);
+		if (!(result->flagError)) {
+			Base::interlockedAdd64(&m_sizeWritten, result->size);
 		}
-		_write(sl_true);
+		_onWriteRequestComplete(result->flagError);
+		lock.unlock();
+		m_onWrite(this);
 	}
 
 	void AsyncOutput::_onError()
@@ -35,6 +35,16 @@
 #define ASYNC_USE_KEVENT
 #endif
 
+#if defined(ASYNC_USE_EPOLL) && !defined(SLIB_PLATFORM_IS_ANDROID)
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define ASYNC_USE_IO_URING
+#endif
+#endif
+#endif
+
 #define ASYNC_MAX_WAIT_EVENT 256
 
+#define ASYNC_IO_URING_ENTRIES 1024
+
 #endif
@@ -27,6 +27,8 @@
 #include "slib/core/async.h"
 #include "slib/core/pipe.h"
 
+#include "async_io_uring.h"
+
 #include <unistd.h>
 #include <sys/epoll.h>
 #include <sys/errno.h>
@@ -42,10 +44,41 @@ namespace slib
 	{
 		int fdEpoll;
 		Ref<PipeEvent> eventWake;
+#if defined(ASYNC_USE_IO_URING)
+		_priv_AsyncIoUring* ring;
+#endif
 	};
 
-	void* AsyncIoLoop::_native_createHandle()
+#if defined(ASYNC_USE_IO_URING)
+	_priv_AsyncIoUring* _priv_AsyncIoUring::get(AsyncIoLoop* loop)
 	{
+		if (loop) {
+			_priv_AsyncIoLoopHandle* handle = (_priv_AsyncIoLoopHandle*)(loop->m_handle);
+			if (handle) {
+				return handle->ring;
+			}
+		}
+		return sl_null;
+	}
+#endif
+
+	void* AsyncIoLoop::_native_createHandle(AsyncIoLoopBackend& backend)
+	{
+#if defined(ASYNC_USE_IO_URING)
+		if (backend == AsyncIoLoopBackend::IoUring) {
+			_priv_AsyncIoUring* ring = _priv_AsyncIoUring::create();
+			if (ring) {
+				_priv_AsyncIoLoopHandle* handle = new _priv_AsyncIoLoopHandle;
+				if (handle) {
+					handle->fdEpoll = -1;
+					handle->ring = ring;
+					return handle;
+				}
+				delete ring;
+			}
+		}
+#endif
+		backend = AsyncIoLoopBackend::Default;
 		Ref<PipeEvent> pipe = PipeEvent::create();
 		if (pipe.isNull()) {
 			return 0;
@@ -61,6 +94,9 @@ namespace slib
 			if (handle) {
 				handle->fdEpoll = fdEpoll;
 				handle->eventWake = pipe;
+#if defined(ASYNC_USE_IO_URING)
+				handle->ring = sl_null;
+#endif
 				// register wake event
 				epoll_event ev;
 				ev.data.ptr = sl_null;
@@ -78,6 +114,13 @@ namespace slib
 	void AsyncIoLoop::_native_closeHandle(void* _handle)
 	{
 		_priv_AsyncIoLoopHandle* handle = (_priv_AsyncIoLoopHandle*)_handle;
+#if defined(ASYNC_USE_IO_URING)
+		if (handle->ring) {
+			delete handle->ring;
+			delete handle;
+			return;
+		}
+#endif
 		::close(handle->fdEpoll);
 		delete handle;
 	}
@@ -86,6 +129,13 @@ namespace slib
 	{
 		_priv_AsyncIoLoopHandle* handle = (_priv_AsyncIoLoopHandle*)m_handle;
 
+#if defined(ASYNC_USE_IO_URING)
+		if (handle->ring) {
+			handle->ring->runLoop(this);
+			return;
+		}
+#endif
+
 		epoll_event waitEvents[ASYNC_MAX_WAIT_EVENT];
 
 		while (m_flagRunning) {
@@ -143,12 +193,23 @@ namespace slib
 	void AsyncIoLoop::_native_wake()
 	{
 		_priv_AsyncIoLoopHandle* handle = (_priv_AsyncIoLoopHandle*)m_handle;
+#if defined(ASYNC_USE_IO_URING)
+		if (handle->ring) {
+			handle->ring->wake();
+			return;
+		}
+#endif
 		handle->eventWake->set();
 	}
 
 	sl_bool AsyncIoLoop::_native_attachInstance(AsyncIoInstance* instance, AsyncIoMode mode)
 	{
 		_priv_AsyncIoLoopHandle* handle = (_priv_AsyncIoLoopHandle*)m_handle;
+#if defined(ASYNC_USE_IO_URING)
+		if (handle->ring) {
+			return handle->ring->attachInstance(instance, mode);
+		}
+#endif
 		int hObject = (int)(instance->getHandle());
 		epoll_event ev;
 		ev.data.ptr = (void*)instance;
@@ -183,6 +244,12 @@ namespace slib
 	void AsyncIoLoop::_native_detachInstance(AsyncIoInstance* instance)
 	{
 		_priv_AsyncIoLoopHandle* handle = (_priv_AsyncIoLoopHandle*)m_handle;
+#if defined(ASYNC_USE_IO_URING)
+		if (handle->ring) {
+			handle->ring->detachInstance(instance);
+			return;
+		}
+#endif
 		int hObject = (int)(instance->getHandle());
 		epoll_event ev;
 		int ret = ::epoll_ctl(handle->fdEpoll, EPOLL_CTL_DEL, hObject, &ev);
@@ -0,0 +1,590 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#include "async_io_uring.h"
+
+#if defined(ASYNC_USE_IO_URING)
+
+#include "slib/core/system.h"
+
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#define IO_URING_DATA_WAKE 0
+#define IO_URING_DATA_POLL 1
+#define IO_URING_DATA_OPERATION 2
+#define IO_URING_DATA_REMOVE 3
+#define IO_URING_DATA_MASK 3
+
+namespace slib
+{
+
+	static int _priv_IoUring_setup(sl_uint32 entries, io_uring_params* params)
+	{
+#if defined(__NR_io_uring_setup)
+		return (int)(syscall(__NR_io_uring_setup, entries, params));
+#else
+		return -1;
+#endif
+	}
+
+	static int _priv_IoUring_enter(int fd, sl_uint32 nSubmit, sl_uint32 nMinComplete, sl_uint32 flags)
+	{
+#if defined(__NR_io_uring_enter)
+		return (int)(syscall(__NR_io_uring_enter, fd, nSubmit, nMinComplete, flags, sl_null, 0));
+#else
+		return -1;
+#endif
+	}
+
+	_priv_AsyncIoUring::_priv_AsyncIoUring()
+	{
+		m_fd = -1;
+		m_sqTailLocal = 0;
+		m_ptrSq = MAP_FAILED;
+		m_sizeSq = 0;
+		m_ptrCq = MAP_FAILED;
+		m_sizeCq = 0;
+		m_sqes = (io_uring_sqe*)MAP_FAILED;
+		m_sizeSqes = 0;
+	}
+
+	_priv_AsyncIoUring::~_priv_AsyncIoUring()
+	{
+		if (m_sqes != MAP_FAILED) {
+			::munmap(m_sqes, m_sizeSqes);
+		}
+		if (m_ptrCq != MAP_FAILED && m_ptrCq != m_ptrSq) {
+			::munmap(m_ptrCq, m_sizeCq);
+		}
+		if (m_ptrSq != MAP_FAILED) {
+			::munmap(m_ptrSq, m_sizeSq);
+		}
+		if (m_fd >= 0) {
+			::close(m_fd);
+		}
+	}
+
+	_priv_AsyncIoUring* _priv_AsyncIoUring::create()
+	{
+#if defined(IORING_FEAT_RSRC_TAGS) && defined(IORING_POLL_ADD_MULTI)
+		Ref<PipeEvent> eventWake = PipeEvent::create();
+		if (eventWake.isNull()) {
+			return sl_null;
+		}
+		io_uring_params params;
+		Base::zeroMemory(&params, sizeof(params));
+		int fd = _priv_IoUring_setup(ASYNC_IO_URING_ENTRIES, &params);
+		if (fd < 0) {
+			return sl_null;
+		}
+		// multi-shot poll is available since Linux 5.13, which also introduced IORING_FEAT_RSRC_TAGS
+		if (!(params.features & IORING_FEAT_RSRC_TAGS) || !(params.features & IORING_FEAT_NODROP)) {
+			::close(fd);
+			return sl_null;
+		}
+		_priv_AsyncIoUring* ring = new _priv_AsyncIoUring;
+		if (!ring) {
+			::close(fd);
+			return sl_null;
+		}
+		ring->m_fd = fd;
+		ring->m_eventWake = eventWake;
+		
+		ring->m_sizeSq = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+		ring->m_sizeCq = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		sl_bool flagSingleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+		if (flagSingleMap) {
+			if (ring->m_sizeCq > ring->m_sizeSq) {
+				ring->m_sizeSq = ring->m_sizeCq;
+			}
+		}
+		ring->m_ptrSq = ::mmap(sl_null, ring->m_sizeSq, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+		if (ring->m_ptrSq == MAP_FAILED) {
+			delete ring;
+			return sl_null;
+		}
+		if (flagSingleMap) {
+			ring->m_ptrCq = ring->m_ptrSq;
+		} else {
+			ring->m_ptrCq = ::mmap(sl_null, ring->m_sizeCq, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+			if (ring->m_ptrCq == MAP_FAILED) {
+				delete ring;
+				return sl_null;
+			}
+		}
+		ring->m_sizeSqes = params.sq_entries * sizeof(io_uring_sqe);
+		ring->m_sqes = (io_uring_sqe*)(::mmap(sl_null, ring->m_sizeSqes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+		if (ring->m_sqes == MAP_FAILED) {
+			delete ring;
+			return sl_null;
+		}
+		
+		sl_uint8* sq = (sl_uint8*)(ring->m_ptrSq);
+		ring->m_sqHead = (unsigned*)(sq + params.sq_off.head);
+		ring->m_sqTail = (unsigned*)(sq + params.sq_off.tail);
+		ring->m_sqMask = *((unsigned*)(sq + params.sq_off.ring_mask));
+		ring->m_sqEntries = *((unsigned*)(sq + params.sq_off.ring_entries));
+		ring->m_sqTailLocal = *(ring->m_sqTail);
+		// SQE slots are used in order, so the index array is fixed
+		unsigned* sqArray = (unsigned*)(sq + params.sq_off.array);
+		for (unsigned i = 0; i < ring->m_sqEntries; i++) {
+			sqArray[i] = i;
+		}
+		
+		sl_uint8* cq = (sl_uint8*)(ring->m_ptrCq);
+		ring->m_cqHead = (unsigned*)(cq + params.cq_off.head);
+		ring->m_cqTail = (unsigned*)(cq + params.cq_off.tail);
+		ring->m_cqMask = *((unsigned*)(cq + params.cq_off.ring_mask));
+		ring->m_cqes = (io_uring_cqe*)(cq + params.cq_off.cqes);
+		
+		MutexLocker lock(&(ring->m_lock));
+		if (ring->_preparePoll(sl_null, (int)(eventWake->getReadPipeHandle()), AsyncIoMode::In)) {
+			ring->_submit();
+			return ring;
+		}
+		lock.unlock();
+		delete ring;
+#endif
+		return sl_null;
+	}
+
+	void _priv_AsyncIoUring::runLoop(AsyncIoLoop* loop)
+	{
+		io_uring_cqe cqes[ASYNC_MAX_WAIT_EVENT];
+
+		while (loop->m_flagRunning) {
+
+			loop->_stepBegin();
+
+			// submits all requests prepared in this step at once, and waits for completions
+			for (;;) {
+				sl_uint32 nSubmit;
+				{
+					MutexLocker lock(&m_lock);
+					nSubmit = m_sqTailLocal - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+				}
+				if (_priv_IoUring_enter(m_fd, nSubmit, 1, IORING_ENTER_GETEVENTS) >= 0) {
+					break;
+				}
+				int err = errno;
+				if (err == EINTR) {
+					continue;
+				}
+				if (err == EBUSY || err == EAGAIN) {
+					// the completion queue is full or the kernel is short of resources: the requests are submitted again after reaping the completions
+					if (*m_cqHead == __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE)) {
+						System::sleep(1);
+					}
+				}
+				break;
+			}
+
+			while (loop->m_flagRunning) {
+				unsigned head = *m_cqHead;
+				unsigned tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+				if (head == tail) {
+					break;
+				}
+				sl_uint32 nCount = 0;
+				while (head != tail && nCount < ASYNC_MAX_WAIT_EVENT) {
+					cqes[nCount] = m_cqes[head & m_cqMask];
+					nCount++;
+					head++;
+				}
+				__atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+				for (sl_uint32 i = 0; loop->m_flagRunning && i < nCount; i++) {
+					io_uring_cqe& cqe = cqes[i];
+					_processCompletion(loop, cqe.user_data, cqe.res, cqe.flags);
+				}
+			}
+
+			_releaseClosedInstances(loop);
+
+			if (loop->m_flagRunning) {
+				loop->_stepEnd();
+			}
+		}
+	}
+
+	void _priv_AsyncIoUring::wake()
+	{
+		m_eventWake->set();
+	}
+
+	sl_bool _priv_AsyncIoUring::attachInstance(AsyncIoInstance* instance, AsyncIoMode mode)
+	{
+		instance->setMode(mode);
+		if (mode == AsyncIoMode::None) {
+			return sl_true;
+		}
+		MutexLocker lock(&m_lock);
+		if (_preparePoll(instance, (int)(instance->getHandle()), mode)) {
+			lock.unlock();
+			// the poll is submitted by the loop after processing orders (for example, `connect()` of the socket)
+			m_eventWake->set();
+			return sl_true;
+		}
+		return sl_false;
+	}
+
+	void _priv_AsyncIoUring::detachInstance(AsyncIoInstance* instance)
+	{
+		if (instance->getMode() == AsyncIoMode::None) {
+			return;
+		}
+		MutexLocker lock(&m_lock);
+		io_uring_sqe* sqe = _getSqe();
+		if (sqe) {
+			sqe->opcode = IORING_OP_POLL_REMOVE;
+			sqe->fd = -1;
+			sqe->addr = (sl_uint64)((sl_size)instance) | IO_URING_DATA_POLL;
+			sqe->user_data = (sl_uint64)((sl_size)instance) | IO_URING_DATA_REMOVE;
+			instance->m_nUringRequests++;
+			m_sqTailLocal++;
+			__atomic_store_n(m_sqTail, m_sqTailLocal, __ATOMIC_RELEASE);
+		}
+	}
+
+	sl_bool _priv_AsyncIoUring::prepareReadWrite(AsyncIoInstance* instance, sl_bool flagRead, void* data, sl_uint32 size, sl_uint64 offset)
+	{
+		MutexLocker lock(&m_lock);
+		io_uring_sqe* sqe = _getSqe();
+		if (sqe) {
+			sqe->opcode = flagRead ? IORING_OP_READ : IORING_OP_WRITE;
+			sqe->fd = (int)(instance->getHandle());
+			sqe->addr = (sl_uint64)((sl_size)data);
+			sqe->len = size;
+			sqe->off = offset;
+			sqe->user_data = (sl_uint64)((sl_size)instance) | IO_URING_DATA_OPERATION;
+			instance->m_nUringRequests++;
+			m_sqTailLocal++;
+			__atomic_store_n(m_sqTail, m_sqTailLocal, __ATOMIC_RELEASE);
+			return sl_true;
+		}
+		return sl_false;
+	}
+
+	io_uring_sqe* _priv_AsyncIoUring::_getSqe()
+	{
+		if (m_sqTailLocal - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE) >= m_sqEntries) {
+			_submit();
+			if (m_sqTailLocal - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE) >= m_sqEntries) {
+				return sl_null;
+			}
+		}
+		io_uring_sqe* sqe = m_sqes + (m_sqTailLocal & m_sqMask);
+		Base::zeroMemory(sqe, sizeof(io_uring_sqe));
+		return sqe;
+	}
+
+	void _priv_AsyncIoUring::_submit()
+	{
+		for (;;) {
+			sl_uint32 n = m_sqTailLocal - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+			if (!n) {
+				return;
+			}
+			// on EBUSY, the requests stay in the submission queue and are submitted by the loop
+			if (_priv_IoUring_enter(m_fd, n, 0, 0) >= 0 || errno != EINTR) {
+				return;
+			}
+		}
+	}
+
+	sl_bool _priv_AsyncIoUring::_preparePoll(AsyncIoInstance* instance, int fd, AsyncIoMode mode)
+	{
+#if defined(IORING_POLL_ADD_MULTI)
+		io_uring_sqe* sqe = _getSqe();
+		if (sqe) {
+			sl_uint32 events = POLLRDHUP;
+			if (mode == AsyncIoMode::In || mode == AsyncIoMode::InOut) {
+				events |= POLLIN | POLLPRI;
+			}
+			if (mode == AsyncIoMode::Out || mode == AsyncIoMode::InOut) {
+				events |= POLLOUT;
+			}
+#if defined(SLIB_ARCH_IS_BIG_ENDIAN)
+			events = (events << 16) | (events >> 16);
+#endif
+			sqe->opcode = IORING_OP_POLL_ADD;
+			sqe->fd = fd;
+			// multi-shot poll is triggered on every wake-up, same as edge-triggered epoll
+			sqe->len = IORING_POLL_ADD_MULTI;
+			sqe->poll32_events = events;
+			if (instance) {
+				sqe->user_data = (sl_uint64)((sl_size)instance) | IO_URING_DATA_POLL;
+				instance->m_nUringRequests++;
+			} else {
+				sqe->user_data = IO_URING_DATA_WAKE;
+			}
+			m_sqTailLocal++;
+			__atomic_store_n(m_sqTail, m_sqTailLocal, __ATOMIC_RELEASE);
+			return sl_true;
+		}
+#endif
+		return sl_false;
+	}
+
+	void _priv_AsyncIoUring::_processCompletion(AsyncIoLoop* loop, sl_uint64 userData, sl_int32 result, sl_uint32 flags)
+	{
+		sl_uint32 type = (sl_uint32)(userData & IO_URING_DATA_MASK);
+		if (type == IO_URING_DATA_WAKE) {
+			m_eventWake->reset();
+			if (!(flags & IORING_CQE_F_MORE)) {
+				MutexLocker lock(&m_lock);
+				_preparePoll(sl_null, (int)(m_eventWake->getReadPipeHandle()), AsyncIoMode::In);
+			}
+			return;
+		}
+		// the instance is alive here, because closed instances are released only after all of their requests are completed
+		AsyncIoInstance* instance = (AsyncIoInstance*)((sl_size)(userData & ~((sl_uint64)IO_URING_DATA_MASK)));
+		if (type == IO_URING_DATA_REMOVE) {
+			MutexLocker lock(&m_lock);
+			instance->m_nUringRequests--;
+			return;
+		}
+		AsyncIoInstance::EventDesc desc;
+		desc.flagIn = sl_false;
+		desc.flagOut = sl_false;
+		desc.flagError = sl_false;
+		desc.result = result;
+		if (type == IO_URING_DATA_OPERATION) {
+			{
+				MutexLocker lock(&m_lock);
+				instance->m_nUringRequests--;
+			}
+			if (result < 0) {
+				desc.flagError = sl_true;
+			}
+			if (!(instance->isClosing())) {
+				instance->onEvent(&desc);
+			}
+			return;
+		}
+		if (!(flags & IORING_CQE_F_MORE)) {
+			// the multi-shot poll is finished: triggered once by old kernels, failed, or cancelled by POLL_REMOVE
+			MutexLocker lock(&m_lock);
+			instance->m_nUringRequests--;
+		}
+		if (instance->isClosing()) {
+			return;
+		}
+		if (result >= 0) {
+			if (result & (POLLIN | POLLPRI)) {
+				desc.flagIn = sl_true;
+			}
+			if (result & POLLOUT) {
+				desc.flagOut = sl_true;
+			}
+			if (result & (POLLERR | POLLHUP | POLLRDHUP)) {
+				desc.flagError = sl_true;
+			}
+			if (!(flags & IORING_CQE_F_MORE)) {
+				MutexLocker lock(&m_lock);
+				_preparePoll(instance, (int)(instance->getHandle()), instance->getMode());
+			}
+		} else {
+			desc.flagError = sl_true;
+		}
+		instance->onEvent(&desc);
+	}
+
+	void _priv_AsyncIoUring::_releaseClosedInstances(AsyncIoLoop* loop)
+	{
+		/*
+			The kernel keeps `user_data` of a request, which points to the instance, until the completion of the request is posted.
+			A multi-shot poll is finished by the completion without IORING_CQE_F_MORE (-ECANCELED when it is removed), and POLL_REMOVE
+			posts its own completion, but the kernel can post these two in either order. So a closed instance is released after
+			the completions of all its requests (polls, reads/writes and POLL_REMOVE) are reaped, not on the completion of POLL_REMOVE alone.
+		*/
+		Ref<AsyncIoInstance> instance;
+		while (loop->m_queueInstancesClosed.pop(&instance)) {
+			m_listInstancesClosed.add_NoLock(instance);
+		}
+		List< Ref<AsyncIoInstance> > listRelease;
+		{
+			MutexLocker lock(&m_lock);
+			sl_size i = m_listInstancesClosed.getCount();
+			while (i > 0) {
+				i--;
+				if (!(m_listInstancesClosed.getData()[i]->m_nUringRequests)) {
+					m_listInstancesClosed.removeAt_NoLock(i, &instance);
+					listRelease.add_NoLock(instance);
+				}
+			}
+		}
+	}
+
+
+	class _priv_IoUringAsyncFileStreamInstance : public AsyncStreamInstance
+	{
+	public:
+		Ref<File> m_file;
+		Ref<AsyncStreamRequest> m_requestOperating;
+		sl_uint64 m_offset;
+
+	public:
+		_priv_IoUringAsyncFileStreamInstance()
+		{
+			m_offset = 0;
+		}
+
+		~_priv_IoUringAsyncFileStreamInstance()
+		{
+			close();
+		}
+
+	public:
+		static Ref<_priv_IoUringAsyncFileStreamInstance> open(const String& path, FileMode mode)
+		{
+			Ref<File> file = File::open(path, mode);
+			if (file.isNotNull()) {
+				Ref<_priv_IoUringAsyncFileStreamInstance> ret = new _priv_IoUringAsyncFileStreamInstance();
+				if (ret.isNotNull()) {
+					ret->m_file = file;
+					ret->setHandle(file->getHandle());
+					if (mode & FileMode::SeekToEnd) {
+						ret->m_offset = file->getSize();
+					}
+					return ret;
+				}
+			}
+			return sl_null;
+		}
+
+		void close() override
+		{
+			if (m_file.isNotNull()) {
+				m_file->close();
+				m_file.setNull();
+			}
+			setHandle(SLIB_FILE_INVALID_HANDLE);
+		}
+
+		void onOrder() override
+		{
+			if (getHandle() == SLIB_FILE_INVALID_HANDLE) {
+				return;
+			}
+			if (m_requestOperating.isNotNull()) {
+				return;
+			}
+			Ref<AsyncIoLoop> loop = getLoop();
+			_priv_AsyncIoUring* ring = _priv_AsyncIoUring::get(loop.get());
+			if (!ring) {
+				return;
+			}
+			Ref<AsyncStreamRequest> req;
+			if (popReadRequest(req) || popWriteRequest(req)) {
+				if (req.isNotNull()) {
+					if (req->data && req->size) {
+						if (ring->prepareReadWrite(this, req->flagRead, req->data, req->size, m_offset)) {
+							m_requestOperating = req;
+							return;
+						}
+						processResult(req.get(), 0, sl_true);
+					} else {
+						processResult(req.get(), req->size, sl_false);
+					}
+				}
+				requestOrder();
+			}
+		}
+
+		void onEvent(EventDesc* pev) override
+		{
+			Ref<AsyncStreamRequest> req = m_requestOperating;
+			m_requestOperating.setNull();
+			sl_uint32 size = 0;
+			sl_bool flagError = sl_false;
+			if (pev->result > 0) {
+				size = (sl_uint32)(pev->result);
+				m_offset += size;
+			} else {
+				flagError = sl_true;
+			}
+			if (req.isNotNull()) {
+				processResult(req.get(), size, flagError);
+			}
+			requestOrder();
+		}
+
+		void processResult(AsyncStreamRequest* req, sl_uint32 size, sl_bool flagError)
+		{
+			Ref<AsyncIoObject> object = getObject();
+			if (object.isNotNull()) {
+				req->runCallback(static_cast<AsyncStream*>(object.get()), size, flagError);
+			}
+		}
+
+		sl_bool isSeekable() override
+		{
+			return sl_true;
+		}
+
+		sl_bool seek(sl_uint64 pos) override
+		{
+			m_offset = pos;
+			return sl_true;
+		}
+
+		sl_uint64 getSize() override
+		{
+			return File::getSize(getHandle());
+		}
+
+	};
+
+}
+
+#endif
+
+#if defined(SLIB_PLATFORM_IS_LINUX)
+
+namespace slib
+{
+
+	Ref<AsyncStream> AsyncFile::openIoUring(const String& path, FileMode mode, const Ref<AsyncIoLoop>& loop)
+	{
+#if defined(ASYNC_USE_IO_URING)
+		if (loop.isNotNull() && loop->getBackend() == AsyncIoLoopBackend::IoUring) {
+			Ref<_priv_IoUringAsyncFileStreamInstance> ret = _priv_IoUringAsyncFileStreamInstance::open(path, mode);
+			if (ret.isNotNull()) {
+				return AsyncStream::create(ret.get(), AsyncIoMode::None, loop);
+			}
+			return sl_null;
+		}
+#endif
+		if (loop.isNotNull()) {
+			return AsyncFile::open(path, mode, loop);
+		}
+		return AsyncFile::open(path, mode);
+	}
+
+}
+
+#endif
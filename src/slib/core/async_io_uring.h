@@ -0,0 +1,109 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#ifndef CHECKHEADER_SLIB_CORE_ASYNC_IO_URING
+#define CHECKHEADER_SLIB_CORE_ASYNC_IO_URING
+
+#include "async_config.h"
+
+#if defined(ASYNC_USE_IO_URING)
+
+#include "slib/core/async.h"
+#include "slib/core/pipe.h"
+#include "slib/core/list.h"
+
+#include <linux/io_uring.h>
+
+namespace slib
+{
+
+	class _priv_AsyncIoUring
+	{
+	public:
+		int m_fd;
+		
+		unsigned* m_sqHead;
+		unsigned* m_sqTail;
+		unsigned m_sqMask;
+		unsigned m_sqEntries;
+		unsigned m_sqTailLocal;
+		io_uring_sqe* m_sqes;
+		
+		unsigned* m_cqHead;
+		unsigned* m_cqTail;
+		unsigned m_cqMask;
+		io_uring_cqe* m_cqes;
+		
+		void* m_ptrSq;
+		sl_size m_sizeSq;
+		void* m_ptrCq;
+		sl_size m_sizeCq;
+		sl_size m_sizeSqes;
+		
+		Ref<PipeEvent> m_eventWake;
+		Mutex m_lock;
+		
+		// closed instances waiting for the completions of their requests, accessed only by the loop thread
+		List< Ref<AsyncIoInstance> > m_listInstancesClosed;
+		
+	public:
+		_priv_AsyncIoUring();
+		
+		~_priv_AsyncIoUring();
+		
+	public:
+		static _priv_AsyncIoUring* create();
+		
+		static _priv_AsyncIoUring* get(AsyncIoLoop* loop);
+		
+	public:
+		void runLoop(AsyncIoLoop* loop);
+		
+		void wake();
+		
+		sl_bool attachInstance(AsyncIoInstance* instance, AsyncIoMode mode);
+		
+		void detachInstance(AsyncIoInstance* instance);
+		
+		// completion is delivered to `onEvent()` of the instance (`result` is the number of transferred bytes or negative error code), submitted on next loop step
+		sl_bool prepareReadWrite(AsyncIoInstance* instance, sl_bool flagRead, void* data, sl_uint32 size, sl_uint64 offset);
+		
+	protected:
+		io_uring_sqe* _getSqe();
+		
+		void _submit();
+		
+		// `instance` is null for the wake-up event
+		sl_bool _preparePoll(AsyncIoInstance* instance, int fd, AsyncIoMode mode);
+		
+		void _releaseClosedInstances(AsyncIoLoop* loop);
+		
+		void _processCompletion(AsyncIoLoop* loop, sl_uint64 userData, sl_int32 result, sl_uint32 flags);
+		
+	};
+
+}
+
+#endif
+
+#endif
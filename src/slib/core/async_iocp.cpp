@@ -36,8 +36,9 @@ namespace slib
 		OVERLAPPED overlappedWake;
 	};
 
-	void* AsyncIoLoop::_native_createHandle()
+	void* AsyncIoLoop::_native_createHandle(AsyncIoLoopBackend& backend)
 	{
+		backend = AsyncIoLoopBackend::Default;
 		HANDLE hCompletionPort = ::CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, NULL, 1);
 		if (hCompletionPort) {
 			_priv_AsyncIoLoopHandle* handle = new _priv_AsyncIoLoopHandle;
@@ -41,8 +41,9 @@ namespace slib
 		Ref<PipeEvent> eventWake;
 	};
 
-	void* AsyncIoLoop::_native_createHandle()
+	void* AsyncIoLoop::_native_createHandle(AsyncIoLoopBackend& backend)
 	{
+		backend = AsyncIoLoopBackend::Default;
 		Ref<PipeEvent> pipe = PipeEvent::create();
 		if (pipe.isNull()) {
 			return 0;
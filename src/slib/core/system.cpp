@@ -28,6 +28,10 @@
 #include "slib/core/list.h"
 #include "slib/core/safe_static.h"
 
+#if defined(SLIB_COMPILER_IS_VC) && (defined(SLIB_ARCH_IS_X64) || defined(SLIB_ARCH_IS_X86))
+#	include <intrin.h>
+#endif
+
 namespace slib
 {
 
@@ -40,6 +44,34 @@ namespace slib
 		return path;
 	}
 
+	sl_bool System::isAVX2Supported()
+	{
+#if defined(SLIB_ARCH_IS_X64) || defined(SLIB_ARCH_IS_X86)
+#	if defined(SLIB_COMPILER_IS_VC)
+		static sl_int32 flagSupported = -1;
+		if (flagSupported < 0) {
+			int info[4];
+			__cpuid(info, 0);
+			sl_bool flag = sl_false;
+			if (info[0] >= 7) {
+				__cpuid(info, 1);
+				// OSXSAVE and AVX, and the OS saves the YMM registers
+				if ((info[2] & 0x18000000) == 0x18000000 && (_xgetbv(0) & 6) == 6) {
+					__cpuidex(info, 7, 0);
+					flag = (info[1] & 0x20) != 0;
+				}
+			}
+			flagSupported = flag ? 1 : 0;
+		}
+		return flagSupported > 0;
+#	else
+		return __builtin_cpu_supports("avx2") != 0;
+#	endif
+#else
+		return sl_false;
+#endif
+	}
+
 #if !defined(SLIB_PLATFORM_IS_APPLE)
 	String System::getApplicationHomeDirectory()
 	{
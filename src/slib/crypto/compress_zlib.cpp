@@ -166,7 +166,7 @@ namespace slib
 		while (1) {
 			sl_uint32 sizeInput = (sl_uint32)(SLIB_MIN(size, sizeChunk));
 			sl_uint32 sizeInputPassed = 0, sizeOutputUsed = 0;
-			sl_int32 iRet = compress(data, sizeInput, sizeInputPassed, chunk, sizeChunk, sizeOutputUsed, flagFinish && sizeInput < sizeChunk);
+			sl_int32 iRet = compress(data, sizeInput, sizeInputPassed, chunk, sizeChunk, sizeOutputUsed, flagFinish && sizeInput == size);
 			if (iRet < 0) {
 				return ret;
 			}
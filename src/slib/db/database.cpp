@@ -33,6 +33,7 @@ namespace slib
 	{
 		m_flagLogSQL = sl_false;
 		m_flagLogErrors = sl_true;
+		m_sizeStatementCache = 64;
 	}
 
 	Database::~Database()
@@ -201,6 +202,94 @@ namespace slib
 		m_flagLogErrors = flag;
 	}
 	
+	sl_uint32 Database::getStatementCacheSize()
+	{
+		return m_sizeStatementCache;
+	}
+	
+	void Database::setStatementCacheSize(sl_uint32 size)
+	{
+		ObjectLocker lock(this);
+		m_sizeStatementCache = size;
+		while (m_listCachedStatements.getCount() > size) {
+			DatabaseCachedStatement item;
+			if (!(m_listCachedStatements.popBack_NoLock(&item))) {
+				break;
+			}
+			m_mapCachedStatements.remove_NoLock(item.sql);
+			_freeCachedStatement(item.handle);
+		}
+	}
+	
+	void Database::clearStatementCache()
+	{
+		ObjectLocker lock(this);
+		Link<DatabaseCachedStatement>* link = m_listCachedStatements.getFront();
+		while (link) {
+			_freeCachedStatement(link->value.handle);
+			link = link->next;
+		}
+		m_listCachedStatements.removeAll_NoLock();
+		m_mapCachedStatements.removeAll_NoLock();
+	}
+	
+	sl_bool Database::ping()
+	{
+		SLIB_STATIC_STRING(sql, "SELECT 1")
+		Ref<DatabaseCursor> cursor = _queryBy(sql, sl_null, 0);
+		if (cursor.isNotNull()) {
+			return cursor->moveNext();
+		}
+		return sl_false;
+	}
+	
+	void* Database::_takeCachedStatement(const String& sql)
+	{
+		ObjectLocker lock(this);
+		Link<DatabaseCachedStatement>* link;
+		if (m_mapCachedStatements.remove_NoLock(sql, &link)) {
+			void* handle = link->value.handle;
+			m_listCachedStatements.removeAt(link);
+			return handle;
+		}
+		return sl_null;
+	}
+	
+	sl_bool Database::_putCachedStatement(const String& sql, void* handle)
+	{
+		ObjectLocker lock(this);
+		if (!m_sizeStatementCache) {
+			return sl_false;
+		}
+		if (m_mapCachedStatements.find_NoLock(sql)) {
+			// another statement of same SQL is already cached
+			return sl_false;
+		}
+		DatabaseCachedStatement item;
+		item.sql = sql;
+		item.handle = handle;
+		Link<DatabaseCachedStatement>* link = m_listCachedStatements.pushFront_NoLock(item);
+		if (!link) {
+			return sl_false;
+		}
+		if (!(m_mapCachedStatements.put_NoLock(sql, link))) {
+			m_listCachedStatements.removeAt(link);
+			return sl_false;
+		}
+		if (m_listCachedStatements.getCount() > m_sizeStatementCache) {
+			DatabaseCachedStatement old;
+			if (m_listCachedStatements.popBack_NoLock(&old)) {
+				m_mapCachedStatements.remove_NoLock(old.sql);
+				_freeCachedStatement(old.handle);
+			}
+		}
+		return sl_true;
+	}
+	
+	void Database::_freeCachedStatement(void* handle)
+	{
+	}
+	
 	void Database::_logSQL(const String& sql)
 	{
 		if (m_flagLogSQL) {
@@ -0,0 +1,235 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#include "slib/db/database.h"
+
+namespace slib
+{
+
+	DatabaseColumnBuffer::DatabaseColumnBuffer()
+	{
+		type = DatabaseColumnType::Int64;
+		sizeText = 0;
+	}
+
+	DatabaseColumnBuffer::~DatabaseColumnBuffer()
+	{
+	}
+
+
+	DatabaseColumnBatch::DatabaseColumnBatch()
+	{
+		m_nRowsCapacity = 0;
+		m_nRows = 0;
+		m_flagError = sl_false;
+	}
+
+	DatabaseColumnBatch::~DatabaseColumnBatch()
+	{
+	}
+
+	sl_bool DatabaseColumnBatch::initialize(const DatabaseColumnType* types, sl_uint32 nColumns, sl_uint32 nRowsCapacity)
+	{
+		m_columns.setNull();
+		m_nRowsCapacity = 0;
+		m_nRows = 0;
+		m_flagError = sl_false;
+		if (!nColumns || !nRowsCapacity) {
+			return sl_false;
+		}
+		Array<DatabaseColumnBuffer> columns = Array<DatabaseColumnBuffer>::create(nColumns);
+		if (columns.isNull()) {
+			return sl_false;
+		}
+		for (sl_uint32 i = 0; i < nColumns; i++) {
+			DatabaseColumnBuffer& column = columns[i];
+			column.type = types[i];
+			switch (types[i]) {
+				case DatabaseColumnType::Int64:
+					column.values = Memory::create(sizeof(sl_int64) * nRowsCapacity);
+					break;
+				case DatabaseColumnType::Double:
+					column.values = Memory::create(sizeof(double) * nRowsCapacity);
+					break;
+				case DatabaseColumnType::Text:
+					column.values = Memory::create(sizeof(sl_size) * (nRowsCapacity + 1));
+					if (column.values.isNotNull()) {
+						*((sl_size*)(column.values.getData())) = 0;
+					}
+					break;
+				default:
+					return sl_false;
+			}
+			if (column.values.isNull()) {
+				return sl_false;
+			}
+			column.nullFlags = Memory::create(nRowsCapacity);
+			if (column.nullFlags.isNull()) {
+				return sl_false;
+			}
+		}
+		m_columns = columns;
+		m_nRowsCapacity = nRowsCapacity;
+		return sl_true;
+	}
+
+	sl_uint32 DatabaseColumnBatch::getColumnsCount() const
+	{
+		return (sl_uint32)(m_columns.getCount());
+	}
+
+	sl_uint32 DatabaseColumnBatch::getRowsCapacity() const
+	{
+		return m_nRowsCapacity;
+	}
+
+	sl_uint32 DatabaseColumnBatch::getRowsCount() const
+	{
+		return m_nRows;
+	}
+
+	sl_bool DatabaseColumnBatch::isError() const
+	{
+		return m_flagError;
+	}
+
+	DatabaseColumnType DatabaseColumnBatch::getColumnType(sl_uint32 column) const
+	{
+		DatabaseColumnBuffer* p = m_columns.getPointerAt(column);
+		if (p) {
+			return p->type;
+		}
+		return DatabaseColumnType::Int64;
+	}
+
+	sl_int64* DatabaseColumnBatch::getInt64Values(sl_uint32 column) const
+	{
+		DatabaseColumnBuffer* p = m_columns.getPointerAt(column);
+		if (p && p->type == DatabaseColumnType::Int64) {
+			return (sl_int64*)(p->values.getData());
+		}
+		return sl_null;
+	}
+
+	double* DatabaseColumnBatch::getDoubleValues(sl_uint32 column) const
+	{
+		DatabaseColumnBuffer* p = m_columns.getPointerAt(column);
+		if (p && p->type == DatabaseColumnType::Double) {
+			return (double*)(p->values.getData());
+		}
+		return sl_null;
+	}
+
+	sl_size* DatabaseColumnBatch::getTextOffsets(sl_uint32 column) const
+	{
+		DatabaseColumnBuffer* p = m_columns.getPointerAt(column);
+		if (p && p->type == DatabaseColumnType::Text) {
+			return (sl_size*)(p->values.getData());
+		}
+		return sl_null;
+	}
+
+	sl_char8* DatabaseColumnBatch::getTextData(sl_uint32 column) const
+	{
+		DatabaseColumnBuffer* p = m_columns.getPointerAt(column);
+		if (p && p->type == DatabaseColumnType::Text) {
+			return (sl_char8*)(p->text.getData());
+		}
+		return sl_null;
+	}
+
+	String DatabaseColumnBatch::getText(sl_uint32 column, sl_uint32 row) const
+	{
+		DatabaseColumnBuffer* p = m_columns.getPointerAt(column);
+		if (p && row < m_nRows) {
+			switch (p->type) {
+				case DatabaseColumnType::Int64:
+					return String::fromInt64(((sl_int64*)(p->values.getData()))[row]);
+				case DatabaseColumnType::Double:
+					return String::fromDouble(((double*)(p->values.getData()))[row]);
+				case DatabaseColumnType::Text:
+					{
+						sl_size* offsets = (sl_size*)(p->values.getData());
+						return String::fromUtf8((sl_char8*)(p->text.getData()) + offsets[row], offsets[row + 1] - offsets[row]);
+					}
+			}
+		}
+		return sl_null;
+	}
+
+	sl_uint8* DatabaseColumnBatch::getNullFlags(sl_uint32 column) const
+	{
+		DatabaseColumnBuffer* p = m_columns.getPointerAt(column);
+		if (p) {
+			return (sl_uint8*)(p->nullFlags.getData());
+		}
+		return sl_null;
+	}
+
+	sl_bool DatabaseColumnBatch::isNull(sl_uint32 column, sl_uint32 row) const
+	{
+		DatabaseColumnBuffer* p = m_columns.getPointerAt(column);
+		if (p && row < m_nRows) {
+			return ((sl_uint8*)(p->nullFlags.getData()))[row] != 0;
+		}
+		return sl_true;
+	}
+
+	void DatabaseColumnBatch::clear()
+	{
+		m_nRows = 0;
+		m_flagError = sl_false;
+		sl_size n = m_columns.getCount();
+		DatabaseColumnBuffer* columns = m_columns.getData();
+		for (sl_size i = 0; i < n; i++) {
+			columns[i].sizeText = 0;
+		}
+	}
+
+	sl_bool DatabaseColumnBatch::_appendText(DatabaseColumnBuffer& column, const void* data, sl_size size)
+	{
+		if (!size) {
+			return sl_true;
+		}
+		sl_size sizeRequired = column.sizeText + size;
+		sl_size sizeOld = column.text.getSize();
+		if (sizeRequired > sizeOld) {
+			sl_size sizeNew = sizeOld ? sizeOld : 4096;
+			while (sizeNew < sizeRequired) {
+				sizeNew <<= 1;
+			}
+			Memory mem = Memory::create(sizeNew);
+			if (mem.isNull()) {
+				return sl_false;
+			}
+			if (column.sizeText) {
+				Base::copyMemory(mem.getData(), column.text.getData(), column.sizeText);
+			}
+			column.text = mem;
+		}
+		Base::copyMemory((sl_uint8*)(column.text.getData()) + column.sizeText, data, size);
+		column.sizeText = sizeRequired;
+		return sl_true;
+	}
+
+}
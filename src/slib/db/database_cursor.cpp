@@ -184,4 +184,79 @@ namespace slib
 		return sl_null;
 	}
 
+	sl_bool DatabaseCursor::isNull(sl_uint32 index)
+	{
+		return getValue(index).isNull();
+	}
+
+	sl_bool DatabaseCursor::getTextData(sl_uint32 index, const void*& outData, sl_size& outSize)
+	{
+		return sl_false;
+	}
+
+	sl_uint32 DatabaseCursor::fetchBatch(DatabaseColumnBatch& batch)
+	{
+		batch.clear();
+		sl_uint32 nColumns = batch.getColumnsCount();
+		sl_uint32 nCapacity = batch.getRowsCapacity();
+		if (!nCapacity || nColumns > getColumnsCount()) {
+			batch.m_flagError = sl_true;
+			return 0;
+		}
+		DatabaseColumnBuffer* columns = batch.m_columns.getData();
+		sl_uint32 iRow = 0;
+		while (iRow < nCapacity) {
+			if (!(moveNext())) {
+				break;
+			}
+			for (sl_uint32 iCol = 0; iCol < nColumns; iCol++) {
+				DatabaseColumnBuffer& column = columns[iCol];
+				sl_bool flagNull = isNull(iCol);
+				((sl_uint8*)(column.nullFlags.getData()))[iRow] = flagNull ? 1 : 0;
+				switch (column.type) {
+					case DatabaseColumnType::Int64:
+						((sl_int64*)(column.values.getData()))[iRow] = flagNull ? 0 : getInt64(iCol);
+						break;
+					case DatabaseColumnType::Double:
+						((double*)(column.values.getData()))[iRow] = flagNull ? 0 : getDouble(iCol);
+						break;
+					case DatabaseColumnType::Text:
+						if (!flagNull) {
+							const void* data;
+							sl_size size;
+							sl_bool flagSuccess;
+							if (getTextData(iCol, data, size)) {
+								flagSuccess = batch._appendText(column, data, size);
+							} else {
+								String s = getString(iCol);
+								flagSuccess = batch._appendText(column, s.getData(), s.getLength());
+							}
+							if (!flagSuccess) {
+								batch.m_nRows = iRow;
+								batch.m_flagError = sl_true;
+								return iRow;
+							}
+						}
+						((sl_size*)(column.values.getData()))[iRow + 1] = column.sizeText;
+						break;
+				}
+			}
+			iRow++;
+		}
+		batch.m_nRows = iRow;
+		return iRow;
+	}
+
+	sl_uint64 DatabaseCursor::forEachRow(const Function<sl_bool(DatabaseCursor*)>& onRow)
+	{
+		sl_uint64 n = 0;
+		while (moveNext()) {
+			n++;
+			if (!(onRow(this))) {
+				break;
+			}
+		}
+		return n;
+	}
+
 }
@@ -0,0 +1,285 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#include "slib/db/database_pool.h"
+
+#include "slib/core/thread.h"
+#include "slib/core/system.h"
+
+namespace slib
+{
+
+	DatabasePoolParam::DatabasePoolParam()
+	{
+		minConnectionsCount = 1;
+		maxConnectionsCount = 8;
+		acquireTimeout = 10000;
+		healthCheckInterval = 30000;
+		maxIdleTime = 600000;
+	}
+
+	DatabasePoolParam::DatabasePoolParam(const DatabasePoolParam& other) = default;
+
+	DatabasePoolParam::~DatabasePoolParam()
+	{
+	}
+
+	DatabasePoolParam& DatabasePoolParam::operator=(const DatabasePoolParam& other) = default;
+
+
+	SLIB_DEFINE_OBJECT(DatabasePool, Object)
+
+	DatabasePool::DatabasePool()
+	{
+		m_nConnections = 0;
+	}
+
+	DatabasePool::~DatabasePool()
+	{
+	}
+
+	Ref<DatabasePool> DatabasePool::create(const DatabasePoolParam& param)
+	{
+		if (param.onCreateConnection.isNull()) {
+			return sl_null;
+		}
+		Ref<Event> event = Event::create();
+		if (event.isNull()) {
+			return sl_null;
+		}
+		Ref<DatabasePool> ret = new DatabasePool;
+		if (ret.isNotNull()) {
+			ret->m_param = param;
+			if (ret->m_param.maxConnectionsCount < 1) {
+				ret->m_param.maxConnectionsCount = 1;
+			}
+			if (ret->m_param.minConnectionsCount > ret->m_param.maxConnectionsCount) {
+				ret->m_param.minConnectionsCount = ret->m_param.maxConnectionsCount;
+			}
+			ret->m_eventRelease = event;
+			sl_uint32 now = System::getTickCount();
+			for (sl_uint32 i = 0; i < ret->m_param.minConnectionsCount; i++) {
+				DatabasePoolItem item;
+				item.db = ret->_createConnection();
+				if (item.db.isNull()) {
+					return sl_null;
+				}
+				item.threadId = 0;
+				item.timeLastUsed = now;
+				ret->m_listIdle.add_NoLock(item);
+				ret->m_nConnections++;
+			}
+			return ret;
+		}
+		return sl_null;
+	}
+
+	Ref<Database> DatabasePool::acquire()
+	{
+		sl_uint64 threadId = Thread::getCurrentThreadUniqueId();
+		sl_int32 timeout = m_param.acquireTimeout;
+		sl_uint32 timeStart = System::getTickCount();
+		for (;;) {
+			ObjectLocker lock(this);
+			sl_size n = m_listIdle.getCount();
+			if (n) {
+				// the connection used by current thread, or else most recently used one
+				DatabasePoolItem* items = m_listIdle.getData();
+				sl_size index = n - 1;
+				for (sl_size i = n; i > 0; i--) {
+					if (items[i - 1].threadId == threadId) {
+						index = i - 1;
+						break;
+					}
+				}
+				DatabasePoolItem item;
+				m_listIdle.removeAt_NoLock(index, &item);
+				if (!(m_listAcquired.add_NoLock(item.db))) {
+					m_nConnections--;
+					return sl_null;
+				}
+				lock.unlock();
+				if (_checkConnection(item, System::getTickCount())) {
+					return item.db;
+				}
+				// broken connection is replaced by new one
+				discard(item.db.get());
+				continue;
+			}
+			if (m_nConnections < m_param.maxConnectionsCount) {
+				m_nConnections++;
+				lock.unlock();
+				Ref<Database> db = _createConnection();
+				lock.lock(this);
+				if (db.isNull() || !(m_listAcquired.add_NoLock(db))) {
+					m_nConnections--;
+					lock.unlock();
+					m_eventRelease->set();
+					return sl_null;
+				}
+				return db;
+			}
+			lock.unlock();
+			sl_int32 t = -1;
+			if (timeout >= 0) {
+				sl_uint32 elapsed = System::getTickCount() - timeStart;
+				if (elapsed >= (sl_uint32)timeout) {
+					return sl_null;
+				}
+				t = timeout - (sl_int32)elapsed;
+			}
+			m_eventRelease->wait(t);
+		}
+	}
+
+	void DatabasePool::release(Database* db)
+	{
+		if (!db) {
+			return;
+		}
+		sl_uint32 now = System::getTickCount();
+		DatabasePoolItem item;
+		item.db = db;
+		item.threadId = Thread::getCurrentThreadUniqueId();
+		item.timeLastUsed = now;
+		DatabasePoolItem itemExpired;
+		{
+			ObjectLocker lock(this);
+			sl_reg index = m_listAcquired.indexOf_NoLock(db);
+			if (index < 0) {
+				return;
+			}
+			m_listAcquired.removeAt_NoLock(index);
+			// least recently used connection is at front
+			if (m_nConnections > m_param.minConnectionsCount && m_listIdle.getCount() > 0) {
+				DatabasePoolItem* front = m_listIdle.getData();
+				if (now - front->timeLastUsed >= m_param.maxIdleTime) {
+					m_listIdle.removeAt_NoLock(0, &itemExpired);
+					m_nConnections--;
+				}
+			}
+			if (!(m_listIdle.add_NoLock(item))) {
+				m_nConnections--;
+			}
+		}
+		m_eventRelease->set();
+	}
+
+	void DatabasePool::discard(Database* db)
+	{
+		if (!db) {
+			return;
+		}
+		// the connection is closed out of the lock, when this reference is released at last
+		Ref<Database> dbDiscarded;
+		{
+			ObjectLocker lock(this);
+			sl_reg index = m_listAcquired.indexOf_NoLock(db);
+			if (index < 0) {
+				return;
+			}
+			m_listAcquired.removeAt_NoLock(index, &dbDiscarded);
+			m_nConnections--;
+		}
+		m_eventRelease->set();
+	}
+
+	sl_uint32 DatabasePool::getConnectionsCount()
+	{
+		return m_nConnections;
+	}
+
+	sl_uint32 DatabasePool::getIdleConnectionsCount()
+	{
+		return (sl_uint32)(m_listIdle.getCount());
+	}
+
+	const DatabasePoolParam& DatabasePool::getParam()
+	{
+		return m_param;
+	}
+
+	Ref<Database> DatabasePool::_createConnection()
+	{
+		return m_param.onCreateConnection();
+	}
+
+	sl_bool DatabasePool::_checkConnection(DatabasePoolItem& item, sl_uint32 now)
+	{
+		if (now - item.timeLastUsed >= m_param.healthCheckInterval) {
+			return item.db->ping();
+		}
+		return sl_true;
+	}
+
+
+	DatabasePoolConnection::DatabasePoolConnection(DatabasePool* pool)
+	{
+		if (pool) {
+			m_pool = pool;
+			m_db = pool->acquire();
+		}
+	}
+
+	DatabasePoolConnection::~DatabasePoolConnection()
+	{
+		release();
+	}
+
+	Database* DatabasePoolConnection::get() const
+	{
+		return m_db.get();
+	}
+
+	sl_bool DatabasePoolConnection::isNull() const
+	{
+		return m_db.isNull();
+	}
+
+	sl_bool DatabasePoolConnection::isNotNull() const
+	{
+		return m_db.isNotNull();
+	}
+
+	void DatabasePoolConnection::release()
+	{
+		if (m_db.isNotNull()) {
+			m_pool->release(m_db.get());
+			m_db.setNull();
+		}
+	}
+
+	void DatabasePoolConnection::discard()
+	{
+		if (m_db.isNotNull()) {
+			m_pool->discard(m_db.get());
+			m_db.setNull();
+		}
+	}
+
+	Database* DatabasePoolConnection::operator->() const
+	{
+		return m_db.get();
+	}
+
+}
@@ -122,6 +122,7 @@ namespace slib
 
 		~_priv_MySQL_Database()
 		{
+			clearStatementCache();
 			::mysql_close(m_mysql);
 		}
 
@@ -175,7 +176,12 @@ namespace slib
 		{
 			initThread();
 			ObjectLocker lock(this);
-			if (0 == ::mysql_ping(m_mysql)) {			
+			unsigned long idConnection = ::mysql_thread_id(m_mysql);
+			if (0 == ::mysql_ping(m_mysql)) {
+				if (idConnection != ::mysql_thread_id(m_mysql)) {
+					// reconnected: prepared statements are lost on the server
+					clearStatementCache();
+				}
 				return sl_true;
 			}
 			return sl_false;
@@ -301,6 +307,28 @@ namespace slib
 				return sl_null;
 			}
 
+			sl_bool isNull(sl_uint32 index) override
+			{
+				if (m_row) {
+					if (index < m_nColumnNames) {
+						return !(m_row[index]);
+					}
+				}
+				return sl_true;
+			}
+
+			sl_bool getTextData(sl_uint32 index, const void*& outData, sl_size& outSize) override
+			{
+				if (m_row) {
+					if (index < m_nColumnNames) {
+						outData = m_row[index];
+						outSize = (sl_size)(m_lengths[index]);
+						return sl_true;
+					}
+				}
+				return sl_false;
+			}
+
 			sl_bool moveNext() override
 			{
 				m_row = ::mysql_fetch_row(m_result);
@@ -862,6 +890,30 @@ namespace slib
 				return sl_null;
 			}
 
+			sl_bool isNull(sl_uint32 index) override
+			{
+				if (index < m_nColumnNames) {
+					return m_fds[index].isNull != 0;
+				}
+				return sl_true;
+			}
+
+			sl_bool getTextData(sl_uint32 index, const void*& outData, sl_size& outSize) override
+			{
+				if (index < m_nColumnNames) {
+					// truncated values are fetched by `getString()`
+					if (!(m_fds[index].isNull) && !(m_fds[index].isError)) {
+						enum_field_types type = m_bind[index].buffer_type;
+						if (type == MYSQL_TYPE_STRING || type == MYSQL_TYPE_BLOB) {
+							outData = m_fds[index].buf;
+							outSize = (sl_size)(m_fds[index].length);
+							return sl_true;
+						}
+					}
+				}
+				return sl_false;
+			}
+
 			sl_bool moveNext() override
 			{
 				int iRet = ::mysql_stmt_fetch(m_statement);
@@ -891,7 +943,15 @@ namespace slib
 
 			~_priv_DatabaseStatement()
 			{
-				close();
+				ObjectLocker lock(m_db.get());
+				if (m_statement) {
+					// pending result sets should be discarded before the statement is reused
+					::mysql_stmt_free_result(m_statement);
+					if (::mysql_stmt_reset(m_statement) || !(((_priv_MySQL_Database*)(m_db.get()))->_putCachedStatement(m_sql, m_statement))) {
+						::mysql_stmt_close(m_statement);
+					}
+					m_statement = sl_null;
+				}
 			}
 			
 			sl_bool isLoggingErrors()
@@ -905,6 +965,17 @@ namespace slib
 			sl_bool prepare()
 			{
 				ObjectLocker lock(m_db.get());
+				close();
+				MYSQL_STMT* statement = (MYSQL_STMT*)(((_priv_MySQL_Database*)(m_db.get()))->_takeCachedStatement(m_sql));
+				if (statement) {
+					m_statement = statement;
+					return sl_true;
+				}
+				return _prepare();
+			}
+
+			sl_bool _prepare()
+			{
 				close();
 				MYSQL_STMT* statement = ::mysql_stmt_init(m_mysql);
 				if (statement) {
@@ -1045,7 +1116,8 @@ namespace slib
 					} else {
 						int err = ::mysql_stmt_errno(m_statement);
 						if (err == CR_SERVER_LOST || err == CR_SERVER_GONE_ERROR) {
-							if (prepare()) {
+							((_priv_MySQL_Database*)(m_db.get()))->clearStatementCache();
+							if (_prepare()) {
 								if (_bind(params, nParams)) {
 									if (0 == ::mysql_stmt_execute(m_statement)) {
 										return sl_true;
@@ -1189,6 +1261,11 @@ namespace slib
 			return sl_null;
 		}
 
+		void _freeCachedStatement(void* handle) override
+		{
+			::mysql_stmt_close((MYSQL_STMT*)handle);
+		}
+
 		String getErrorMessage() override
 		{
 			String error = ::mysql_error(m_mysql);
@@ -25,12 +25,74 @@
 #include "slib/db/redis.h"
 
 #include "slib/core/log.h"
+#include "slib/core/scoped.h"
 
 #define TAG "Redis"
 
 namespace slib
 {	
 
+	RedisPipeline::RedisPipeline()
+	{
+	}
+	
+	RedisPipeline::~RedisPipeline()
+	{
+	}
+	
+	void RedisPipeline::appendBy(const Variant* args, sl_uint32 nArgs)
+	{
+		if (nArgs) {
+			m_commands.add_NoLock(VariantList(args, nArgs));
+		}
+	}
+	
+	void RedisPipeline::set(const String& key, const Variant& value)
+	{
+		append("SET", key, value);
+	}
+	
+	void RedisPipeline::get(const String& key)
+	{
+		append("GET", key);
+	}
+	
+	void RedisPipeline::del(const String& key)
+	{
+		append("DEL", key);
+	}
+	
+	void RedisPipeline::incr(const String& key)
+	{
+		append("INCR", key);
+	}
+	
+	void RedisPipeline::incrby(const String& key, sl_int64 n)
+	{
+		append("INCRBY", key, n);
+	}
+	
+	void RedisPipeline::expire(const String& key, sl_int64 seconds)
+	{
+		append("EXPIRE", key, seconds);
+	}
+	
+	sl_uint32 RedisPipeline::getCount() const
+	{
+		return (sl_uint32)(m_commands.getCount());
+	}
+	
+	const List<VariantList>& RedisPipeline::getCommands() const
+	{
+		return m_commands;
+	}
+	
+	void RedisPipeline::clear()
+	{
+		m_commands.setNull();
+	}
+	
+	
 	SLIB_DEFINE_OBJECT(RedisDatabase, Object)
 
 	RedisDatabase::RedisDatabase()
@@ -51,6 +113,15 @@ namespace slib
 		return sl_null;
 	}
 	
+	VariantList RedisDatabase::executePipeline(const RedisPipeline& pipeline)
+	{
+		VariantList val;
+		if (executePipeline(pipeline, &val)) {
+			return val;
+		}
+		return sl_null;
+	}
+	
 	String RedisDatabase::get(const String& key)
 	{
 		String val;
@@ -69,6 +140,15 @@ namespace slib
 		return def;
 	}
 
+	VariantList RedisDatabase::mget(const List<String>& keys)
+	{
+		VariantList val;
+		if (mget(keys, &val)) {
+			return val;
+		}
+		return sl_null;
+	}
+
 	sl_int64 RedisDatabase::incr(const String& key, sl_int64 def)
 	{
 		sl_int64 val;
@@ -187,6 +267,93 @@ namespace slib
 		m_flagLogErrors = flag;
 	}
 	
+	class _priv_RedisArguments
+	{
+	public:
+		sl_uint32 count;
+		const char** argv;
+		size_t* argvlen;
+		
+	public:
+		_priv_RedisArguments(const Variant* args, sl_uint32 nArgs)
+		{
+			count = 0;
+			argv = sl_null;
+			argvlen = sl_null;
+			m_data = Array<Memory>::create(nArgs);
+			m_argv = Array<const char*>::create(nArgs);
+			m_argvlen = Array<size_t>::create(nArgs);
+			if (m_data.isNull() || m_argv.isNull() || m_argvlen.isNull()) {
+				return;
+			}
+			argv = m_argv.getData();
+			argvlen = m_argvlen.getData();
+			Memory* data = m_data.getData();
+			for (sl_uint32 i = 0; i < nArgs; i++) {
+				const Variant& arg = args[i];
+				if (arg.isMemory()) {
+					data[i] = arg.getMemory();
+				} else {
+					String s = arg.getString();
+					data[i] = Memory::create(s.getData(), s.getLength());
+				}
+				argv[i] = (const char*)(data[i].getData());
+				if (!(argv[i])) {
+					argv[i] = "";
+				}
+				argvlen[i] = (size_t)(data[i].getSize());
+			}
+			count = nArgs;
+		}
+		
+	private:
+		Array<Memory> m_data;
+		Array<const char*> m_argv;
+		Array<size_t> m_argvlen;
+		
+	};
+	
+	static Variant _priv_Redis_parseReply(redisReply* reply)
+	{
+		if (reply) {
+			switch (reply->type) {
+				case REDIS_REPLY_INTEGER:
+					return reply->integer;
+				case REDIS_REPLY_STRING:
+				case REDIS_REPLY_STATUS:
+					return String(reply->str, reply->len);
+				case REDIS_REPLY_ARRAY:
+				{
+					VariantList list;
+					for (size_t i = 0; i < reply->elements; i++) {
+						list.add_NoLock(_priv_Redis_parseReply(reply->element[i]));
+					}
+					return list;
+				}
+				case REDIS_REPLY_ERROR:
+				case REDIS_REPLY_NIL:
+					break;
+			}
+		}
+		return sl_null;
+	}
+	
+	static Memory _priv_Redis_formatCommand(const Variant* args, sl_uint32 nArgs)
+	{
+		_priv_RedisArguments arguments(args, nArgs);
+		if (!(arguments.count)) {
+			return sl_null;
+		}
+		char* cmd = sl_null;
+		int len = redisFormatCommandArgv(&cmd, (int)(arguments.count), arguments.argv, arguments.argvlen);
+		if (len < 0 || !cmd) {
+			return sl_null;
+		}
+		Memory ret = Memory::create(cmd, len);
+		redisFreeCommand(cmd);
+		return ret;
+	}
+	
 	class _priv_RedisDatabase : public RedisDatabase
 	{
 	public:
@@ -223,42 +390,20 @@ namespace slib
 			}
 		}
 		
-		Variant _parseReply(redisReply* reply)
-		{
-			if (reply) {
-				switch (reply->type) {
-					case REDIS_REPLY_INTEGER:
-						return reply->integer;
-					case REDIS_REPLY_STRING:
-					case REDIS_REPLY_STATUS:
-						return String(reply->str);
-					case REDIS_REPLY_ARRAY:
-					{
-						VariantList list;
-						for (size_t i = 0; i < reply->elements; i++) {
-							list.add(_parseReply(reply->element[i]));
-						}
-						return list;
-					}
-					case REDIS_REPLY_ERROR:
-						break;
-				}
-			}
-			return sl_null;
-		}
-		
 		sl_bool _processReply(redisReply* reply, Variant* pValue)
 		{
 			if (reply) {
 				if (reply->type == REDIS_REPLY_ERROR) {
-					_logError(reply->str);
+					String error(reply->str, reply->len);
+					_logError(error);
 					if (pValue) {
-						*pValue = String(reply->str);
+						*pValue = error;
 					}
+					freeReplyObject(reply);
 					return sl_false;
 				}
 				if (pValue) {
-					*pValue = _parseReply(reply);
+					*pValue = _priv_Redis_parseReply(reply);
 				}
 				freeReplyObject(reply);
 				return sl_true;
@@ -323,6 +468,23 @@ namespace slib
 			}
 		}
 		
+		redisReply* _commandBy(const Variant* args, sl_uint32 nArgs)
+		{
+			_priv_RedisArguments arguments(args, nArgs);
+			if (!(arguments.count)) {
+				return sl_null;
+			}
+			ObjectLocker lock(this);
+			return (redisReply*)(redisCommandArgv(m_context, (int)(arguments.count), arguments.argv, arguments.argvlen));
+		}
+		
+		template <class... ARGS>
+		redisReply* _command(ARGS&&... args)
+		{
+			Variant params[] = {Forward<ARGS>(args)...};
+			return _commandBy(params, sizeof...(args));
+		}
+		
 		sl_bool execute(const String& command, Variant* pValue) override
 		{
 			ObjectLocker lock(this);
@@ -331,124 +493,174 @@ namespace slib
 			return _processReply(reply, pValue);
 		}
 		
-		sl_bool set(const String& key, const Variant& value) override
+		sl_bool executeBy(const Variant* args, sl_uint32 nArgs, Variant* pValue) override
+		{
+			return _processReply(_commandBy(args, nArgs), pValue);
+		}
+		
+		sl_bool executePipeline(const RedisPipeline& pipeline, VariantList* pReplies) override
 		{
+			ListElements<VariantList> commands(pipeline.getCommands());
 			ObjectLocker lock(this);
-			String str = value.getString();
-			redisReply* reply = (redisReply*)(redisCommand(m_context, "SET %s %s", key.getData(), str.getData()));
-			return _processCheckReply(reply, "OK");
+			// commands are written to the output buffer of the context, and flushed by the first `redisGetReply`
+			sl_size nAppended = 0;
+			for (sl_size i = 0; i < commands.count; i++) {
+				ListElements<Variant> args(commands[i]);
+				_priv_RedisArguments arguments(args.data, (sl_uint32)(args.count));
+				if (!(arguments.count)) {
+					break;
+				}
+				if (REDIS_OK != redisAppendCommandArgv(m_context, (int)(arguments.count), arguments.argv, arguments.argvlen)) {
+					break;
+				}
+				nAppended++;
+			}
+			VariantList replies;
+			for (sl_size i = 0; i < nAppended; i++) {
+				void* _reply = sl_null;
+				if (REDIS_OK != redisGetReply(m_context, &_reply)) {
+					_logError("Cannot connect to the server");
+					return sl_false;
+				}
+				redisReply* reply = (redisReply*)_reply;
+				if (reply->type == REDIS_REPLY_ERROR) {
+					_logError(String(reply->str, reply->len));
+					replies.add_NoLock(Variant());
+				} else {
+					replies.add_NoLock(_priv_Redis_parseReply(reply));
+				}
+				freeReplyObject(reply);
+			}
+			if (nAppended < commands.count) {
+				return sl_false;
+			}
+			if (pReplies) {
+				*pReplies = replies;
+			}
+			return sl_true;
+		}
+		
+		sl_bool set(const String& key, const Variant& value) override
+		{
+			return _processCheckReply(_command("SET", key, value), "OK");
 		}
 		
 		sl_bool get(const String& key, String* pValue) override
 		{
-			ObjectLocker lock(this);
-			redisReply* reply = (redisReply*)(redisCommand(m_context, "GET %s", key.getData()));
-			return _processStringReply(reply, pValue);
+			return _processStringReply(_command("GET", key), pValue);
 		}
 		
 		sl_bool del(const String& key) override
 		{
-			ObjectLocker lock(this);
-			redisReply* reply = (redisReply*)(redisCommand(m_context, "DEL %s", key.getData()));
-			return _processCheckReply(reply, 1);
+			return _processCheckReply(_command("DEL", key), 1);
+		}
+		
+		sl_bool mget(const List<String>& _keys, VariantList* pValues) override
+		{
+			ListElements<String> keys(_keys);
+			if (!(keys.count)) {
+				return sl_false;
+			}
+			SLIB_SCOPED_BUFFER(Variant, 64, args, keys.count + 1)
+			if (!args) {
+				return sl_false;
+			}
+			args[0] = "MGET";
+			for (sl_size i = 0; i < keys.count; i++) {
+				args[i + 1] = keys[i];
+			}
+			return _processListReply(_commandBy(args, (sl_uint32)(keys.count + 1)), pValues);
+		}
+		
+		sl_bool mset(const HashMap<String, Variant>& values) override
+		{
+			sl_size n = values.getCount();
+			if (!n) {
+				return sl_false;
+			}
+			SLIB_SCOPED_BUFFER(Variant, 64, args, n * 2 + 1)
+			if (!args) {
+				return sl_false;
+			}
+			args[0] = "MSET";
+			sl_uint32 nArgs = 1;
+			for (auto& item : values) {
+				if (nArgs >= n * 2 + 1) {
+					break;
+				}
+				args[nArgs++] = item.key;
+				args[nArgs++] = item.value;
+			}
+			return _processCheckReply(_commandBy(args, nArgs), "OK");
 		}
 		
 		sl_bool incr(const String& key, sl_int64* pValue) override
 		{
-			ObjectLocker lock(this);
-			redisReply* reply = (redisReply*)(redisCommand(m_context, "INCR %s", key.getData()));
-			return _processIntReply(reply, pValue);
+			return _processIntReply(_command("INCR", key), pValue);
 		}
 		
 		sl_bool decr(const String& key, sl_int64* pValue) override
 		{
-			ObjectLocker lock(this);
-			redisReply* reply = (redisReply*)(redisCommand(m_context, "DECR %s", key.getData()));
-			return _processIntReply(reply, pValue);
+			return _processIntReply(_command("DECR", key), pValue);
 		}
 		
 		sl_bool incrby(const String& key, sl_int64 n, sl_int64* pValue) override
 		{
-			ObjectLocker lock(this);
-			redisReply* reply = (redisReply*)(redisCommand(m_context, "INCRBY %s %lld", key.getData(), n));
-			return _processIntReply(reply, pValue);
+			return _processIntReply(_command("INCRBY", key, n), pValue);
 		}
 		
 		sl_bool decrby(const String& key, sl_int64 n, sl_int64* pValue) override
 		{
-			ObjectLocker lock(this);
-			redisReply* reply = (redisReply*)(redisCommand(m_context, "DECRBY %s %lld", key.getData(), n));
-			return _processIntReply(reply, pValue);
+			return _processIntReply(_command("DECRBY", key, n), pValue);
 		}
 		
 		sl_bool llen(const String& key, sl_int64* pValue) override
 		{
-			ObjectLocker lock(this);
-			redisReply* reply = (redisReply*)(redisCommand(m_context, "LLEN %s", key.getData()));
-			return _processIntReply(reply, pValue);
+			return _processIntReply(_command("LLEN", key), pValue);
 		}
 		
 		sl_int64 lpush(const String& key, const Variant& value) override
 		{
-			ObjectLocker lock(this);
-			String str = value.getString();
-			redisReply* reply = (redisReply*)(redisCommand(m_context, "LPUSH %s %s", key.getData(), str.getData()));
 			sl_int64 count = 0;
-			_processIntReply(reply, &count);
+			_processIntReply(_command("LPUSH", key, value), &count);
 			return count;
 		}
 
 		sl_int64 rpush(const String& key, const Variant& value) override
 		{
-			ObjectLocker lock(this);
-			String str = value.getString();
-			redisReply* reply = (redisReply*)(redisCommand(m_context, "RPUSH %s %s", key.getData(), str.getData()));
 			sl_int64 count = 0;
-			_processIntReply(reply, &count);
+			_processIntReply(_command("RPUSH", key, value), &count);
 			return count;
 		}
 
 		sl_bool lindex(const String& key, sl_int64 index, String* pValue) override
 		{
-			ObjectLocker lock(this);
-			redisReply* reply = (redisReply*)(redisCommand(m_context, "LINDEX %s %lld", key.getData(), index));
-			return _processStringReply(reply, pValue);
+			return _processStringReply(_command("LINDEX", key, index), pValue);
 		}
 		
 		sl_bool lset(const String& key, sl_int64 index, const Variant& value) override
 		{
-			ObjectLocker lock(this);
-			String str = value.getString();
-			redisReply* reply = (redisReply*)(redisCommand(m_context, "LSET %s %lld %s", key.getData(), index, str.getData()));
-			return _processCheckReply(reply, "OK");
+			return _processCheckReply(_command("LSET", key, index, value), "OK");
 		}
 		
 		sl_bool ltrm(const String& key, sl_int64 start, sl_int64 stop) override
 		{
-			ObjectLocker lock(this);
-			redisReply* reply = (redisReply*)(redisCommand(m_context, "LSET %s %lld %lld", key.getData(), start, stop));
-			return _processCheckReply(reply, "OK");
+			return _processCheckReply(_command("LTRIM", key, start, stop), "OK");
 		}
 		
 		sl_bool lpop(const String& key, String* pValue) override
 		{
-			ObjectLocker lock(this);
-			redisReply* reply = (redisReply*)(redisCommand(m_context, "LPOP %s", key.getData()));
-			return _processStringReply(reply, pValue);
+			return _processStringReply(_command("LPOP", key), pValue);
 		}
 		
 		sl_bool rpop(const String& key, String* pValue) override
 		{
-			ObjectLocker lock(this);
-			redisReply* reply = (redisReply*)(redisCommand(m_context, "RPOP %s", key.getData()));
-			return _processStringReply(reply, pValue);
+			return _processStringReply(_command("RPOP", key), pValue);
 		}
 		
 		sl_bool lrange(const String& key, sl_int64 start, sl_int64 stop, VariantList* pValue) override
 		{
-			ObjectLocker lock(this);
-			redisReply* reply = (redisReply*)(redisCommand(m_context, "LRANGE %s %lld %lld", key.getData(), start, stop));
-			return _processListReply(reply, pValue);
+			return _processListReply(_command("LRANGE", key, start, stop), pValue);
 		}
 		
 	};
@@ -457,5 +669,278 @@ namespace slib
 	{
 		return _priv_RedisDatabase::connect(ip, port);
 	}
+	
+	
+	AsyncRedisClientParam::AsyncRedisClientParam()
+	{
+	}
+	
+	AsyncRedisClientParam::AsyncRedisClientParam(const AsyncRedisClientParam& other) = default;
+	
+	AsyncRedisClientParam::~AsyncRedisClientParam()
+	{
+	}
+	
+	
+	SLIB_DEFINE_OBJECT(AsyncRedisClient, Object)
+	
+	AsyncRedisClient::AsyncRedisClient()
+	{
+		m_reader = sl_null;
+		m_flagConnected = sl_false;
+		m_flagClosed = sl_false;
+	}
+	
+	AsyncRedisClient::~AsyncRedisClient()
+	{
+		close();
+		if (m_reader) {
+			redisReaderFree((redisReader*)m_reader);
+		}
+	}
+	
+	Ref<AsyncRedisClient> AsyncRedisClient::create(const AsyncRedisClientParam& param)
+	{
+		if (param.address.isInvalid()) {
+			return sl_null;
+		}
+		Memory bufReceive = Memory::create(0x10000);
+		if (bufReceive.isNull()) {
+			return sl_null;
+		}
+		redisReader* reader = redisReaderCreate();
+		if (!reader) {
+			return sl_null;
+		}
+		Ref<AsyncRedisClient> ret = new AsyncRedisClient;
+		if (ret.isNotNull()) {
+			ret->m_reader = reader;
+			ret->m_bufReceive = bufReceive;
+			ret->m_onConnect = param.onConnect;
+			ret->m_onError = param.onError;
+			AsyncTcpSocketParam tp;
+			tp.ioLoop = param.ioLoop;
+			tp.flagIPv6 = param.address.ip.isIPv6();
+			tp.onConnect = SLIB_FUNCTION_WEAKREF(AsyncRedisClient, _onConnect, ret);
+			WeakRef<AsyncRedisClient> weak = ret;
+			tp.onError = [weak](AsyncTcpSocket*) {
+				Ref<AsyncRedisClient> client = weak;
+				if (client.isNotNull()) {
+					client->_onError();
+				}
+			};
+			Ref<AsyncTcpSocket> socket = AsyncTcpSocket::create(tp);
+			if (socket.isNotNull()) {
+				// the socket should be set before connecting, because `_onConnect` can be called on the I/O thread at once
+				ret->m_socket = socket;
+				if (socket->connect(param.address)) {
+					return ret;
+				}
+				ret->m_socket.setNull();
+			}
+			return sl_null;
+		}
+		redisReaderFree(reader);
+		return sl_null;
+	}
+	
+	void AsyncRedisClient::close()
+	{
+		ObjectLocker lock(this);
+		if (m_flagClosed) {
+			return;
+		}
+		m_flagClosed = sl_true;
+		m_flagConnected = sl_false;
+		Ref<AsyncTcpSocket> socket = m_socket;
+		m_socket.setNull();
+		m_queuePendingCommands.clear();
+		LinkedQueue< Function<void(AsyncRedisClient*, sl_bool, Variant&)> > callbacks;
+		callbacks.merge(&m_queueCallbacks);
+		lock.unlock();
+		if (socket.isNotNull()) {
+			socket->close();
+		}
+		Function<void(AsyncRedisClient*, sl_bool, Variant&)> callback;
+		while (callbacks.pop(&callback)) {
+			Variant reply;
+			callback(this, sl_true, reply);
+		}
+	}
+	
+	sl_bool AsyncRedisClient::isConnected()
+	{
+		return m_flagConnected;
+	}
+	
+	sl_bool AsyncRedisClient::executeBy(const Variant* args, sl_uint32 nArgs, const Function<void(AsyncRedisClient*, sl_bool flagError, Variant& reply)>& callback)
+	{
+		Memory cmd = _priv_Redis_formatCommand(args, nArgs);
+		if (cmd.isNull()) {
+			return sl_false;
+		}
+		ObjectLocker lock(this);
+		if (m_flagClosed) {
+			return sl_false;
+		}
+		// the order of callbacks should match the order of commands on the wire
+		if (!(m_queueCallbacks.push(callback))) {
+			return sl_false;
+		}
+		if (m_flagConnected) {
+			if (m_socket->send(cmd, SLIB_FUNCTION_WEAKREF(AsyncRedisClient, _onSend, this))) {
+				return sl_true;
+			}
+		} else {
+			if (m_queuePendingCommands.add(cmd)) {
+				return sl_true;
+			}
+		}
+		m_queueCallbacks.popBack();
+		return sl_false;
+	}
+	
+	sl_bool AsyncRedisClient::get(const String& key, const Function<void(AsyncRedisClient*, sl_bool flagError, Variant& reply)>& callback)
+	{
+		return execute(callback, "GET", key);
+	}
+	
+	sl_bool AsyncRedisClient::set(const String& key, const Variant& value, const Function<void(AsyncRedisClient*, sl_bool flagError, Variant& reply)>& callback)
+	{
+		return execute(callback, "SET", key, value);
+	}
+	
+	sl_bool AsyncRedisClient::del(const String& key, const Function<void(AsyncRedisClient*, sl_bool flagError, Variant& reply)>& callback)
+	{
+		return execute(callback, "DEL", key);
+	}
+	
+	sl_bool AsyncRedisClient::mget(const List<String>& _keys, const Function<void(AsyncRedisClient*, sl_bool flagError, Variant& reply)>& callback)
+	{
+		ListElements<String> keys(_keys);
+		if (!(keys.count)) {
+			return sl_false;
+		}
+		SLIB_SCOPED_BUFFER(Variant, 64, args, keys.count + 1)
+		if (!args) {
+			return sl_false;
+		}
+		args[0] = "MGET";
+		for (sl_size i = 0; i < keys.count; i++) {
+			args[i + 1] = keys[i];
+		}
+		return executeBy(args, (sl_uint32)(keys.count + 1), callback);
+	}
+	
+	sl_bool AsyncRedisClient::mset(const HashMap<String, Variant>& values, const Function<void(AsyncRedisClient*, sl_bool flagError, Variant& reply)>& callback)
+	{
+		sl_size n = values.getCount();
+		if (!n) {
+			return sl_false;
+		}
+		SLIB_SCOPED_BUFFER(Variant, 64, args, n * 2 + 1)
+		if (!args) {
+			return sl_false;
+		}
+		args[0] = "MSET";
+		sl_uint32 nArgs = 1;
+		for (auto& item : values) {
+			if (nArgs >= n * 2 + 1) {
+				break;
+			}
+			args[nArgs++] = item.key;
+			args[nArgs++] = item.value;
+		}
+		return executeBy(args, nArgs, callback);
+	}
+	
+	void AsyncRedisClient::_receive(AsyncTcpSocket* socket)
+	{
+		if (!(socket->receive(m_bufReceive, SLIB_FUNCTION_WEAKREF(AsyncRedisClient, _onReceive, this)))) {
+			_onError();
+		}
+	}
+	
+	void AsyncRedisClient::_onConnect(AsyncTcpSocket* socket, const SocketAddress& address, sl_bool flagError)
+	{
+		if (flagError) {
+			m_onConnect(this, sl_true);
+			_onError();
+			return;
+		}
+		ObjectLocker lock(this);
+		if (m_flagClosed) {
+			return;
+		}
+		m_flagConnected = sl_true;
+		if (m_queuePendingCommands.getSize() > 0) {
+			Memory cmds = m_queuePendingCommands.merge();
+			m_queuePendingCommands.clear();
+			if (cmds.isNull() || !(socket->send(cmds, SLIB_FUNCTION_WEAKREF(AsyncRedisClient, _onSend, this)))) {
+				lock.unlock();
+				_onError();
+				return;
+			}
+		}
+		lock.unlock();
+		m_onConnect(this, sl_false);
+		_receive(socket);
+	}
+	
+	void AsyncRedisClient::_onReceive(AsyncStreamResult* result)
+	{
+		if (result->flagError) {
+			_onError();
+			return;
+		}
+		redisReader* reader = (redisReader*)m_reader;
+		if (REDIS_OK != redisReaderFeed(reader, (const char*)(result->data), result->size)) {
+			_onError();
+			return;
+		}
+		for (;;) {
+			void* _reply = sl_null;
+			if (REDIS_OK != redisReaderGetReply(reader, &_reply)) {
+				_onError();
+				return;
+			}
+			if (!_reply) {
+				break;
+			}
+			redisReply* reply = (redisReply*)_reply;
+			sl_bool flagError = reply->type == REDIS_REPLY_ERROR;
+			Variant value;
+			if (flagError) {
+				value = String(reply->str, reply->len);
+			} else {
+				value = _priv_Redis_parseReply(reply);
+			}
+			freeReplyObject(reply);
+			Function<void(AsyncRedisClient*, sl_bool, Variant&)> callback;
+			if (m_queueCallbacks.pop(&callback)) {
+				callback(this, flagError, value);
+			}
+		}
+		Ref<AsyncTcpSocket> socket = m_socket;
+		if (socket.isNotNull()) {
+			_receive(socket.get());
+		}
+	}
+	
+	void AsyncRedisClient::_onSend(AsyncStreamResult* result)
+	{
+		if (result->flagError) {
+			_onError();
+		}
+	}
+	
+	void AsyncRedisClient::_onError()
+	{
+		if (m_flagClosed) {
+			return;
+		}
+		close();
+		m_onError(this);
+	}
 
 }
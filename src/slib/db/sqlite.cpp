@@ -54,6 +54,7 @@ namespace slib
 
 		~_priv_Sqlite3Database()
 		{
+			clearStatementCache();
 			::sqlite3_close(m_db);
 		}
 
@@ -88,16 +89,6 @@ namespace slib
 			return -1;
 		}
 
-		static HashMap<String, Variant> _getRow(sqlite3_stmt* stmt, String* columns, sl_uint32 nColumns)
-		{
-			HashMap<String, Variant> row;
-			for (sl_uint32 cIndex = 0; cIndex < nColumns; cIndex++) {
-				String cValue = String::fromUtf8(::sqlite3_column_text(stmt, (int)cIndex));
-				row.put_NoLock(columns[cIndex], cValue);
-			}
-			return row;
-		}
-
 		class _priv_DatabaseCursor : public DatabaseCursor
 		{
 		public:
@@ -108,12 +99,15 @@ namespace slib
 			sl_uint32 m_nColumnNames;
 			String* m_columnNames;
 			CHashMap<String, sl_int32> m_mapColumnIndexes;
+			
+			sl_bool m_flagEnd;
 
 			_priv_DatabaseCursor(Database* db, DatabaseStatement* statementObj, sqlite3_stmt* statement)
 			{
 				m_db = db;
 				m_statementObj = statementObj;
 				m_statement = statement;
+				m_flagEnd = sl_false;
 
 				sl_int32 cols = ::sqlite3_column_count(statement);
 				for (sl_int32 i = 0; i < cols; i++) {
@@ -342,12 +336,39 @@ namespace slib
 				return sl_null;
 			}
 
+			sl_bool isNull(sl_uint32 index) override
+			{
+				if (index < m_nColumnNames) {
+					return ::sqlite3_column_type(m_statement, index) == SQLITE_NULL;
+				}
+				return sl_true;
+			}
+
+			sl_bool getTextData(sl_uint32 index, const void*& outData, sl_size& outSize) override
+			{
+				if (index < m_nColumnNames) {
+					int type = ::sqlite3_column_type(m_statement, index);
+					if (type == SQLITE_TEXT || type == SQLITE_BLOB) {
+						// `sqlite3_column_text` should be called before `sqlite3_column_bytes`
+						outData = ::sqlite3_column_text(m_statement, index);
+						outSize = (sl_size)(::sqlite3_column_bytes(m_statement, index));
+						return sl_true;
+					}
+				}
+				return sl_false;
+			}
+
 			sl_bool moveNext() override
 			{
+				if (m_flagEnd) {
+					// stepping again after SQLITE_DONE restarts the statement
+					return sl_false;
+				}
 				sl_int32 nRet = ::sqlite3_step(m_statement);
 				if (nRet == SQLITE_ROW) {
 					return sl_true;
 				}
+				m_flagEnd = sl_true;
 				return sl_false;
 			}
 
@@ -358,18 +379,25 @@ namespace slib
 		public:
 			sqlite3* m_sqlite;
 			sqlite3_stmt* m_statement;
+			String m_sql;
 			Array<Variant> m_boundParams;
 
-			_priv_DatabaseStatement(_priv_Sqlite3Database* db, sqlite3_stmt* statement)
+			_priv_DatabaseStatement(_priv_Sqlite3Database* db, const String& sql, sqlite3_stmt* statement)
 			{
 				m_db = db;
 				m_sqlite = db->m_db;
+				m_sql = sql;
 				m_statement = statement;
 			}
 
 			~_priv_DatabaseStatement()
 			{
-				::sqlite3_finalize(m_statement);
+				ObjectLocker lock(m_db.get());
+				::sqlite3_reset(m_statement);
+				::sqlite3_clear_bindings(m_statement);
+				if (!(((_priv_Sqlite3Database*)(m_db.get()))->_putCachedStatement(m_sql, m_statement))) {
+					::sqlite3_finalize(m_statement);
+				}
 			}
 			
 			sl_bool isLoggingErrors()
@@ -480,9 +508,9 @@ namespace slib
 		{
 			ObjectLocker lock(this);
 			Ref<DatabaseStatement> ret;
-			sqlite3_stmt* statement = sl_null;
-			if (SQLITE_OK == ::sqlite3_prepare_v2(m_db, sql.getData(), -1, &statement, sl_null)) {
-				ret = new _priv_DatabaseStatement(this, statement);
+			sqlite3_stmt* statement = (sqlite3_stmt*)(_takeCachedStatement(sql));
+			if (statement || SQLITE_OK == ::sqlite3_prepare_v2(m_db, sql.getData(), -1, &statement, sl_null)) {
+				ret = new _priv_DatabaseStatement(this, sql, statement);
 				if (ret.isNotNull()) {
 					return ret;
 				}
@@ -490,6 +518,11 @@ namespace slib
 			}
 			return ret;
 		}
+		
+		void _freeCachedStatement(void* handle) override
+		{
+			::sqlite3_finalize((sqlite3_stmt*)handle);
+		}
 
 		String getErrorMessage() override
 		{
@@ -24,6 +24,8 @@
 
 #include "slib/graphics/yuv.h"
 
+#include "bitmap_data_simd.h"
+
 namespace slib
 {
 
@@ -1274,6 +1276,17 @@ namespace slib
 
 	void _priv_BitmapData_copyPixels_Normal(sl_uint32 width, sl_uint32 height, BitmapFormat src_format, sl_uint8** src_planes, sl_int32* src_pitches, BitmapFormat dst_format, sl_uint8** dst_planes, sl_int32* dst_pitches)
 	{
+		_priv_BitmapData_SwizzleRowProc proc = _priv_BitmapData_RowKernels::getSwizzle(src_format, dst_format);
+		if (proc) {
+			sl_uint8* sr = src_planes[0];
+			sl_uint8* dr = dst_planes[0];
+			for (sl_uint32 i = 0; i < height; i++) {
+				proc(sr, dr, width);
+				sr += src_pitches[0];
+				dr += dst_pitches[0];
+			}
+			return;
+		}
 		switch (src_format) {
 			case BitmapFormat::RGBA:
 				_priv_BitmapData_copyPixels_Normal_Step1<RGBA_PROC>(width, height, src_planes, src_pitches, dst_format, dst_planes, dst_pitches);
@@ -1489,6 +1502,28 @@ namespace slib
 
 	void _priv_BitmapData_copyPixels_YUV420ToOther(sl_uint32 width, sl_uint32 height, BitmapData& src, BitmapFormat dst_format, sl_uint8** dst_planes, sl_int32* dst_pitches)
 	{
+		_priv_BitmapData_YUV420RowProc proc = _priv_BitmapData_RowKernels::getYUV420ToRGB(dst_format);
+		if (proc) {
+			ColorComponentBuffer src_cb[3];
+			if (src.getColorComponentBuffers(src_cb) != 3) {
+				return;
+			}
+			sl_uint8* sry = (sl_uint8*)(src_cb[0].data);
+			sl_uint8* sru = (sl_uint8*)(src_cb[1].data);
+			sl_uint8* srv = (sl_uint8*)(src_cb[2].data);
+			sl_uint8* dr = dst_planes[0];
+			sl_uint32 strideUV = (sl_uint32)(src_cb[1].sample_stride);
+			for (sl_uint32 i = 0; i < height; i++) {
+				proc(sry, sru, srv, strideUV, dr, width);
+				sry += src_cb[0].pitch;
+				if (i & 1) {
+					sru += src_cb[1].pitch;
+					srv += src_cb[2].pitch;
+				}
+				dr += dst_pitches[0];
+			}
+			return;
+		}
 		switch (dst_format) {
 			case BitmapFormat::RGBA:
 				_priv_BitmapData_copyPixels_YUV420ToOther_Step1<RGBA_PROC>(width, height, src, dst_planes, dst_pitches);
@@ -1902,13 +1937,7 @@ namespace slib
 						sl_uint8* sr = (sl_uint8*)(src_planes[iPlane]);
 						sl_uint8* dr = (sl_uint8*)(dst_planes[iPlane]);
 						for (sl_uint32 i = 0; i < height; i++) {
-							sl_uint8* ss = sr;
-							sl_uint8* ds = dr;
-							for (sl_uint32 j = 0; j < row_size; j++) {
-								*ds = *ss;
-								ss++;
-								ds++;
-							}
+							Base::moveMemory(dr, sr, row_size);
 							sr += src_pitches[iPlane];
 							dr += dst_pitches[iPlane];
 						}
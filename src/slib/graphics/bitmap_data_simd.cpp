@@ -0,0 +1,439 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#include "bitmap_data_simd.h"
+
+#include "slib/graphics/yuv.h"
+#include "slib/core/system.h"
+
+#if defined(SLIB_ARCH_IS_X64) || (defined(SLIB_ARCH_IS_X86) && (defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+#	define BITMAP_SIMD_USE_SSE2
+#	include <emmintrin.h>
+#	if defined(SLIB_COMPILER_IS_VC) || defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+#		define BITMAP_SIMD_USE_AVX2
+#		include <immintrin.h>
+#		if defined(SLIB_COMPILER_IS_VC)
+#			define BITMAP_SIMD_AVX2_FUNC
+#		else
+#			define BITMAP_SIMD_AVX2_FUNC __attribute__((target("avx2")))
+#		endif
+#	endif
+#elif defined(SLIB_ARCH_IS_ARM64) || defined(__ARM_NEON)
+#	define BITMAP_SIMD_USE_NEON
+#	include <arm_neon.h>
+#endif
+
+// same fixed-point coefficients as YUV::convertYUVToRGB, so that the kernels produce the identical output
+#define YUV_YG 18997
+#define YUV_BB (-17544) /* UB * 128 - YGB */
+#define YUV_BG 8696 /* UG * 128 + VG * 128 - YGB */
+#define YUV_BR (-14216) /* VR * 128 - YGB */
+#define YUV_UG 25
+#define YUV_VG 52
+#define YUV_VR_NEG 102
+#define YUV_UB_NEG_SHIFT 7 /* -UB = 128 */
+
+namespace slib
+{
+
+	// byte position of R, G, B, A
+	static constexpr sl_uint32 _priv_BitmapData_pixelPositions[4][4] = {
+		{0, 1, 2, 3}, // RGBA
+		{2, 1, 0, 3}, // BGRA
+		{1, 2, 3, 0}, // ARGB
+		{3, 2, 1, 0} // ABGR
+	};
+
+	// channel (R, G, B, A) at each byte position
+	static constexpr sl_uint32 _priv_BitmapData_pixelChannels[4][4] = {
+		{0, 1, 2, 3}, // RGBA
+		{2, 1, 0, 3}, // BGRA
+		{3, 0, 1, 2}, // ARGB
+		{3, 2, 1, 0} // ABGR
+	};
+
+	static sl_int32 _priv_BitmapData_getPixelOrder(BitmapFormat format)
+	{
+		switch (format) {
+			case BitmapFormat::RGBA:
+			case BitmapFormat::RGBA_PA:
+				return 0;
+			case BitmapFormat::BGRA:
+			case BitmapFormat::BGRA_PA:
+				return 1;
+			case BitmapFormat::ARGB:
+			case BitmapFormat::ARGB_PA:
+				return 2;
+			case BitmapFormat::ABGR:
+			case BitmapFormat::ABGR_PA:
+				return 3;
+			default:
+				return -1;
+		}
+	}
+
+	template <sl_uint32 ORDER>
+	SLIB_INLINE static void _priv_BitmapData_YUV420ToRGB_Tail(const sl_uint8* y, const sl_uint8* u, const sl_uint8* v, sl_uint32 strideUV, sl_uint8* dst, sl_uint32 x, sl_uint32 width)
+	{
+		sl_uint8 c[4];
+		c[3] = 255;
+		for (; x < width; x++) {
+			sl_uint32 k = (x >> 1) * strideUV;
+			YUV::convertYUVToRGB(y[x], u[k], v[k], c[0], c[1], c[2]);
+			sl_uint8* d = dst + (x << 2);
+			d[_priv_BitmapData_pixelPositions[ORDER][0]] = c[0];
+			d[_priv_BitmapData_pixelPositions[ORDER][1]] = c[1];
+			d[_priv_BitmapData_pixelPositions[ORDER][2]] = c[2];
+			d[_priv_BitmapData_pixelPositions[ORDER][3]] = c[3];
+		}
+	}
+
+	template <sl_uint32 SRC, sl_uint32 DST>
+	SLIB_INLINE static void _priv_BitmapData_Swizzle_Tail(const sl_uint8* src, sl_uint8* dst, sl_uint32 x, sl_uint32 width)
+	{
+		for (; x < width; x++) {
+			const sl_uint8* s = src + (x << 2);
+			sl_uint8* d = dst + (x << 2);
+			d[0] = s[_priv_BitmapData_pixelPositions[SRC][_priv_BitmapData_pixelChannels[DST][0]]];
+			d[1] = s[_priv_BitmapData_pixelPositions[SRC][_priv_BitmapData_pixelChannels[DST][1]]];
+			d[2] = s[_priv_BitmapData_pixelPositions[SRC][_priv_BitmapData_pixelChannels[DST][2]]];
+			d[3] = s[_priv_BitmapData_pixelPositions[SRC][_priv_BitmapData_pixelChannels[DST][3]]];
+		}
+	}
+
+#if defined(BITMAP_SIMD_USE_SSE2)
+	// `y` holds Y * 257 in 16 bits, the intermediate values fit in 16 bits except the saturated ones which are clamped anyway
+	SLIB_INLINE static void _priv_BitmapData_YUVToRGB_SSE2(__m128i y, __m128i u, __m128i v, __m128i* rgba)
+	{
+		__m128i y1 = _mm_mulhi_epu16(y, _mm_set1_epi16(YUV_YG));
+		rgba[0] = _mm_srai_epi16(_mm_adds_epi16(y1, _mm_add_epi16(_mm_mullo_epi16(v, _mm_set1_epi16(YUV_VR_NEG)), _mm_set1_epi16(YUV_BR))), 6);
+		rgba[1] = _mm_srai_epi16(_mm_adds_epi16(y1, _mm_sub_epi16(_mm_set1_epi16(YUV_BG), _mm_add_epi16(_mm_mullo_epi16(v, _mm_set1_epi16(YUV_VG)), _mm_mullo_epi16(u, _mm_set1_epi16(YUV_UG))))), 6);
+		rgba[2] = _mm_srai_epi16(_mm_adds_epi16(y1, _mm_add_epi16(_mm_slli_epi16(u, YUV_UB_NEG_SHIFT), _mm_set1_epi16(YUV_BB))), 6);
+		rgba[3] = _mm_set1_epi16(255);
+	}
+
+	// stores 8 pixels from 16 bit channels
+	template <sl_uint32 ORDER>
+	SLIB_INLINE static void _priv_BitmapData_StorePixels_SSE2(sl_uint8* dst, const __m128i* rgba)
+	{
+		__m128i p02 = _mm_packus_epi16(rgba[_priv_BitmapData_pixelChannels[ORDER][0]], rgba[_priv_BitmapData_pixelChannels[ORDER][2]]);
+		__m128i p13 = _mm_packus_epi16(rgba[_priv_BitmapData_pixelChannels[ORDER][1]], rgba[_priv_BitmapData_pixelChannels[ORDER][3]]);
+		__m128i lo = _mm_unpacklo_epi8(p02, p13);
+		__m128i hi = _mm_unpackhi_epi8(p02, p13);
+		_mm_storeu_si128((__m128i*)dst, _mm_unpacklo_epi16(lo, hi));
+		_mm_storeu_si128((__m128i*)(dst + 16), _mm_unpackhi_epi16(lo, hi));
+	}
+
+	template <sl_uint32 ORDER>
+	SLIB_INLINE static void _priv_BitmapData_YUV420ToRGB_SSE2_16(const sl_uint8* y, __m128i u, __m128i v, sl_uint8* dst)
+	{
+		__m128i yy = _mm_loadu_si128((const __m128i*)y);
+		__m128i rgba[4];
+		_priv_BitmapData_YUVToRGB_SSE2(_mm_unpacklo_epi8(yy, yy), _mm_unpacklo_epi16(u, u), _mm_unpacklo_epi16(v, v), rgba);
+		_priv_BitmapData_StorePixels_SSE2<ORDER>(dst, rgba);
+		_priv_BitmapData_YUVToRGB_SSE2(_mm_unpackhi_epi8(yy, yy), _mm_unpackhi_epi16(u, u), _mm_unpackhi_epi16(v, v), rgba);
+		_priv_BitmapData_StorePixels_SSE2<ORDER>(dst + 32, rgba);
+	}
+
+	template <sl_uint32 ORDER>
+	static void _priv_BitmapData_YUV420ToRGB_SSE2(const sl_uint8* y, const sl_uint8* u, const sl_uint8* v, sl_uint32 strideUV, sl_uint8* dst, sl_uint32 width)
+	{
+		sl_uint32 x = 0;
+		if (strideUV == 1) {
+			__m128i zero = _mm_setzero_si128();
+			for (; x + 16 <= width; x += 16) {
+				__m128i uu = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(u + (x >> 1))), zero);
+				__m128i vv = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(v + (x >> 1))), zero);
+				_priv_BitmapData_YUV420ToRGB_SSE2_16<ORDER>(y + x, uu, vv, dst + (x << 2));
+			}
+		} else if (strideUV == 2) {
+			const sl_uint8* uv = u < v ? u : v;
+			__m128i mask = _mm_set1_epi16(0xFF);
+			for (; x + 16 <= width; x += 16) {
+				__m128i t = _mm_loadu_si128((const __m128i*)(uv + x));
+				__m128i even = _mm_and_si128(t, mask);
+				__m128i odd = _mm_srli_epi16(t, 8);
+				if (u < v) {
+					_priv_BitmapData_YUV420ToRGB_SSE2_16<ORDER>(y + x, even, odd, dst + (x << 2));
+				} else {
+					_priv_BitmapData_YUV420ToRGB_SSE2_16<ORDER>(y + x, odd, even, dst + (x << 2));
+				}
+			}
+		}
+		_priv_BitmapData_YUV420ToRGB_Tail<ORDER>(y, u, v, strideUV, dst, x, width);
+	}
+
+	template <sl_uint32 SRC, sl_uint32 DST>
+	static void _priv_BitmapData_Swizzle_SSE2(const sl_uint8* src, sl_uint8* dst, sl_uint32 width)
+	{
+		// the samples are widened to 16 bits, so that a pixel fits in a 64 bit half of the register which can be shuffled by an immediate
+		const int imm = _priv_BitmapData_pixelPositions[SRC][_priv_BitmapData_pixelChannels[DST][0]] | (_priv_BitmapData_pixelPositions[SRC][_priv_BitmapData_pixelChannels[DST][1]] << 2) | (_priv_BitmapData_pixelPositions[SRC][_priv_BitmapData_pixelChannels[DST][2]] << 4) | (_priv_BitmapData_pixelPositions[SRC][_priv_BitmapData_pixelChannels[DST][3]] << 6);
+		__m128i zero = _mm_setzero_si128();
+		sl_uint32 x = 0;
+		for (; x + 4 <= width; x += 4) {
+			__m128i t = _mm_loadu_si128((const __m128i*)(src + (x << 2)));
+			__m128i lo = _mm_unpacklo_epi8(t, zero);
+			__m128i hi = _mm_unpackhi_epi8(t, zero);
+			lo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, imm), imm);
+			hi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, imm), imm);
+			_mm_storeu_si128((__m128i*)(dst + (x << 2)), _mm_packus_epi16(lo, hi));
+		}
+		_priv_BitmapData_Swizzle_Tail<SRC, DST>(src, dst, x, width);
+	}
+#endif
+
+#if defined(BITMAP_SIMD_USE_AVX2)
+	BITMAP_SIMD_AVX2_FUNC static inline void _priv_BitmapData_YUVToRGB_AVX2(__m256i y, __m256i u, __m256i v, __m256i* rgba)
+	{
+		__m256i y1 = _mm256_mulhi_epu16(y, _mm256_set1_epi16(YUV_YG));
+		rgba[0] = _mm256_srai_epi16(_mm256_adds_epi16(y1, _mm256_add_epi16(_mm256_mullo_epi16(v, _mm256_set1_epi16(YUV_VR_NEG)), _mm256_set1_epi16(YUV_BR))), 6);
+		rgba[1] = _mm256_srai_epi16(_mm256_adds_epi16(y1, _mm256_sub_epi16(_mm256_set1_epi16(YUV_BG), _mm256_add_epi16(_mm256_mullo_epi16(v, _mm256_set1_epi16(YUV_VG)), _mm256_mullo_epi16(u, _mm256_set1_epi16(YUV_UG))))), 6);
+		rgba[2] = _mm256_srai_epi16(_mm256_adds_epi16(y1, _mm256_add_epi16(_mm256_slli_epi16(u, YUV_UB_NEG_SHIFT), _mm256_set1_epi16(YUV_BB))), 6);
+		rgba[3] = _mm256_set1_epi16(255);
+	}
+
+	// the unpack instructions work in each 128 bit lane, so `lo` gets the pixels 0-3 and 16-19, `hi` gets 4-7 and 20-23 (relative to `y`)
+	template <sl_uint32 ORDER>
+	BITMAP_SIMD_AVX2_FUNC static inline void _priv_BitmapData_PackPixels_AVX2(const __m256i* rgba, __m256i& lo, __m256i& hi)
+	{
+		__m256i p02 = _mm256_packus_epi16(rgba[_priv_BitmapData_pixelChannels[ORDER][0]], rgba[_priv_BitmapData_pixelChannels[ORDER][2]]);
+		__m256i p13 = _mm256_packus_epi16(rgba[_priv_BitmapData_pixelChannels[ORDER][1]], rgba[_priv_BitmapData_pixelChannels[ORDER][3]]);
+		__m256i t0 = _mm256_unpacklo_epi8(p02, p13);
+		__m256i t1 = _mm256_unpackhi_epi8(p02, p13);
+		lo = _mm256_unpacklo_epi16(t0, t1);
+		hi = _mm256_unpackhi_epi16(t0, t1);
+	}
+
+	// `u` and `v` hold the 16 bit samples for 32 pixels, in the order of [0-7 | 8-15]
+	template <sl_uint32 ORDER>
+	BITMAP_SIMD_AVX2_FUNC static inline void _priv_BitmapData_YUV420ToRGB_AVX2_32(const sl_uint8* y, __m256i u, __m256i v, sl_uint8* dst)
+	{
+		__m256i yy = _mm256_loadu_si256((const __m256i*)y);
+		__m256i rgba[4];
+		__m256i a0, a1, b0, b1;
+		_priv_BitmapData_YUVToRGB_AVX2(_mm256_unpacklo_epi8(yy, yy), _mm256_unpacklo_epi16(u, u), _mm256_unpacklo_epi16(v, v), rgba);
+		_priv_BitmapData_PackPixels_AVX2<ORDER>(rgba, a0, a1);
+		_priv_BitmapData_YUVToRGB_AVX2(_mm256_unpackhi_epi8(yy, yy), _mm256_unpackhi_epi16(u, u), _mm256_unpackhi_epi16(v, v), rgba);
+		_priv_BitmapData_PackPixels_AVX2<ORDER>(rgba, b0, b1);
+		_mm256_storeu_si256((__m256i*)dst, _mm256_permute2x128_si256(a0, a1, 0x20));
+		_mm256_storeu_si256((__m256i*)(dst + 32), _mm256_permute2x128_si256(b0, b1, 0x20));
+		_mm256_storeu_si256((__m256i*)(dst + 64), _mm256_permute2x128_si256(a0, a1, 0x31));
+		_mm256_storeu_si256((__m256i*)(dst + 96), _mm256_permute2x128_si256(b0, b1, 0x31));
+	}
+
+	template <sl_uint32 ORDER>
+	BITMAP_SIMD_AVX2_FUNC static void _priv_BitmapData_YUV420ToRGB_AVX2(const sl_uint8* y, const sl_uint8* u, const sl_uint8* v, sl_uint32 strideUV, sl_uint8* dst, sl_uint32 width)
+	{
+		sl_uint32 x = 0;
+		if (strideUV == 1) {
+			for (; x + 32 <= width; x += 32) {
+				__m256i uu = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(u + (x >> 1))));
+				__m256i vv = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(v + (x >> 1))));
+				_priv_BitmapData_YUV420ToRGB_AVX2_32<ORDER>(y + x, uu, vv, dst + (x << 2));
+			}
+		} else if (strideUV == 2) {
+			const sl_uint8* uv = u < v ? u : v;
+			__m256i mask = _mm256_set1_epi16(0xFF);
+			for (; x + 32 <= width; x += 32) {
+				__m256i t = _mm256_loadu_si256((const __m256i*)(uv + x));
+				__m256i even = _mm256_and_si256(t, mask);
+				__m256i odd = _mm256_srli_epi16(t, 8);
+				if (u < v) {
+					_priv_BitmapData_YUV420ToRGB_AVX2_32<ORDER>(y + x, even, odd, dst + (x << 2));
+				} else {
+					_priv_BitmapData_YUV420ToRGB_AVX2_32<ORDER>(y + x, odd, even, dst + (x << 2));
+				}
+			}
+		}
+		_priv_BitmapData_YUV420ToRGB_SSE2<ORDER>(y + x, u + (x >> 1) * strideUV, v + (x >> 1) * strideUV, strideUV, dst + (x << 2), width - x);
+	}
+
+	template <sl_uint32 SRC, sl_uint32 DST>
+	BITMAP_SIMD_AVX2_FUNC static void _priv_BitmapData_Swizzle_AVX2(const sl_uint8* src, sl_uint8* dst, sl_uint32 width)
+	{
+		const char p0 = (char)(_priv_BitmapData_pixelPositions[SRC][_priv_BitmapData_pixelChannels[DST][0]]);
+		const char p1 = (char)(_priv_BitmapData_pixelPositions[SRC][_priv_BitmapData_pixelChannels[DST][1]]);
+		const char p2 = (char)(_priv_BitmapData_pixelPositions[SRC][_priv_BitmapData_pixelChannels[DST][2]]);
+		const char p3 = (char)(_priv_BitmapData_pixelPositions[SRC][_priv_BitmapData_pixelChannels[DST][3]]);
+		__m256i mask = _mm256_setr_epi8(
+			p0, p1, p2, p3, p0 + 4, p1 + 4, p2 + 4, p3 + 4, p0 + 8, p1 + 8, p2 + 8, p3 + 8, p0 + 12, p1 + 12, p2 + 12, p3 + 12,
+			p0, p1, p2, p3, p0 + 4, p1 + 4, p2 + 4, p3 + 4, p0 + 8, p1 + 8, p2 + 8, p3 + 8, p0 + 12, p1 + 12, p2 + 12, p3 + 12);
+		sl_uint32 x = 0;
+		for (; x + 8 <= width; x += 8) {
+			__m256i t = _mm256_loadu_si256((const __m256i*)(src + (x << 2)));
+			_mm256_storeu_si256((__m256i*)(dst + (x << 2)), _mm256_shuffle_epi8(t, mask));
+		}
+		_priv_BitmapData_Swizzle_Tail<SRC, DST>(src, dst, x, width);
+	}
+#endif
+
+#if defined(BITMAP_SIMD_USE_NEON)
+	SLIB_INLINE static uint8x8_t _priv_BitmapData_YUVClamp_NEON(int16x8_t y1, int16x8_t t)
+	{
+		return vqmovun_s16(vshrq_n_s16(vqaddq_s16(y1, t), 6));
+	}
+
+	SLIB_INLINE static void _priv_BitmapData_YUVToRGB_NEON(uint8x8_t y, int16x8_t u, int16x8_t v, uint8x8_t* rgb)
+	{
+		uint16x8_t y16 = vorrq_u16(vshll_n_u8(y, 8), vmovl_u8(y));
+		uint16x4_t lo = vshrn_n_u32(vmull_n_u16(vget_low_u16(y16), YUV_YG), 16);
+		uint16x4_t hi = vshrn_n_u32(vmull_n_u16(vget_high_u16(y16), YUV_YG), 16);
+		int16x8_t y1 = vreinterpretq_s16_u16(vcombine_u16(lo, hi));
+		rgb[0] = _priv_BitmapData_YUVClamp_NEON(y1, vaddq_s16(vmulq_n_s16(v, YUV_VR_NEG), vdupq_n_s16(YUV_BR)));
+		rgb[1] = _priv_BitmapData_YUVClamp_NEON(y1, vsubq_s16(vdupq_n_s16(YUV_BG), vaddq_s16(vmulq_n_s16(v, YUV_VG), vmulq_n_s16(u, YUV_UG))));
+		rgb[2] = _priv_BitmapData_YUVClamp_NEON(y1, vaddq_s16(vshlq_n_s16(u, YUV_UB_NEG_SHIFT), vdupq_n_s16(YUV_BB)));
+	}
+
+	template <sl_uint32 ORDER>
+	SLIB_INLINE static void _priv_BitmapData_YUV420ToRGB_NEON_16(const sl_uint8* y, uint8x8_t u, uint8x8_t v, sl_uint8* dst)
+	{
+		uint8x16_t yy = vld1q_u8(y);
+		int16x8_t uu = vreinterpretq_s16_u16(vmovl_u8(u));
+		int16x8_t vv = vreinterpretq_s16_u16(vmovl_u8(v));
+		int16x8x2_t uz = vzipq_s16(uu, uu);
+		int16x8x2_t vz = vzipq_s16(vv, vv);
+		uint8x8_t lo[3], hi[3];
+		_priv_BitmapData_YUVToRGB_NEON(vget_low_u8(yy), uz.val[0], vz.val[0], lo);
+		_priv_BitmapData_YUVToRGB_NEON(vget_high_u8(yy), uz.val[1], vz.val[1], hi);
+		uint8x16x4_t out;
+		out.val[_priv_BitmapData_pixelPositions[ORDER][0]] = vcombine_u8(lo[0], hi[0]);
+		out.val[_priv_BitmapData_pixelPositions[ORDER][1]] = vcombine_u8(lo[1], hi[1]);
+		out.val[_priv_BitmapData_pixelPositions[ORDER][2]] = vcombine_u8(lo[2], hi[2]);
+		out.val[_priv_BitmapData_pixelPositions[ORDER][3]] = vdupq_n_u8(255);
+		vst4q_u8(dst, out);
+	}
+
+	template <sl_uint32 ORDER>
+	static void _priv_BitmapData_YUV420ToRGB_NEON(const sl_uint8* y, const sl_uint8* u, const sl_uint8* v, sl_uint32 strideUV, sl_uint8* dst, sl_uint32 width)
+	{
+		sl_uint32 x = 0;
+		if (strideUV == 1) {
+			for (; x + 16 <= width; x += 16) {
+				_priv_BitmapData_YUV420ToRGB_NEON_16<ORDER>(y + x, vld1_u8(u + (x >> 1)), vld1_u8(v + (x >> 1)), dst + (x << 2));
+			}
+		} else if (strideUV == 2) {
+			const sl_uint8* uv = u < v ? u : v;
+			for (; x + 16 <= width; x += 16) {
+				uint8x8x2_t t = vld2_u8(uv + x);
+				if (u < v) {
+					_priv_BitmapData_YUV420ToRGB_NEON_16<ORDER>(y + x, t.val[0], t.val[1], dst + (x << 2));
+				} else {
+					_priv_BitmapData_YUV420ToRGB_NEON_16<ORDER>(y + x, t.val[1], t.val[0], dst + (x << 2));
+				}
+			}
+		}
+		_priv_BitmapData_YUV420ToRGB_Tail<ORDER>(y, u, v, strideUV, dst, x, width);
+	}
+
+	template <sl_uint32 SRC, sl_uint32 DST>
+	static void _priv_BitmapData_Swizzle_NEON(const sl_uint8* src, sl_uint8* dst, sl_uint32 width)
+	{
+		sl_uint32 x = 0;
+		for (; x + 16 <= width; x += 16) {
+			uint8x16x4_t in = vld4q_u8(src + (x << 2));
+			uint8x16x4_t out;
+			out.val[0] = in.val[_priv_BitmapData_pixelPositions[SRC][_priv_BitmapData_pixelChannels[DST][0]]];
+			out.val[1] = in.val[_priv_BitmapData_pixelPositions[SRC][_priv_BitmapData_pixelChannels[DST][1]]];
+			out.val[2] = in.val[_priv_BitmapData_pixelPositions[SRC][_priv_BitmapData_pixelChannels[DST][2]]];
+			out.val[3] = in.val[_priv_BitmapData_pixelPositions[SRC][_priv_BitmapData_pixelChannels[DST][3]]];
+			vst4q_u8(dst + (x << 2), out);
+		}
+		_priv_BitmapData_Swizzle_Tail<SRC, DST>(src, dst, x, width);
+	}
+#endif
+
+#define BITMAP_SIMD_YUV420_TABLE(KERNEL) \
+	{ KERNEL<0>, KERNEL<1>, KERNEL<2>, KERNEL<3> }
+
+#define BITMAP_SIMD_SWIZZLE_TABLE(KERNEL) \
+	{ \
+		{ sl_null, KERNEL<0, 1>, KERNEL<0, 2>, KERNEL<0, 3> }, \
+		{ KERNEL<1, 0>, sl_null, KERNEL<1, 2>, KERNEL<1, 3> }, \
+		{ KERNEL<2, 0>, KERNEL<2, 1>, sl_null, KERNEL<2, 3> }, \
+		{ KERNEL<3, 0>, KERNEL<3, 1>, KERNEL<3, 2>, sl_null } \
+	}
+
+	class _priv_BitmapData_RowKernelTable
+	{
+	public:
+		_priv_BitmapData_YUV420RowProc yuv420ToRGB[4];
+		_priv_BitmapData_SwizzleRowProc swizzle[4][4];
+
+	public:
+		_priv_BitmapData_RowKernelTable()
+		{
+			Base::zeroMemory(this, sizeof(_priv_BitmapData_RowKernelTable));
+#if defined(BITMAP_SIMD_USE_SSE2)
+			_priv_BitmapData_YUV420RowProc yuvSSE2[4] = BITMAP_SIMD_YUV420_TABLE(_priv_BitmapData_YUV420ToRGB_SSE2);
+			_priv_BitmapData_SwizzleRowProc swizzleSSE2[4][4] = BITMAP_SIMD_SWIZZLE_TABLE(_priv_BitmapData_Swizzle_SSE2);
+			Base::copyMemory(yuv420ToRGB, yuvSSE2, sizeof(yuv420ToRGB));
+			Base::copyMemory(swizzle, swizzleSSE2, sizeof(swizzle));
+#	if defined(BITMAP_SIMD_USE_AVX2)
+			if (System::isAVX2Supported()) {
+				_priv_BitmapData_YUV420RowProc yuvAVX2[4] = BITMAP_SIMD_YUV420_TABLE(_priv_BitmapData_YUV420ToRGB_AVX2);
+				_priv_BitmapData_SwizzleRowProc swizzleAVX2[4][4] = BITMAP_SIMD_SWIZZLE_TABLE(_priv_BitmapData_Swizzle_AVX2);
+				Base::copyMemory(yuv420ToRGB, yuvAVX2, sizeof(yuv420ToRGB));
+				Base::copyMemory(swizzle, swizzleAVX2, sizeof(swizzle));
+			}
+#	endif
+#elif defined(BITMAP_SIMD_USE_NEON)
+			_priv_BitmapData_YUV420RowProc yuvNEON[4] = BITMAP_SIMD_YUV420_TABLE(_priv_BitmapData_YUV420ToRGB_NEON);
+			_priv_BitmapData_SwizzleRowProc swizzleNEON[4][4] = BITMAP_SIMD_SWIZZLE_TABLE(_priv_BitmapData_Swizzle_NEON);
+			Base::copyMemory(yuv420ToRGB, yuvNEON, sizeof(yuv420ToRGB));
+			Base::copyMemory(swizzle, swizzleNEON, sizeof(swizzle));
+#endif
+		}
+
+	public:
+		static const _priv_BitmapData_RowKernelTable& get()
+		{
+			static _priv_BitmapData_RowKernelTable kernels;
+			return kernels;
+		}
+
+	};
+
+	_priv_BitmapData_YUV420RowProc _priv_BitmapData_RowKernels::getYUV420ToRGB(BitmapFormat dst)
+	{
+		// alpha is always 255, so the premultiplied formats have the same samples
+		sl_int32 order = _priv_BitmapData_getPixelOrder(dst);
+		if (order < 0) {
+			return sl_null;
+		}
+		return _priv_BitmapData_RowKernelTable::get().yuv420ToRGB[order];
+	}
+
+	_priv_BitmapData_SwizzleRowProc _priv_BitmapData_RowKernels::getSwizzle(BitmapFormat src, BitmapFormat dst)
+	{
+		if (BitmapFormats::isPrecomputedAlpha(src) != BitmapFormats::isPrecomputedAlpha(dst)) {
+			return sl_null;
+		}
+		sl_int32 orderSrc = _priv_BitmapData_getPixelOrder(src);
+		sl_int32 orderDst = _priv_BitmapData_getPixelOrder(dst);
+		if (orderSrc < 0 || orderDst < 0) {
+			return sl_null;
+		}
+		return _priv_BitmapData_RowKernelTable::get().swizzle[orderSrc][orderDst];
+	}
+
+}
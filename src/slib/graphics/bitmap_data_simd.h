@@ -0,0 +1,49 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#ifndef CHECKHEADER_SLIB_GRAPHICS_BITMAP_DATA_SIMD
+#define CHECKHEADER_SLIB_GRAPHICS_BITMAP_DATA_SIMD
+
+#include "slib/graphics/bitmap_format.h"
+
+namespace slib
+{
+
+	// converts a row of 4:2:0 samples, `u` and `v` are sampled every two pixels. `strideUV` is 1 for planar formats and 2 for interleaved formats
+	typedef void (*_priv_BitmapData_YUV420RowProc)(const sl_uint8* y, const sl_uint8* u, const sl_uint8* v, sl_uint32 strideUV, sl_uint8* dst, sl_uint32 width);
+
+	typedef void (*_priv_BitmapData_SwizzleRowProc)(const sl_uint8* src, sl_uint8* dst, sl_uint32 width);
+
+	class _priv_BitmapData_RowKernels
+	{
+	public:
+		// returns null when there is no specialized kernel for the format
+		static _priv_BitmapData_YUV420RowProc getYUV420ToRGB(BitmapFormat dst);
+
+		static _priv_BitmapData_SwizzleRowProc getSwizzle(BitmapFormat src, BitmapFormat dst);
+
+	};
+
+}
+
+#endif
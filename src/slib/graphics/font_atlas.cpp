@@ -22,8 +22,12 @@
 
 #include "slib/graphics/font_atlas.h"
 
+#include "slib/graphics/freetype.h"
+#include "slib/graphics/image.h"
+
 #include "slib/core/variant.h"
 #include "slib/core/safe_static.h"
+#include "slib/core/sort.h"
 
 #define PLANE_SIZE_MIN 32
 #define PLANE_WIDTH_DEFAULT 0
@@ -31,6 +35,7 @@
 #define MAX_PLANES_DEFAULT 16
 #define FONT_SIZE_MIN 4
 #define FONT_SIZE_MAX 48
+#define DISTANCE_FIELD_PLANE_SIZE 512
 
 namespace slib
 {
@@ -58,6 +63,187 @@ namespace slib
 	}
 
 
+	struct _priv_FontAtlasSkylineNode
+	{
+		sl_uint32 x;
+		sl_uint32 y;
+		sl_uint32 width;
+	};
+	
+	// bottom-left skyline bin packing
+	class _priv_FontAtlasPlane : public Referable
+	{
+	public:
+		Ref<Bitmap> bitmap;
+		Ref<Canvas> canvas;
+		sl_uint32 width;
+		sl_uint32 height;
+		CList<_priv_FontAtlasSkylineNode> skyline;
+		sl_uint64 stampUse;
+		
+	public:
+		static Ref<_priv_FontAtlasPlane> create(sl_uint32 width, sl_uint32 height, sl_bool flagCanvas)
+		{
+			Ref<Bitmap> bitmap;
+			if (flagCanvas) {
+				bitmap = Bitmap::create(width, height);
+			} else {
+				bitmap = Image::create(width, height);
+			}
+			if (bitmap.isNotNull()) {
+				Ref<Canvas> canvas;
+				if (flagCanvas) {
+					canvas = bitmap->getCanvas();
+				}
+				if (canvas.isNotNull() || !flagCanvas) {
+					Ref<_priv_FontAtlasPlane> ret = new _priv_FontAtlasPlane;
+					if (ret.isNotNull()) {
+						ret->bitmap = bitmap;
+						ret->canvas = canvas;
+						ret->width = width;
+						ret->height = height;
+						ret->stampUse = 0;
+						ret->reset();
+						return ret;
+					}
+				}
+			}
+			return sl_null;
+		}
+		
+		void reset()
+		{
+			skyline.removeAll_NoLock();
+			_priv_FontAtlasSkylineNode node;
+			node.x = 0;
+			node.y = 0;
+			node.width = width;
+			skyline.add_NoLock(node);
+		}
+		
+		sl_bool allocate(sl_uint32 w, sl_uint32 h, Rectanglei& _out)
+		{
+			_priv_FontAtlasSkylineNode* nodes = skyline.getData();
+			sl_size n = skyline.getCount();
+			sl_size indexBest = n;
+			sl_uint32 bottomBest = 0;
+			sl_uint32 widthBest = 0;
+			sl_uint32 yBest = 0;
+			for (sl_size i = 0; i < n; i++) {
+				sl_uint32 y;
+				if (_fit(nodes, n, i, w, h, y)) {
+					sl_uint32 bottom = y + h;
+					if (indexBest == n || bottom < bottomBest || (bottom == bottomBest && nodes[i].width < widthBest)) {
+						indexBest = i;
+						bottomBest = bottom;
+						widthBest = nodes[i].width;
+						yBest = y;
+					}
+				}
+			}
+			if (indexBest == n) {
+				return sl_false;
+			}
+			sl_uint32 x = nodes[indexBest].x;
+			_out.left = x;
+			_out.top = yBest;
+			_out.right = x + w;
+			_out.bottom = yBest + h;
+			
+			_priv_FontAtlasSkylineNode node;
+			node.x = x;
+			node.y = yBest + h;
+			node.width = w;
+			skyline.insert_NoLock(indexBest, node);
+			
+			// shrink the nodes covered by the new node
+			sl_size i = indexBest + 1;
+			while (i < skyline.getCount()) {
+				nodes = skyline.getData();
+				_priv_FontAtlasSkylineNode& prev = nodes[i - 1];
+				_priv_FontAtlasSkylineNode& cur = nodes[i];
+				sl_uint32 right = prev.x + prev.width;
+				if (cur.x >= right) {
+					break;
+				}
+				sl_uint32 shrink = right - cur.x;
+				if (cur.width <= shrink) {
+					skyline.removeAt_NoLock(i);
+				} else {
+					cur.x += shrink;
+					cur.width -= shrink;
+					break;
+				}
+			}
+			// merge the neighbors on the same level
+			i = 0;
+			while (i + 1 < skyline.getCount()) {
+				nodes = skyline.getData();
+				if (nodes[i].y == nodes[i + 1].y) {
+					nodes[i].width += nodes[i + 1].width;
+					skyline.removeAt_NoLock(i + 1);
+				} else {
+					i++;
+				}
+			}
+			return sl_true;
+		}
+		
+	private:
+		sl_bool _fit(_priv_FontAtlasSkylineNode* nodes, sl_size n, sl_size index, sl_uint32 w, sl_uint32 h, sl_uint32& _y)
+		{
+			if (nodes[index].x + w > width) {
+				return sl_false;
+			}
+			sl_uint32 y = 0;
+			sl_uint32 widthLeft = w;
+			for (sl_size i = index; i < n; i++) {
+				if (nodes[i].y > y) {
+					y = nodes[i].y;
+				}
+				if (y + h > height) {
+					return sl_false;
+				}
+				if (nodes[i].width >= widthLeft) {
+					_y = y;
+					return sl_true;
+				}
+				widthLeft -= nodes[i].width;
+			}
+			return sl_false;
+		}
+		
+	};
+	
+	struct _priv_FontAtlasPendingChar
+	{
+		sl_char32 ch;
+		sl_uint32 width;
+		sl_uint32 height;
+	};
+	
+	// taller glyphs first, for the density of skyline packing
+	class _priv_FontAtlasPendingCharCompare
+	{
+	public:
+		int operator()(const _priv_FontAtlasPendingChar& a, const _priv_FontAtlasPendingChar& b) const
+		{
+			if (a.height != b.height) {
+				return a.height < b.height ? -1 : 1;
+			}
+			if (a.width != b.width) {
+				return a.width < b.width ? -1 : 1;
+			}
+			return 0;
+		}
+	};
+	
+	static String _priv_FontAtlas_getCharString(sl_char32 ch)
+	{
+		return String(&ch, 1);
+	}
+
+
 	SLIB_DEFINE_OBJECT(FontAtlas, Object)
 
 	FontAtlas::FontAtlas()
@@ -66,11 +252,13 @@ namespace slib
 		m_planeHeight = PLANE_HEIGHT_DEFAULT;
 		m_maxPlanes = MAX_PLANES_DEFAULT;
 		m_fontSourceHeight = 0;
-
-		m_countPlanes = 0;
-		m_currentPlaneY = 0;
-		m_currentPlaneX = 0;
-		m_currentPlaneRowHeight = 0;
+		
+		m_flagDistanceField = sl_false;
+		m_distanceFieldSize = 0;
+		m_distanceFieldSpread = 0;
+		m_distanceFieldAscent = 0;
+		
+		m_stampUse = 0;
 	}
 
 	FontAtlas::~FontAtlas()
@@ -108,7 +296,7 @@ namespace slib
 					}
 					sl_uint32 planeHeight = param.planeHeight;
 					if (planeHeight == 0) {
-						planeHeight = (sl_uint32)(fontDraw->getFontHeight());
+						planeHeight = planeWidth / 4;
 					}
 					if (planeHeight < PLANE_SIZE_MIN) {
 						planeHeight = PLANE_SIZE_MIN;
@@ -117,23 +305,18 @@ namespace slib
 					if (maxPlanes < 1) {
 						maxPlanes = 1;
 					}
-					Ref<Bitmap> plane = Bitmap::create(planeWidth, planeHeight);
+					Ref<_priv_FontAtlasPlane> plane = _priv_FontAtlasPlane::create(planeWidth, planeHeight, sl_true);
 					if (plane.isNotNull()) {
-						Ref<Canvas> canvas = plane->getCanvas();
-						if (canvas.isNotNull()) {
-							Ref<FontAtlas> ret = new FontAtlas;
-							if (ret.isNotNull()) {
-								ret->m_fontSource = fontSource;
-								ret->m_fontSourceHeight = fontSource->getFontHeight();
-								ret->m_fontDraw = fontDraw;
-								ret->m_planeWidth = planeWidth;
-								ret->m_planeHeight = planeHeight;
-								ret->m_maxPlanes = maxPlanes;
-								ret->m_currentPlane = plane;
-								ret->m_currentCanvas = canvas;
-								ret->m_countPlanes = 1;
-								return ret;
-							}
+						Ref<FontAtlas> ret = new FontAtlas;
+						if (ret.isNotNull()) {
+							ret->m_fontSource = fontSource;
+							ret->m_fontSourceHeight = fontSource->getFontHeight();
+							ret->m_fontDraw = fontDraw;
+							ret->m_planeWidth = planeWidth;
+							ret->m_planeHeight = planeHeight;
+							ret->m_maxPlanes = maxPlanes;
+							ret->m_planes.add_NoLock(plane);
+							return ret;
 						}
 					}
 				}
@@ -187,13 +370,113 @@ namespace slib
 		}
 	}
 
-	sl_bool FontAtlas::getChar(sl_char16 ch, FontAtlasChar& _out)
+	Ref<FontAtlas> FontAtlas::createDistanceField(const Ref<FreeType>& face, sl_uint32 fieldSize, sl_uint32 spread)
+	{
+		if (face.isNull() || !fieldSize) {
+			return sl_null;
+		}
+		if (!(face->setSize(fieldSize, fieldSize))) {
+			return sl_null;
+		}
+		FontMetrics fm;
+		if (!(face->getFontMetrics(fm))) {
+			return sl_null;
+		}
+		Ref<_priv_FontAtlasPlane> plane = _priv_FontAtlasPlane::create(DISTANCE_FIELD_PLANE_SIZE, DISTANCE_FIELD_PLANE_SIZE, sl_false);
+		if (plane.isNotNull()) {
+			Ref<FontAtlas> ret = new FontAtlas;
+			if (ret.isNotNull()) {
+				ret->m_face = face;
+				ret->m_flagDistanceField = sl_true;
+				ret->m_distanceFieldSize = fieldSize;
+				ret->m_distanceFieldSpread = spread;
+				ret->m_distanceFieldAscent = fm.ascent;
+				ret->m_fontSourceHeight = fm.ascent + fm.descent;
+				ret->m_planeWidth = DISTANCE_FIELD_PLANE_SIZE;
+				ret->m_planeHeight = DISTANCE_FIELD_PLANE_SIZE;
+				ret->m_maxPlanes = MAX_PLANES_DEFAULT;
+				ret->m_planes.add_NoLock(plane);
+				return ret;
+			}
+		}
+		return sl_null;
+	}
+	
+	typedef CHashMap< String, Ref<FontAtlas> > _priv_FontAtlasDistanceFieldMap;
+	SLIB_SAFE_STATIC_GETTER(_priv_FontAtlasDistanceFieldMap, _priv_FontAtlas_getSharedDistanceFields)
+	
+	void FontAtlas::setSharedDistanceField(const String& fontFamily, const Ref<FontAtlas>& atlas, sl_bool flagBold)
+	{
+		_priv_FontAtlasDistanceFieldMap* map = _priv_FontAtlas_getSharedDistanceFields();
+		if (map) {
+			String sig = fontFamily;
+			if (flagBold) {
+				sig += "B";
+			}
+			if (atlas.isNotNull()) {
+				map->put(sig, atlas);
+			} else {
+				map->remove(sig);
+			}
+		}
+	}
+	
+	Ref<FontAtlas> FontAtlas::getSharedDistanceField(const Ref<Font>& font)
+	{
+		if (font.isNotNull()) {
+			_priv_FontAtlasDistanceFieldMap* map = _priv_FontAtlas_getSharedDistanceFields();
+			if (map && map->getCount()) {
+				String sig = font->getFamilyName();
+				if (font->isBold()) {
+					sig += "B";
+				}
+				return map->getValue(sig, Ref<FontAtlas>::null());
+			}
+		}
+		return sl_null;
+	}
+
+	sl_char32 FontAtlas::readChar(const sl_char16* text, sl_size len, sl_size& pos)
+	{
+		sl_char32 ch = (sl_char32)((sl_uint16)(text[pos]));
+		pos++;
+		if (ch >= 0xD800 && ch < 0xDC00 && pos < len) {
+			sl_char32 ch1 = (sl_char32)((sl_uint16)(text[pos]));
+			if (ch1 >= 0xDC00 && ch1 < 0xE000) {
+				pos++;
+				return 0x10000 + (((ch - 0xD800) << 10) | (ch1 - 0xDC00));
+			}
+		}
+		return ch;
+	}
+
+	sl_bool FontAtlas::isDistanceField()
+	{
+		return m_flagDistanceField;
+	}
+	
+	sl_real FontAtlas::getDistanceFieldSize()
+	{
+		return (sl_real)m_distanceFieldSize;
+	}
+	
+	sl_uint32 FontAtlas::getDistanceFieldSpread()
+	{
+		return m_distanceFieldSpread;
+	}
+	
+	sl_real FontAtlas::getFontHeight()
+	{
+		return m_fontSourceHeight;
+	}
+
+	sl_bool FontAtlas::getChar(sl_char32 ch, FontAtlasChar& _out)
 	{
 		ObjectLocker lock(this);
 		return _getChar(ch, sl_false, _out);
 	}
 
-	Size FontAtlas::getFontSize(sl_char16 ch)
+	Size FontAtlas::getFontSize(sl_char32 ch)
 	{
 		ObjectLocker lock(this);
 		FontAtlasChar fac;
@@ -203,7 +486,7 @@ namespace slib
 		return Size::zero();
 	}
 
-	Size FontAtlas::getFontSize_NoLock(sl_char16 ch)
+	Size FontAtlas::getFontSize_NoLock(sl_char32 ch)
 	{
 		FontAtlasChar fac;
 		if (_getChar(ch, sl_true, fac)) {
@@ -225,8 +508,9 @@ namespace slib
 		sl_real maxWidth = 0;
 		sl_real totalHeight = 0;
 		FontAtlasChar fac;
-		for (sl_size i = 0; i < len; i++) {
-			sl_char16 ch = sz[i];
+		sl_size i = 0;
+		while (i < len) {
+			sl_char32 ch = readChar(sz, len, i);
 			if (ch == '\r' || ch == '\n') {
 				if (!flagMultiLine) {
 					return Size(lineWidth, lineHeight);
@@ -240,13 +524,13 @@ namespace slib
 				totalHeight += lineHeight;
 				lineWidth = 0;
 				lineHeight = 0;
-				if (ch == '\r' && i + 1 < len) {
-					if (sz[i + 1] == '\n') {
+				if (ch == '\r' && i < len) {
+					if (sz[i] == '\n') {
 						i++;
 					}
 				}
 			} else {
-				if (_getChar(sz[i], sl_true, fac)) {
+				if (_getChar(ch, sl_true, fac)) {
 					lineWidth += fac.fontWidth;
 					if (lineHeight < fac.fontHeight) {
 						lineHeight = fac.fontHeight;
@@ -260,8 +544,67 @@ namespace slib
 		totalHeight += lineHeight;
 		return Size(maxWidth, totalHeight);
 	}
+	
+	void FontAtlas::prepareText(const String16& str)
+	{
+		if (str.isEmpty()) {
+			return;
+		}
+		ObjectLocker lock(this);
+		sl_char16* sz = str.getData();
+		sl_size len = str.getLength();
+		
+		CList<_priv_FontAtlasPendingChar> pendings;
+		CHashMap<sl_char32, sl_bool> setPending;
+		FontAtlasChar fac;
+		sl_size i = 0;
+		while (i < len) {
+			sl_char32 ch = readChar(sz, len, i);
+			if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n') {
+				continue;
+			}
+			if (m_map.get_NoLock(ch, &fac)) {
+				if (fac.fontWidth <= 0 || fac.fontHeight <= 0) {
+					continue;
+				}
+				if (fac.bitmap.isNotNull()) {
+					_touchPlane(fac.bitmap.get());
+					continue;
+				}
+			} else {
+				if (!(_measureChar(ch, fac))) {
+					continue;
+				}
+			}
+			if (setPending.find_NoLock(ch)) {
+				continue;
+			}
+			setPending.put_NoLock(ch, sl_true);
+			Sizei sizeDraw = _getCellSize(ch, fac);
+			if (sizeDraw.x <= 0 || sizeDraw.y <= 0) {
+				continue;
+			}
+			_priv_FontAtlasPendingChar pending;
+			pending.ch = ch;
+			pending.width = sizeDraw.x;
+			pending.height = sizeDraw.y;
+			pendings.add_NoLock(pending);
+		}
+		
+		sl_size n = pendings.getCount();
+		if (!n) {
+			return;
+		}
+		_priv_FontAtlasPendingChar* p = pendings.getData();
+		QuickSort::sortDesc(p, n, _priv_FontAtlasPendingCharCompare());
+		for (i = 0; i < n; i++) {
+			if (m_map.get_NoLock(p[i].ch, &fac)) {
+				_drawChar(p[i].ch, fac);
+			}
+		}
+	}
 
-	sl_bool FontAtlas::_getChar(sl_char16 ch, sl_bool flagSizeOnly, FontAtlasChar& _out)
+	sl_bool FontAtlas::_getChar(sl_char32 ch, sl_bool flagSizeOnly, FontAtlasChar& _out)
 	{
 		if (ch == ' ' || ch == '\r' || ch == '\n') {
 			_out.fontWidth = m_fontSourceHeight * 0.3f;
@@ -287,29 +630,46 @@ namespace slib
 				return sl_true;
 			}
 			if (_out.bitmap.isNotNull()) {
+				_touchPlane(_out.bitmap.get());
 				return sl_true;
 			}
 		} else {
-			Size sizeFont = m_fontSource->measureSingleLineText(String(&ch, 1));
-			if (sizeFont.x <= 0 || sizeFont.y <= 0) {
-				FontAtlasChar fac;
-				fac.fontWidth = 0;
-				fac.fontHeight = 0;
-				m_map.put_NoLock(ch, fac);
+			if (!(_measureChar(ch, _out))) {
 				return sl_false;
 			}
-			_out.fontWidth = sizeFont.x;
-			_out.fontHeight = sizeFont.y;
-			_out.bitmap.setNull();
 			if (flagSizeOnly) {
-				return m_map.put_NoLock(ch, _out);
+				return sl_true;
 			}
 		}
+		return _drawChar(ch, _out);
+	}
+	
+	sl_bool FontAtlas::_measureChar(sl_char32 ch, FontAtlasChar& _out)
+	{
+		Size sizeFont;
+		if (m_flagDistanceField) {
+			sizeFont.x = m_face->getCharAdvance(ch);
+			sizeFont.y = m_fontSourceHeight;
+		} else {
+			sizeFont = m_fontSource->measureSingleLineText(_priv_FontAtlas_getCharString(ch));
+		}
+		if (sizeFont.x <= 0 || sizeFont.y <= 0) {
+			_out.fontWidth = 0;
+			_out.fontHeight = 0;
+			_out.bitmap.setNull();
+			m_map.put_NoLock(ch, _out);
+			return sl_false;
+		}
+		_out.fontWidth = sizeFont.x;
+		_out.fontHeight = sizeFont.y;
+		_out.bitmap.setNull();
+		return m_map.put_NoLock(ch, _out) != sl_null;
+	}
+	
+	sl_bool FontAtlas::_drawChar(sl_char32 ch, FontAtlasChar& _out)
+	{
+		Sizei sizeDraw = _getCellSize(ch, _out);
 		
-		String s(&ch, 1);
-		
-		Sizei sizeDraw = m_fontDraw->measureSingleLineText(s);
-
 		sl_uint32 widthChar = sizeDraw.x;
 		sl_uint32 heightChar = sizeDraw.y;
 		if (sizeDraw.x <= 0 || sizeDraw.y <= 0) {
@@ -319,65 +679,136 @@ namespace slib
 			return sl_false;
 		}
 		
-		if (m_currentPlaneX > 0 && m_currentPlaneX + widthChar > m_planeWidth) {
-			m_currentPlaneX = 0;
-			m_currentPlaneY += m_currentPlaneRowHeight;
-			m_currentPlaneRowHeight = 0;
-		}
-		if (m_currentPlaneY > 0 && m_currentPlaneY + heightChar > m_planeHeight) {
-			if (m_countPlanes >= m_maxPlanes) {
-				m_map.removeAll_NoLock();
-				m_countPlanes = 1;
-			} else {
-				Ref<Bitmap> plane = Bitmap::create(m_planeWidth, m_planeHeight);
-				if (plane.isNull()) {
-					return sl_false;
+		_priv_FontAtlasPlane* plane = _allocateRegion(widthChar, heightChar, _out.region);
+		if (!plane) {
+			return sl_false;
+		}
+		
+		sl_uint32 x = _out.region.left;
+		sl_uint32 y = _out.region.top;
+		if (m_flagDistanceField) {
+			plane->bitmap->resetPixels(x, y, widthChar, heightChar, Color(255, 255, 255, 0));
+			FreeTypeGlyphField field;
+			if (m_face->getGlyphDistanceField(ch, m_distanceFieldSpread, field)) {
+				Image* image = field.image.get();
+				// origin of the glyph in the cell
+				sl_int32 dx = (sl_int32)m_distanceFieldSpread + field.left;
+				sl_int32 dy = (sl_int32)m_distanceFieldSpread + (sl_int32)(m_distanceFieldAscent + 0.5f) - field.top;
+				sl_int32 sx = 0;
+				sl_int32 sy = 0;
+				sl_int32 w = (sl_int32)(image->getWidth());
+				sl_int32 h = (sl_int32)(image->getHeight());
+				if (dx < 0) {
+					sx = -dx;
+					w += dx;
+					dx = 0;
 				}
-				Ref<Canvas> canvas = plane->getCanvas();
-				if (canvas.isNull()) {
-					return sl_false;
+				if (dy < 0) {
+					sy = -dy;
+					h += dy;
+					dy = 0;
+				}
+				if (dx + w > (sl_int32)widthChar) {
+					w = (sl_int32)widthChar - dx;
+				}
+				if (dy + h > (sl_int32)heightChar) {
+					h = (sl_int32)heightChar - dy;
+				}
+				if (w > 0 && h > 0) {
+					plane->bitmap->writePixels(x + dx, y + dy, w, h, image->getColorsAt(sx, sy), image->getStride());
 				}
-				m_currentPlane = plane;
-				m_currentCanvas = canvas;
-				m_countPlanes++;
 			}
-			m_currentPlaneX = 0;
-			m_currentPlaneY = 0;
-			m_currentPlaneRowHeight = 0;
+		} else {
+			plane->bitmap->resetPixels(x, y, widthChar, heightChar, Color::Zero);
+			plane->canvas->drawText(_priv_FontAtlas_getCharString(ch), (sl_real)x, (sl_real)y, m_fontDraw, Color::White);
 		}
-
-		sl_uint32 x = m_currentPlaneX;
-		sl_uint32 y = m_currentPlaneY;
-		_out.region.left = x;
-		_out.region.top = y;
-		_out.region.right = x + widthChar;
-		_out.region.bottom = y + heightChar;
-
-		m_currentPlane->resetPixels(x, y, widthChar, heightChar, Color::Zero);
-		m_currentCanvas->drawText(s, (sl_real)x, (sl_real)y, m_fontDraw, Color::White);
-
-		m_currentPlane->update(x, y, widthChar, heightChar);
+		plane->bitmap->update(x, y, widthChar, heightChar);
 		
-		m_currentPlaneX += widthChar;
+		_out.bitmap = plane->bitmap;
 		
-		if (heightChar > m_currentPlaneRowHeight) {
-			m_currentPlaneRowHeight = heightChar;
+		return m_map.put_NoLock(ch, _out) != sl_null;
+	}
+	
+	Sizei FontAtlas::_getCellSize(sl_char32 ch, const FontAtlasChar& fac)
+	{
+		if (m_flagDistanceField) {
+			sl_uint32 padding = m_distanceFieldSpread << 1;
+			return Sizei((sl_int32)(Math::ceil(fac.fontWidth)) + padding, (sl_int32)(Math::ceil(fac.fontHeight)) + padding);
 		}
-		
-		_out.bitmap = m_currentPlane;
-		
-		return m_map.put_NoLock(ch, _out);
-		
+		return m_fontDraw->measureSingleLineText(_priv_FontAtlas_getCharString(ch));
+	}
+	
+	_priv_FontAtlasPlane* FontAtlas::_allocateRegion(sl_uint32 width, sl_uint32 height, Rectanglei& _out)
+	{
+		if (width > m_planeWidth || height > m_planeHeight) {
+			return sl_null;
+		}
+		sl_uint64 stamp = ++m_stampUse;
+		_priv_FontAtlasPlane* planeLRU = sl_null;
+		ListElements< Ref<_priv_FontAtlasPlane> > planes(m_planes);
+		for (sl_size i = 0; i < planes.count; i++) {
+			_priv_FontAtlasPlane* plane = planes[i].get();
+			if (plane->allocate(width, height, _out)) {
+				plane->stampUse = stamp;
+				return plane;
+			}
+			if (!planeLRU || plane->stampUse < planeLRU->stampUse) {
+				planeLRU = plane;
+			}
+		}
+		if (planes.count < m_maxPlanes) {
+			Ref<_priv_FontAtlasPlane> plane = _priv_FontAtlasPlane::create(m_planeWidth, m_planeHeight, !m_flagDistanceField);
+			if (plane.isNotNull() && plane->allocate(width, height, _out)) {
+				m_planes.add_NoLock(plane);
+				plane->stampUse = stamp;
+				return plane.get();
+			}
+		}
+		if (planeLRU) {
+			_evictPlane(planeLRU);
+			if (planeLRU->allocate(width, height, _out)) {
+				planeLRU->stampUse = stamp;
+				return planeLRU;
+			}
+		}
+		return sl_null;
+	}
+	
+	void FontAtlas::_touchPlane(Bitmap* bitmap)
+	{
+		ListElements< Ref<_priv_FontAtlasPlane> > planes(m_planes);
+		for (sl_size i = 0; i < planes.count; i++) {
+			if (planes[i]->bitmap.get() == bitmap) {
+				planes[i]->stampUse = ++m_stampUse;
+				return;
+			}
+		}
+	}
+	
+	void FontAtlas::_evictPlane(_priv_FontAtlasPlane* plane)
+	{
+		// the sizes of the evicted glyphs are kept
+		HashMapNode<sl_char32, FontAtlasChar>* node = m_map.getFirstNode();
+		while (node) {
+			if (node->value.bitmap == plane->bitmap) {
+				node->value.bitmap.setNull();
+			}
+			node = node->getNext();
+		}
+		plane->reset();
 	}
 
 	void FontAtlas::removeAll()
 	{
 		ObjectLocker lock(this);
 		m_map.removeAll_NoLock();
-		m_countPlanes = 1;
-		m_currentPlaneX = 0;
-		m_currentPlaneY = 0;
-		m_currentPlaneRowHeight = 0;
+		sl_size n = m_planes.getCount();
+		if (n > 1) {
+			m_planes.removeRange_NoLock(1, n - 1);
+		}
+		if (n > 0) {
+			m_planes.getData()[0]->reset();
+		}
 	}
 
 }
@@ -30,6 +30,7 @@
 #include "freetype/ft2build.h"
 #include "freetype/freetype.h"
 #include "freetype/ftstroke.h"
+#include "freetype/ftoutln.h"
 
 namespace slib
 {
@@ -66,6 +67,18 @@ namespace slib
 	};
 
 
+	FreeTypeGlyphField::FreeTypeGlyphField()
+	{
+		left = 0;
+		top = 0;
+		advance = 0;
+	}
+	
+	FreeTypeGlyphField::~FreeTypeGlyphField()
+	{
+	}
+	
+	
 	SLIB_DEFINE_OBJECT(FreeType, Object)
 
 	FreeType::FreeType()
@@ -177,6 +190,247 @@ namespace slib
 		return getStringExtent(text.getData(), (sl_uint32)(text.getLength()));
 	}
 
+	sl_bool FreeType::getFontMetrics(FontMetrics& _out)
+	{
+		ObjectLocker lock(this);
+		FT_Size size = m_face->size;
+		if (!size) {
+			return sl_false;
+		}
+		sl_real ascent = (sl_real)(size->metrics.ascender) / 64.0f;
+		sl_real descent = -(sl_real)(size->metrics.descender) / 64.0f;
+		sl_real height = (sl_real)(size->metrics.height) / 64.0f;
+		_out.ascent = ascent;
+		_out.descent = descent;
+		_out.leading = height > ascent + descent ? height - ascent - descent : 0;
+		return sl_true;
+	}
+	
+	sl_real FreeType::getCharAdvance(sl_char32 ch)
+	{
+		ObjectLocker lock(this);
+		FT_UInt glyph_index = FT_Get_Char_Index(m_face, (FT_ULong)ch);
+		if (glyph_index > 0) {
+			if (FT_Load_Glyph(m_face, glyph_index, FT_LOAD_NO_BITMAP | FT_LOAD_NO_HINTING) == 0) {
+				return (sl_real)(m_face->glyph->advance.x) / 64.0f;
+			}
+		}
+		return 0;
+	}
+	
+	struct _priv_FreeType_Segment
+	{
+		float x0;
+		float y0;
+		float x1;
+		float y1;
+	};
+	
+	// flattens the outline into line segments (in pixels)
+	class _priv_FreeType_OutlineFlattener
+	{
+	public:
+		CList<_priv_FreeType_Segment> segments;
+		float x;
+		float y;
+		float xStart;
+		float yStart;
+		
+	public:
+		void lineTo(float tx, float ty)
+		{
+			if (tx != x || ty != y) {
+				_priv_FreeType_Segment seg;
+				seg.x0 = x;
+				seg.y0 = y;
+				seg.x1 = tx;
+				seg.y1 = ty;
+				segments.add_NoLock(seg);
+			}
+			x = tx;
+			y = ty;
+		}
+		
+		void closeContour()
+		{
+			if (segments.getCount()) {
+				lineTo(xStart, yStart);
+			}
+		}
+		
+		static float toPixel(FT_Pos v)
+		{
+			return (float)v / 64.0f;
+		}
+		
+		static int moveTo(const FT_Vector* to, void* user)
+		{
+			_priv_FreeType_OutlineFlattener* f = (_priv_FreeType_OutlineFlattener*)user;
+			f->closeContour();
+			f->x = f->xStart = toPixel(to->x);
+			f->y = f->yStart = toPixel(to->y);
+			return 0;
+		}
+		
+		static int lineTo(const FT_Vector* to, void* user)
+		{
+			_priv_FreeType_OutlineFlattener* f = (_priv_FreeType_OutlineFlattener*)user;
+			f->lineTo(toPixel(to->x), toPixel(to->y));
+			return 0;
+		}
+		
+		static int conicTo(const FT_Vector* control, const FT_Vector* to, void* user)
+		{
+			_priv_FreeType_OutlineFlattener* f = (_priv_FreeType_OutlineFlattener*)user;
+			float x0 = f->x, y0 = f->y;
+			float cx = toPixel(control->x), cy = toPixel(control->y);
+			float x1 = toPixel(to->x), y1 = toPixel(to->y);
+			int n = getCountOfSteps(x0, y0, cx, cy, x1, y1);
+			for (int i = 1; i <= n; i++) {
+				float t = (float)i / (float)n;
+				float s = 1 - t;
+				f->lineTo(s * s * x0 + 2 * s * t * cx + t * t * x1, s * s * y0 + 2 * s * t * cy + t * t * y1);
+			}
+			return 0;
+		}
+		
+		static int cubicTo(const FT_Vector* control1, const FT_Vector* control2, const FT_Vector* to, void* user)
+		{
+			_priv_FreeType_OutlineFlattener* f = (_priv_FreeType_OutlineFlattener*)user;
+			float x0 = f->x, y0 = f->y;
+			float cx1 = toPixel(control1->x), cy1 = toPixel(control1->y);
+			float cx2 = toPixel(control2->x), cy2 = toPixel(control2->y);
+			float x1 = toPixel(to->x), y1 = toPixel(to->y);
+			int n = getCountOfSteps(x0, y0, cx1, cy1, x1, y1) + getCountOfSteps(x0, y0, cx2, cy2, x1, y1);
+			for (int i = 1; i <= n; i++) {
+				float t = (float)i / (float)n;
+				float s = 1 - t;
+				float a = s * s * s, b = 3 * s * s * t, c = 3 * s * t * t, d = t * t * t;
+				f->lineTo(a * x0 + b * cx1 + c * cx2 + d * x1, a * y0 + b * cy1 + c * cy2 + d * y1);
+			}
+			return 0;
+		}
+		
+		// about one step per 2 pixels of the control polygon
+		static int getCountOfSteps(float x0, float y0, float cx, float cy, float x1, float y1)
+		{
+			float len = Math::sqrt((cx - x0) * (cx - x0) + (cy - y0) * (cy - y0)) + Math::sqrt((x1 - cx) * (x1 - cx) + (y1 - cy) * (y1 - cy));
+			int n = (int)(len / 2.0f) + 1;
+			if (n > 16) {
+				n = 16;
+			}
+			return n;
+		}
+		
+	};
+	
+	sl_bool FreeType::getGlyphDistanceField(sl_char32 ch, sl_uint32 spread, FreeTypeGlyphField& _out)
+	{
+		ObjectLocker lock(this);
+		if (!spread) {
+			spread = 1;
+		}
+		FT_UInt glyph_index = FT_Get_Char_Index(m_face, (FT_ULong)ch);
+		if (!glyph_index) {
+			return sl_false;
+		}
+		if (FT_Load_Glyph(m_face, glyph_index, FT_LOAD_NO_BITMAP | FT_LOAD_NO_HINTING)) {
+			return sl_false;
+		}
+		FT_GlyphSlot slot = m_face->glyph;
+		if (slot->format != FT_GLYPH_FORMAT_OUTLINE) {
+			return sl_false;
+		}
+		FT_Outline* outline = &(slot->outline);
+		_out.advance = (sl_real)(slot->advance.x) / 64.0f;
+		
+		_priv_FreeType_OutlineFlattener flattener;
+		flattener.x = flattener.y = flattener.xStart = flattener.yStart = 0;
+		FT_Outline_Funcs funcs;
+		funcs.move_to = &_priv_FreeType_OutlineFlattener::moveTo;
+		funcs.line_to = &_priv_FreeType_OutlineFlattener::lineTo;
+		funcs.conic_to = &_priv_FreeType_OutlineFlattener::conicTo;
+		funcs.cubic_to = &_priv_FreeType_OutlineFlattener::cubicTo;
+		funcs.shift = 0;
+		funcs.delta = 0;
+		if (FT_Outline_Decompose(outline, &funcs, &flattener)) {
+			return sl_false;
+		}
+		flattener.closeContour();
+		
+		FT_BBox box;
+		FT_Outline_Get_CBox(outline, &box);
+		sl_int32 left = (sl_int32)(box.xMin >> 6) - (sl_int32)spread;
+		sl_int32 right = (sl_int32)((box.xMax + 63) >> 6) + (sl_int32)spread;
+		sl_int32 bottom = (sl_int32)(box.yMin >> 6) - (sl_int32)spread;
+		sl_int32 top = (sl_int32)((box.yMax + 63) >> 6) + (sl_int32)spread;
+		sl_int32 width = right - left;
+		sl_int32 height = top - bottom;
+		if (width <= 0 || height <= 0) {
+			return sl_false;
+		}
+		Ref<Image> image = Image::create(width, height);
+		if (image.isNull()) {
+			return sl_false;
+		}
+		
+		_priv_FreeType_Segment* segments = flattener.segments.getData();
+		sl_size nSegments = flattener.segments.getCount();
+		sl_bool flagEvenOdd = (outline->flags & FT_OUTLINE_EVEN_ODD_FILL) != 0;
+		float fSpread = (float)spread;
+		
+		for (sl_int32 iy = 0; iy < height; iy++) {
+			Color* colors = image->getColorsAt(0, iy);
+			float py = (float)(top - iy) - 0.5f;
+			for (sl_int32 ix = 0; ix < width; ix++) {
+				float px = (float)(left + ix) + 0.5f;
+				float minDist2 = fSpread * fSpread;
+				sl_int32 winding = 0;
+				for (sl_size k = 0; k < nSegments; k++) {
+					_priv_FreeType_Segment& seg = segments[k];
+					float dx = seg.x1 - seg.x0;
+					float dy = seg.y1 - seg.y0;
+					float ex = px - seg.x0;
+					float ey = py - seg.y0;
+					float len2 = dx * dx + dy * dy;
+					float t = len2 > 0 ? (ex * dx + ey * dy) / len2 : 0;
+					if (t < 0) {
+						t = 0;
+					} else if (t > 1) {
+						t = 1;
+					}
+					float qx = ex - t * dx;
+					float qy = ey - t * dy;
+					float d2 = qx * qx + qy * qy;
+					if (d2 < minDist2) {
+						minDist2 = d2;
+					}
+					if ((seg.y0 <= py) != (seg.y1 <= py)) {
+						float xCross = seg.x0 + (py - seg.y0) * dx / dy;
+						if (xCross > px) {
+							winding += dy > 0 ? 1 : -1;
+						}
+					}
+				}
+				sl_bool flagInside = flagEvenOdd ? (winding & 1) : (winding != 0);
+				float dist = Math::sqrt(minDist2) / fSpread;
+				float v = flagInside ? 128.0f + dist * 127.0f : 128.0f - dist * 128.0f;
+				sl_int32 a = (sl_int32)(v + 0.5f);
+				if (a < 0) {
+					a = 0;
+				} else if (a > 255) {
+					a = 255;
+				}
+				colors[ix] = Color(255, 255, 255, (sl_uint8)a);
+			}
+		}
+		
+		_out.image = image;
+		_out.left = left;
+		_out.top = top;
+		return sl_true;
+	}
+
 	void FreeType::drawString(const Ref<Image>& imageOutput, sl_int32 x, sl_int32 y, const sl_char16* sz, sl_uint32 len, const Color& color)
 	{
 		ObjectLocker lock(this);
@@ -179,13 +179,12 @@ namespace slib
 		if (!len) {
 			return;
 		}
-		String16 s = String16::allocate(1);
-		sl_char16* t = s.getData();
-		for (sl_size i = 0; i < len; i++) {
-			sl_char16 ch = sz[i];
+		sl_size i = 0;
+		while (i < len) {
+			sl_size start = i;
+			sl_char32 ch = FontAtlas::readChar(sz, len, i);
 			Size size = atlas->getFontSize(ch);
-			t[0] = ch;
-			canvas->drawText16(s, x, y, font, color);
+			canvas->drawText16(String16(sz + start, i - start), x, y, font, color);
 			x += size.x;
 		}
 #else
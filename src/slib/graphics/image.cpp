@@ -25,6 +25,9 @@
 #include "slib/core/file.h"
 #include "slib/core/asset.h"
 #include "slib/core/scoped.h"
+#include "slib/core/thread_pool.h"
+
+#include "image_resample.h"
 
 namespace slib
 {
@@ -39,6 +42,16 @@ namespace slib
 	}
 	
 	
+	ImageInfo::ImageInfo()
+	: type(ImageFileType::Unknown), width(0), height(0)
+	{
+	}
+	
+	ImageInfo::~ImageInfo()
+	{
+	}
+	
+	
 	SLIB_DEFINE_OBJECT(Image, Bitmap)
 	
 	Image::Image()
@@ -1089,6 +1102,11 @@ namespace slib
 	};
 
 	void Image::draw(ImageDesc& dst, const ImageDesc& src, BlendMode blend, StretchMode stretch)
+	{
+		draw(dst, src, blend, stretch, sl_null);
+	}
+
+	void Image::draw(ImageDesc& dst, const ImageDesc& src, BlendMode blend, StretchMode stretch, const Ref<ThreadPool>& threadPool)
 	{
 		if (src.width == 0 || src.height == 0 || src.stride == 0 || src.colors == sl_null) {
 			return;
@@ -1104,6 +1122,10 @@ namespace slib
 			_priv_ImageStretch::template stretch<_priv_ImageStretch_FillColor>(dst, src, blend);
 			return;
 		}
+		if (_priv_ImageResample::isSupported(stretch)) {
+			_priv_ImageResample::resample(dst, src, blend, stretch, threadPool.get());
+			return;
+		}
 		if (stretch == StretchMode::Nearest) {
 			_priv_ImageStretch::template stretch<_priv_ImageStretch_Nearest>(dst, src, blend);
 		} else if (stretch == StretchMode::Linear) {
@@ -1241,11 +1263,16 @@ namespace slib
 	}
 
 	Ref<Image> Image::scale(sl_uint32 width, sl_uint32 height, StretchMode stretch) const
+	{
+		return scale(width, height, stretch, sl_null);
+	}
+
+	Ref<Image> Image::scale(sl_uint32 width, sl_uint32 height, StretchMode stretch, const Ref<ThreadPool>& threadPool) const
 	{
 		if (width > 0 && height > 0) {
 			Ref<Image> ret = Image::create(width, height);
 			if (ret.isNotNull()) {
-				draw(ret->m_desc, m_desc, BlendMode::Copy, stretch);
+				draw(ret->m_desc, m_desc, BlendMode::Copy, stretch, threadPool);
 			}
 			return ret;
 		}
@@ -1253,13 +1280,18 @@ namespace slib
 	}
 
 	Ref<Image> Image::scaleToSmall(sl_uint32 requiredWidth, sl_uint32 requiredHeight, StretchMode stretch) const
+	{
+		return scaleToSmall(requiredWidth, requiredHeight, stretch, sl_null);
+	}
+
+	Ref<Image> Image::scaleToSmall(sl_uint32 requiredWidth, sl_uint32 requiredHeight, StretchMode stretch, const Ref<ThreadPool>& threadPool) const
 	{
 		sl_uint32 width = SLIB_MIN(requiredWidth, m_desc.width);
 		sl_uint32 height = SLIB_MIN(requiredHeight, m_desc.height);
 		if (width > 0 && height > 0) {
 			Ref<Image> ret = Image::create(width, height);
 			if (ret.isNotNull()) {
-				draw(ret->m_desc, m_desc, BlendMode::Copy, stretch);
+				draw(ret->m_desc, m_desc, BlendMode::Copy, stretch, threadPool);
 			}
 			return ret;
 		}
@@ -1292,14 +1324,46 @@ namespace slib
 		return getFileType(mem.getData(), mem.getSize());
 	}
 
+	sl_bool Image::getImageInfo(Memory mem, ImageInfo& info)
+	{
+		return getImageInfo(mem.getData(), mem.getSize(), info);
+	}
+
+	sl_bool Image::getImageInfoFromFile(const String& filePath, ImageInfo& info)
+	{
+		// the header is usually in the first block, unless large metadata precedes the frame header
+		const sl_size sizeHeaderBlock = 65536;
+		Memory mem = File::readAllBytes(filePath, sizeHeaderBlock);
+		if (mem.isNull()) {
+			return sl_false;
+		}
+		if (getImageInfo(mem, info)) {
+			return sl_true;
+		}
+		if (mem.getSize() < sizeHeaderBlock) {
+			return sl_false;
+		}
+		return getImageInfo(File::readAllBytes(filePath), info);
+	}
+
 	Ref<Image> Image::loadFromMemory(const void* mem, sl_size size, sl_uint32 width, sl_uint32 height)
 	{
-		Ref<Image> ret = loadSTB(mem, size);
+		if (width == 0 || height == 0) {
+			return loadSTB(mem, size);
+		}
+		// reduce the size while decoding, instead of decoding the full image before scaling
+		Ref<Image> ret;
+		ImageFileType type = getFileType(mem, size);
+		if (type == ImageFileType::JPEG) {
+			ret = loadJPEG(mem, size, width, height);
+		} else if (type == ImageFileType::PNG) {
+			ret = loadPNG(mem, size, width, height);
+		}
+		if (ret.isNull()) {
+			ret = loadSTB(mem, size);
+		}
 		if (ret.isNotNull()) {
-			if (width == 0 || height == 0) {
-				return ret;
-			}
-			if (ret->getWidth() != width && ret->getHeight() != height) {
+			if (ret->getWidth() != width || ret->getHeight() != height) {
 				ret = ret->scale(width, height);
 			}
 			return ret;
@@ -1333,7 +1397,7 @@ namespace slib
 			if (width == 0 || height == 0) {
 				return ret;
 			}
-			if (ret->getWidth() != width && ret->getHeight() != height) {
+			if (ret->getWidth() != width || ret->getHeight() != height) {
 				ret = ret->scale(width, height);
 			}
 			return ret;
@@ -21,6 +21,7 @@
  */
 
 #include "slib/graphics/image.h"
+#include "slib/graphics/image_stream.h"
 
 #include "slib/core/file.h"
 #include "slib/core/scoped.h"
@@ -51,7 +52,21 @@ namespace slib
 		longjmp(err->setjmp_buffer, 1);
 	}
 
-	Ref<Image> Image::loadJPEG(const void* content, sl_size size)
+	// smallest N (of N/8) that keeps the required size
+	static sl_uint32 _slib_image_jpeg_get_scale(sl_uint32 width, sl_uint32 height, sl_uint32 requiredWidth, sl_uint32 requiredHeight)
+	{
+		if (!requiredWidth && !requiredHeight) {
+			return 8;
+		}
+		for (sl_uint32 n = 1; n < 8; n++) {
+			if ((width * n + 7) / 8 >= requiredWidth && (height * n + 7) / 8 >= requiredHeight) {
+				return n;
+			}
+		}
+		return 8;
+	}
+
+	static Ref<Image> _slib_image_jpeg_load(const void* content, sl_size size, const Rectanglei* region, sl_uint32 requiredWidth, sl_uint32 requiredHeight)
 	{
 		jpeg_decompress_struct cinfo;
 		_slib_image_ext_jpeg_error_mgr jerr;
@@ -73,38 +88,375 @@ namespace slib
 
 		cinfo.out_color_space = JCS_RGB;
 
+		// region in source pixels
+		sl_uint32 left = 0;
+		sl_uint32 top = 0;
+		sl_uint32 right = cinfo.image_width;
+		sl_uint32 bottom = cinfo.image_height;
+		if (region) {
+			if (region->left > 0) {
+				left = region->left;
+			}
+			if (region->top > 0) {
+				top = region->top;
+			}
+			if (region->right < (sl_int32)right) {
+				right = region->right < 0 ? 0 : region->right;
+			}
+			if (region->bottom < (sl_int32)bottom) {
+				bottom = region->bottom < 0 ? 0 : region->bottom;
+			}
+			if (left >= right || top >= bottom) {
+				jpeg_destroy_decompress(&cinfo);
+				return sl_null;
+			}
+		}
+
+		sl_uint32 scale = _slib_image_jpeg_get_scale(right - left, bottom - top, requiredWidth, requiredHeight);
+		if (scale < 8) {
+			cinfo.scale_num = scale;
+			cinfo.scale_denom = 8;
+			cinfo.dct_method = JDCT_IFAST;
+			cinfo.do_fancy_upsampling = 0;
+		}
+
 		jpeg_start_decompress(&cinfo);
 
-		sl_uint32 width = cinfo.output_width;
-		sl_uint32 height = cinfo.output_height;
-		ret = Image::create(width, height);
-		if (ret.isNotNull()) {
-			JSAMPROW row_pointer[1];
-			SLIB_SCOPED_BUFFER(sl_uint8, 4096, row, width*3);
-			if (row) {
-				row_pointer[0] = (JSAMPROW)(row);
-				Color* pixels = ret->getColors();
-				sl_uint32 stride = ret->getStride();
-				while (cinfo.output_scanline < height) {
-					jpeg_read_scanlines(&cinfo, row_pointer, 1);
-					sl_uint8* p = row;
-					for (sl_uint32 i = 0; i < width; i++) {
-						pixels[i].r = *(p++);
-						pixels[i].g = *(p++);
-						pixels[i].b = *(p++);
-						pixels[i].a = 255;
+		sl_uint32 outputWidth = cinfo.output_width;
+		sl_uint32 outputHeight = cinfo.output_height;
+		sl_uint32 x0 = left * scale / 8;
+		sl_uint32 y0 = top * scale / 8;
+		sl_uint32 x1 = SLIB_MIN(outputWidth, (right * scale + 7) / 8);
+		sl_uint32 y1 = SLIB_MIN(outputHeight, (bottom * scale + 7) / 8);
+		if (x0 < x1 && y0 < y1) {
+			sl_uint32 width = x1 - x0;
+			ret = Image::create(width, y1 - y0);
+			if (ret.isNotNull()) {
+				JSAMPROW row_pointer[1];
+				SLIB_SCOPED_BUFFER(sl_uint8, 4096, row, outputWidth*3);
+				if (row) {
+					row_pointer[0] = (JSAMPROW)(row);
+					Color* pixels = ret->getColors();
+					sl_uint32 stride = ret->getStride();
+					while (cinfo.output_scanline < y1) {
+						sl_uint32 y = cinfo.output_scanline;
+						jpeg_read_scanlines(&cinfo, row_pointer, 1);
+						if (y < y0) {
+							continue;
+						}
+						sl_uint8* p = row + x0 * 3;
+						for (sl_uint32 i = 0; i < width; i++) {
+							pixels[i].r = *(p++);
+							pixels[i].g = *(p++);
+							pixels[i].b = *(p++);
+							pixels[i].a = 255;
+						}
+						pixels += stride;
 					}
-					pixels += stride;
 				}
 			}
 		}
 
-		jpeg_finish_decompress(&cinfo);
+		if (cinfo.output_scanline < outputHeight) {
+			// remaining rows are out of the region
+			jpeg_abort_decompress(&cinfo);
+		} else {
+			jpeg_finish_decompress(&cinfo);
+		}
 		jpeg_destroy_decompress(&cinfo);
 
 		return ret;
 	}
 
+	Ref<Image> Image::loadJPEG(const void* content, sl_size size)
+	{
+		return _slib_image_jpeg_load(content, size, sl_null, 0, 0);
+	}
+
+	Ref<Image> Image::loadJPEG(const void* content, sl_size size, sl_uint32 requiredWidth, sl_uint32 requiredHeight)
+	{
+		return _slib_image_jpeg_load(content, size, sl_null, requiredWidth, requiredHeight);
+	}
+
+	Ref<Image> Image::loadJPEG(const void* content, sl_size size, const Rectanglei& region, sl_uint32 requiredWidth, sl_uint32 requiredHeight)
+	{
+		return _slib_image_jpeg_load(content, size, &region, requiredWidth, requiredHeight);
+	}
+
+#define SLIB_IMAGE_JPEG_STREAM_BUFFER_SIZE 4096
+
+	struct _slib_image_jpeg_stream_source
+	{
+		jpeg_source_mgr pub;
+		IReader* reader;
+		sl_bool flagStarted;
+		sl_bool flagPrematureEnd;
+		JOCTET buffer[SLIB_IMAGE_JPEG_STREAM_BUFFER_SIZE];
+	};
+
+	static void _slib_image_jpeg_stream_init_source(j_decompress_ptr cinfo)
+	{
+	}
+
+	static boolean _slib_image_jpeg_stream_fill_input_buffer(j_decompress_ptr cinfo)
+	{
+		_slib_image_jpeg_stream_source* src = (_slib_image_jpeg_stream_source*)(cinfo->src);
+		sl_reg n = src->reader->read(src->buffer, SLIB_IMAGE_JPEG_STREAM_BUFFER_SIZE);
+		if (n <= 0) {
+			if (!(src->flagStarted)) {
+				(*(cinfo->err->error_exit))((j_common_ptr)cinfo);
+			}
+			// premature end of stream: inserts EOI marker to let the decoder finish, and fails the decoding later
+			src->flagPrematureEnd = sl_true;
+			src->buffer[0] = (JOCTET)0xFF;
+			src->buffer[1] = (JOCTET)JPEG_EOI;
+			n = 2;
+		}
+		src->pub.next_input_byte = src->buffer;
+		src->pub.bytes_in_buffer = (size_t)n;
+		src->flagStarted = sl_true;
+		return 1;
+	}
+
+	static void _slib_image_jpeg_stream_skip_input_data(j_decompress_ptr cinfo, long num_bytes)
+	{
+		jpeg_source_mgr* src = cinfo->src;
+		if (num_bytes > 0) {
+			while (num_bytes > (long)(src->bytes_in_buffer)) {
+				num_bytes -= (long)(src->bytes_in_buffer);
+				(*(src->fill_input_buffer))(cinfo);
+			}
+			src->next_input_byte += (size_t)num_bytes;
+			src->bytes_in_buffer -= (size_t)num_bytes;
+		}
+	}
+
+	static void _slib_image_jpeg_stream_term_source(j_decompress_ptr cinfo)
+	{
+	}
+
+	struct _slib_image_jpeg_stream_destination
+	{
+		jpeg_destination_mgr pub;
+		IWriter* writer;
+		JOCTET buffer[SLIB_IMAGE_JPEG_STREAM_BUFFER_SIZE];
+	};
+
+	static void _slib_image_jpeg_stream_init_destination(j_compress_ptr cinfo)
+	{
+		_slib_image_jpeg_stream_destination* dest = (_slib_image_jpeg_stream_destination*)(cinfo->dest);
+		dest->pub.next_output_byte = dest->buffer;
+		dest->pub.free_in_buffer = SLIB_IMAGE_JPEG_STREAM_BUFFER_SIZE;
+	}
+
+	static boolean _slib_image_jpeg_stream_empty_output_buffer(j_compress_ptr cinfo)
+	{
+		_slib_image_jpeg_stream_destination* dest = (_slib_image_jpeg_stream_destination*)(cinfo->dest);
+		if (dest->writer->writeFully(dest->buffer, SLIB_IMAGE_JPEG_STREAM_BUFFER_SIZE) != SLIB_IMAGE_JPEG_STREAM_BUFFER_SIZE) {
+			(*(cinfo->err->error_exit))((j_common_ptr)cinfo);
+		}
+		dest->pub.next_output_byte = dest->buffer;
+		dest->pub.free_in_buffer = SLIB_IMAGE_JPEG_STREAM_BUFFER_SIZE;
+		return 1;
+	}
+
+	static void _slib_image_jpeg_stream_term_destination(j_compress_ptr cinfo)
+	{
+		_slib_image_jpeg_stream_destination* dest = (_slib_image_jpeg_stream_destination*)(cinfo->dest);
+		sl_reg n = (sl_reg)(SLIB_IMAGE_JPEG_STREAM_BUFFER_SIZE - dest->pub.free_in_buffer);
+		if (n > 0) {
+			if (dest->writer->writeFully(dest->buffer, n) != n) {
+				(*(cinfo->err->error_exit))((j_common_ptr)cinfo);
+			}
+		}
+	}
+
+	sl_bool ImageRowDecoder::decodeJPEG(IReader* reader, IImageRowWriter* output)
+	{
+		if (!reader || !output) {
+			return sl_false;
+		}
+
+		jpeg_decompress_struct cinfo;
+		_slib_image_ext_jpeg_error_mgr jerr;
+		cinfo.err = jpeg_std_error(&(jerr.pub));
+		jerr.pub.error_exit = _slib_image_jpeg_error_exit;
+
+		_slib_image_jpeg_stream_source src;
+		src.pub.init_source = _slib_image_jpeg_stream_init_source;
+		src.pub.fill_input_buffer = _slib_image_jpeg_stream_fill_input_buffer;
+		src.pub.skip_input_data = _slib_image_jpeg_stream_skip_input_data;
+		src.pub.resync_to_restart = jpeg_resync_to_restart;
+		src.pub.term_source = _slib_image_jpeg_stream_term_source;
+		src.pub.next_input_byte = sl_null;
+		src.pub.bytes_in_buffer = 0;
+		src.reader = reader;
+		src.flagStarted = sl_false;
+		src.flagPrematureEnd = sl_false;
+
+		Memory memRow;
+
+		if (setjmp(jerr.setjmp_buffer)) {
+			jpeg_destroy_decompress(&cinfo);
+			return sl_false;
+		}
+
+		jpeg_create_decompress(&cinfo);
+		cinfo.src = &(src.pub);
+
+		jpeg_read_header(&cinfo, 1);
+
+		cinfo.out_color_space = JCS_RGB;
+
+		jpeg_start_decompress(&cinfo);
+
+		sl_uint32 width = cinfo.output_width;
+		sl_uint32 height = cinfo.output_height;
+		memRow = Memory::create((sl_size)width * 7);
+		if (memRow.isNull() || !(output->beginImage(width, height))) {
+			jpeg_destroy_decompress(&cinfo);
+			return sl_false;
+		}
+		Color* colors = (Color*)(memRow.getData());
+		sl_uint8* row = (sl_uint8*)(colors + width);
+		JSAMPROW row_pointer[1];
+		row_pointer[0] = (JSAMPROW)(row);
+		while (cinfo.output_scanline < height) {
+			jpeg_read_scanlines(&cinfo, row_pointer, 1);
+			sl_uint8* p = row;
+			for (sl_uint32 i = 0; i < width; i++) {
+				colors[i].r = *(p++);
+				colors[i].g = *(p++);
+				colors[i].b = *(p++);
+				colors[i].a = 255;
+			}
+			if (src.flagPrematureEnd || !(output->writeRow(colors))) {
+				jpeg_destroy_decompress(&cinfo);
+				return sl_false;
+			}
+		}
+
+		jpeg_finish_decompress(&cinfo);
+		jpeg_destroy_decompress(&cinfo);
+
+		if (src.flagPrematureEnd) {
+			return sl_false;
+		}
+		return output->endImage();
+	}
+
+	class _slib_image_jpeg_stream_encoder : public ImageRowEncoder
+	{
+	public:
+		jpeg_compress_struct m_cinfo;
+		_slib_image_ext_jpeg_error_mgr m_jerr;
+		_slib_image_jpeg_stream_destination m_dest;
+		float m_quality;
+		Memory m_row;
+		sl_bool m_flagCreated;
+		sl_bool m_flagError;
+
+	public:
+		_slib_image_jpeg_stream_encoder(IWriter* writer, float quality)
+		{
+			m_cinfo.err = jpeg_std_error(&(m_jerr.pub));
+			m_jerr.pub.error_exit = _slib_image_jpeg_error_exit;
+			m_dest.pub.init_destination = _slib_image_jpeg_stream_init_destination;
+			m_dest.pub.empty_output_buffer = _slib_image_jpeg_stream_empty_output_buffer;
+			m_dest.pub.term_destination = _slib_image_jpeg_stream_term_destination;
+			m_dest.writer = writer;
+			m_quality = quality;
+			m_flagCreated = sl_false;
+			m_flagError = sl_false;
+		}
+
+		~_slib_image_jpeg_stream_encoder()
+		{
+			if (m_flagCreated) {
+				jpeg_destroy_compress(&m_cinfo);
+			}
+		}
+
+	public:
+		sl_bool beginImage(sl_uint32 width, sl_uint32 height) override
+		{
+			if (m_flagCreated || !width || !height) {
+				return sl_false;
+			}
+			m_row = Memory::create((sl_size)width * 3);
+			if (m_row.isNull()) {
+				return sl_false;
+			}
+			if (setjmp(m_jerr.setjmp_buffer)) {
+				m_flagError = sl_true;
+				return sl_false;
+			}
+			jpeg_create_compress(&m_cinfo);
+			m_flagCreated = sl_true;
+			m_cinfo.dest = &(m_dest.pub);
+			m_cinfo.image_width = (JDIMENSION)width;
+			m_cinfo.image_height = (JDIMENSION)height;
+			m_cinfo.input_components = 3;
+			m_cinfo.in_color_space = JCS_RGB;
+			jpeg_set_defaults(&m_cinfo);
+			sl_int32 q = (sl_int32)(m_quality * 100);
+			if (q < 0) {
+				q = 0;
+			}
+			if (q > 100) {
+				q = 100;
+			}
+			jpeg_set_quality(&m_cinfo, (int)q, 1 /* limit to baseline-JPEG values */);
+			jpeg_start_compress(&m_cinfo, 1);
+			return sl_true;
+		}
+
+		sl_bool writeRow(const Color* colors) override
+		{
+			if (!m_flagCreated || m_flagError || m_cinfo.next_scanline >= m_cinfo.image_height) {
+				return sl_false;
+			}
+			if (setjmp(m_jerr.setjmp_buffer)) {
+				m_flagError = sl_true;
+				return sl_false;
+			}
+			sl_uint32 width = m_cinfo.image_width;
+			sl_uint8* row = (sl_uint8*)(m_row.getData());
+			sl_uint8* p = row;
+			for (sl_uint32 i = 0; i < width; i++) {
+				*(p++) = colors[i].r;
+				*(p++) = colors[i].g;
+				*(p++) = colors[i].b;
+			}
+			JSAMPROW row_pointer[1];
+			row_pointer[0] = (JSAMPROW)(row);
+			jpeg_write_scanlines(&m_cinfo, row_pointer, 1);
+			return sl_true;
+		}
+
+		sl_bool endImage() override
+		{
+			if (!m_flagCreated || m_flagError || m_cinfo.next_scanline < m_cinfo.image_height) {
+				return sl_false;
+			}
+			if (setjmp(m_jerr.setjmp_buffer)) {
+				m_flagError = sl_true;
+				return sl_false;
+			}
+			jpeg_finish_compress(&m_cinfo);
+			return sl_true;
+		}
+
+	};
+
+	Ref<ImageRowEncoder> ImageRowEncoder::createJPEG(IWriter* writer, float quality)
+	{
+		if (writer) {
+			return new _slib_image_jpeg_stream_encoder(writer, quality);
+		}
+		return sl_null;
+	}
+
 	Memory Image::saveJPEG(const Ref<Image>& image, float quality)
 	{
 		if (image.isNull()) {
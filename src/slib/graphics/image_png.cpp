@@ -21,6 +21,7 @@
  */
 
 #include "slib/graphics/image.h"
+#include "slib/graphics/image_stream.h"
 
 #include "slib/core/file.h"
 
@@ -59,6 +60,213 @@ namespace slib
 		return ret;
 	}
 
+	struct _slib_image_png_mem_reader
+	{
+		const sl_uint8* data;
+		sl_size size;
+		sl_size offset;
+	};
+
+	static void _slib_image_png_mem_read_callback(png_structp png_ptr, png_bytep data, png_size_t length)
+	{
+		_slib_image_png_mem_reader* reader = (_slib_image_png_mem_reader*)(png_get_io_ptr(png_ptr));
+		if (length > reader->size - reader->offset) {
+			png_error(png_ptr, "unexpected end of data");
+		}
+		Base::copyMemory(data, reader->data + reader->offset, length);
+		reader->offset += length;
+	}
+
+	static void _slib_image_png_decode_warning(png_structp png_ptr, png_const_charp warning_message)
+	{
+	}
+
+	// decodes row by row into RGBA, accumulating `factor` x `factor` boxes of `region`
+	static Ref<Image> _slib_image_png_load(const void* content, sl_size size, const Rectanglei* region, sl_uint32 requiredWidth, sl_uint32 requiredHeight)
+	{
+		png_structp png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, _slib_image_png_decode_warning);
+		if (!png_ptr) {
+			return sl_null;
+		}
+		png_infop info_ptr = png_create_info_struct(png_ptr);
+		if (!info_ptr) {
+			png_destroy_read_struct(&png_ptr, NULL, NULL);
+			return sl_null;
+		}
+
+		Ref<Image> ret;
+		Memory memRow;
+		Memory memSum;
+
+		if (setjmp(png_jmpbuf(png_ptr))) {
+			png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+			return sl_null;
+		}
+
+		_slib_image_png_mem_reader reader;
+		reader.data = (const sl_uint8*)content;
+		reader.size = size;
+		reader.offset = 0;
+		png_set_read_fn(png_ptr, &reader, _slib_image_png_mem_read_callback);
+
+		png_read_info(png_ptr, info_ptr);
+
+		png_uint_32 imageWidth = 0;
+		png_uint_32 imageHeight = 0;
+		int bitDepth = 0;
+		int colorType = 0;
+		int interlaceType = 0;
+		png_get_IHDR(png_ptr, info_ptr, &imageWidth, &imageHeight, &bitDepth, &colorType, &interlaceType, NULL, NULL);
+
+		if (interlaceType != PNG_INTERLACE_NONE) {
+			// rows of interlaced image are completed only at the last pass
+			png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+			Ref<Image> image = Image::loadPNG(content, size);
+			if (image.isNull()) {
+				return sl_null;
+			}
+			if (region) {
+				Rectanglei rc = *region;
+				if (!(rc.intersectRectangle(Rectanglei(0, 0, image->getWidth(), image->getHeight()), &rc))) {
+					return sl_null;
+				}
+				image = image->sub(rc.left, rc.top, rc.getWidth(), rc.getHeight());
+			}
+			return image;
+		}
+
+		png_set_expand(png_ptr);
+		png_set_strip_16(png_ptr);
+		png_set_gray_to_rgb(png_ptr);
+		png_set_filler(png_ptr, 0xff, PNG_FILLER_AFTER);
+		png_read_update_info(png_ptr, info_ptr);
+		if (png_get_rowbytes(png_ptr, info_ptr) != (png_size_t)imageWidth * 4) {
+			png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+			return sl_null;
+		}
+
+		sl_uint32 left = 0;
+		sl_uint32 top = 0;
+		sl_uint32 right = imageWidth;
+		sl_uint32 bottom = imageHeight;
+		if (region) {
+			if (region->left > 0) {
+				left = region->left;
+			}
+			if (region->top > 0) {
+				top = region->top;
+			}
+			if (region->right < (sl_int32)right) {
+				right = region->right < 0 ? 0 : region->right;
+			}
+			if (region->bottom < (sl_int32)bottom) {
+				bottom = region->bottom < 0 ? 0 : region->bottom;
+			}
+			if (left >= right || top >= bottom) {
+				png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+				return sl_null;
+			}
+		}
+		sl_uint32 regionWidth = right - left;
+		sl_uint32 regionHeight = bottom - top;
+
+		sl_uint32 factor = 0;
+		if (requiredWidth) {
+			factor = regionWidth / requiredWidth;
+		}
+		if (requiredHeight) {
+			sl_uint32 f = regionHeight / requiredHeight;
+			if (!factor || f < factor) {
+				factor = f;
+			}
+		}
+		if (!factor) {
+			factor = 1;
+		}
+		sl_uint32 width = (regionWidth + factor - 1) / factor;
+		sl_uint32 height = (regionHeight + factor - 1) / factor;
+
+		ret = Image::create(width, height);
+		memRow = Memory::create((sl_size)imageWidth * 4);
+		if (factor > 1) {
+			memSum = Memory::create(sizeof(sl_uint32) * 4 * width);
+		}
+		if (ret.isNull() || memRow.isNull() || (factor > 1 && memSum.isNull())) {
+			png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+			return sl_null;
+		}
+		sl_uint8* row = (sl_uint8*)(memRow.getData());
+		sl_uint32* sum = (sl_uint32*)(memSum.getData());
+		if (sum) {
+			Base::zeroMemory(sum, sizeof(sl_uint32) * 4 * width);
+		}
+
+		Color* pixels = ret->getColors();
+		sl_uint32 stride = ret->getStride();
+		for (sl_uint32 y = 0; y < bottom; y++) {
+			png_read_row(png_ptr, (png_bytep)row, NULL);
+			if (y < top) {
+				continue;
+			}
+			const sl_uint8* p = row + left * 4;
+			if (factor == 1) {
+				Base::copyMemory(pixels, p, (sl_size)width * 4);
+				pixels += stride;
+				continue;
+			}
+			sl_uint32* s = sum;
+			sl_uint32 nRemain = regionWidth;
+			for (sl_uint32 i = 0; i < width; i++) {
+				sl_uint32 n = SLIB_MIN(factor, nRemain);
+				for (sl_uint32 k = 0; k < n; k++) {
+					s[0] += p[0];
+					s[1] += p[1];
+					s[2] += p[2];
+					s[3] += p[3];
+					p += 4;
+				}
+				nRemain -= n;
+				s += 4;
+			}
+			sl_uint32 yBox = y - top + 1;
+			if (yBox % factor == 0 || y + 1 == bottom) {
+				sl_uint32 nRows = yBox % factor;
+				if (!nRows) {
+					nRows = factor;
+				}
+				s = sum;
+				nRemain = regionWidth;
+				for (sl_uint32 i = 0; i < width; i++) {
+					sl_uint32 n = SLIB_MIN(factor, nRemain) * nRows;
+					sl_uint32 half = n >> 1;
+					pixels[i].r = (sl_uint8)((s[0] + half) / n);
+					pixels[i].g = (sl_uint8)((s[1] + half) / n);
+					pixels[i].b = (sl_uint8)((s[2] + half) / n);
+					pixels[i].a = (sl_uint8)((s[3] + half) / n);
+					nRemain -= SLIB_MIN(factor, nRemain);
+					s += 4;
+				}
+				Base::zeroMemory(sum, sizeof(sl_uint32) * 4 * width);
+				pixels += stride;
+			}
+		}
+
+		// the rows below the region are not read
+		png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+
+		return ret;
+	}
+
+	Ref<Image> Image::loadPNG(const void* content, sl_size size, sl_uint32 requiredWidth, sl_uint32 requiredHeight)
+	{
+		return _slib_image_png_load(content, size, sl_null, requiredWidth, requiredHeight);
+	}
+
+	Ref<Image> Image::loadPNG(const void* content, sl_size size, const Rectanglei& region, sl_uint32 requiredWidth, sl_uint32 requiredHeight)
+	{
+		return _slib_image_png_load(content, size, &region, requiredWidth, requiredHeight);
+	}
+
 	static void _slib_image_png_mem_write_callback(png_structp png_ptr, png_bytep data, png_size_t length)
 	{
 		if (png_ptr == NULL)
@@ -71,6 +279,201 @@ namespace slib
 	{
 	}
 
+	static void _slib_image_png_stream_read_callback(png_structp png_ptr, png_bytep data, png_size_t length)
+	{
+		IReader* reader = (IReader*)(png_get_io_ptr(png_ptr));
+		if (reader->readFully(data, length) != (sl_reg)length) {
+			png_error(png_ptr, "unexpected end of stream");
+		}
+	}
+
+	static void _slib_image_png_stream_write_callback(png_structp png_ptr, png_bytep data, png_size_t length)
+	{
+		IWriter* writer = (IWriter*)(png_get_io_ptr(png_ptr));
+		if (writer->writeFully(data, length) != (sl_reg)length) {
+			png_error(png_ptr, "failed to write");
+		}
+	}
+
+	static void _slib_image_png_stream_flush_callback(png_structp png_ptr)
+	{
+	}
+
+	sl_bool ImageRowDecoder::decodePNG(IReader* reader, IImageRowWriter* output)
+	{
+		if (!reader || !output) {
+			return sl_false;
+		}
+		png_structp png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, _slib_image_png_decode_warning);
+		if (!png_ptr) {
+			return sl_false;
+		}
+		png_infop info_ptr = png_create_info_struct(png_ptr);
+		if (!info_ptr) {
+			png_destroy_read_struct(&png_ptr, NULL, NULL);
+			return sl_false;
+		}
+
+		Memory memRows;
+
+		if (setjmp(png_jmpbuf(png_ptr))) {
+			png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+			return sl_false;
+		}
+
+		png_set_read_fn(png_ptr, reader, _slib_image_png_stream_read_callback);
+
+		png_read_info(png_ptr, info_ptr);
+
+		png_uint_32 width = 0;
+		png_uint_32 height = 0;
+		int bitDepth = 0;
+		int colorType = 0;
+		int interlaceType = 0;
+		png_get_IHDR(png_ptr, info_ptr, &width, &height, &bitDepth, &colorType, &interlaceType, NULL, NULL);
+
+		png_set_expand(png_ptr);
+		png_set_strip_16(png_ptr);
+		png_set_gray_to_rgb(png_ptr);
+		png_set_filler(png_ptr, 0xff, PNG_FILLER_AFTER);
+		int nPasses = png_set_interlace_handling(png_ptr);
+		png_read_update_info(png_ptr, info_ptr);
+		if (png_get_rowbytes(png_ptr, info_ptr) != (png_size_t)width * 4) {
+			png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+			return sl_false;
+		}
+
+		// rows of interlaced image are completed only at the last pass, so the whole image is buffered
+		sl_uint32 nRows = nPasses > 1 ? height : 1;
+		memRows = Memory::create((sl_size)width * 4 * nRows);
+		if (memRows.isNull() || !(output->beginImage(width, height))) {
+			png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+			return sl_false;
+		}
+		sl_uint8* rows = (sl_uint8*)(memRows.getData());
+		sl_size pitch = (sl_size)width * 4;
+		if (nPasses > 1) {
+			for (int pass = 0; pass < nPasses; pass++) {
+				for (sl_uint32 y = 0; y < height; y++) {
+					png_read_row(png_ptr, (png_bytep)(rows + y * pitch), NULL);
+				}
+			}
+			for (sl_uint32 y = 0; y < height; y++) {
+				if (!(output->writeRow((Color*)(rows + y * pitch)))) {
+					png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+					return sl_false;
+				}
+			}
+		} else {
+			for (sl_uint32 y = 0; y < height; y++) {
+				png_read_row(png_ptr, (png_bytep)rows, NULL);
+				if (!(output->writeRow((Color*)rows))) {
+					png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+					return sl_false;
+				}
+			}
+		}
+
+		png_read_end(png_ptr, NULL);
+		png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+
+		return output->endImage();
+	}
+
+	class _slib_image_png_stream_encoder : public ImageRowEncoder
+	{
+	public:
+		png_structp m_png;
+		png_infop m_info;
+		IWriter* m_writer;
+		sl_uint32 m_height;
+		sl_uint32 m_nRowsWritten;
+		sl_bool m_flagError;
+
+	public:
+		_slib_image_png_stream_encoder(IWriter* writer)
+		{
+			m_png = sl_null;
+			m_info = sl_null;
+			m_writer = writer;
+			m_height = 0;
+			m_nRowsWritten = 0;
+			m_flagError = sl_false;
+		}
+
+		~_slib_image_png_stream_encoder()
+		{
+			if (m_png) {
+				png_destroy_write_struct(&m_png, &m_info);
+			}
+		}
+
+	public:
+		sl_bool beginImage(sl_uint32 width, sl_uint32 height) override
+		{
+			if (m_png || !width || !height) {
+				return sl_false;
+			}
+			m_png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, _slib_image_png_encode_warning);
+			if (!m_png) {
+				return sl_false;
+			}
+			if (setjmp(png_jmpbuf(m_png))) {
+				m_flagError = sl_true;
+				return sl_false;
+			}
+			m_info = png_create_info_struct(m_png);
+			if (!m_info) {
+				m_flagError = sl_true;
+				return sl_false;
+			}
+			png_set_write_fn(m_png, m_writer, _slib_image_png_stream_write_callback, _slib_image_png_stream_flush_callback);
+			png_set_IHDR(m_png, m_info
+				, (png_uint_32)width, (png_uint_32)height
+				, 8, PNG_COLOR_TYPE_RGB_ALPHA
+				, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
+			png_write_info(m_png, m_info);
+			m_height = height;
+			return sl_true;
+		}
+
+		sl_bool writeRow(const Color* colors) override
+		{
+			if (!m_png || m_flagError || m_nRowsWritten >= m_height) {
+				return sl_false;
+			}
+			if (setjmp(png_jmpbuf(m_png))) {
+				m_flagError = sl_true;
+				return sl_false;
+			}
+			png_write_row(m_png, (png_const_bytep)colors);
+			m_nRowsWritten++;
+			return sl_true;
+		}
+
+		sl_bool endImage() override
+		{
+			if (!m_png || m_flagError || m_nRowsWritten < m_height) {
+				return sl_false;
+			}
+			if (setjmp(png_jmpbuf(m_png))) {
+				m_flagError = sl_true;
+				return sl_false;
+			}
+			png_write_end(m_png, NULL);
+			return sl_true;
+		}
+
+	};
+
+	Ref<ImageRowEncoder> ImageRowEncoder::createPNG(IWriter* writer)
+	{
+		if (writer) {
+			return new _slib_image_png_stream_encoder(writer);
+		}
+		return sl_null;
+	}
+
 	Memory Image::savePNG(const Ref<Image>& image)
 	{
 		if (image.isNull()) {
@@ -0,0 +1,471 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#include "image_resample.h"
+
+#include "slib/core/thread_pool.h"
+#include "slib/core/event.h"
+#include "slib/core/math.h"
+#include "slib/core/memory.h"
+#include "slib/core/scoped.h"
+
+#if defined(SLIB_ARCH_IS_X64) || (defined(SLIB_ARCH_IS_X86) && (defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+#	define IMAGE_RESAMPLE_USE_SSE2
+#	include <emmintrin.h>
+#elif defined(SLIB_ARCH_IS_ARM64) || defined(__ARM_NEON)
+#	define IMAGE_RESAMPLE_USE_NEON
+#	include <arm_neon.h>
+#endif
+
+#define IMAGE_RESAMPLE_PRECISION_BITS 14
+#define IMAGE_RESAMPLE_ROUND (1 << (IMAGE_RESAMPLE_PRECISION_BITS - 1))
+// minimum number of rows processed by a thread
+#define IMAGE_RESAMPLE_MIN_ROWS_PER_BAND 32
+
+namespace slib
+{
+
+	class _priv_ImageResample_Filter
+	{
+	public:
+		double support;
+		double (*kernel)(double x);
+		
+	public:
+		static double bicubic(double x)
+		{
+			const double a = -0.5;
+			if (x < 0) {
+				x = -x;
+			}
+			if (x < 1) {
+				return ((a + 2) * x - (a + 3)) * x * x + 1;
+			}
+			if (x < 2) {
+				return (((x - 5) * x + 8) * x - 4) * a;
+			}
+			return 0;
+		}
+		
+		static double sinc(double x)
+		{
+			if (x == 0) {
+				return 1;
+			}
+			x *= SLIB_PI_LONG;
+			return Math::sin(x) / x;
+		}
+		
+		static double lanczos(double x)
+		{
+			if (x > -3 && x < 3) {
+				return sinc(x) * sinc(x / 3);
+			}
+			return 0;
+		}
+		
+		sl_bool setStretchMode(StretchMode stretch)
+		{
+			if (stretch == StretchMode::Bicubic) {
+				support = 2;
+				kernel = &bicubic;
+				return sl_true;
+			}
+			if (stretch == StretchMode::Lanczos) {
+				support = 3;
+				kernel = &lanczos;
+				return sl_true;
+			}
+			return sl_false;
+		}
+		
+	};
+	
+	// fixed-point weights of the taps contributing to each output pixel
+	class _priv_ImageResample_Coefficients
+	{
+	public:
+		sl_uint32 count;
+		sl_uint32 maxTaps;
+		sl_uint32* bounds; // (start, count of taps) per output pixel
+		sl_int16* weights; // `maxTaps` weights per output pixel
+		
+		Memory memBounds;
+		Memory memWeights;
+		
+	public:
+		sl_bool build(sl_uint32 sizeIn, sl_uint32 sizeOut, const _priv_ImageResample_Filter& filter)
+		{
+			double scale = (double)sizeIn / (double)sizeOut;
+			double filterScale = scale < 1 ? 1 : scale;
+			double support = filter.support * filterScale;
+			sl_uint32 _maxTaps = (sl_uint32)(Math::ceil(support)) * 2 + 1;
+			memBounds = Memory::create(sizeof(sl_uint32) * 2 * sizeOut);
+			memWeights = Memory::create(sizeof(sl_int16) * _maxTaps * sizeOut);
+			if (memBounds.isNull() || memWeights.isNull()) {
+				return sl_false;
+			}
+			SLIB_SCOPED_BUFFER(double, 64, w, _maxTaps)
+			if (!w) {
+				return sl_false;
+			}
+			count = sizeOut;
+			maxTaps = _maxTaps;
+			bounds = (sl_uint32*)(memBounds.getData());
+			weights = (sl_int16*)(memWeights.getData());
+			Base::zeroMemory(weights, sizeof(sl_int16) * _maxTaps * sizeOut);
+			for (sl_uint32 i = 0; i < sizeOut; i++) {
+				double center = ((double)i + 0.5) * scale;
+				sl_int32 xmin = (sl_int32)(center - support + 0.5);
+				if (xmin < 0) {
+					xmin = 0;
+				}
+				sl_int32 xmax = (sl_int32)(center + support + 0.5);
+				if (xmax > (sl_int32)sizeIn) {
+					xmax = sizeIn;
+				}
+				sl_int32 n = xmax - xmin;
+				if (n > (sl_int32)_maxTaps) {
+					n = _maxTaps;
+				}
+				if (n <= 0) {
+					xmin = (sl_int32)center;
+					if (xmin >= (sl_int32)sizeIn) {
+						xmin = sizeIn - 1;
+					}
+					n = 1;
+				}
+				double sum = 0;
+				for (sl_int32 k = 0; k < n; k++) {
+					w[k] = filter.kernel(((double)(k + xmin) - center + 0.5) / filterScale);
+					sum += w[k];
+				}
+				sl_int16* f = weights + i * _maxTaps;
+				if (sum == 0) {
+					f[n / 2] = (sl_int16)(1 << IMAGE_RESAMPLE_PRECISION_BITS);
+				} else {
+					for (sl_int32 k = 0; k < n; k++) {
+						double v = w[k] / sum * (double)(1 << IMAGE_RESAMPLE_PRECISION_BITS);
+						f[k] = (sl_int16)(v < 0 ? v - 0.5 : v + 0.5);
+					}
+				}
+				bounds[i << 1] = xmin;
+				bounds[(i << 1) + 1] = n;
+			}
+			return sl_true;
+		}
+		
+	};
+	
+	SLIB_INLINE static sl_uint8 _priv_ImageResample_clamp(sl_int32 v)
+	{
+		v >>= IMAGE_RESAMPLE_PRECISION_BITS;
+		if (v < 0) {
+			return 0;
+		}
+		if (v > 255) {
+			return 255;
+		}
+		return (sl_uint8)v;
+	}
+	
+	static void _priv_ImageResample_horizontalRow(sl_uint8* dst, const sl_uint8* src, const _priv_ImageResample_Coefficients& c)
+	{
+		sl_uint32 maxTaps = c.maxTaps;
+		for (sl_uint32 i = 0; i < c.count; i++) {
+			const sl_uint8* s = src + (c.bounds[i << 1] << 2);
+			sl_uint32 n = c.bounds[(i << 1) + 1];
+			const sl_int16* w = c.weights + i * maxTaps;
+#if defined(IMAGE_RESAMPLE_USE_SSE2)
+			__m128i zero = _mm_setzero_si128();
+			__m128i acc = _mm_set1_epi32(IMAGE_RESAMPLE_ROUND);
+			sl_uint32 k = 0;
+			for (; k + 1 < n; k += 2) {
+				__m128i p = _mm_loadl_epi64((const __m128i*)(s + (k << 2)));
+				p = _mm_unpacklo_epi8(p, zero);
+				// interleave the channels of two pixels: (c0 of p0, c0 of p1, c1 of p0, c1 of p1, ...)
+				p = _mm_unpacklo_epi16(p, _mm_srli_si128(p, 8));
+				__m128i f = _mm_set1_epi32((sl_int32)((sl_uint32)(sl_uint16)(w[k]) | ((sl_uint32)(sl_uint16)(w[k + 1]) << 16)));
+				acc = _mm_add_epi32(acc, _mm_madd_epi16(p, f));
+			}
+			if (k < n) {
+				__m128i p = _mm_cvtsi32_si128(*((const sl_int32*)(s + (k << 2))));
+				p = _mm_unpacklo_epi16(_mm_unpacklo_epi8(p, zero), zero);
+				acc = _mm_add_epi32(acc, _mm_madd_epi16(p, _mm_set1_epi32((sl_uint16)(w[k]))));
+			}
+			acc = _mm_srai_epi32(acc, IMAGE_RESAMPLE_PRECISION_BITS);
+			acc = _mm_packs_epi32(acc, acc);
+			acc = _mm_packus_epi16(acc, acc);
+			*((sl_int32*)dst) = _mm_cvtsi128_si32(acc);
+#elif defined(IMAGE_RESAMPLE_USE_NEON)
+			int32x4_t acc = vdupq_n_s32(IMAGE_RESAMPLE_ROUND);
+			for (sl_uint32 k = 0; k < n; k++) {
+				uint8x8_t p = vreinterpret_u8_u32(vld1_lane_u32((const uint32_t*)(s + (k << 2)), vdup_n_u32(0), 0));
+				acc = vmlal_n_s16(acc, vget_low_s16(vreinterpretq_s16_u16(vmovl_u8(p))), w[k]);
+			}
+			int16x4_t v = vqshrn_n_s32(acc, IMAGE_RESAMPLE_PRECISION_BITS);
+			vst1_lane_u32((uint32_t*)dst, vreinterpret_u32_u8(vqmovun_s16(vcombine_s16(v, v))), 0);
+#else
+			sl_int32 acc0 = IMAGE_RESAMPLE_ROUND, acc1 = IMAGE_RESAMPLE_ROUND, acc2 = IMAGE_RESAMPLE_ROUND, acc3 = IMAGE_RESAMPLE_ROUND;
+			for (sl_uint32 k = 0; k < n; k++) {
+				const sl_uint8* p = s + (k << 2);
+				sl_int32 f = w[k];
+				acc0 += p[0] * f;
+				acc1 += p[1] * f;
+				acc2 += p[2] * f;
+				acc3 += p[3] * f;
+			}
+			dst[0] = _priv_ImageResample_clamp(acc0);
+			dst[1] = _priv_ImageResample_clamp(acc1);
+			dst[2] = _priv_ImageResample_clamp(acc2);
+			dst[3] = _priv_ImageResample_clamp(acc3);
+#endif
+			dst += 4;
+		}
+	}
+	
+	// `rows` points to the first contributing row of the intermediate image
+	static void _priv_ImageResample_verticalRow(sl_uint8* dst, const sl_uint8* rows, sl_size strideRows, sl_uint32 size, const sl_int16* w, sl_uint32 n)
+	{
+		sl_uint32 x = 0;
+#if defined(IMAGE_RESAMPLE_USE_SSE2)
+		__m128i zero = _mm_setzero_si128();
+		for (; x + 16 <= size; x += 16) {
+			__m128i acc0 = _mm_set1_epi32(IMAGE_RESAMPLE_ROUND);
+			__m128i acc1 = acc0;
+			__m128i acc2 = acc0;
+			__m128i acc3 = acc0;
+			const sl_uint8* s = rows + x;
+			sl_uint32 k = 0;
+			for (; k < n; k += 2) {
+				__m128i a = _mm_loadu_si128((const __m128i*)s);
+				__m128i b;
+				__m128i f;
+				if (k + 1 < n) {
+					b = _mm_loadu_si128((const __m128i*)(s + strideRows));
+					f = _mm_set1_epi32((sl_int32)((sl_uint32)(sl_uint16)(w[k]) | ((sl_uint32)(sl_uint16)(w[k + 1]) << 16)));
+				} else {
+					b = zero;
+					f = _mm_set1_epi32((sl_uint16)(w[k]));
+				}
+				__m128i lo = _mm_unpacklo_epi8(a, b);
+				__m128i hi = _mm_unpackhi_epi8(a, b);
+				acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_unpacklo_epi8(lo, zero), f));
+				acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_unpackhi_epi8(lo, zero), f));
+				acc2 = _mm_add_epi32(acc2, _mm_madd_epi16(_mm_unpacklo_epi8(hi, zero), f));
+				acc3 = _mm_add_epi32(acc3, _mm_madd_epi16(_mm_unpackhi_epi8(hi, zero), f));
+				s += strideRows << 1;
+			}
+			acc0 = _mm_srai_epi32(acc0, IMAGE_RESAMPLE_PRECISION_BITS);
+			acc1 = _mm_srai_epi32(acc1, IMAGE_RESAMPLE_PRECISION_BITS);
+			acc2 = _mm_srai_epi32(acc2, IMAGE_RESAMPLE_PRECISION_BITS);
+			acc3 = _mm_srai_epi32(acc3, IMAGE_RESAMPLE_PRECISION_BITS);
+			_mm_storeu_si128((__m128i*)(dst + x), _mm_packus_epi16(_mm_packs_epi32(acc0, acc1), _mm_packs_epi32(acc2, acc3)));
+		}
+#elif defined(IMAGE_RESAMPLE_USE_NEON)
+		for (; x + 16 <= size; x += 16) {
+			int32x4_t acc0 = vdupq_n_s32(IMAGE_RESAMPLE_ROUND);
+			int32x4_t acc1 = acc0;
+			int32x4_t acc2 = acc0;
+			int32x4_t acc3 = acc0;
+			const sl_uint8* s = rows + x;
+			for (sl_uint32 k = 0; k < n; k++) {
+				uint8x16_t p = vld1q_u8(s);
+				int16x8_t lo = vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(p)));
+				int16x8_t hi = vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(p)));
+				sl_int16 f = w[k];
+				acc0 = vmlal_n_s16(acc0, vget_low_s16(lo), f);
+				acc1 = vmlal_n_s16(acc1, vget_high_s16(lo), f);
+				acc2 = vmlal_n_s16(acc2, vget_low_s16(hi), f);
+				acc3 = vmlal_n_s16(acc3, vget_high_s16(hi), f);
+				s += strideRows;
+			}
+			int16x8_t v0 = vcombine_s16(vqshrn_n_s32(acc0, IMAGE_RESAMPLE_PRECISION_BITS), vqshrn_n_s32(acc1, IMAGE_RESAMPLE_PRECISION_BITS));
+			int16x8_t v1 = vcombine_s16(vqshrn_n_s32(acc2, IMAGE_RESAMPLE_PRECISION_BITS), vqshrn_n_s32(acc3, IMAGE_RESAMPLE_PRECISION_BITS));
+			vst1q_u8(dst + x, vcombine_u8(vqmovun_s16(v0), vqmovun_s16(v1)));
+		}
+#endif
+		for (; x < size; x++) {
+			sl_int32 acc = IMAGE_RESAMPLE_ROUND;
+			const sl_uint8* s = rows + x;
+			for (sl_uint32 k = 0; k < n; k++) {
+				acc += *s * (sl_int32)(w[k]);
+				s += strideRows;
+			}
+			dst[x] = _priv_ImageResample_clamp(acc);
+		}
+	}
+	
+	class _priv_ImageResample_Bands : public Referable
+	{
+	public:
+		Function<void(sl_uint32, sl_uint32)> task;
+		sl_uint32 count;
+		sl_int32 nBands;
+		sl_int32 indexNext;
+		sl_int32 nRemaining;
+		Ref<Event> ev;
+		
+	public:
+		// returns false when every band is taken
+		sl_bool runNext()
+		{
+			sl_int32 index = Base::interlockedIncrement32(&indexNext) - 1;
+			if (index >= nBands) {
+				return sl_false;
+			}
+			sl_uint32 start = (sl_uint32)((sl_uint64)count * index / nBands);
+			sl_uint32 end = (sl_uint32)((sl_uint64)count * (index + 1) / nBands);
+			task(start, end);
+			if (!(Base::interlockedDecrement32(&nRemaining))) {
+				ev->set();
+			}
+			return sl_true;
+		}
+		
+	};
+	
+	// runs `task(start, end)` on bands of [0, count), and waits for completion.
+	// The calling thread also takes the bands, so that it can finish all of them even if no thread of the pool is available
+	static void _priv_ImageResample_runBands(ThreadPool* threadPool, sl_uint32 count, const Function<void(sl_uint32, sl_uint32)>& task)
+	{
+		sl_uint32 nBands = 1;
+		if (threadPool) {
+			nBands = threadPool->getMaximumThreadsCount();
+			sl_uint32 m = count / IMAGE_RESAMPLE_MIN_ROWS_PER_BAND;
+			if (nBands > m) {
+				nBands = m;
+			}
+		}
+		if (nBands <= 1) {
+			task(0, count);
+			return;
+		}
+		Ref<_priv_ImageResample_Bands> bands = new _priv_ImageResample_Bands;
+		if (bands.isNotNull()) {
+			bands->ev = Event::create(sl_false);
+		}
+		if (bands.isNull() || bands->ev.isNull()) {
+			task(0, count);
+			return;
+		}
+		bands->task = task;
+		bands->count = count;
+		bands->nBands = (sl_int32)nBands;
+		bands->indexNext = 0;
+		bands->nRemaining = (sl_int32)nBands;
+		for (sl_uint32 i = 1; i < nBands; i++) {
+			// the tasks started after all bands are taken do nothing
+			if (!(threadPool->addTask([bands]() {
+				while (bands->runNext()) {
+				}
+			}))) {
+				break;
+			}
+		}
+		while (bands->runNext()) {
+		}
+		// waits for the bands which are being processed by other threads
+		bands->ev->wait();
+	}
+	
+	sl_bool _priv_ImageResample::isSupported(StretchMode stretch)
+	{
+		return stretch == StretchMode::Bicubic || stretch == StretchMode::Lanczos;
+	}
+	
+	void _priv_ImageResample::resample(ImageDesc& dst, const ImageDesc& src, BlendMode blend, StretchMode stretch, ThreadPool* threadPool)
+	{
+		_priv_ImageResample_Filter filter;
+		if (!(filter.setStretchMode(stretch))) {
+			return;
+		}
+		
+		sl_uint32 sw = src.width;
+		sl_uint32 sh = src.height;
+		sl_uint32 dw = dst.width;
+		sl_uint32 dh = dst.height;
+		
+		_priv_ImageResample_Coefficients cx, cy;
+		if (!(cx.build(sw, dw, filter))) {
+			return;
+		}
+		if (!(cy.build(sh, dh, filter))) {
+			return;
+		}
+		
+		// source rows referenced by the vertical pass
+		sl_uint32 y0 = sh;
+		sl_uint32 y1 = 0;
+		for (sl_uint32 i = 0; i < dh; i++) {
+			sl_uint32 start = cy.bounds[i << 1];
+			sl_uint32 end = start + cy.bounds[(i << 1) + 1];
+			if (start < y0) {
+				y0 = start;
+			}
+			if (end > y1) {
+				y1 = end;
+			}
+		}
+		
+		sl_size strideTemp = (sl_size)dw << 2;
+		Memory memTemp = Memory::create(strideTemp * (y1 - y0));
+		if (memTemp.isNull()) {
+			return;
+		}
+		sl_uint8* temp = (sl_uint8*)(memTemp.getData());
+		
+		const _priv_ImageResample_Coefficients* pcx = &cx;
+		const _priv_ImageResample_Coefficients* pcy = &cy;
+		const ImageDesc* pSrc = &src;
+		ImageDesc* pDst = &dst;
+		
+		_priv_ImageResample_runBands(threadPool, y1 - y0, [pcx, pSrc, temp, strideTemp, y0](sl_uint32 start, sl_uint32 end) {
+			for (sl_uint32 y = start; y < end; y++) {
+				_priv_ImageResample_horizontalRow(temp + y * strideTemp, (const sl_uint8*)(pSrc->colors + (sl_reg)(y + y0) * pSrc->stride), *pcx);
+			}
+		});
+		
+		_priv_ImageResample_runBands(threadPool, dh, [pcy, pDst, temp, strideTemp, y0, blend](sl_uint32 start, sl_uint32 end) {
+			sl_uint32 dw = pDst->width;
+			sl_uint32 maxTaps = pcy->maxTaps;
+			sl_bool flagBlend = blend != BlendMode::Copy;
+			SLIB_SCOPED_BUFFER(Color, 1024, row, flagBlend ? dw : 0)
+			if (!row) {
+				return;
+			}
+			for (sl_uint32 y = start; y < end; y++) {
+				Color* colorsDst = pDst->colors + (sl_reg)y * pDst->stride;
+				sl_uint8* out = flagBlend ? (sl_uint8*)row : (sl_uint8*)colorsDst;
+				const sl_uint8* rows = temp + (pcy->bounds[y << 1] - y0) * strideTemp;
+				_priv_ImageResample_verticalRow(out, rows, strideTemp, dw << 2, pcy->weights + y * maxTaps, pcy->bounds[(y << 1) + 1]);
+				if (flagBlend) {
+					for (sl_uint32 x = 0; x < dw; x++) {
+						colorsDst[x].blend_PA_NPA(row[x]);
+					}
+				}
+			}
+		});
+	}
+
+}
@@ -0,0 +1,46 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#ifndef CHECKHEADER_SLIB_GRAPHICS_IMAGE_RESAMPLE
+#define CHECKHEADER_SLIB_GRAPHICS_IMAGE_RESAMPLE
+
+#include "slib/graphics/image.h"
+
+namespace slib
+{
+
+	class ThreadPool;
+
+	// two pass (horizontal, then vertical) resampling with fixed-point coefficient tables
+	class _priv_ImageResample
+	{
+	public:
+		static sl_bool isSupported(StretchMode stretch);
+
+		static void resample(ImageDesc& dst, const ImageDesc& src, BlendMode blend, StretchMode stretch, ThreadPool* threadPool);
+
+	};
+
+}
+
+#endif
@@ -41,6 +41,22 @@
 namespace slib
 {
 
+	sl_bool Image::getImageInfo(const void* mem, sl_size size, ImageInfo& info)
+	{
+		int width = 0;
+		int height = 0;
+		int nComponents = 0;
+		if (stbi_info_from_memory((stbi_uc*)mem, (int)size, &width, &height, &nComponents)) {
+			if (width > 0 && height > 0) {
+				info.type = getFileType(mem, size);
+				info.width = (sl_uint32)width;
+				info.height = (sl_uint32)height;
+				return sl_true;
+			}
+		}
+		return sl_false;
+	}
+
 	Ref<Image> Image::loadSTB(const void* content, sl_size size)
 	{
 		Ref<Image> ret;
@@ -0,0 +1,111 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#include "slib/graphics/image_stream.h"
+
+#include "slib/graphics/image.h"
+
+namespace slib
+{
+
+	IImageRowWriter::IImageRowWriter()
+	{
+	}
+
+	IImageRowWriter::~IImageRowWriter()
+	{
+	}
+
+
+	ImageRowEncoder::ImageRowEncoder()
+	{
+	}
+
+	ImageRowEncoder::~ImageRowEncoder()
+	{
+	}
+
+
+	// returns the signature bytes before reading from the source
+	class _priv_ImageRowDecoder_PrefixReader : public IReader
+	{
+	public:
+		IReader* m_reader;
+		const sl_uint8* m_prefix;
+		sl_size m_sizePrefix;
+
+	public:
+		_priv_ImageRowDecoder_PrefixReader(IReader* reader, const sl_uint8* prefix, sl_size sizePrefix)
+		{
+			m_reader = reader;
+			m_prefix = prefix;
+			m_sizePrefix = sizePrefix;
+		}
+
+	public:
+		sl_reg read(void* buf, sl_size size) override
+		{
+			if (m_sizePrefix) {
+				if (size > m_sizePrefix) {
+					size = m_sizePrefix;
+				}
+				Base::copyMemory(buf, m_prefix, size);
+				m_prefix += size;
+				m_sizePrefix -= size;
+				return size;
+			}
+			return m_reader->read(buf, size);
+		}
+
+	};
+
+	sl_bool ImageRowDecoder::decode(IReader* reader, IImageRowWriter* output)
+	{
+		if (!reader || !output) {
+			return sl_false;
+		}
+		sl_uint8 signature[16];
+		sl_reg n = reader->readFully(signature, sizeof(signature));
+		if (n <= 0) {
+			return sl_false;
+		}
+		_priv_ImageRowDecoder_PrefixReader prefixReader(reader, signature, n);
+		ImageFileType type = Image::getFileType(signature, n);
+		if (type == ImageFileType::JPEG) {
+			return decodeJPEG(&prefixReader, output);
+		}
+		if (type == ImageFileType::PNG) {
+			return decodePNG(&prefixReader, output);
+		}
+		return sl_false;
+	}
+
+	sl_bool ImageRowDecoder::transcode(IReader* reader, const Ref<ImageRowEncoder>& encoder)
+	{
+		if (encoder.isNull()) {
+			return sl_false;
+		}
+		return decode(reader, encoder.get());
+	}
+
+}
@@ -22,6 +22,9 @@
 
 #include "slib/graphics/zxing.h"
 
+#include "slib/core/event.h"
+#include "slib/core/time.h"
+
 #include "zxing/MultiFormatWriter.h"
 #include "zxing/MultiFormatReader.h"
 #include "zxing/Result.h"
@@ -29,6 +32,22 @@
 #include "zxing/DecodeHints.h"
 #include "zxing/HybridBinarizer.h"
 #include "zxing/GenericLuminanceSource.h"
+#include "zxing/ByteArray.h"
+
+#include <thread>
+
+#if defined(SLIB_ARCH_IS_X64) || (defined(SLIB_ARCH_IS_X86) && (defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+#	define ZXING_USE_SSE2
+#	include <emmintrin.h>
+#elif defined(SLIB_ARCH_IS_ARM64) || defined(__ARM_NEON)
+#	define ZXING_USE_NEON
+#	include <arm_neon.h>
+#endif
+
+// same weights as GenericLuminanceSource: (306 * R + 601 * G + 117 * B + 0x200) >> 10
+#define ZXING_GRAY_R 306
+#define ZXING_GRAY_G 601
+#define ZXING_GRAY_B 117
 
 using namespace ZXing;
 
@@ -51,6 +70,22 @@ namespace slib
 		flagSubRegion = sl_false;
 	}
 	
+	ZXingBatchScanParam::ZXingBatchScanParam()
+	{
+		format = ZXingFormat::QR_CODE;
+		flagTryHarder = sl_true;
+		flagTryRotate = sl_false;
+		preDetectSize = 1024;
+		threadsCount = 0;
+	}
+	
+	ZXingScanResult::ZXingScanResult()
+	{
+		flagLoaded = sl_false;
+		flagPreDetected = sl_false;
+		elapsedMicroseconds = 0;
+	}
+	
 	BarcodeFormat _priv_ZXing_getBarcodeFormat(ZXingFormat format)
 	{
 		switch (format) {
@@ -127,38 +162,95 @@ namespace slib
 		return sl_null;
 	}
 	
-	String ZXing::scan(const ZXingScanParam& param)
+	static void _priv_ZXing_convertToGray(const Color* colors, sl_int32 stride, sl_uint32 width, sl_uint32 height, sl_uint8* gray)
 	{
-		Ref<Image> image = param.image;
-		if (image.isNull()) {
-			return sl_null;
+		for (sl_uint32 y = 0; y < height; y++) {
+			const sl_uint8* src = (const sl_uint8*)(colors + (sl_reg)stride * y);
+			sl_uint8* dst = gray + (sl_size)width * y;
+			sl_uint32 x = 0;
+#if defined(ZXING_USE_SSE2)
+			__m128i weights = _mm_setr_epi16(ZXING_GRAY_R, ZXING_GRAY_G, ZXING_GRAY_B, 0, ZXING_GRAY_R, ZXING_GRAY_G, ZXING_GRAY_B, 0);
+			__m128i round = _mm_set1_epi32(0x200);
+			__m128i zero = _mm_setzero_si128();
+			for (; x + 8 <= width; x += 8) {
+				__m128i v0 = _mm_loadu_si128((const __m128i*)(src + (x << 2)));
+				__m128i v1 = _mm_loadu_si128((const __m128i*)(src + (x << 2) + 16));
+				// (306R + 601G, 117B) of each pixel
+				__m128i s0 = _mm_madd_epi16(_mm_unpacklo_epi8(v0, zero), weights);
+				__m128i s1 = _mm_madd_epi16(_mm_unpackhi_epi8(v0, zero), weights);
+				__m128i s2 = _mm_madd_epi16(_mm_unpacklo_epi8(v1, zero), weights);
+				__m128i s3 = _mm_madd_epi16(_mm_unpackhi_epi8(v1, zero), weights);
+				s0 = _mm_add_epi32(s0, _mm_srli_epi64(s0, 32));
+				s1 = _mm_add_epi32(s1, _mm_srli_epi64(s1, 32));
+				s2 = _mm_add_epi32(s2, _mm_srli_epi64(s2, 32));
+				s3 = _mm_add_epi32(s3, _mm_srli_epi64(s3, 32));
+				__m128i l0 = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(s0), _mm_castsi128_ps(s1), _MM_SHUFFLE(2, 0, 2, 0)));
+				__m128i l1 = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(s2), _mm_castsi128_ps(s3), _MM_SHUFFLE(2, 0, 2, 0)));
+				l0 = _mm_srli_epi32(_mm_add_epi32(l0, round), 10);
+				l1 = _mm_srli_epi32(_mm_add_epi32(l1, round), 10);
+				__m128i l = _mm_packs_epi32(l0, l1);
+				_mm_storel_epi64((__m128i*)(dst + x), _mm_packus_epi16(l, l));
+			}
+#elif defined(ZXING_USE_NEON)
+			for (; x + 8 <= width; x += 8) {
+				uint8x8x4_t v = vld4_u8(src + (x << 2));
+				uint16x8_t r = vmovl_u8(v.val[0]);
+				uint16x8_t g = vmovl_u8(v.val[1]);
+				uint16x8_t b = vmovl_u8(v.val[2]);
+				uint32x4_t lo = vmull_n_u16(vget_low_u16(r), ZXING_GRAY_R);
+				lo = vmlal_n_u16(lo, vget_low_u16(g), ZXING_GRAY_G);
+				lo = vmlal_n_u16(lo, vget_low_u16(b), ZXING_GRAY_B);
+				uint32x4_t hi = vmull_n_u16(vget_high_u16(r), ZXING_GRAY_R);
+				hi = vmlal_n_u16(hi, vget_high_u16(g), ZXING_GRAY_G);
+				hi = vmlal_n_u16(hi, vget_high_u16(b), ZXING_GRAY_B);
+				vst1_u8(dst + x, vmovn_u16(vcombine_u16(vrshrn_n_u32(lo, 10), vrshrn_n_u32(hi, 10))));
+			}
+#endif
+			for (; x < width; x++) {
+				const sl_uint8* p = src + (x << 2);
+				dst[x] = (sl_uint8)((ZXING_GRAY_R * p[0] + ZXING_GRAY_G * p[1] + ZXING_GRAY_B * p[2] + 0x200) >> 10);
+			}
 		}
-		DecodeHints hints;
-		hints.setCharacterSet("UTF-8");
-		hints.setShouldTryHarder(param.flagTryHarder);
-		hints.setShouldTryRotate(sl_false);
-		hints.setPossibleFormats({_priv_ZXing_getBarcodeFormat(param.format)});
-		MultiFormatReader reader(hints);
-		try {
-			std::shared_ptr<GenericLuminanceSource> src;
-			if (param.flagSubRegion) {
-				Rectanglei region = param.subRegion;
-				int width = region.getWidth();
-				if (region.left + width > (int)(image->getWidth())) {
-					return sl_null;
-				}
-				int height = region.getHeight();
-				if (region.top + height > (int)(image->getHeight())) {
-					return sl_null;
-				}
-				int stride = image->getWidth();
-				src = std::make_shared<GenericLuminanceSource>(width, height, image->getColors() + (stride * region.top + region.left), stride * 4, 4, 0, 1, 2);
-			} else {
-				src = std::make_shared<GenericLuminanceSource>(image->getWidth(), image->getHeight(), image->getColors(), image->getStride() * 4, 4, 0, 1, 2);
+	}
+	
+	// averages 2x2 blocks
+	static void _priv_ZXing_halveGray(const sl_uint8* src, sl_uint32 widthSrc, sl_uint8* dst, sl_uint32 widthDst, sl_uint32 heightDst)
+	{
+		for (sl_uint32 y = 0; y < heightDst; y++) {
+			const sl_uint8* s0 = src + (sl_size)widthSrc * (y << 1);
+			const sl_uint8* s1 = s0 + widthSrc;
+			sl_uint8* d = dst + (sl_size)widthDst * y;
+			sl_uint32 x = 0;
+#if defined(ZXING_USE_SSE2)
+			__m128i mask = _mm_set1_epi16(0xFF);
+			__m128i two = _mm_set1_epi16(2);
+			for (; x + 8 <= widthDst; x += 8) {
+				__m128i a = _mm_loadu_si128((const __m128i*)(s0 + (x << 1)));
+				__m128i b = _mm_loadu_si128((const __m128i*)(s1 + (x << 1)));
+				__m128i sum = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(a, mask), _mm_srli_epi16(a, 8)), _mm_add_epi16(_mm_and_si128(b, mask), _mm_srli_epi16(b, 8)));
+				sum = _mm_srli_epi16(_mm_add_epi16(sum, two), 2);
+				_mm_storel_epi64((__m128i*)(d + x), _mm_packus_epi16(sum, sum));
 			}
+#elif defined(ZXING_USE_NEON)
+			for (; x + 8 <= widthDst; x += 8) {
+				uint16x8_t sum = vaddq_u16(vpaddlq_u8(vld1q_u8(s0 + (x << 1))), vpaddlq_u8(vld1q_u8(s1 + (x << 1))));
+				vst1_u8(d + x, vrshrn_n_u16(sum, 2));
+			}
+#endif
+			for (; x < widthDst; x++) {
+				sl_uint32 k = x << 1;
+				d[x] = (sl_uint8)((s0[k] + s0[k + 1] + s1[k] + s1[k + 1] + 2) >> 2);
+			}
+		}
+	}
+	
+	static String _priv_ZXing_decode(MultiFormatReader& reader, const std::shared_ptr<const ByteArray>& gray, sl_uint32 width, sl_uint32 height, sl_bool flagTryRotate)
+	{
+		try {
+			std::shared_ptr<GenericLuminanceSource> src = std::make_shared<GenericLuminanceSource>(0, 0, (int)width, (int)height, gray, (int)width);
 			HybridBinarizer binary(src);
 			Result result = reader.read(binary);
-			if (param.flagTryRotate) {
+			if (flagTryRotate) {
 				if (!(result.isValid())) {
 					std::shared_ptr<BinaryBitmap> r = binary.rotated(180);
 					result = reader.read(*r);
@@ -180,5 +272,216 @@ namespace slib
 		}
 		return sl_null;
 	}
+	
+	static std::shared_ptr<ByteArray> _priv_ZXing_getGray(const Color* colors, sl_int32 stride, sl_uint32 width, sl_uint32 height)
+	{
+		try {
+			std::shared_ptr<ByteArray> gray = std::make_shared<ByteArray>();
+			gray->resize((sl_size)width * height);
+			_priv_ZXing_convertToGray(colors, stride, width, height, gray->data());
+			return gray;
+		} catch (std::exception&) {
+		}
+		return nullptr;
+	}
+	
+	static DecodeHints _priv_ZXing_getHints(ZXingFormat format, sl_bool flagTryHarder)
+	{
+		DecodeHints hints;
+		hints.setCharacterSet("UTF-8");
+		hints.setShouldTryHarder(flagTryHarder);
+		hints.setShouldTryRotate(sl_false);
+		hints.setPossibleFormats({_priv_ZXing_getBarcodeFormat(format)});
+		return hints;
+	}
+	
+	String ZXing::scan(const ZXingScanParam& param)
+	{
+		Ref<Image> image = param.image;
+		if (image.isNull()) {
+			return sl_null;
+		}
+		sl_int32 stride = image->getStride();
+		const Color* colors = image->getColors();
+		sl_uint32 width = image->getWidth();
+		sl_uint32 height = image->getHeight();
+		if (param.flagSubRegion) {
+			Rectanglei region = param.subRegion;
+			if (region.left < 0 || region.top < 0 || region.right < region.left || region.bottom < region.top) {
+				return sl_null;
+			}
+			if (region.right > (sl_int32)width || region.bottom > (sl_int32)height) {
+				return sl_null;
+			}
+			colors += (sl_reg)stride * region.top + region.left;
+			width = region.getWidth();
+			height = region.getHeight();
+		}
+		std::shared_ptr<ByteArray> gray = _priv_ZXing_getGray(colors, stride, width, height);
+		if (!gray) {
+			return sl_null;
+		}
+		MultiFormatReader reader(_priv_ZXing_getHints(param.format, param.flagTryHarder));
+		return _priv_ZXing_decode(reader, gray, width, height, param.flagTryRotate);
+	}
+	
+	static void _priv_ZXing_scanBatchImage(MultiFormatReader& reader, const Ref<Image>& image, const ZXingBatchScanParam& param, ZXingScanResult& result)
+	{
+		sl_uint32 width = image->getWidth();
+		sl_uint32 height = image->getHeight();
+		std::shared_ptr<ByteArray> gray = _priv_ZXing_getGray(image->getColors(), image->getStride(), width, height);
+		if (!gray) {
+			return;
+		}
+		sl_uint32 preDetectSize = param.preDetectSize;
+		if (preDetectSize && (width > preDetectSize || height > preDetectSize)) {
+			std::shared_ptr<ByteArray> small = gray;
+			sl_uint32 w = width;
+			sl_uint32 h = height;
+			while ((w > preDetectSize || h > preDetectSize) && w >= 2 && h >= 2) {
+				sl_uint32 w2 = w >> 1;
+				sl_uint32 h2 = h >> 1;
+				try {
+					std::shared_ptr<ByteArray> half = std::make_shared<ByteArray>();
+					half->resize((sl_size)w2 * h2);
+					_priv_ZXing_halveGray(small->data(), w, half->data(), w2, h2);
+					small = half;
+				} catch (std::exception&) {
+					break;
+				}
+				w = w2;
+				h = h2;
+			}
+			if (w != width) {
+				result.text = _priv_ZXing_decode(reader, small, w, h, param.flagTryRotate);
+				if (result.text.isNotNull()) {
+					result.flagPreDetected = sl_true;
+					return;
+				}
+			}
+		}
+		result.text = _priv_ZXing_decode(reader, gray, width, height, param.flagTryRotate);
+	}
+	
+	// each worker has its own reader, and takes the next image until all images are scanned.
+	// The calling thread is also a worker, so that it can scan all images even if no thread of the pool is available
+	class _priv_ZXing_BatchScanner : public Referable
+	{
+	public:
+		ZXingBatchScanParam param;
+		Ref<Image>* images;
+		sl_size nImages;
+		String* filePaths;
+		sl_size nTotal;
+		ZXingScanResult* results;
+		sl_reg indexNext;
+		sl_reg nRemaining;
+		Ref<Event> ev;
+		
+	public:
+		void run()
+		{
+			std::unique_ptr<MultiFormatReader> reader;
+			for (;;) {
+				sl_size index = (sl_size)(Base::interlockedIncrement(&indexNext) - 1);
+				if (index >= nTotal) {
+					break;
+				}
+				if (!reader) {
+					reader.reset(new MultiFormatReader(_priv_ZXing_getHints(param.format, param.flagTryHarder)));
+				}
+				ZXingScanResult& result = results[index];
+				TimeCounter counter;
+				Ref<Image> image;
+				if (index < nImages) {
+					image = images[index];
+				} else {
+					image = Image::loadFromFile(filePaths[index - nImages]);
+				}
+				if (image.isNotNull() && image->getWidth() && image->getHeight()) {
+					result.flagLoaded = sl_true;
+					_priv_ZXing_scanBatchImage(*reader, image, param, result);
+				}
+				result.elapsedMicroseconds = (sl_uint64)(counter.getTime().getMicrosecondsCount());
+				if (!(Base::interlockedDecrement(&nRemaining)) && ev.isNotNull()) {
+					ev->set();
+				}
+			}
+		}
+		
+	};
+	
+	List<ZXingScanResult> ZXing::scanBatch(const ZXingBatchScanParam& param)
+	{
+		ListLocker< Ref<Image> > images(param.images);
+		ListLocker<String> filePaths(param.filePaths);
+		sl_size nImages = images.count;
+		sl_size nTotal = nImages + filePaths.count;
+		if (!nTotal) {
+			return sl_null;
+		}
+		List<ZXingScanResult> results = List<ZXingScanResult>::create(nTotal);
+		if (results.isNull()) {
+			return sl_null;
+		}
+		ZXingScanResult* pResults = results.getData();
+		
+		Ref<ThreadPool> threadPool = param.threadPool;
+		sl_uint32 nWorkers;
+		if (threadPool.isNotNull()) {
+			nWorkers = threadPool->getMaximumThreadsCount();
+		} else {
+			nWorkers = param.threadsCount;
+			if (!nWorkers) {
+				nWorkers = (sl_uint32)(std::thread::hardware_concurrency());
+			}
+		}
+		if (nWorkers > nTotal) {
+			nWorkers = (sl_uint32)nTotal;
+		}
+		if (nWorkers < 1) {
+			nWorkers = 1;
+		}
+		if (nWorkers > 1 && threadPool.isNull()) {
+			// the calling thread works as one of the workers
+			threadPool = ThreadPool::create(0, nWorkers - 1);
+			if (threadPool.isNull()) {
+				nWorkers = 1;
+			}
+		}
+		
+		Ref<_priv_ZXing_BatchScanner> scanner = new _priv_ZXing_BatchScanner;
+		if (scanner.isNull()) {
+			return sl_null;
+		}
+		scanner->param = param;
+		// the pool is not referenced by its own tasks
+		scanner->param.threadPool.setNull();
+		scanner->images = images.data;
+		scanner->nImages = nImages;
+		scanner->filePaths = filePaths.data;
+		scanner->nTotal = nTotal;
+		scanner->results = pResults;
+		scanner->indexNext = 0;
+		scanner->nRemaining = (sl_reg)nTotal;
+		
+		if (nWorkers > 1) {
+			scanner->ev = Event::create(sl_false);
+			if (scanner->ev.isNotNull()) {
+				for (sl_uint32 i = 1; i < nWorkers; i++) {
+					// the tasks started after all images are taken do nothing
+					if (!(threadPool->addTask(SLIB_FUNCTION_REF(_priv_ZXing_BatchScanner, run, scanner)))) {
+						break;
+					}
+				}
+				scanner->run();
+				// waits for the images which are being scanned by other threads
+				scanner->ev->wait();
+				return results;
+			}
+		}
+		scanner->run();
+		return results;
+	}
 
 }
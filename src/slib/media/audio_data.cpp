@@ -409,6 +409,146 @@ namespace slib
 		}
 	}
 
+	// returns the sample type in native byte order, or 0 when the samples need byte swapping
+	static AudioSampleType _priv_AudioData_getNativeSampleType(AudioSampleType type)
+	{
+		switch (type) {
+			case AudioSampleType::Int8:
+			case AudioSampleType::Uint8:
+			case AudioSampleType::Int16:
+			case AudioSampleType::Uint16:
+			case AudioSampleType::Float:
+				return type;
+			case AudioSampleType::Int16LE:
+				return Endian::isLE() ? AudioSampleType::Int16 : (AudioSampleType)0;
+			case AudioSampleType::Int16BE:
+				return Endian::isBE() ? AudioSampleType::Int16 : (AudioSampleType)0;
+			case AudioSampleType::Uint16LE:
+				return Endian::isLE() ? AudioSampleType::Uint16 : (AudioSampleType)0;
+			case AudioSampleType::Uint16BE:
+				return Endian::isBE() ? AudioSampleType::Uint16 : (AudioSampleType)0;
+			case AudioSampleType::FloatLE:
+				return Endian::isLE() ? AudioSampleType::Float : (AudioSampleType)0;
+			case AudioSampleType::FloatBE:
+				return Endian::isBE() ? AudioSampleType::Float : (AudioSampleType)0;
+		}
+		return (AudioSampleType)0;
+	}
+
+	template <class IN_TYPE>
+	static void _priv_AudioData_convertNativeSamples_Step1(sl_size count, const IN_TYPE* data_in, AudioSampleType type_out, void* data_out)
+	{
+		switch (type_out) {
+			case AudioSampleType::Int8:
+				AudioUtil::convertSamples(count, data_in, (sl_int8*)data_out);
+				break;
+			case AudioSampleType::Uint8:
+				AudioUtil::convertSamples(count, data_in, (sl_uint8*)data_out);
+				break;
+			case AudioSampleType::Int16:
+				AudioUtil::convertSamples(count, data_in, (sl_int16*)data_out);
+				break;
+			case AudioSampleType::Uint16:
+				AudioUtil::convertSamples(count, data_in, (sl_uint16*)data_out);
+				break;
+			case AudioSampleType::Float:
+				AudioUtil::convertSamples(count, data_in, (float*)data_out);
+				break;
+			default:
+				break;
+		}
+	}
+
+	static void _priv_AudioData_convertNativeSamples(sl_size count, AudioSampleType type_in, const void* data_in, AudioSampleType type_out, void* data_out)
+	{
+		switch (type_in) {
+			case AudioSampleType::Int8:
+				_priv_AudioData_convertNativeSamples_Step1(count, (const sl_int8*)data_in, type_out, data_out);
+				break;
+			case AudioSampleType::Uint8:
+				_priv_AudioData_convertNativeSamples_Step1(count, (const sl_uint8*)data_in, type_out, data_out);
+				break;
+			case AudioSampleType::Int16:
+				_priv_AudioData_convertNativeSamples_Step1(count, (const sl_int16*)data_in, type_out, data_out);
+				break;
+			case AudioSampleType::Uint16:
+				_priv_AudioData_convertNativeSamples_Step1(count, (const sl_uint16*)data_in, type_out, data_out);
+				break;
+			case AudioSampleType::Float:
+				_priv_AudioData_convertNativeSamples_Step1(count, (const float*)data_in, type_out, data_out);
+				break;
+			default:
+				break;
+		}
+	}
+
+	template <class TYPE>
+	static void _priv_AudioData_mixNativeSamples(sl_size count, const void* data_in, const void* data_in1, void* data_out)
+	{
+		if (data_in1) {
+			AudioUtil::mixSamples(count, (const TYPE*)data_in, (const TYPE*)data_in1, (TYPE*)data_out);
+		} else {
+			AudioUtil::mixChannels(count, 2, (const TYPE*)data_in, (TYPE*)data_out);
+		}
+	}
+
+	// uses the vectorized kernels of AudioUtil when both formats are in native byte order
+	static sl_bool _priv_AudioData_copyNativeSamples(sl_size count, AudioFormat format_in, sl_uint8* data_in, sl_uint8* data_in1, AudioFormat format_out, sl_uint8* data_out, sl_uint8* data_out1)
+	{
+		AudioSampleType type_in = _priv_AudioData_getNativeSampleType(AudioFormats::getSampleType(format_in));
+		AudioSampleType type_out = _priv_AudioData_getNativeSampleType(AudioFormats::getSampleType(format_out));
+		if (!((sl_uint32)type_in) || !((sl_uint32)type_out)) {
+			return sl_false;
+		}
+		sl_size maskAlign_in = AudioFormats::getBytesPerSample(format_in) - 1;
+		sl_size maskAlign_out = AudioFormats::getBytesPerSample(format_out) - 1;
+		if ((((sl_size)data_in | (sl_size)data_in1) & maskAlign_in) || (((sl_size)data_out | (sl_size)data_out1) & maskAlign_out)) {
+			return sl_false;
+		}
+		sl_uint32 nChannels_in = AudioFormats::getChannelsCount(format_in);
+		sl_uint32 nChannels_out = AudioFormats::getChannelsCount(format_out);
+		sl_bool flagNonInterleaved_in = nChannels_in == 2 && AudioFormats::isNonInterleaved(format_in);
+		sl_bool flagNonInterleaved_out = nChannels_out == 2 && AudioFormats::isNonInterleaved(format_out);
+		if (nChannels_in == nChannels_out) {
+			if (flagNonInterleaved_in != flagNonInterleaved_out) {
+				return sl_false;
+			}
+			if (flagNonInterleaved_in) {
+				_priv_AudioData_convertNativeSamples(count, type_in, data_in, type_out, data_out);
+				_priv_AudioData_convertNativeSamples(count, type_in, data_in1, type_out, data_out1);
+			} else {
+				_priv_AudioData_convertNativeSamples(count * nChannels_in, type_in, data_in, type_out, data_out);
+			}
+			return sl_true;
+		}
+		if (nChannels_in == 2 && nChannels_out == 1 && type_in == type_out) {
+			if (!flagNonInterleaved_in) {
+				data_in1 = sl_null;
+			}
+			switch (type_in) {
+				case AudioSampleType::Int8:
+					_priv_AudioData_mixNativeSamples<sl_int8>(count, data_in, data_in1, data_out);
+					break;
+				case AudioSampleType::Uint8:
+					_priv_AudioData_mixNativeSamples<sl_uint8>(count, data_in, data_in1, data_out);
+					break;
+				case AudioSampleType::Int16:
+					_priv_AudioData_mixNativeSamples<sl_int16>(count, data_in, data_in1, data_out);
+					break;
+				case AudioSampleType::Uint16:
+					_priv_AudioData_mixNativeSamples<sl_uint16>(count, data_in, data_in1, data_out);
+					break;
+				case AudioSampleType::Float:
+					_priv_AudioData_mixNativeSamples<float>(count, data_in, data_in1, data_out);
+					break;
+				default:
+					return sl_false;
+			}
+			return sl_true;
+		}
+		return sl_false;
+	}
+
 	void AudioData::copySamplesFrom(const AudioData& other, sl_size countSamples) const
 	{
 		if (format == AudioFormat::None) {
@@ -427,16 +567,16 @@ namespace slib
 			return;
 		}
 		
-		sl_uint8* data_in = (sl_uint8*)data;
-		sl_uint8* data_in1 = (sl_uint8*)data1;
-		if (AudioFormats::isNonInterleaved(format) && !data_in1) {
-			data_in1 = data_in + getSizeForChannel();
+		sl_uint8* data_in = (sl_uint8*)(other.data);
+		sl_uint8* data_in1 = (sl_uint8*)(other.data1);
+		if (AudioFormats::isNonInterleaved(other.format) && !data_in1) {
+			data_in1 = data_in + other.getSizeForChannel();
 		}
 		
-		sl_uint8* data_out = (sl_uint8*)(other.data);
-		sl_uint8* data_out1 = (sl_uint8*)(other.data1);
-		if (AudioFormats::isNonInterleaved(other.format) && !data_out1) {
-			data_out1 = data_out + other.getSizeForChannel();
+		sl_uint8* data_out = (sl_uint8*)data;
+		sl_uint8* data_out1 = (sl_uint8*)data1;
+		if (AudioFormats::isNonInterleaved(format) && !data_out1) {
+			data_out1 = data_out + getSizeForChannel();
 		}
 		
 		if (format == other.format) {
@@ -451,7 +591,11 @@ namespace slib
 			return;
 		}
 		
-		_priv_AudioData_copySamples(countSamples, format, data_in, data_in1, other.format, data_out, data_out1);
+		if (_priv_AudioData_copyNativeSamples(countSamples, other.format, data_in, data_in1, format, data_out, data_out1)) {
+			return;
+		}
+		
+		_priv_AudioData_copySamples(countSamples, other.format, data_in, data_in1, format, data_out, data_out1);
 	}
 
 	void AudioData::copySamplesFrom(const AudioData& other) const
@@ -0,0 +1,373 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#include "slib/media/audio_resampler.h"
+
+#include "slib/core/base.h"
+#include "slib/core/math.h"
+
+#if defined(SLIB_ARCH_IS_X64) || (defined(SLIB_ARCH_IS_X86) && (defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+#	define AUDIO_RESAMPLER_USE_SSE2
+#	include <emmintrin.h>
+#elif defined(SLIB_ARCH_IS_ARM64) || defined(__ARM_NEON)
+#	define AUDIO_RESAMPLER_USE_NEON
+#	include <arm_neon.h>
+#endif
+
+#define AUDIO_RESAMPLER_MAX_PHASES 256
+#define AUDIO_RESAMPLER_MAX_TAPS 256
+#define AUDIO_RESAMPLER_ROLLOFF 0.91
+#define AUDIO_RESAMPLER_CHUNK 256
+
+namespace slib
+{
+
+	static sl_uint32 _priv_AudioResampler_gcd(sl_uint32 a, sl_uint32 b)
+	{
+		while (b) {
+			sl_uint32 t = a % b;
+			a = b;
+			b = t;
+		}
+		return a;
+	}
+
+	// `n` is a multiple of 4
+	static float _priv_AudioResampler_dot(const float* a, const float* b, sl_uint32 n)
+	{
+#if defined(AUDIO_RESAMPLER_USE_SSE2)
+		__m128 acc = _mm_setzero_ps();
+		for (sl_uint32 i = 0; i < n; i += 4) {
+			acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+		}
+		acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+		acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+		return _mm_cvtss_f32(acc);
+#elif defined(AUDIO_RESAMPLER_USE_NEON)
+		float32x4_t acc = vdupq_n_f32(0);
+		for (sl_uint32 i = 0; i < n; i += 4) {
+			acc = vmlaq_f32(acc, vld1q_f32(a + i), vld1q_f32(b + i));
+		}
+		float32x2_t v = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+		return vget_lane_f32(vpadd_f32(v, v), 0);
+#else
+		float acc0 = 0, acc1 = 0, acc2 = 0, acc3 = 0;
+		for (sl_uint32 i = 0; i < n; i += 4) {
+			acc0 += a[i] * b[i];
+			acc1 += a[i + 1] * b[i + 1];
+			acc2 += a[i + 2] * b[i + 2];
+			acc3 += a[i + 3] * b[i + 3];
+		}
+		return (acc0 + acc1) + (acc2 + acc3);
+#endif
+	}
+
+	// returns the sub-range of `data` starting from `offset`
+	static void _priv_AudioResampler_getRange(const AudioData& data, sl_size offset, sl_size count, AudioData& _out)
+	{
+		_out.format = data.format;
+		_out.count = count;
+		_out.ref = data.ref;
+		_out.ref1 = data.ref1;
+		sl_size nBytesPerSample = AudioFormats::getBytesPerSample(data.format);
+		if (AudioFormats::isNonInterleaved(data.format)) {
+			sl_uint8* data1 = (sl_uint8*)(data.data1);
+			if (!data1) {
+				data1 = (sl_uint8*)(data.data) + data.getSizeForChannel();
+			}
+			_out.data = (sl_uint8*)(data.data) + offset * nBytesPerSample;
+			_out.data1 = data1 + offset * nBytesPerSample;
+		} else {
+			_out.data = (sl_uint8*)(data.data) + offset * nBytesPerSample * AudioFormats::getChannelsCount(data.format);
+			_out.data1 = sl_null;
+		}
+	}
+
+	AudioResampler::AudioResampler()
+	{
+		m_rateInput = 0;
+		m_rateOutput = 0;
+		m_nChannels = 0;
+		m_nTaps = 0;
+		m_nUp = 1;
+		m_nDown = 1;
+		m_nPhases = 1;
+		m_capacity = 0;
+		m_countBuffered = 0;
+		m_pos = 0;
+		m_phase = 0;
+	}
+
+	AudioResampler::~AudioResampler()
+	{
+	}
+
+	Ref<AudioResampler> AudioResampler::create(sl_uint32 samplesPerSecondInput, sl_uint32 samplesPerSecondOutput, sl_uint32 nChannels, sl_uint32 nTaps)
+	{
+		if (!samplesPerSecondInput || !samplesPerSecondOutput) {
+			return sl_null;
+		}
+		if (nChannels != 1 && nChannels != 2) {
+			return sl_null;
+		}
+		nTaps = (nTaps + 3) & ~((sl_uint32)3);
+		if (nTaps < 4) {
+			nTaps = 4;
+		}
+		if (nTaps > AUDIO_RESAMPLER_MAX_TAPS) {
+			nTaps = AUDIO_RESAMPLER_MAX_TAPS;
+		}
+		sl_uint32 gcd = _priv_AudioResampler_gcd(samplesPerSecondInput, samplesPerSecondOutput);
+		sl_uint32 nUp = samplesPerSecondOutput / gcd;
+		sl_uint32 nDown = samplesPerSecondInput / gcd;
+		sl_uint32 nPhases = nUp;
+		if (nPhases > AUDIO_RESAMPLER_MAX_PHASES) {
+			nPhases = AUDIO_RESAMPLER_MAX_PHASES;
+		}
+		Memory filters = Memory::create((nPhases + 1) * nTaps * sizeof(float));
+		if (filters.isNull()) {
+			return sl_null;
+		}
+		
+		// the cutoff frequency is lowered below the output Nyquist frequency when downsampling
+		double rolloff = 1;
+		if (nUp != nDown) {
+			rolloff = AUDIO_RESAMPLER_ROLLOFF;
+			if (nUp < nDown) {
+				rolloff = rolloff * nUp / nDown;
+			}
+		}
+		float* f = (float*)(filters.getData());
+		sl_int32 half = (sl_int32)(nTaps >> 1);
+		for (sl_uint32 p = 0; p <= nPhases; p++) {
+			double sum = 0;
+			for (sl_uint32 j = 0; j < nTaps; j++) {
+				// distance from the output position to the input sample
+				double t = (double)(half - 1 - (sl_int32)j) + (double)p / nPhases;
+				double x = rolloff * t * SLIB_PI_LONG;
+				double h = rolloff;
+				if (Math::abs(x) > 1e-9) {
+					h = rolloff * Math::sin(x) / x;
+				}
+				// Blackman window
+				double w = (t + half) / nTaps * SLIB_PI_DUAL_LONG;
+				h *= 0.42 - 0.5 * Math::cos(w) + 0.08 * Math::cos(2 * w);
+				f[j] = (float)h;
+				sum += h;
+			}
+			if (sum > 1e-9) {
+				for (sl_uint32 j = 0; j < nTaps; j++) {
+					f[j] = (float)(f[j] / sum);
+				}
+			}
+			f += nTaps;
+		}
+		
+		Ref<AudioResampler> ret = new AudioResampler;
+		if (ret.isNotNull()) {
+			ret->m_rateInput = samplesPerSecondInput;
+			ret->m_rateOutput = samplesPerSecondOutput;
+			ret->m_nChannels = nChannels;
+			ret->m_nTaps = nTaps;
+			ret->m_nUp = nUp;
+			ret->m_nDown = nDown;
+			ret->m_nPhases = nPhases;
+			ret->m_filters = filters;
+			ret->reset();
+			return ret;
+		}
+		return sl_null;
+	}
+
+	sl_uint32 AudioResampler::getInputSamplingRate()
+	{
+		return m_rateInput;
+	}
+
+	sl_uint32 AudioResampler::getOutputSamplingRate()
+	{
+		return m_rateOutput;
+	}
+
+	sl_uint32 AudioResampler::getChannelsCount()
+	{
+		return m_nChannels;
+	}
+
+	sl_uint32 AudioResampler::getDelay()
+	{
+		return m_nTaps >> 1;
+	}
+
+	sl_size AudioResampler::getOutputSamplesCount(sl_size countInput)
+	{
+		sl_size total = m_countBuffered + countInput;
+		if (total < m_pos + m_nTaps) {
+			return 0;
+		}
+		// count of n satisfying m_pos + (m_phase + n * m_nDown) / m_nUp <= total - m_nTaps
+		sl_uint64 nPositions = total - m_nTaps - m_pos + 1;
+		return (sl_size)((nPositions * m_nUp - m_phase + m_nDown - 1) / m_nDown);
+	}
+
+	sl_size AudioResampler::resample(const AudioData& input, const AudioData& output)
+	{
+		if (input.format != AudioFormat::None && input.count) {
+			if (!(_reserve(m_countBuffered + input.count))) {
+				return 0;
+			}
+			float* buf = (float*)(m_buffer.getData());
+			AudioData audio;
+			audio.count = input.count;
+			audio.data = buf + m_countBuffered;
+			if (m_nChannels == 2) {
+				audio.format = AudioFormat::Float_Stereo_NonInterleaved;
+				audio.data1 = buf + m_capacity + m_countBuffered;
+			} else {
+				audio.format = AudioFormat::Float_Mono;
+			}
+			audio.copySamplesFrom(input);
+			m_countBuffered += input.count;
+		}
+		if (output.format == AudioFormat::None) {
+			return 0;
+		}
+		
+		const float* buf[2];
+		buf[0] = (const float*)(m_buffer.getData());
+		buf[1] = buf[0] + m_capacity;
+		sl_uint32 nTaps = m_nTaps;
+		float samples[2][AUDIO_RESAMPLER_CHUNK];
+		float filter[AUDIO_RESAMPLER_MAX_TAPS];
+		const float* filters = (const float*)(m_filters.getData());
+		
+		sl_size nOutput = 0;
+		while (nOutput < output.count && m_pos + nTaps <= m_countBuffered) {
+			sl_size n = 0;
+			while (n < AUDIO_RESAMPLER_CHUNK && nOutput + n < output.count && m_pos + nTaps <= m_countBuffered) {
+				const float* f;
+				if (m_nPhases == m_nUp) {
+					f = filters + m_phase * nTaps;
+				} else {
+					_getFilter(filter);
+					f = filter;
+				}
+				for (sl_uint32 k = 0; k < m_nChannels; k++) {
+					samples[k][n] = _priv_AudioResampler_dot(f, buf[k] + m_pos, nTaps);
+				}
+				n++;
+				m_phase += m_nDown;
+				m_pos += m_phase / m_nUp;
+				m_phase %= m_nUp;
+			}
+			AudioData src;
+			src.count = n;
+			src.data = samples[0];
+			if (m_nChannels == 2) {
+				src.format = AudioFormat::Float_Stereo_NonInterleaved;
+				src.data1 = samples[1];
+			} else {
+				src.format = AudioFormat::Float_Mono;
+			}
+			AudioData dst;
+			_priv_AudioResampler_getRange(output, nOutput, n, dst);
+			dst.copySamplesFrom(src);
+			nOutput += n;
+		}
+		
+		// discards the consumed samples
+		sl_size nConsumed = m_pos;
+		if (nConsumed > m_countBuffered) {
+			nConsumed = m_countBuffered;
+		}
+		if (nConsumed) {
+			sl_size nRemain = m_countBuffered - nConsumed;
+			for (sl_uint32 k = 0; k < m_nChannels; k++) {
+				float* p = (float*)(buf[k]);
+				Base::moveMemory(p, p + nConsumed, nRemain * sizeof(float));
+			}
+			m_countBuffered = nRemain;
+			m_pos -= nConsumed;
+		}
+		return nOutput;
+	}
+
+	void AudioResampler::reset()
+	{
+		// history of zeros, so that the first output sample is positioned at the first input sample
+		sl_size nHistory = (m_nTaps >> 1) - 1;
+		if (_reserve(nHistory)) {
+			float* buf = (float*)(m_buffer.getData());
+			for (sl_uint32 k = 0; k < m_nChannels; k++) {
+				Base::zeroMemory(buf + k * m_capacity, nHistory * sizeof(float));
+			}
+			m_countBuffered = nHistory;
+		} else {
+			m_countBuffered = 0;
+		}
+		m_pos = 0;
+		m_phase = 0;
+	}
+
+	sl_bool AudioResampler::_reserve(sl_size count)
+	{
+		if (count <= m_capacity) {
+			return sl_true;
+		}
+		sl_size capacity = m_capacity + (m_capacity >> 1);
+		if (capacity < count) {
+			capacity = count;
+		}
+		if (capacity < 1024) {
+			capacity = 1024;
+		}
+		Memory buffer = Memory::create(capacity * m_nChannels * sizeof(float));
+		if (buffer.isNull()) {
+			return sl_false;
+		}
+		float* dst = (float*)(buffer.getData());
+		const float* src = (const float*)(m_buffer.getData());
+		if (src) {
+			for (sl_uint32 k = 0; k < m_nChannels; k++) {
+				Base::copyMemory(dst + k * capacity, src + k * m_capacity, m_countBuffered * sizeof(float));
+			}
+		}
+		m_buffer = buffer;
+		m_capacity = capacity;
+		return sl_true;
+	}
+
+	void AudioResampler::_getFilter(float* filter)
+	{
+		sl_uint64 pos = (sl_uint64)m_phase * m_nPhases;
+		sl_uint32 index = (sl_uint32)(pos / m_nUp);
+		float frac = (float)(pos % m_nUp) / (float)m_nUp;
+		sl_uint32 nTaps = m_nTaps;
+		const float* f0 = (const float*)(m_filters.getData()) + index * nTaps;
+		const float* f1 = f0 + nTaps;
+		for (sl_uint32 j = 0; j < nTaps; j++) {
+			filter[j] = f0[j] + (f1[j] - f0[j]) * frac;
+		}
+	}
+
+}
@@ -22,6 +22,16 @@
 
 #include "slib/media/audio_util.h"
 
+#include "slib/core/base.h"
+
+#if defined(SLIB_ARCH_IS_X64) || (defined(SLIB_ARCH_IS_X86) && (defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+#	define AUDIO_UTIL_USE_SSE2
+#	include <emmintrin.h>
+#elif defined(SLIB_ARCH_IS_ARM64) || defined(__ARM_NEON)
+#	define AUDIO_UTIL_USE_NEON
+#	include <arm_neon.h>
+#endif
+
 #define AUDIO_UTIL_DEF_CONVERT_SAMPLES(TYPE_IN, TYPE_OUT) \
 	void AudioUtil::convertSamples(sl_size count, const TYPE_IN* in, TYPE_OUT* out) \
 	{ \
@@ -30,37 +40,237 @@
 		} \
 	}
 
+#define AUDIO_UTIL_DEF_COPY_SAMPLES(TYPE) \
+	void AudioUtil::convertSamples(sl_size count, const TYPE* in, TYPE* out) \
+	{ \
+		if (in != out) { \
+			Base::copyMemory(out, in, count * sizeof(TYPE)); \
+		} \
+	}
+
+#define AUDIO_UTIL_DEF_MIX_SAMPLES(TYPE) \
+	void AudioUtil::mixSamples(sl_size count, const TYPE* in1, const TYPE* in2, TYPE* out) \
+	{ \
+		for (sl_size i = 0; i < count; i++) { \
+			mixSamples(in1[i], in2[i], out[i]); \
+		} \
+	}
+
+#define AUDIO_UTIL_DEF_MIX_CHANNELS(TYPE, SUM_TYPE) \
+	void AudioUtil::mixChannels(sl_size count, sl_uint32 nChannels, const TYPE* in, TYPE* out) \
+	{ \
+		_priv_AudioUtil_mixChannels<TYPE, SUM_TYPE>(count, nChannels, in, out); \
+	}
+
 namespace slib
 {
 
-	AUDIO_UTIL_DEF_CONVERT_SAMPLES(sl_int8, sl_int8)
+	template <class TYPE, class SUM_TYPE>
+	static void _priv_AudioUtil_mixChannels(sl_size count, sl_uint32 nChannels, const TYPE* in, TYPE* out)
+	{
+		if (nChannels == 0) {
+			return;
+		}
+		if (nChannels == 1) {
+			AudioUtil::convertSamples(count, in, out);
+			return;
+		}
+		if (nChannels == 2) {
+			for (sl_size i = 0; i < count; i++) {
+				AudioUtil::mixSamples(in[0], in[1], out[i]);
+				in += 2;
+			}
+			return;
+		}
+		for (sl_size i = 0; i < count; i++) {
+			SUM_TYPE sum = 0;
+			for (sl_uint32 k = 0; k < nChannels; k++) {
+				sum += in[k];
+			}
+			out[i] = (TYPE)(sum / (SUM_TYPE)nChannels);
+			in += nChannels;
+		}
+	}
+
+	AUDIO_UTIL_DEF_COPY_SAMPLES(sl_int8)
 	AUDIO_UTIL_DEF_CONVERT_SAMPLES(sl_int8, sl_uint8)
 	AUDIO_UTIL_DEF_CONVERT_SAMPLES(sl_int8, sl_int16)
 	AUDIO_UTIL_DEF_CONVERT_SAMPLES(sl_int8, sl_uint16)
 	AUDIO_UTIL_DEF_CONVERT_SAMPLES(sl_int8, float)
 
 	AUDIO_UTIL_DEF_CONVERT_SAMPLES(sl_uint8, sl_int8)
-	AUDIO_UTIL_DEF_CONVERT_SAMPLES(sl_uint8, sl_uint8)
+	AUDIO_UTIL_DEF_COPY_SAMPLES(sl_uint8)
 	AUDIO_UTIL_DEF_CONVERT_SAMPLES(sl_uint8, sl_int16)
 	AUDIO_UTIL_DEF_CONVERT_SAMPLES(sl_uint8, sl_uint16)
 	AUDIO_UTIL_DEF_CONVERT_SAMPLES(sl_uint8, float)
 
 	AUDIO_UTIL_DEF_CONVERT_SAMPLES(sl_int16, sl_int8)
 	AUDIO_UTIL_DEF_CONVERT_SAMPLES(sl_int16, sl_uint8)
-	AUDIO_UTIL_DEF_CONVERT_SAMPLES(sl_int16, sl_int16)
+	AUDIO_UTIL_DEF_COPY_SAMPLES(sl_int16)
 	AUDIO_UTIL_DEF_CONVERT_SAMPLES(sl_int16, sl_uint16)
-	AUDIO_UTIL_DEF_CONVERT_SAMPLES(sl_int16, float)
+
+	// the vector kernels below produce exactly the same results as `convertSample` and `mixSamples`
+	void AudioUtil::convertSamples(sl_size count, const sl_int16* in, float* out)
+	{
+		sl_size i = 0;
+#if defined(AUDIO_UTIL_USE_SSE2)
+		__m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+		for (; i + 8 <= count; i += 8) {
+			__m128i v = _mm_loadu_si128((const __m128i*)(in + i));
+			__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+			__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+			_mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+			_mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+		}
+#elif defined(AUDIO_UTIL_USE_NEON)
+		for (; i + 8 <= count; i += 8) {
+			int16x8_t v = vld1q_s16(in + i);
+			vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), 1.0f / 32768.0f));
+			vst1q_f32(out + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), 1.0f / 32768.0f));
+		}
+#endif
+		for (; i < count; i++) {
+			convertSample(in[i], out[i]);
+		}
+	}
 
 	AUDIO_UTIL_DEF_CONVERT_SAMPLES(sl_uint16, sl_int8)
 	AUDIO_UTIL_DEF_CONVERT_SAMPLES(sl_uint16, sl_uint8)
 	AUDIO_UTIL_DEF_CONVERT_SAMPLES(sl_uint16, sl_int16)
-	AUDIO_UTIL_DEF_CONVERT_SAMPLES(sl_uint16, sl_uint16)
+	AUDIO_UTIL_DEF_COPY_SAMPLES(sl_uint16)
 	AUDIO_UTIL_DEF_CONVERT_SAMPLES(sl_uint16, float)
 
 	AUDIO_UTIL_DEF_CONVERT_SAMPLES(float, sl_int8)
 	AUDIO_UTIL_DEF_CONVERT_SAMPLES(float, sl_uint8)
-	AUDIO_UTIL_DEF_CONVERT_SAMPLES(float, sl_int16)
+
+	void AudioUtil::convertSamples(sl_size count, const float* in, sl_int16* out)
+	{
+		sl_size i = 0;
+#if defined(AUDIO_UTIL_USE_SSE2)
+		__m128 scale = _mm_set1_ps(32768.0f);
+		for (; i + 8 <= count; i += 8) {
+			__m128i lo = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(in + i), scale));
+			__m128i hi = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(in + i + 4), scale));
+			_mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(lo, hi));
+		}
+#elif defined(AUDIO_UTIL_USE_NEON)
+		for (; i + 8 <= count; i += 8) {
+			int32x4_t lo = vcvtq_s32_f32(vmulq_n_f32(vld1q_f32(in + i), 32768.0f));
+			int32x4_t hi = vcvtq_s32_f32(vmulq_n_f32(vld1q_f32(in + i + 4), 32768.0f));
+			vst1q_s16(out + i, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+		}
+#endif
+		for (; i < count; i++) {
+			convertSample(in[i], out[i]);
+		}
+	}
+
 	AUDIO_UTIL_DEF_CONVERT_SAMPLES(float, sl_uint16)
-	AUDIO_UTIL_DEF_CONVERT_SAMPLES(float, float)
+	AUDIO_UTIL_DEF_COPY_SAMPLES(float)
+
+
+	AUDIO_UTIL_DEF_MIX_SAMPLES(sl_int8)
+	AUDIO_UTIL_DEF_MIX_SAMPLES(sl_uint8)
+
+	void AudioUtil::mixSamples(sl_size count, const sl_int16* in1, const sl_int16* in2, sl_int16* out)
+	{
+		sl_size i = 0;
+#if defined(AUDIO_UTIL_USE_SSE2)
+		// (a + b) >> 1 == (a >> 1) + (b >> 1) + (a & b & 1)
+		__m128i one = _mm_set1_epi16(1);
+		for (; i + 8 <= count; i += 8) {
+			__m128i a = _mm_loadu_si128((const __m128i*)(in1 + i));
+			__m128i b = _mm_loadu_si128((const __m128i*)(in2 + i));
+			__m128i v = _mm_add_epi16(_mm_add_epi16(_mm_srai_epi16(a, 1), _mm_srai_epi16(b, 1)), _mm_and_si128(_mm_and_si128(a, b), one));
+			_mm_storeu_si128((__m128i*)(out + i), v);
+		}
+#elif defined(AUDIO_UTIL_USE_NEON)
+		for (; i + 8 <= count; i += 8) {
+			vst1q_s16(out + i, vhaddq_s16(vld1q_s16(in1 + i), vld1q_s16(in2 + i)));
+		}
+#endif
+		for (; i < count; i++) {
+			mixSamples(in1[i], in2[i], out[i]);
+		}
+	}
+
+	AUDIO_UTIL_DEF_MIX_SAMPLES(sl_uint16)
+
+	void AudioUtil::mixSamples(sl_size count, const float* in1, const float* in2, float* out)
+	{
+		sl_size i = 0;
+#if defined(AUDIO_UTIL_USE_SSE2)
+		__m128 half = _mm_set1_ps(0.5f);
+		for (; i + 4 <= count; i += 4) {
+			_mm_storeu_ps(out + i, _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(in1 + i), _mm_loadu_ps(in2 + i)), half));
+		}
+#elif defined(AUDIO_UTIL_USE_NEON)
+		for (; i + 4 <= count; i += 4) {
+			vst1q_f32(out + i, vmulq_n_f32(vaddq_f32(vld1q_f32(in1 + i), vld1q_f32(in2 + i)), 0.5f));
+		}
+#endif
+		for (; i < count; i++) {
+			mixSamples(in1[i], in2[i], out[i]);
+		}
+	}
+
+
+	AUDIO_UTIL_DEF_MIX_CHANNELS(sl_int8, sl_int32)
+	AUDIO_UTIL_DEF_MIX_CHANNELS(sl_uint8, sl_uint32)
+
+	void AudioUtil::mixChannels(sl_size count, sl_uint32 nChannels, const sl_int16* in, sl_int16* out)
+	{
+		if (nChannels != 2) {
+			_priv_AudioUtil_mixChannels<sl_int16, sl_int32>(count, nChannels, in, out);
+			return;
+		}
+		sl_size i = 0;
+#if defined(AUDIO_UTIL_USE_SSE2)
+		for (; i + 8 <= count; i += 8) {
+			__m128i v0 = _mm_loadu_si128((const __m128i*)(in + (i << 1)));
+			__m128i v1 = _mm_loadu_si128((const __m128i*)(in + (i << 1) + 8));
+			__m128i s0 = _mm_add_epi32(_mm_srai_epi32(_mm_slli_epi32(v0, 16), 16), _mm_srai_epi32(v0, 16));
+			__m128i s1 = _mm_add_epi32(_mm_srai_epi32(_mm_slli_epi32(v1, 16), 16), _mm_srai_epi32(v1, 16));
+			_mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(_mm_srai_epi32(s0, 1), _mm_srai_epi32(s1, 1)));
+		}
+#elif defined(AUDIO_UTIL_USE_NEON)
+		for (; i + 8 <= count; i += 8) {
+			int16x8x2_t v = vld2q_s16(in + (i << 1));
+			vst1q_s16(out + i, vhaddq_s16(v.val[0], v.val[1]));
+		}
+#endif
+		for (; i < count; i++) {
+			mixSamples(in[i << 1], in[(i << 1) + 1], out[i]);
+		}
+	}
+
+	AUDIO_UTIL_DEF_MIX_CHANNELS(sl_uint16, sl_int32)
+
+	void AudioUtil::mixChannels(sl_size count, sl_uint32 nChannels, const float* in, float* out)
+	{
+		if (nChannels != 2) {
+			_priv_AudioUtil_mixChannels<float, float>(count, nChannels, in, out);
+			return;
+		}
+		sl_size i = 0;
+#if defined(AUDIO_UTIL_USE_SSE2)
+		__m128 half = _mm_set1_ps(0.5f);
+		for (; i + 4 <= count; i += 4) {
+			__m128 v0 = _mm_loadu_ps(in + (i << 1));
+			__m128 v1 = _mm_loadu_ps(in + (i << 1) + 4);
+			__m128 even = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(2, 0, 2, 0));
+			__m128 odd = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(3, 1, 3, 1));
+			_mm_storeu_ps(out + i, _mm_mul_ps(_mm_add_ps(even, odd), half));
+		}
+#elif defined(AUDIO_UTIL_USE_NEON)
+		for (; i + 4 <= count; i += 4) {
+			float32x4x2_t v = vld2q_f32(in + (i << 1));
+			vst1q_f32(out + i, vmulq_n_f32(vaddq_f32(v.val[0], v.val[1]), 0.5f));
+		}
+#endif
+		for (; i < count; i++) {
+			mixSamples(in[i << 1], in[(i << 1) + 1], out[i]);
+		}
+	}
 
 }
@@ -25,6 +25,7 @@
 #include "slib/core/log.h"
 #include "slib/core/io.h"
 #include "slib/core/scoped.h"
+#include "slib/core/list.h"
 
 #include "vpx/vp8cx.h"
 #include "vpx/vp8dx.h"
@@ -188,24 +189,53 @@ namespace slib
 		{
 			if (m_nWidth == input.image.width && m_nHeight == input.image.height) {
 				
-				BitmapData dst;
-				dst.width = m_codec_image->w;
-				dst.height = m_codec_image->h;
-				dst.format = BitmapFormat::YUV_I420;
-				dst.data = m_codec_image->planes[0];
-				dst.pitch = m_codec_image->stride[0];
-				dst.data1 = m_codec_image->planes[1];
-				dst.pitch1 = m_codec_image->stride[1];
-				dst.data2 = m_codec_image->planes[2];
-				dst.pitch2 = m_codec_image->stride[2];
+				vpx_image_t* codec_image = m_codec_image;
+				vpx_image_t wrapped_image;
 				
-				dst.copyPixelsFrom(input.image);
+				BitmapData src(input.image);
+				if (src.format == BitmapFormat::YUV_I420 || src.format == BitmapFormat::YUV_YV12) {
+					src.fillDefaultValues();
+				}
+				if ((src.format == BitmapFormat::YUV_I420 || src.format == BitmapFormat::YUV_YV12) && src.data && src.pitch > 0 && src.pitch1 > 0 && src.pitch2 > 0) {
+					// the planes already match the layout of the codec, so they are passed without copy
+					wrapped_image = *m_codec_image;
+					wrapped_image.img_data = sl_null;
+					wrapped_image.img_data_owner = 0;
+					wrapped_image.self_allocd = 0;
+					wrapped_image.planes[VPX_PLANE_Y] = (unsigned char*)(src.data);
+					wrapped_image.stride[VPX_PLANE_Y] = src.pitch;
+					if (src.format == BitmapFormat::YUV_I420) {
+						wrapped_image.planes[VPX_PLANE_U] = (unsigned char*)(src.data1);
+						wrapped_image.stride[VPX_PLANE_U] = src.pitch1;
+						wrapped_image.planes[VPX_PLANE_V] = (unsigned char*)(src.data2);
+						wrapped_image.stride[VPX_PLANE_V] = src.pitch2;
+					} else {
+						wrapped_image.planes[VPX_PLANE_U] = (unsigned char*)(src.data2);
+						wrapped_image.stride[VPX_PLANE_U] = src.pitch2;
+						wrapped_image.planes[VPX_PLANE_V] = (unsigned char*)(src.data1);
+						wrapped_image.stride[VPX_PLANE_V] = src.pitch1;
+					}
+					codec_image = &wrapped_image;
+				} else {
+					BitmapData dst;
+					dst.width = m_codec_image->w;
+					dst.height = m_codec_image->h;
+					dst.format = BitmapFormat::YUV_I420;
+					dst.data = m_codec_image->planes[0];
+					dst.pitch = m_codec_image->stride[0];
+					dst.data1 = m_codec_image->planes[1];
+					dst.pitch1 = m_codec_image->stride[1];
+					dst.data2 = m_codec_image->planes[2];
+					dst.pitch2 = m_codec_image->stride[2];
+					
+					dst.copyPixelsFrom(input.image);
+				}
 				
 				sl_int32 flags = 0;
 				if (m_nProcessFrameCount > 0 && m_nProcessFrameCount % m_nKeyFrameInterval == 0) {
 					flags |= VPX_EFLAG_FORCE_KF;
 				}
-				vpx_codec_err_t res = vpx_codec_encode(m_codec, m_codec_image, m_nProcessFrameCount++, 1, flags, VPX_DL_REALTIME);
+				vpx_codec_err_t res = vpx_codec_encode(m_codec, codec_image, m_nProcessFrameCount++, 1, flags, VPX_DL_REALTIME);
 				if (res == VPX_CODEC_OK) {
 					vpx_codec_iter_t iter = sl_null;
 					const vpx_codec_cx_pkt_t *pkt = sl_null;
@@ -257,6 +287,9 @@ namespace slib
 	{
 	public:
 		vpx_codec_ctx_t* m_codec;
+		
+		// a buffer is free when the pool holds the only reference
+		CList<Memory> m_framePool;
 
 	public:
 		_priv_VpxDecoderImpl()
@@ -278,6 +311,55 @@ namespace slib
 		{
 			LogError("VideoVpxDecoder", str);
 		}
+		
+		Memory getFrameBuffer(sl_size size)
+		{
+			ObjectLocker lock(&m_framePool);
+			Memory* buffers = m_framePool.getData();
+			sl_size n = m_framePool.getCount();
+			for (sl_size i = 0; i < n; i++) {
+				CMemory* buffer = buffers[i].ref.get();
+				if (buffer->getReferenceCount() == 1) {
+					if (buffer->getCount() >= size) {
+						return buffers[i];
+					}
+					m_framePool.removeAt_NoLock(i);
+					break;
+				}
+			}
+			Memory buffer = Memory::create(size);
+			if (buffer.isNull()) {
+				return sl_null;
+			}
+			Base::zeroMemory(buffer.getData(), size);
+			m_framePool.add_NoLock(buffer);
+			return buffer;
+		}
+		
+		static int callbackGetFrameBuffer(void* priv, size_t min_size, vpx_codec_frame_buffer_t* fb)
+		{
+			_priv_VpxDecoderImpl* decoder = (_priv_VpxDecoderImpl*)priv;
+			Memory buffer = decoder->getFrameBuffer(min_size);
+			if (buffer.isNull()) {
+				return -1;
+			}
+			// held by the decoder until the release callback
+			CMemory* ref = buffer.ref.get();
+			ref->increaseReference();
+			fb->data = (uint8_t*)(ref->getData());
+			fb->size = ref->getCount();
+			fb->priv = ref;
+			return 0;
+		}
+		
+		static int callbackReleaseFrameBuffer(void* priv, vpx_codec_frame_buffer_t* fb)
+		{
+			CMemory* ref = (CMemory*)(fb->priv);
+			if (ref) {
+				ref->decreaseReference();
+			}
+			return 0;
+		}
 
 		static Ref<_priv_VpxDecoderImpl> create(const VpxDecoderParam& param)
 		{
@@ -299,6 +381,8 @@ namespace slib
 							ret->m_nWidth = param.width;
 							ret->m_nHeight = param.height;
 							ret->m_codec = codec;
+							// decodes directly into pooled buffers (VP9 only)
+							vpx_codec_set_frame_buffer_functions(codec, &callbackGetFrameBuffer, &callbackReleaseFrameBuffer, ret.get());
 							return ret;
 						}
 						vpx_codec_destroy(codec);
@@ -330,15 +414,20 @@ namespace slib
 			}
 		}
 
-		sl_bool decode(const void* input, const sl_uint32& inputSize , VideoFrame& output)
+		sl_bool decode(const void* input, const sl_uint32& inputSize , VideoFrame& output) override
 		{
 			MemoryReader reader(input, inputSize);
 			sl_int64 pts = reader.readInt64();
 			SLIB_UNUSED(pts);
 			sl_int64 size = reader.readInt64();
+			
+			sl_bool flagDecoded = sl_false;
 
 			if (!vpx_codec_decode(m_codec, (sl_uint8*)input + 16, (unsigned int)size, NULL, 0)) {
 				
+				// frames are handed out by reference when `output` has no buffer
+				sl_bool flagReference = !(output.image.data);
+				
 				vpx_codec_iter_t iter = NULL;
 				
 				vpx_image_t* image;
@@ -346,8 +435,8 @@ namespace slib
 				while ((image = vpx_codec_get_frame(m_codec, &iter)) != NULL) {
 					
 					BitmapData src;
-					src.width = image->w;
-					src.height = image->h;
+					src.width = image->d_w;
+					src.height = image->d_h;
 					src.format = BitmapFormat::YUV_I420;
 					src.data = image->planes[0];
 					src.pitch = image->stride[0];
@@ -356,10 +445,43 @@ namespace slib
 					src.data2 = image->planes[2];
 					src.pitch2 = image->stride[2];
 					
-					output.image.copyPixelsFrom(src);				
+					if (!flagReference) {
+						output.image.copyPixelsFrom(src);
+					} else if (image->fb_priv) {
+						// decoded into a pooled buffer, which is reused after the caller releases the frame
+						src.ref = (CMemory*)(image->fb_priv);
+						src.ref1 = src.ref;
+						src.ref2 = src.ref;
+						output.image = src;
+					} else {
+						sl_uint32 widthUV = (src.width + 1) >> 1;
+						sl_uint32 heightUV = (src.height + 1) >> 1;
+						sl_size sizeY = (sl_size)(src.width) * src.height;
+						sl_size sizeUV = (sl_size)widthUV * heightUV;
+						Memory buffer = getFrameBuffer(sizeY + (sizeUV << 1));
+						if (buffer.isNull()) {
+							continue;
+						}
+						BitmapData dst;
+						dst.width = src.width;
+						dst.height = src.height;
+						dst.format = BitmapFormat::YUV_I420;
+						dst.data = buffer.getData();
+						dst.pitch = src.width;
+						dst.data1 = (sl_uint8*)(dst.data) + sizeY;
+						dst.pitch1 = widthUV;
+						dst.data2 = (sl_uint8*)(dst.data1) + sizeUV;
+						dst.pitch2 = widthUV;
+						dst.copyPixelsFrom(src);
+						dst.ref = buffer.ref;
+						dst.ref1 = buffer.ref;
+						dst.ref2 = buffer.ref;
+						output.image = dst;
+					}
+					flagDecoded = sl_true;
 				}
 			}
-			return sl_false;
+			return flagDecoded;
 		}
 	};
 
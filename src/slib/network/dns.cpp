@@ -26,6 +26,11 @@
 #include "slib/core/scoped.h"
 #include "slib/core/mio.h"
 #include "slib/core/log.h"
+#include "slib/core/file.h"
+#include "slib/core/math.h"
+#include "slib/core/system.h"
+#include "slib/core/dispatch.h"
+#include "slib/core/safe_static.h"
 
 #define PRIV_MAX_NAME SLIB_NETWORK_DNS_NAME_MAX_LENGTH
 
@@ -547,6 +552,7 @@ namespace slib
 	{
 		id = 0;
 		flagQuestion = sl_false;
+		responseCode = DnsResponseCode::NoError;
 	}
 
 	DnsPacket::~DnsPacket()
@@ -568,6 +574,7 @@ namespace slib
 				flagQuestion = sl_false;
 			}
 			id = header->getId();
+			responseCode = header->getResponseCode();
 			
 			sl_uint32 i, n;
 			sl_uint32 offset = sizeof(DnsHeader);
@@ -601,6 +608,7 @@ namespace slib
 					IPv4Address addr = record.parseData_A();
 					if (addr.isNotZero()) {
 						item.address = addr;
+						item.TTL = record.getTTL();
 						addresses.add(item);
 					}
 				} else if (type == DnsRecordType::AAAA) {
@@ -609,12 +617,14 @@ namespace slib
 					IPv6Address addr = record.parseData_AAAA();
 					if (addr.isNotZero()) {
 						item.address = addr;
+						item.TTL = record.getTTL();
 						addresses.add(item);
 					}
 				} else if (type == DnsRecordType::CNAME) {
 					DnsPacket::Alias item;
 					item.name = record.getName();
 					item.alias = record.parseData_CNAME();
+					item.TTL = record.getTTL();
 					if (item.alias.isNotEmpty()) {
 						aliases.add(item);
 					}
@@ -643,6 +653,11 @@ namespace slib
 	}
 
 	Memory DnsPacket::buildQuestionPacket(sl_uint16 id, const String& host)
+	{
+		return buildQuestionPacket(id, host, DnsRecordType::A);
+	}
+	
+	Memory DnsPacket::buildQuestionPacket(sl_uint16 id, const String& host, DnsRecordType type)
 	{
 		char buf[1024];
 		DnsHeader* header = (DnsHeader*)buf;
@@ -654,7 +669,7 @@ namespace slib
 		header->setQuestionsCount(1);
 		DnsQuestionRecord record;
 		record.setName(host);
-		record.setType(DnsRecordType::A);
+		record.setType(type);
 		sl_uint32 size = record.buildRecord(buf, sizeof(DnsHeader), 1024);
 		if (size > 0) {
 			return Memory::create(buf, size);
@@ -737,7 +752,7 @@ namespace slib
 
 	DnsClient::DnsClient()
 	{
-		m_idLast = 0;
+		m_idLast = (sl_uint16)(Math::randomInt());
 	}
 
 	DnsClient::~DnsClient()
@@ -761,18 +776,29 @@ namespace slib
 		return ret;
 	}
 
-	void DnsClient::sendQuestion(const SocketAddress& serverAddress, const String& hostName)
+	sl_uint16 DnsClient::sendQuestion(const SocketAddress& serverAddress, const String& hostName, DnsRecordType type)
+	{
+		// unpredictable id makes spoofed answers harder
+		sl_uint16 id = (sl_uint16)(Math::randomInt());
+		if (id == m_idLast) {
+			id++;
+		}
+		m_idLast = id;
+		sendQuestion(id, serverAddress, hostName, type);
+		return id;
+	}
+
+	void DnsClient::sendQuestion(sl_uint16 id, const SocketAddress& serverAddress, const String& hostName, DnsRecordType type)
 	{
-		sl_uint16 id = m_idLast++;
-		Memory mem = DnsPacket::buildQuestionPacket(id, hostName);
+		Memory mem = DnsPacket::buildQuestionPacket(id, hostName, type);
 		if (mem.isNotNull()) {
 			m_udp->sendTo(serverAddress, mem);
 		}
 	}
 
-	void DnsClient::sendQuestion(const IPv4Address& serverIp, const String& hostName)
+	sl_uint16 DnsClient::sendQuestion(const IPv4Address& serverIp, const String& hostName)
 	{
-		sendQuestion(SocketAddress(serverIp, SLIB_NETWORK_DNS_PORT), hostName);
+		return sendQuestion(SocketAddress(serverIp, SLIB_NETWORK_DNS_PORT), hostName);
 	}
 
 	void DnsClient::_onReceiveFrom(AsyncUdpSocket* socket, const SocketAddress& address, void* data, sl_uint32 sizeReceive)
@@ -788,6 +814,450 @@ namespace slib
 		m_onAnswer(this, serverAddress, packet);
 	}
 
+/*************************************************************
+				DnsResolver
+*************************************************************/
+
+	DnsResolverParam::DnsResolverParam()
+	{
+		timeout = 2000;
+		retryCount = 2;
+		maxCacheTTL = 3600;
+		negativeCacheTTL = 30;
+		flagUseHostsFile = sl_true;
+	}
+
+	DnsResolverParam::~DnsResolverParam()
+	{
+	}
+	
+	class DnsResolver::Lookup : public Referable
+	{
+	public:
+		String hostName;
+		List< Function<void(const List<IPAddress>&)> > callbacks;
+		sl_uint16 id;
+		sl_uint32 attempt;
+		SocketAddress serverAddress;
+		sl_bool flagCompleted;
+		
+	public:
+		Lookup()
+		{
+			id = 0;
+			attempt = 0;
+			flagCompleted = sl_false;
+		}
+		
+	};
+	
+	class _priv_DnsResolver_Default
+	{
+	public:
+		SpinLock lock;
+		Ref<DnsResolver> resolver;
+		sl_bool flagInit;
+		
+	public:
+		_priv_DnsResolver_Default()
+		{
+			flagInit = sl_false;
+		}
+		
+	};
+	
+	static _priv_DnsResolver_Default* _priv_DnsResolver_getDefault()
+	{
+		SLIB_SAFE_STATIC(_priv_DnsResolver_Default, ret)
+		if (SLIB_SAFE_STATIC_CHECK_FREED(ret)) {
+			return sl_null;
+		}
+		return &ret;
+	}
+	
+	static String _priv_DnsResolver_normalizeName(const String& hostName)
+	{
+		String name = hostName.toLower();
+		if (name.endsWith('.')) {
+			name = name.substring(0, name.getLength() - 1);
+		}
+		return name;
+	}
+
+	SLIB_DEFINE_OBJECT(DnsResolver, Object)
+
+	DnsResolver::DnsResolver()
+	{
+	}
+
+	DnsResolver::~DnsResolver()
+	{
+	}
+
+	Ref<DnsResolver> DnsResolver::create(const DnsResolverParam& param)
+	{
+		Ref<AsyncIoLoop> loop = param.ioLoop;
+		if (loop.isNull()) {
+			loop = AsyncIoLoop::getDefault();
+			if (loop.isNull()) {
+				return sl_null;
+			}
+		}
+		Ref<DnsResolver> ret = new DnsResolver;
+		if (ret.isNull()) {
+			return sl_null;
+		}
+		ret->m_param = param;
+		if (ret->m_param.serverAddresses.isEmpty()) {
+			ret->m_param.serverAddresses = getSystemServerAddresses();
+		}
+		ret->m_ioLoop = loop;
+		DnsClientParam cp;
+		cp.onAnswer = SLIB_FUNCTION_WEAKREF(DnsResolver, _onAnswer, ret);
+		cp.ioLoop = loop;
+		ret->m_client = DnsClient::create(cp);
+		if (ret->m_client.isNull()) {
+			return sl_null;
+		}
+#if !defined(SLIB_PLATFORM_IS_WINDOWS)
+		if (param.flagUseHostsFile) {
+			ListElements<String> lines(File::readAllTextUTF8("/etc/hosts").split("\n"));
+			for (sl_size i = 0; i < lines.count; i++) {
+				String line = lines[i];
+				sl_reg indexComment = line.indexOf('#');
+				if (indexComment >= 0) {
+					line = line.substring(0, indexComment);
+				}
+				ListElements<String> fields(line.replaceAll("\t", " ").split(" "));
+				IPAddress ip;
+				sl_size k = 0;
+				for (; k < fields.count; k++) {
+					if (fields[k].isNotEmpty()) {
+						break;
+					}
+				}
+				if (k >= fields.count || !(ip.parse(fields[k])) || !(ip.isIPv4())) {
+					continue;
+				}
+				for (k++; k < fields.count; k++) {
+					String name = _priv_DnsResolver_normalizeName(fields[k]);
+					if (name.isNotEmpty() && !(ret->m_cache.find_NoLock(name))) {
+						ret->addStaticAddresses(name, List<IPAddress>::createFromElement(ip));
+					}
+				}
+			}
+		}
+#endif
+		return ret;
+	}
+	
+	Ref<DnsResolver> DnsResolver::getDefault()
+	{
+		_priv_DnsResolver_Default* def = _priv_DnsResolver_getDefault();
+		if (!def) {
+			return sl_null;
+		}
+		SpinLocker lock(&(def->lock));
+		if (!(def->flagInit)) {
+			def->flagInit = sl_true;
+			DnsResolverParam param;
+			param.serverAddresses = getSystemServerAddresses();
+			if (param.serverAddresses.isNotEmpty()) {
+				def->resolver = create(param);
+			}
+		}
+		return def->resolver;
+	}
+	
+	void DnsResolver::setDefault(const Ref<DnsResolver>& resolver)
+	{
+		_priv_DnsResolver_Default* def = _priv_DnsResolver_getDefault();
+		if (!def) {
+			return;
+		}
+		SpinLocker lock(&(def->lock));
+		def->flagInit = sl_true;
+		def->resolver = resolver;
+	}
+	
+	List<SocketAddress> DnsResolver::getSystemServerAddresses()
+	{
+		List<SocketAddress> ret;
+#if !defined(SLIB_PLATFORM_IS_WINDOWS)
+		ListElements<String> lines(File::readAllTextUTF8("/etc/resolv.conf").split("\n"));
+		for (sl_size i = 0; i < lines.count; i++) {
+			String line = lines[i].trim();
+			if (line.startsWith("nameserver")) {
+				IPAddress ip;
+				if (ip.parse(line.substring(10).trim()) && ip.isIPv4()) {
+					ret.add_NoLock(SocketAddress(ip, SLIB_NETWORK_DNS_PORT));
+				}
+			}
+		}
+#endif
+		return ret;
+	}
+	
+	void DnsResolver::resolve(const String& _hostName, const Function<void(const List<IPAddress>& addresses)>& callback)
+	{
+		IPAddress ip;
+		if (ip.parse(_hostName)) {
+			callback(List<IPAddress>::createFromElement(ip));
+			return;
+		}
+		String hostName = _priv_DnsResolver_normalizeName(_hostName);
+		if (hostName.isEmpty()) {
+			callback(sl_null);
+			return;
+		}
+		ObjectLocker lock(this);
+		CacheEntry entry;
+		if (m_cache.get_NoLock(hostName, &entry)) {
+			if (entry.flagStatic || (sl_int32)(entry.timeExpire - System::getTickCount()) > 0) {
+				lock.unlock();
+				callback(entry.addresses);
+				return;
+			}
+			m_cache.remove_NoLock(hostName);
+		}
+		Ref<Lookup> lookup;
+		if (m_lookupsByName.get_NoLock(hostName, &lookup)) {
+			lookup->callbacks.add_NoLock(callback);
+			return;
+		}
+		lookup = new Lookup;
+		if (lookup.isNull()) {
+			lock.unlock();
+			callback(sl_null);
+			return;
+		}
+		lookup->hostName = hostName;
+		lookup->callbacks.add_NoLock(callback);
+		m_lookupsByName.put_NoLock(hostName, lookup);
+		_send(lookup.get());
+	}
+	
+	List<IPAddress> DnsResolver::resolveAndWait(const String& hostName)
+	{
+		Ref<Event> ev = Event::create();
+		if (ev.isNull()) {
+			return sl_null;
+		}
+		struct Result : public Referable
+		{
+			List<IPAddress> addresses;
+		};
+		Ref<Result> result = new Result;
+		resolve(hostName, [ev, result](const List<IPAddress>& addresses) {
+			result->addresses = addresses;
+			ev->set();
+		});
+		ev->wait(m_param.timeout * (m_param.retryCount + 1) + 1000);
+		return result->addresses;
+	}
+	
+	sl_bool DnsResolver::getCachedAddresses(const String& _hostName, List<IPAddress>* addresses)
+	{
+		String hostName = _priv_DnsResolver_normalizeName(_hostName);
+		ObjectLocker lock(this);
+		CacheEntry entry;
+		if (m_cache.get_NoLock(hostName, &entry)) {
+			if (entry.flagStatic || (sl_int32)(entry.timeExpire - System::getTickCount()) > 0) {
+				if (addresses) {
+					*addresses = entry.addresses;
+				}
+				return sl_true;
+			}
+		}
+		return sl_false;
+	}
+	
+	void DnsResolver::addStaticAddresses(const String& hostName, const List<IPAddress>& addresses)
+	{
+		CacheEntry entry;
+		entry.addresses = addresses;
+		entry.timeExpire = 0;
+		entry.flagStatic = sl_true;
+		ObjectLocker lock(this);
+		m_cache.put_NoLock(_priv_DnsResolver_normalizeName(hostName), entry);
+	}
+	
+	void DnsResolver::clearCache()
+	{
+		ObjectLocker lock(this);
+		List<String> names;
+		for (auto& item : m_cache) {
+			if (!(item.value.flagStatic)) {
+				names.add_NoLock(item.key);
+			}
+		}
+		for (auto& name : names) {
+			m_cache.remove_NoLock(name);
+		}
+	}
+	
+	void DnsResolver::_send(Lookup* lookup)
+	{
+		if (lookup->id) {
+			m_lookupsById.remove_NoLock(lookup->id);
+			lookup->id = 0;
+		}
+		sl_size nServers = m_param.serverAddresses.getCount();
+		// all ids except zero are in use by the lookups in flight
+		if (!nServers || m_lookupsById.getCount() >= 0xFFFF) {
+			WeakRef<DnsResolver> thiz = this;
+			Ref<Lookup> refLookup = lookup;
+			m_ioLoop->dispatch([thiz, refLookup]() {
+				Ref<DnsResolver> resolver = thiz;
+				if (resolver.isNotNull()) {
+					resolver->_complete(refLookup.get(), sl_null, 0);
+				}
+			}, 0);
+			return;
+		}
+		lookup->serverAddress = m_param.serverAddresses.getValueAt_NoLock(lookup->attempt % nServers);
+		// unpredictable id makes spoofed answers harder, and must not be shared with other lookups in flight
+		sl_uint16 id;
+		do {
+			id = (sl_uint16)(Math::randomInt());
+		} while (!id || m_lookupsById.find_NoLock(id));
+		lookup->id = id;
+		m_lookupsById.put_NoLock(id, lookup);
+		m_client->sendQuestion(id, lookup->serverAddress, lookup->hostName);
+		WeakRef<DnsResolver> thiz = this;
+		Ref<Lookup> refLookup = lookup;
+		sl_uint32 attempt = lookup->attempt;
+		Dispatch::setTimeout([thiz, refLookup, attempt]() {
+			Ref<DnsResolver> resolver = thiz;
+			if (resolver.isNotNull()) {
+				resolver->_onTimeout(refLookup.get(), attempt);
+			}
+		}, m_param.timeout);
+	}
+	
+	void DnsResolver::_complete(Lookup* lookup, const List<IPAddress>& addresses, sl_uint32 TTL)
+	{
+		ObjectLocker lock(this);
+		if (lookup->flagCompleted) {
+			return;
+		}
+		lookup->flagCompleted = sl_true;
+		m_lookupsByName.remove_NoLock(lookup->hostName);
+		m_lookupsById.remove_NoLock(lookup->id);
+		if (TTL) {
+			if (TTL > m_param.maxCacheTTL) {
+				TTL = m_param.maxCacheTTL;
+			}
+			CacheEntry entry;
+			entry.addresses = addresses;
+			entry.timeExpire = System::getTickCount() + TTL * 1000;
+			entry.flagStatic = sl_false;
+			m_cache.put_NoLock(lookup->hostName, entry);
+		}
+		ListElements< Function<void(const List<IPAddress>&)> > callbacks(lookup->callbacks);
+		lock.unlock();
+		for (sl_size i = 0; i < callbacks.count; i++) {
+			callbacks[i](addresses);
+		}
+	}
+	
+	void DnsResolver::_onTimeout(Lookup* lookup, sl_uint32 attempt)
+	{
+		ObjectLocker lock(this);
+		if (lookup->flagCompleted || lookup->attempt != attempt) {
+			return;
+		}
+		lookup->attempt++;
+		if (lookup->attempt > m_param.retryCount) {
+			lock.unlock();
+			_complete(lookup, sl_null, 0);
+			return;
+		}
+		_send(lookup);
+	}
+	
+	void DnsResolver::_onAnswer(DnsClient* client, const SocketAddress& serverAddress, const DnsPacket& packet)
+	{
+		if (packet.flagQuestion) {
+			return;
+		}
+		ObjectLocker lock(this);
+		Ref<Lookup> lookup;
+		if (!(m_lookupsById.get_NoLock(packet.id, &lookup))) {
+			return;
+		}
+		if (lookup->flagCompleted || lookup->id != packet.id || lookup->serverAddress != serverAddress) {
+			return;
+		}
+		sl_bool flagMatch = sl_false;
+		{
+			ListElements<DnsPacket::Question> questions(packet.questions);
+			for (sl_size i = 0; i < questions.count; i++) {
+				if (questions[i].name.equalsIgnoreCase(lookup->hostName)) {
+					flagMatch = sl_true;
+					break;
+				}
+			}
+		}
+		if (!flagMatch) {
+			return;
+		}
+		if (packet.responseCode == DnsResponseCode::NoError || packet.responseCode == DnsResponseCode::NameError) {
+			sl_uint32 TTL = m_param.maxCacheTTL;
+			// follows CNAME chain
+			List<String> names;
+			String name = lookup->hostName;
+			names.add_NoLock(name);
+			ListElements<DnsPacket::Alias> aliases(packet.aliases);
+			for (sl_uint32 depth = 0; depth < 8; depth++) {
+				sl_size i = 0;
+				for (; i < aliases.count; i++) {
+					if (aliases[i].name.equalsIgnoreCase(name)) {
+						break;
+					}
+				}
+				if (i >= aliases.count) {
+					break;
+				}
+				name = aliases[i].alias;
+				names.add_NoLock(name);
+				if (aliases[i].TTL < TTL) {
+					TTL = aliases[i].TTL;
+				}
+			}
+			List<IPAddress> addresses;
+			ListElements<DnsPacket::Address> items(packet.addresses);
+			for (sl_size i = 0; i < items.count; i++) {
+				DnsPacket::Address& item = items[i];
+				if (item.address.isIPv4()) {
+					for (auto& n : names) {
+						if (item.name.equalsIgnoreCase(n)) {
+							addresses.add_NoLock(item.address);
+							if (item.TTL < TTL) {
+								TTL = item.TTL;
+							}
+							break;
+						}
+					}
+				}
+			}
+			if (addresses.isEmpty()) {
+				TTL = m_param.negativeCacheTTL;
+			}
+			lock.unlock();
+			_complete(lookup.get(), addresses, TTL);
+			return;
+		}
+		// server failure: tries next server
+		lookup->attempt++;
+		if (lookup->attempt > m_param.retryCount) {
+			lock.unlock();
+			_complete(lookup.get(), sl_null, 0);
+			return;
+		}
+		_send(lookup.get());
+	}
+
 /*************************************************************
 					DnsServer
 *************************************************************/
@@ -816,6 +1286,12 @@ namespace slib
 		flagEncryptDefaultForward = sl_false;
 
 		flagAutoStart = sl_true;
+
+		countDnsSockets = 1;
+
+		flagCacheAnswers = sl_false;
+		cacheTTL = 60;
+		cacheSize = 4096;
 	}
 
 	DnsServerParam::~DnsServerParam()
@@ -833,6 +1309,12 @@ namespace slib
 		IPv4Address defaultForwardAddressIp = IPv4Address(8, 8, 4, 4);
 		defaultForwardAddressIp.parse(conf.getItem("forward_dns").getString());
 		defaultForwardAddress = SocketAddress(defaultForwardAddressIp, SLIB_NETWORK_DNS_PORT);
+
+		countDnsSockets = conf.getItem("dns_sockets").getUint32(1);
+
+		flagCacheAnswers = conf.getItem("cache_answers").getBoolean(sl_false);
+		cacheTTL = conf.getItem("cache_ttl").getUint32(60);
+		cacheSize = conf.getItem("cache_size").getUint32(4096);
 	}
 
 
@@ -847,15 +1329,112 @@ namespace slib
 
 		m_flagEncryptDefaultForward = sl_false;
 		m_flagProxy = sl_false;
+
+		m_flagCacheAnswers = sl_false;
+		m_cacheTTL = 0;
+		m_nCacheBuckets = 0;
 	}
 
 	DnsServer::~DnsServer()
 	{
 		release();
+		for (auto& loop : m_listIoLoops) {
+			loop->release();
+		}
 	}
 
 #define TAG_SERVER "DnsServer"
 
+#define DNS_SERVER_CACHE_WAYS 4
+#define DNS_SERVER_CACHE_PACKET_SIZE_MAX 512
+
+	// returns the size of the single question following the header, or zero if the packet is not cacheable
+	static sl_uint32 _priv_DnsServer_getQuestionSize(const sl_uint8* packet, sl_uint32 size)
+	{
+		if (size < sizeof(DnsHeader)) {
+			return 0;
+		}
+		if (((DnsHeader*)packet)->getQuestionsCount() != 1) {
+			return 0;
+		}
+		sl_uint32 offset = sizeof(DnsHeader);
+		for (;;) {
+			if (offset >= size) {
+				return 0;
+			}
+			sl_uint32 n = packet[offset];
+			if (n & 0xC0) {
+				return 0;
+			}
+			offset += n + 1;
+			if (!n) {
+				break;
+			}
+		}
+		offset += 4; // type, class
+		if (offset > size) {
+			return 0;
+		}
+		return offset - sizeof(DnsHeader);
+	}
+
+	// name is compared case-insensitively, label lengths are less than 64 and are not affected
+	static sl_uint32 _priv_DnsServer_hashQuestion(const sl_uint8* question, sl_uint32 size)
+	{
+		sl_uint32 hash = 2166136261U;
+		sl_uint32 sizeName = size - 4;
+		for (sl_uint32 i = 0; i < size; i++) {
+			sl_uint32 ch = question[i];
+			if (i < sizeName && ch >= 'A' && ch <= 'Z') {
+				ch += 'a' - 'A';
+			}
+			hash = (hash ^ ch) * 16777619U;
+		}
+		return hash;
+	}
+
+	static sl_bool _priv_DnsServer_equalsQuestion(const sl_uint8* q1, const sl_uint8* q2, sl_uint32 size)
+	{
+		sl_uint32 sizeName = size - 4;
+		for (sl_uint32 i = 0; i < sizeName; i++) {
+			sl_uint32 c1 = q1[i];
+			sl_uint32 c2 = q2[i];
+			if (c1 != c2) {
+				if (c1 >= 'A' && c1 <= 'Z') {
+					c1 += 'a' - 'A';
+				}
+				if (c2 >= 'A' && c2 <= 'Z') {
+					c2 += 'a' - 'A';
+				}
+				if (c1 != c2) {
+					return sl_false;
+				}
+			}
+		}
+		return Base::equalsMemory(q1 + sizeName, q2 + sizeName, 4);
+	}
+
+	static sl_uint32 _priv_DnsServer_getMinimumTTL(const DnsPacket& packet)
+	{
+		sl_uint32 TTL = 0;
+		sl_bool flagFound = sl_false;
+		ListElements<DnsPacket::Address> addresses(packet.addresses);
+		for (sl_size i = 0; i < addresses.count; i++) {
+			if (!flagFound || addresses[i].TTL < TTL) {
+				TTL = addresses[i].TTL;
+				flagFound = sl_true;
+			}
+		}
+		ListElements<DnsPacket::Alias> aliases(packet.aliases);
+		for (sl_size i = 0; i < aliases.count; i++) {
+			if (!flagFound || aliases[i].TTL < TTL) {
+				TTL = aliases[i].TTL;
+				flagFound = sl_true;
+			}
+		}
+		return TTL;
+	}
+
 	Ref<DnsServer> DnsServer::create(const DnsServerParam& param)
 	{
 		Ref<DnsServer> ret = new DnsServer;
@@ -868,13 +1447,50 @@ namespace slib
 			up.ioLoop = param.ioLoop;
 			up.flagAutoStart = sl_false;
 			
-			up.bindAddress.port = param.portDns;
-			Ref<AsyncUdpSocket> socketDns = AsyncUdpSocket::create(up);
-			if (socketDns.isNull()) {
-				LogError(TAG_SERVER, "Failed to bind to port %d", param.portDns);
-				return sl_null;
+			sl_uint32 nSocketsDns = param.countDnsSockets;
+			if (nSocketsDns < 1) {
+				nSocketsDns = 1;
+			}
+			for (sl_uint32 i = 0; i < nSocketsDns; i++) {
+				if (nSocketsDns > 1) {
+					if (i) {
+						Ref<AsyncIoLoop> loop = AsyncIoLoop::create();
+						if (loop.isNull()) {
+							return sl_null;
+						}
+						ret->m_listIoLoops.add_NoLock(loop);
+						up.ioLoop = loop;
+					}
+					Ref<Socket> socket = Socket::openUdp();
+					if (socket.isNull()) {
+						return sl_null;
+					}
+					socket->setOption_ReuseAddress(sl_true);
+					if (!(socket->setOption_ReusePort(sl_true))) {
+						LogError(TAG_SERVER, "Failed to enable SO_REUSEPORT: %s", socket->getLastErrorMessage());
+						return sl_null;
+					}
+					SocketAddress bindAddress;
+					bindAddress.port = param.portDns;
+					if (!(socket->bind(bindAddress))) {
+						LogError(TAG_SERVER, "Failed to bind to port %d", param.portDns);
+						return sl_null;
+					}
+					up.socket = socket;
+				} else {
+					up.bindAddress.port = param.portDns;
+				}
+				Ref<AsyncUdpSocket> socketDns = AsyncUdpSocket::create(up);
+				if (socketDns.isNull()) {
+					LogError(TAG_SERVER, "Failed to bind to port %d", param.portDns);
+					return sl_null;
+				}
+				ret->m_listUdpDns.add_NoLock(socketDns);
 			}
+			Ref<AsyncUdpSocket> socketDns = ret->m_listUdpDns.getValueAt_NoLock(0);
 			
+			up.socket.setNull();
+			up.ioLoop = param.ioLoop;
 			up.bindAddress.port = param.portEncryption;
 			Ref<AsyncUdpSocket> socketEncrypt = AsyncUdpSocket::create(up);
 			if (socketEncrypt.isNull()) {
@@ -897,6 +1513,25 @@ namespace slib
 				ret->m_onResolve = param.onResolve;
 				ret->m_onCache = param.onCache;
 
+				if (param.flagCacheAnswers && param.cacheTTL && param.cacheSize) {
+					sl_uint32 nBuckets = 1;
+					while (nBuckets * DNS_SERVER_CACHE_WAYS < param.cacheSize) {
+						nBuckets <<= 1;
+					}
+					ret->m_cache = Array<CacheSlot>::create(nBuckets * DNS_SERVER_CACHE_WAYS);
+					if (ret->m_cache.isNotNull()) {
+						CacheSlot* slots = ret->m_cache.getData();
+						for (sl_uint32 i = 0; i < nBuckets * DNS_SERVER_CACHE_WAYS; i++) {
+							slots[i].hash = 0;
+							slots[i].timeExpire = 0;
+							slots[i].sizeQuestion = 0;
+						}
+						ret->m_nCacheBuckets = nBuckets;
+						ret->m_cacheTTL = param.cacheTTL;
+						ret->m_flagCacheAnswers = sl_true;
+					}
+				}
+
 				ret->m_flagInit = sl_true;
 				if (param.flagAutoStart) {
 					ret->start();
@@ -918,12 +1553,15 @@ namespace slib
 		m_flagInit = sl_false;
 
 		m_flagRunning = sl_false;
-		if (m_udpDns.isNotNull()) {
-			m_udpDns->close();
+		for (auto& socket : m_listUdpDns) {
+			socket->close();
 		}
 		if (m_udpEncrypt.isNotNull()) {
 			m_udpEncrypt->close();
 		}
+		for (auto& loop : m_listIoLoops) {
+			loop->release();
+		}
 	}
 
 	void DnsServer::start()
@@ -935,8 +1573,8 @@ namespace slib
 		if (m_flagRunning) {
 			return;
 		}
-		if (m_udpDns.isNotNull()) {
-			m_udpDns->start();
+		for (auto& socket : m_listUdpDns) {
+			socket->start();
 		}
 		if (m_udpEncrypt.isNotNull()) {
 			m_udpEncrypt->start();
@@ -964,6 +1602,9 @@ namespace slib
 			return;
 		}
 		if (rp.forwardAddress.isInvalid()) {
+			if (m_flagCacheAnswers && rp.hostAddress.isNotZero()) {
+				_putCache(DnsPacket::buildHostAddressAnswerPacket(id, hostName, rp.hostAddress), m_cacheTTL);
+			}
 			_sendPacket(flagEncryptedRequest, clientAddress, _buildHostAddressAnswerPacket(id, hostName, rp.hostAddress, flagEncryptedRequest));
 			return;
 		}
@@ -973,7 +1614,7 @@ namespace slib
 		
 		// forward DNS request
 		{
-			sl_uint16 idForward = m_lastForwardId++;
+			sl_uint16 idForward = (sl_uint16)(Base::interlockedIncrement32(&m_lastForwardId));
 			ForwardElement fe;
 			fe.requestedId = id;
 			fe.requestedHostName = hostName;
@@ -1067,6 +1708,9 @@ namespace slib
 					aliasesProcess = aliasesNoProcess;
 				}
 			}
+			if (m_flagCacheAnswers && resolvedAddress.isNotZero()) {
+				_putCache(DnsPacket::buildHostAddressAnswerPacket(fe.requestedId, fe.requestedHostName, resolvedAddress), _priv_DnsServer_getMinimumTTL(packet));
+			}
 			if (fe.clientAddress.isValid()) {
 				_sendPacket(fe.flagEncrypted, fe.clientAddress, _buildHostAddressAnswerPacket(fe.requestedId, fe.requestedHostName, resolvedAddress, fe.flagEncrypted));
 			}
@@ -1077,7 +1721,7 @@ namespace slib
 	{
 		DnsHeader* header = (DnsHeader*)data;
 
-		sl_uint16 idForward = m_lastForwardId++;
+		sl_uint16 idForward = (sl_uint16)(Base::interlockedIncrement32(&m_lastForwardId));
 
 		ForwardElement fe;
 		fe.requestedId = header->getId();
@@ -1110,6 +1754,12 @@ namespace slib
 
 			header->setId(fe.requestedId);
 			Memory packet = Memory::create(data, size);
+			if (m_flagCacheAnswers && header->getResponseCode() == DnsResponseCode::NoError) {
+				DnsPacket parsed;
+				if (parsed.parsePacket(data, size)) {
+					_putCache(packet, _priv_DnsServer_getMinimumTTL(parsed));
+				}
+			}
 			if (fe.flagEncrypted) {
 				packet = m_encrypt.encrypt_CBC_PKCS7Padding(packet);
 			}
@@ -1154,8 +1804,108 @@ namespace slib
 		return mem;
 	}
 
+	sl_bool DnsServer::_processCachedQuestion(AsyncUdpSocket* socket, const SocketAddress& clientAddress, const void* data, sl_uint32 size)
+	{
+		const sl_uint8* request = (const sl_uint8*)data;
+		DnsHeader* header = (DnsHeader*)request;
+		if (size < sizeof(DnsHeader) || !(header->isQuestion()) || header->getOpcode() != DnsOpcode::Query) {
+			return sl_false;
+		}
+		sl_uint32 sizeQuestion = _priv_DnsServer_getQuestionSize(request, size);
+		if (!sizeQuestion) {
+			return sl_false;
+		}
+		const sl_uint8* question = request + sizeof(DnsHeader);
+		sl_uint32 hash = _priv_DnsServer_hashQuestion(question, sizeQuestion);
+		
+		sl_uint8 response[DNS_SERVER_CACHE_PACKET_SIZE_MAX];
+		sl_uint32 sizeResponse = 0;
+		{
+			SpinLocker lock(&m_lockCache);
+			CacheSlot* slots = m_cache.getData() + (hash & (m_nCacheBuckets - 1)) * DNS_SERVER_CACHE_WAYS;
+			sl_uint32 now = System::getTickCount();
+			for (sl_uint32 i = 0; i < DNS_SERVER_CACHE_WAYS; i++) {
+				CacheSlot& slot = slots[i];
+				if (slot.sizeQuestion == sizeQuestion && slot.hash == hash && (sl_int32)(slot.timeExpire - now) > 0) {
+					const sl_uint8* packet = (const sl_uint8*)(slot.packet.getData());
+					if (_priv_DnsServer_equalsQuestion(packet + sizeof(DnsHeader), question, sizeQuestion)) {
+						sizeResponse = (sl_uint32)(slot.packet.getSize());
+						Base::copyMemory(response, packet, sizeResponse);
+						break;
+					}
+				}
+			}
+		}
+		if (!sizeResponse) {
+			return sl_false;
+		}
+		
+		// keeps the id and the letter case of the question
+		DnsHeader* headerResponse = (DnsHeader*)response;
+		headerResponse->setId(header->getId());
+		headerResponse->setRD(header->isRD());
+		Base::copyMemory(response + sizeof(DnsHeader), question, sizeQuestion);
+		
+		Ref<Socket> s = socket->getSocket();
+		if (s.isNotNull() && s->sendTo(clientAddress, response, sizeResponse) == (sl_int32)sizeResponse) {
+			return sl_true;
+		}
+		return socket->sendTo(clientAddress, response, sizeResponse);
+	}
+
+	void DnsServer::_putCache(const Memory& packet, sl_uint32 TTL)
+	{
+		if (TTL > m_cacheTTL) {
+			TTL = m_cacheTTL;
+		}
+		if (!TTL) {
+			return;
+		}
+		sl_uint32 size = (sl_uint32)(packet.getSize());
+		if (size > DNS_SERVER_CACHE_PACKET_SIZE_MAX) {
+			return;
+		}
+		const sl_uint8* data = (const sl_uint8*)(packet.getData());
+		sl_uint32 sizeQuestion = _priv_DnsServer_getQuestionSize(data, size);
+		if (!sizeQuestion) {
+			return;
+		}
+		const sl_uint8* question = data + sizeof(DnsHeader);
+		sl_uint32 hash = _priv_DnsServer_hashQuestion(question, sizeQuestion);
+		
+		Memory packetOld;
+		SpinLocker lock(&m_lockCache);
+		CacheSlot* slots = m_cache.getData() + (hash & (m_nCacheBuckets - 1)) * DNS_SERVER_CACHE_WAYS;
+		sl_uint32 now = System::getTickCount();
+		CacheSlot* slot = sl_null;
+		sl_int32 remainMin = 0;
+		for (sl_uint32 i = 0; i < DNS_SERVER_CACHE_WAYS; i++) {
+			CacheSlot& item = slots[i];
+			if (item.sizeQuestion == sizeQuestion && item.hash == hash && _priv_DnsServer_equalsQuestion((const sl_uint8*)(item.packet.getData()) + sizeof(DnsHeader), question, sizeQuestion)) {
+				slot = &item;
+				break;
+			}
+			// replaces empty or expired slot, or else the one expiring first
+			sl_int32 remain = item.sizeQuestion ? (sl_int32)(item.timeExpire - now) : -1;
+			if (!slot || remain < remainMin) {
+				slot = &item;
+				remainMin = remain;
+			}
+		}
+		packetOld = slot->packet;
+		slot->packet = packet;
+		slot->hash = hash;
+		slot->sizeQuestion = sizeQuestion;
+		slot->timeExpire = now + TTL * 1000;
+	}
+
 	void DnsServer::_onReceiveFrom(AsyncUdpSocket* socket, const SocketAddress& addressFrom, void* data, sl_uint32 size)
 	{
+		if (m_flagCacheAnswers && socket != m_udpEncrypt) {
+			if (_processCachedQuestion(socket, addressFrom, data, size)) {
+				return;
+			}
+		}
 		sl_bool flagEncrypted = sl_false;
 		Memory memDecrypt;
 		if (socket == m_udpEncrypt) {
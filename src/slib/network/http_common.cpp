@@ -163,6 +163,7 @@ namespace slib
 	DEFINE_HTTP_HEADER(Connection, "Connection")
 	DEFINE_HTTP_HEADER(CacheControl, "Cache-Control")
 	DEFINE_HTTP_HEADER(ContentDisposition, "Content-Disposition")
+	DEFINE_HTTP_HEADER(Upgrade, "Upgrade")
 
 	DEFINE_HTTP_HEADER(ContentLength, "Content-Length")
 	DEFINE_HTTP_HEADER(ContentType, "Content-Type")
@@ -174,6 +175,8 @@ namespace slib
 	DEFINE_HTTP_HEADER(Cookie, "Cookie")
 	DEFINE_HTTP_HEADER(Range, "Range")
 	DEFINE_HTTP_HEADER(IfModifiedSince, "If-Modified-Since")
+	DEFINE_HTTP_HEADER(SecWebSocketKey, "Sec-WebSocket-Key")
+	DEFINE_HTTP_HEADER(SecWebSocketVersion, "Sec-WebSocket-Version")
 
 	DEFINE_HTTP_HEADER(TransferEncoding, "Transfer-Encoding")
 	DEFINE_HTTP_HEADER(AccessControlAllowOrigin, "Access-Control-Allow-Origin")
@@ -181,6 +184,10 @@ namespace slib
 	DEFINE_HTTP_HEADER(AcceptRanges, "Accept-Ranges")
 	DEFINE_HTTP_HEADER(ContentRange, "Content-Range")
 	DEFINE_HTTP_HEADER(LastModified, "Last-Modified")
+	DEFINE_HTTP_HEADER(SecWebSocketAccept, "Sec-WebSocket-Accept")
+
+	DEFINE_HTTP_HEADER(SecWebSocketExtensions, "Sec-WebSocket-Extensions")
+	DEFINE_HTTP_HEADER(SecWebSocketProtocol, "Sec-WebSocket-Protocol")
 
 	sl_reg HttpHeaders::parseHeaders(HttpHeaderMap& map, const void* _data, sl_size size)
 	{
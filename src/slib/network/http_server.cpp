@@ -45,6 +45,7 @@ namespace slib
 	{
 		m_requestContentLength = 0;
 		m_flagAsynchronousResponse = sl_false;
+		m_flagResponseCompleted = sl_false;
 
 		setClosingConnection(sl_false);
 		setProcessingByThread(sl_true);
@@ -168,11 +169,61 @@ namespace slib
 #define SIZE_READ_BUF 0x10000
 #define SIZE_COPY_BUF 0x10000
 
+#define TIMEOUT_NONE 0
+#define TIMEOUT_HEADER 1
+#define TIMEOUT_BODY 2
+#define TIMEOUT_KEEP_ALIVE 3
+#define TIMEOUT_SEND 4
+
+	static sl_bool _priv_HttpServer_containsConnectionToken(const String& value, const String& token)
+	{
+		ListElements<String> items(HttpHeaders::splitValueToList(value));
+		for (sl_size i = 0; i < items.count; i++) {
+			if (items[i].trim().equalsIgnoreCase(token)) {
+				return sl_true;
+			}
+		}
+		return sl_false;
+	}
+
+	// HTTP/1.1 connections are persistent unless `close` is given in the `Connection` header of the request or the response.
+	// HTTP/1.0 connections are persistent only if `keep-alive` is requested
+	static sl_bool _priv_HttpServer_isKeepAlive(HttpServerContext* context)
+	{
+		SLIB_STATIC_STRING(strClose, "close");
+		if (_priv_HttpServer_containsConnectionToken(context->getResponseHeader(HttpHeaders::Connection), strClose)) {
+			return sl_false;
+		}
+		String connection = context->getRequestHeader(HttpHeaders::Connection);
+		if (connection.isNotEmpty()) {
+			if (_priv_HttpServer_containsConnectionToken(connection, strClose)) {
+				return sl_false;
+			}
+			SLIB_STATIC_STRING(strKeepAlive, "keep-alive");
+			if (_priv_HttpServer_containsConnectionToken(connection, strKeepAlive)) {
+				return sl_true;
+			}
+		}
+		SLIB_STATIC_STRING(strHttp11, "HTTP/1.1");
+		return context->getRequestVersion() == strHttp11;
+	}
+
 	HttpServerConnection::HttpServerConnection()
 	{
 		m_flagClosed = sl_true;
 		m_flagReading = sl_false;
 		m_flagKeepAlive = sl_true;
+		m_flagInputPaused = sl_false;
+		m_flagInputEnded = sl_false;
+		m_flagTunnelResponded = 0;
+		m_flagOutputPaused = 0;
+		m_flagReadDeferred = sl_false;
+		m_tickInputExpire = 0;
+		m_typeInputTimeout = TIMEOUT_NONE;
+		m_tickOutputExpire = 0;
+		m_tickTimerSlot = 0;
+		m_timerPrev = sl_null;
+		m_timerNext = sl_null;
 	}
 
 	HttpServerConnection::~HttpServerConnection()
@@ -190,6 +241,7 @@ namespace slib
 					AsyncOutputParam op;
 					op.stream = io;
 					op.onEnd = SLIB_FUNCTION_WEAKREF(HttpServerConnection, onAsyncOutputEnd, ret);
+					op.onWrite = SLIB_FUNCTION_WEAKREF(HttpServerConnection, onAsyncOutputWrite, ret);
 					op.bufferSize = SIZE_COPY_BUF;
 					Ref<AsyncOutput> output = AsyncOutput::create(op);
 					if (output.isNotNull()) {
@@ -216,8 +268,26 @@ namespace slib
 		
 		Ref<HttpServer> server = m_server;
 		if (server.isNotNull()) {
+			server->_removeConnectionTimeout(this);
 			server->closeConnection(this);
 		}
+		lock.unlock();
+		
+		Ref<WebSocketConnection> webSocket = m_webSocket;
+		if (webSocket.isNotNull()) {
+			webSocket->close();
+			m_webSocket.setNull();
+		}
+		Ref<AsyncTcpRelay> relay = m_relay;
+		if (relay.isNotNull()) {
+			relay->close();
+			m_relay.setNull();
+		}
+		Ref<AsyncTcpSocket> socketTunnel = m_socketTunnel;
+		if (socketTunnel.isNotNull()) {
+			socketTunnel->close();
+			m_socketTunnel.setNull();
+		}
 		m_io->close();
 		m_output->close();
 	}
@@ -225,6 +295,9 @@ namespace slib
 	void HttpServerConnection::start(const void* data, sl_uint32 size)
 	{
 		m_contextCurrent.setNull();
+		m_bufPipelined.setNull();
+		m_flagInputPaused = sl_false;
+		_setInputTimeout(TIMEOUT_HEADER);
 		if (data && size > 0) {
 			_processInput(data, size);
 		} else {
@@ -250,12 +323,16 @@ namespace slib
 	void HttpServerConnection::_read()
 	{
 		ObjectLocker lock(this);
-		if (m_flagClosed) {
+		if (m_flagClosed || m_flagInputEnded) {
 			return;
 		}
 		if (m_flagReading) {
 			return;
 		}
+		if (m_flagOutputPaused) {
+			m_flagReadDeferred = sl_true;
+			return;
+		}
 		m_flagReading = sl_true;
 		if (!(m_io->readToMemory(m_bufRead, SLIB_FUNCTION_WEAKREF(HttpServerConnection, onReadStream, this)))) {
 			m_flagReading = sl_false;
@@ -269,110 +346,198 @@ namespace slib
 		if (server.isNull()) {
 			return;
 		}
-		if (m_flagClosed) {
+		if (m_flagClosed || m_flagInputEnded) {
 			return;
 		}
 		
 		const HttpServerParam& param = server->getParam();
 		sl_uint64 maxRequestHeadersSize = param.maxRequestHeadersSize;
 		sl_uint64 maxRequestBodySize = param.maxRequestBodySize;
+		sl_size maxPipelinedRequestsCount = param.maxPipelinedRequestsCount;
+		if (maxPipelinedRequestsCount < 1) {
+			maxPipelinedRequestsCount = 1;
+		}
 
 		char* data = (char*)_data;
-		Ref<HttpServerContext> _context = m_contextCurrent;
-		if (_context.isNull()) {
-			_context = HttpServerContext::create(this);
+		
+		while (size > 0) {
+			
+			Ref<HttpServerContext> _context = m_contextCurrent;
 			if (_context.isNull()) {
-				sendResponse_ServerError();
-				return;
-			}
-			m_contextCurrent = _context;
-			_context->setProcessingByThread(param.flagProcessByThreads);
-		}
-		HttpServerContext* context = _context.get();
-		if (context->m_requestHeader.isNull()) {
-			sl_size posBody;
-			if (context->m_requestHeaderReader.add(data, size, posBody)) {
-				context->m_requestHeader = context->m_requestHeaderReader.mergeHeader();
-				if (context->m_requestHeader.isNull()) {
-					sendResponse_ServerError();
+				ObjectLocker lock(this);
+				if (m_queueContexts.getCount() >= maxPipelinedRequestsCount) {
+					// too many pipelined requests, continue parsing after the responses are sent
+					m_bufPipelined = Memory::create(data, size);
+					m_flagInputPaused = sl_true;
+					_setInputTimeout(TIMEOUT_NONE);
 					return;
 				}
-				if (posBody > size) {
+				lock.unlock();
+				_context = HttpServerContext::create(this);
+				if (_context.isNull()) {
 					sendResponse_ServerError();
 					return;
 				}
-				context->m_requestHeaderReader.clear();
-				Memory header = context->getRawRequestHeader();
-				sl_reg iRet = context->parseRequestPacket(header.getData(), header.getSize());
-				if (iRet != (sl_reg)(context->m_requestHeader.getSize())) {
-					sendResponse_BadRequest();
-					return;
+				m_contextCurrent = _context;
+				_context->setProcessingByThread(param.flagProcessByThreads);
+				_setInputTimeout(TIMEOUT_HEADER);
+			}
+			HttpServerContext* context = _context.get();
+			if (context->m_requestHeader.isNull()) {
+				sl_size posBody;
+				if (context->m_requestHeaderReader.add(data, size, posBody)) {
+					context->m_requestHeader = context->m_requestHeaderReader.mergeHeader();
+					if (context->m_requestHeader.isNull()) {
+						sendResponse_ServerError();
+						return;
+					}
+					if (posBody > size) {
+						sendResponse_ServerError();
+						return;
+					}
+					context->m_requestHeaderReader.clear();
+					_setInputTimeout(TIMEOUT_NONE);
+					Memory header = context->getRawRequestHeader();
+					sl_reg iRet = context->parseRequestPacket(header.getData(), header.getSize());
+					if (iRet != (sl_reg)(context->m_requestHeader.getSize())) {
+						sendResponse_BadRequest();
+						return;
+					}
+					context->m_requestContentLength = context->getRequestContentLengthHeader();
+					if (context->m_requestContentLength > maxRequestBodySize) {
+						sendResponse_BadRequest();
+						return;
+					}
+					data += posBody;
+					size -= (sl_uint32)posBody;
+					// all remaining input is exposed to `preprocessRequest`, because the server can take over the connection
+					Memory body = Memory::create(data, size);
+					context->m_requestBody = body;
+					context->applyQueryToParameters();
+					if (server->preprocessRequest(context)) {
+						return;
+					}
+					if (param.flagProcessConnect && context->getMethod() == HttpMethod::CONNECT) {
+						m_contextCurrent.setNull();
+						_setInputTimeout(TIMEOUT_NONE);
+						// remaining input is already sent by the client to the tunnel
+						m_flagInputEnded = sl_true;
+						m_queueContexts.push(_context);
+						_processConnect(context, data, size);
+						return;
+					}
+					if (param.flagUseWebSocket && WebSocketConnection::isUpgradeRequest(context)) {
+						m_contextCurrent.setNull();
+						if (m_queueContexts.getCount() > 0) {
+							// upgrading is not allowed while pipelined responses are pending
+							sendResponse_BadRequest();
+							return;
+						}
+						Ref<WebSocketConnection> webSocket = WebSocketConnection::create(this, param.webSocket);
+						if (webSocket.isNull()) {
+							sendResponse_ServerError();
+							return;
+						}
+						m_webSocket = webSocket;
+						webSocket->accept(context, data, size);
+						return;
+					}
+					sl_uint32 sizeBody = size;
+					if (sizeBody > context->m_requestContentLength) {
+						sizeBody = (sl_uint32)(context->m_requestContentLength);
+						body = body.sub(0, sizeBody);
+					}
+					if (!(context->m_requestBodyBuffer.add(body))) {
+						sendResponse_ServerError();
+						return;
+					}
+					data += sizeBody;
+					size -= sizeBody;
+					if (context->m_requestBodyBuffer.getSize() < context->m_requestContentLength) {
+						_setInputTimeout(TIMEOUT_BODY);
+					}
+				} else {
+					if (context->m_requestHeaderReader.getHeaderSize() > maxRequestHeadersSize) {
+						sendResponse_BadRequest();
+						return;
+					}
+					size = 0;
 				}
-				context->m_requestContentLength = context->getRequestContentLengthHeader();
-				if (context->m_requestContentLength > maxRequestBodySize) {
-					sendResponse_BadRequest();
-					return;
+			} else {
+				sl_uint32 sizeBody = size;
+				sl_uint64 sizeRemain = context->m_requestContentLength - context->m_requestBodyBuffer.getSize();
+				if (sizeBody > sizeRemain) {
+					sizeBody = (sl_uint32)sizeRemain;
 				}
-				context->m_requestBody = Memory::create(data + posBody, size - (sl_uint32)posBody);
-				if (!(context->m_requestBodyBuffer.add(context->m_requestBody))) {
+				if (!(context->m_requestBodyBuffer.add(Memory::create(data, sizeBody)))) {
 					sendResponse_ServerError();
 					return;
 				}
-				context->applyQueryToParameters();
-				if (server->preprocessRequest(context)) {
-					return;
-				}
-			} else {
-				if (context->m_requestHeaderReader.getHeaderSize() > maxRequestHeadersSize) {
-					sendResponse_BadRequest();
-					return;
+				data += sizeBody;
+				size -= sizeBody;
+				if (context->m_requestBodyBuffer.getSize() < context->m_requestContentLength) {
+					_setInputTimeout(TIMEOUT_BODY);
 				}
 			}
-		} else {
-			if (!(context->m_requestBodyBuffer.add(Memory::create(data, size)))) {
-				sendResponse_ServerError();
-				return;
-			}
-		}
-		
-		if (context->m_requestHeader.isNotNull()) {
 			
-			if (context->m_requestBodyBuffer.getSize() >= context->m_requestContentLength) {
-
-				m_contextCurrent.setNull();
-
-				context->m_requestBody = context->m_requestBodyBuffer.merge();
-				if (context->m_requestContentLength > 0 && context->m_requestBody.isNull()) {
-					sendResponse_ServerError();
-					return;
-				}
-				context->m_requestBodyBuffer.clear();
-
-				String multipartBoundary = context->getRequestMultipartFormDataBoundary();
-				if (multipartBoundary.isNotEmpty()) {
-					Memory body = context->getRequestBody();
-					context->applyMultipartFormData(multipartBoundary, body);
-				} else if (context->getMethod() == HttpMethod::POST) {
-					String reqContentType = context->getRequestContentTypeNoParams();
-					if (reqContentType == ContentTypes::WebForm) {
+			if (context->m_requestHeader.isNotNull()) {
+				
+				if (context->m_requestBodyBuffer.getSize() >= context->m_requestContentLength) {
+					
+					m_contextCurrent.setNull();
+					_setInputTimeout(TIMEOUT_NONE);
+					
+					context->m_requestBody = context->m_requestBodyBuffer.merge();
+					if (context->m_requestContentLength > 0 && context->m_requestBody.isNull()) {
+						sendResponse_ServerError();
+						return;
+					}
+					context->m_requestBodyBuffer.clear();
+					
+					String multipartBoundary = context->getRequestMultipartFormDataBoundary();
+					if (multipartBoundary.isNotEmpty()) {
 						Memory body = context->getRequestBody();
-						context->applyPostParameters(body.getData(), body.getSize());
+						context->applyMultipartFormData(multipartBoundary, body);
+					} else if (context->getMethod() == HttpMethod::POST) {
+						String reqContentType = context->getRequestContentTypeNoParams();
+						if (reqContentType == ContentTypes::WebForm) {
+							Memory body = context->getRequestBody();
+							context->applyPostParameters(body.getData(), body.getSize());
+						}
 					}
-				}
-				
-				if (context->isProcessingByThread()) {
-					Ref<ThreadPool> threadPool = server->getThreadPool();
-					if (threadPool.isNotNull()) {
-						threadPool->addTask(SLIB_BIND_WEAKREF(void(), HttpServerConnection, _processContext, this, _context));
+					
+					sl_bool flagKeepAlive = _priv_HttpServer_isKeepAlive(context);
+					
+					m_queueContexts.push(_context);
+					
+					if (context->isProcessingByThread()) {
+						Ref<ThreadPool> threadPool = server->getThreadPool();
+						if (threadPool.isNotNull()) {
+							threadPool->addTask(SLIB_BIND_WEAKREF(void(), HttpServerConnection, _processContext, this, _context));
+						} else {
+							sendResponse_ServerError();
+							return;
+						}
 					} else {
-						sendResponse_ServerError();
+						_processContext(context);
+					}
+					
+					if (!flagKeepAlive) {
+						// the connection will be closed after the response
+						return;
 					}
-				} else {
-					_processContext(context);
 				}
-				return;
 			}
 		}
+		
+		ObjectLocker lock(this);
+		if (m_queueContexts.getCount() > 0) {
+			// the requests are pipelined, so reading is resumed after the pending responses are sent
+			m_flagInputPaused = sl_true;
+			_setInputTimeout(TIMEOUT_NONE);
+			return;
+		}
+		lock.unlock();
 		_read();
 	}
 
@@ -383,7 +548,7 @@ namespace slib
 			return;
 		}
 		if (context->getMethod() == HttpMethod::CONNECT) {
-			sendConnectResponse_Failed();
+			_sendConnectFailed(context.get());
 			return;
 		}
 		server->processRequest(context.get());
@@ -392,6 +557,130 @@ namespace slib
 		}
 	}
 
+	void HttpServerConnection::_processConnect(HttpServerContext* context, const void* data, sl_uint32 size)
+	{
+		Ref<HttpServer> server = getServer();
+		if (server.isNull()) {
+			return;
+		}
+		if (!(server->dispatchConnect(context))) {
+			_sendConnectFailed(context);
+			return;
+		}
+		String target = context->getPath();
+		sl_reg indexPort = target.lastIndexOf(':');
+		if (indexPort <= 0) {
+			_sendConnectFailed(context);
+			return;
+		}
+		sl_uint32 port = 0;
+		if (!(target.substring(indexPort + 1).parseUint32(10, &port)) || !port || port > 0xFFFF) {
+			_sendConnectFailed(context);
+			return;
+		}
+		String host = target.substring(0, indexPort);
+		if (host.startsWith('[') && host.endsWith(']')) {
+			host = host.substring(1, host.getLength() - 1);
+		}
+		AsyncTcpSocketParam cp;
+		cp.ioLoop = server->getAsyncIoLoop();
+		cp.onConnect = SLIB_FUNCTION_WEAKREF(HttpServerConnection, _onConnectTunnel, this);
+		IPv6Address ipv6;
+		if (ipv6.parse(host)) {
+			cp.flagIPv6 = sl_true;
+		}
+		Ref<AsyncTcpSocket> socket = AsyncTcpSocket::create(cp);
+		if (socket.isNull()) {
+			_sendConnectFailed(context);
+			return;
+		}
+		if (size > 0) {
+			m_dataTunnel = Memory::create(data, size);
+		}
+		m_contextTunnel = context;
+		m_socketTunnel = socket;
+		if (!(socket->connect(host, (sl_uint16)port))) {
+			_onConnectTunnel(socket.get(), SocketAddress::none(), sl_true);
+		}
+	}
+	
+	void HttpServerConnection::_onConnectTunnel(AsyncTcpSocket* socket, const SocketAddress& address, sl_bool flagError)
+	{
+		if (m_socketTunnel != socket) {
+			return;
+		}
+		if (m_flagClosed) {
+			return;
+		}
+		Ref<HttpServerContext> context = m_contextTunnel;
+		if (context.isNull()) {
+			return;
+		}
+		if (flagError) {
+			m_socketTunnel.setNull();
+			socket->close();
+			_sendConnectFailed(context.get());
+			return;
+		}
+		// the tunnel is established after this response and the pending responses before it are sent
+		SLIB_STATIC_STRING(s, "HTTP/1.1 200 Connection established\r\n\r\n");
+		_sendRawResponse(context.get(), Memory::create(s.getData(), s.getLength()), sl_false);
+	}
+	
+	void HttpServerConnection::_sendConnectFailed(HttpServerContext* context)
+	{
+		m_contextTunnel.setNull();
+		SLIB_STATIC_STRING(s, "HTTP/1.1 500 Tunneling is not supported\r\n\r\n");
+		_sendRawResponse(context, Memory::create(s.getData(), s.getLength()), sl_true);
+	}
+	
+	void HttpServerConnection::_establishTunnelAfterOutput()
+	{
+		if (m_flagTunnelResponded && !(m_output->getPendingSize()) && Base::interlockedCompareExchange32(&m_flagTunnelResponded, 0, 1)) {
+			m_io->addTask(SLIB_FUNCTION_WEAKREF(HttpServerConnection, _establishTunnel, this));
+		}
+	}
+	
+	void HttpServerConnection::_establishTunnel()
+	{
+		if (m_flagClosed) {
+			return;
+		}
+		Ref<AsyncTcpSocket> socket = m_socketTunnel;
+		if (socket.isNull()) {
+			close();
+			return;
+		}
+		Ref<HttpServer> server = getServer();
+		if (server.isNull()) {
+			close();
+			return;
+		}
+		AsyncTcpRelayParam rp;
+		rp.stream1 = m_io;
+		rp.stream2 = socket;
+		rp.initialData = m_dataTunnel;
+		rp.idleTimeout = server->getParam().tunnelIdleTimeout;
+		rp.flagAutoStart = sl_false;
+		rp.onEnd = SLIB_FUNCTION_WEAKREF(HttpServerConnection, _onEndTunnel, this);
+		m_dataTunnel.setNull();
+		Ref<AsyncTcpRelay> relay = AsyncTcpRelay::create(rp);
+		if (relay.isNull()) {
+			close();
+			return;
+		}
+		m_relay = relay;
+		m_socketTunnel.setNull();
+		if (!(relay->start())) {
+			close();
+		}
+	}
+	
+	void HttpServerConnection::_onEndTunnel(AsyncTcpRelay* relay, sl_bool flagError)
+	{
+		close();
+	}
+
 	void HttpServerConnection::_completeResponse(HttpServerContext* context)
 	{
 		context->setResponseHeader(HttpHeaders::ContentLength, String::fromUint64(context->getResponseContentLength()));
@@ -404,18 +693,114 @@ namespace slib
 			close();
 			return;
 		}
-		if (!(m_output->write(header))) {
-			close();
+		ObjectLocker lock(this);
+		context->m_responseHeader = header;
+		context->m_flagResponseCompleted = sl_true;
+		_flushResponses();
+	}
+
+	void HttpServerConnection::_flushResponses()
+	{
+		ObjectLocker lock(this);
+		if (m_flagClosed) {
 			return;
 		}
-		m_output->mergeBuffer(&(context->m_bufferOutput));
-		if (context->isKeepAlive()) {
+		Ref<HttpServer> server = m_server;
+		if (server.isNull()) {
+			return;
+		}
+		const HttpServerParam& param = server->getParam();
+		// the responses are sent in the order of the requests, even though they are completed in different order
+		sl_bool flagWrite = sl_false;
+		Ref<HttpServerContext> context;
+		while (m_queueContexts.getFrontValue(&context) && context->m_flagResponseCompleted) {
+			m_queueContexts.popFront();
+			if (!(m_output->write(context->m_responseHeader))) {
+				close();
+				return;
+			}
+			context->m_responseHeader.setNull();
+			m_output->mergeBuffer(&(context->m_bufferOutput));
+			flagWrite = sl_true;
+			if (context == m_contextTunnel) {
+				// the last response before the connection is taken over by the tunnel
+				m_contextTunnel.setNull();
+				m_flagTunnelResponded = 1;
+				break;
+			}
+			// raw responses of the failed requests are not related to the request headers
+			if (context->isClosingConnection() || (context->m_requestHeader.isNotNull() && !(_priv_HttpServer_isKeepAlive(context.get())))) {
+				m_flagKeepAlive = sl_false;
+				m_flagInputPaused = sl_false;
+				m_bufPipelined.setNull();
+				m_queueContexts.removeAll();
+				break;
+			}
+		}
+		if (flagWrite) {
 			m_output->startWriting();
-			start();
+			sl_uint64 sizeOutput = m_output->getPendingSize();
+			if (sizeOutput) {
+				server->_setConnectionTimeout(this, sl_false, param.sendTimeout);
+				if (param.outputHighWatermark && sizeOutput > param.outputHighWatermark && Base::interlockedCompareExchange32(&m_flagOutputPaused, 1, 0)) {
+					// the client does not read the responses fast enough
+					server->_increaseCounter(server->m_counters.inputPauses);
+					// the output can be drained before the flag is set
+					_resumeOutputPaused(m_output->getPendingSize(), param.outputLowWatermark);
+				}
+			}
+			// the output can be drained before the flag is set
+			_establishTunnelAfterOutput();
+		}
+		if (m_flagInputPaused) {
+			sl_size nPending = m_queueContexts.getCount();
+			if (nPending == 0 || (m_bufPipelined.isNotNull() && nPending < param.maxPipelinedRequestsCount)) {
+				m_flagInputPaused = sl_false;
+				m_io->addTask(SLIB_FUNCTION_WEAKREF(HttpServerConnection, _resumeInput, this));
+			}
+		}
+	}
+
+	void HttpServerConnection::_sendRawResponse(HttpServerContext* _context, const Memory& response, sl_bool flagClose)
+	{
+		if (response.isNull()) {
+			close();
+			return;
+		}
+		Ref<HttpServerContext> context = _context;
+		if (context.isNull()) {
+			context = HttpServerContext::create(this);
+			if (context.isNull()) {
+				close();
+				return;
+			}
+		}
+		ObjectLocker lock(this);
+		if (m_flagClosed) {
+			return;
+		}
+		context->setClosingConnection(flagClose);
+		context->m_responseHeader = response;
+		context->m_flagResponseCompleted = sl_true;
+		if (!_context) {
+			m_queueContexts.push(context);
+		}
+		_flushResponses();
+	}
+
+	void HttpServerConnection::_resumeInput()
+	{
+		Ref<HttpServerContext> context = m_contextCurrent;
+		if (context.isNotNull()) {
+			// the timeout was not counted while the input is paused
+			_setInputTimeout(context->m_requestHeader.isNull() ? TIMEOUT_HEADER : TIMEOUT_BODY);
+		}
+		Memory mem = m_bufPipelined;
+		m_bufPipelined.setNull();
+		if (mem.isNotNull()) {
+			_processInput(mem.getData(), (sl_uint32)(mem.getSize()));
 		} else {
-			m_contextCurrent.setNull();
-			m_flagKeepAlive = sl_false;
-			m_output->startWriting();
+			_read();
 		}
 	}
 
@@ -433,58 +818,139 @@ namespace slib
 	{
 		if (flagError || !m_flagKeepAlive) {
 			close();
+			return;
+		}
+		Ref<HttpServer> server = m_server;
+		if (server.isNull()) {
+			return;
+		}
+		server->_setConnectionTimeout(this, sl_false, 0);
+		_establishTunnelAfterOutput();
+		if (m_webSocket.isNotNull() || m_relay.isNotNull() || m_flagInputEnded) {
+			// upgraded connections are not managed by the keep-alive timeout
+			return;
+		}
+		if (m_contextCurrent.isNull() && !(m_queueContexts.getCount())) {
+			_setInputTimeout(TIMEOUT_KEEP_ALIVE);
 		}
 	}
 
-	void HttpServerConnection::sendResponse(const Memory& mem)
+	void HttpServerConnection::onAsyncOutputWrite(AsyncOutput* output)
 	{
-		if (mem.isNotNull()) {
-			if (m_io->writeFromMemory(mem, sl_null)) {
-				return;
-			}
+		// can be called with the lock of `AsyncCopy`, so this object is not locked here
+		Ref<HttpServer> server = m_server;
+		if (server.isNull()) {
+			return;
 		}
-		close();
+		const HttpServerParam& param = server->getParam();
+		sl_uint64 sizeOutput = output->getPendingSize();
+		if (sizeOutput) {
+			// progress of the output postpones the timeout
+			server->_setConnectionTimeout(this, sl_false, param.sendTimeout);
+		}
+		_resumeOutputPaused(sizeOutput, param.outputLowWatermark);
 	}
 
-	void HttpServerConnection::sendResponseAndRestart(const Memory& mem)
+	void HttpServerConnection::_resumeOutputPaused(sl_uint64 sizeOutput, sl_uint64 lowWatermark)
 	{
-		if (mem.isNotNull()) {
-			if (m_io->writeFromMemory(mem, sl_null)) {
-				start();
-				return;
-			}
+		if (m_flagOutputPaused && sizeOutput <= lowWatermark && Base::interlockedCompareExchange32(&m_flagOutputPaused, 0, 1)) {
+			m_io->addTask(SLIB_FUNCTION_WEAKREF(HttpServerConnection, _resumeRead, this));
 		}
-		close();
 	}
 
-	class _priv_HttpServerConnection_SendResponseAndCloseListener : public Referable
+	void HttpServerConnection::_resumeRead()
 	{
-	public:
-		WeakRef<HttpServerConnection> m_connection;
+		ObjectLocker lock(this);
+		if (m_flagReadDeferred) {
+			m_flagReadDeferred = sl_false;
+			lock.unlock();
+			_read();
+		}
+	}
 
-		_priv_HttpServerConnection_SendResponseAndCloseListener(HttpServerConnection* connection)
-		{
-			m_connection = connection;
+	void HttpServerConnection::_setInputTimeout(sl_uint32 type)
+	{
+		Ref<HttpServer> server = m_server;
+		if (server.isNull()) {
+			return;
+		}
+		const HttpServerParam& param = server->getParam();
+		sl_uint32 timeout = 0;
+		switch (type) {
+			case TIMEOUT_HEADER:
+				timeout = param.headerTimeout;
+				break;
+			case TIMEOUT_BODY:
+				timeout = param.bodyTimeout;
+				break;
+			case TIMEOUT_KEEP_ALIVE:
+				timeout = param.keepAliveTimeout;
+				break;
 		}
+		server->_setConnectionTimeout(this, sl_true, timeout, type);
+	}
 
-		void onWriteStream(AsyncStreamResult* result)
-		{
-			Ref<HttpServerConnection> connection = m_connection;
-			if (connection.isNotNull()) {
-				connection->close();
-			}
+	void HttpServerConnection::_onTimeout(sl_uint32 type)
+	{
+		Ref<HttpServer> server = m_server;
+		if (server.isNull()) {
+			return;
 		}
-	};
+		if (server->getParam().flagLogDebug) {
+			Log(SERVER_TAG, "[%s] Connection Timeout - Type: %d", String::fromPointerValue(this), type);
+		}
+		HttpServerCounters& counters = server->m_counters;
+		switch (type) {
+			case TIMEOUT_HEADER:
+				server->_increaseCounter(counters.headerTimeouts);
+				break;
+			case TIMEOUT_BODY:
+				server->_increaseCounter(counters.bodyTimeouts);
+				break;
+			case TIMEOUT_KEEP_ALIVE:
+				server->_increaseCounter(counters.keepAliveTimeouts);
+				break;
+			case TIMEOUT_SEND:
+				server->_increaseCounter(counters.sendTimeouts);
+				break;
+		}
+		sl_bool flagRespond = sl_false;
+		if (type == TIMEOUT_HEADER || type == TIMEOUT_BODY) {
+			ObjectLocker lock(this);
+			flagRespond = !(m_queueContexts.getCount()) && !(m_output->getPendingSize());
+		}
+		if (flagRespond) {
+			// the request is not completed in time
+			SLIB_STATIC_STRING(s, "HTTP/1.1 408 Request Timeout\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+			sendResponseAndClose(Memory::create(s.getData(), s.getLength()));
+		} else {
+			close();
+		}
+	}
+
+	void HttpServerConnection::sendResponse(const Memory& mem)
+	{
+		_sendRawResponse(sl_null, mem, sl_false);
+	}
+
+	void HttpServerConnection::sendResponseAndRestart(const Memory& mem)
+	{
+		ObjectLocker lock(this);
+		// the rest of the input is discarded, and reading is resumed after the pending responses are sent
+		m_contextCurrent.setNull();
+		m_bufPipelined.setNull();
+		m_flagInputPaused = sl_true;
+		_sendRawResponse(sl_null, mem, sl_false);
+	}
 
 	void HttpServerConnection::sendResponseAndClose(const Memory& mem)
 	{
-		if (mem.isNotNull()) {
-			Ref<_priv_HttpServerConnection_SendResponseAndCloseListener> listener(new _priv_HttpServerConnection_SendResponseAndCloseListener(this));
-			if (m_io->writeFromMemory(mem, SLIB_FUNCTION_REF(_priv_HttpServerConnection_SendResponseAndCloseListener, onWriteStream, listener))) {
-				return;
-			}
-		}
-		close();
+		ObjectLocker lock(this);
+		m_contextCurrent.setNull();
+		m_bufPipelined.setNull();
+		m_flagInputPaused = sl_false;
+		m_flagInputEnded = sl_true;
+		_sendRawResponse(sl_null, mem, sl_true);
 	}
 
 	void HttpServerConnection::sendResponse_BadRequest()
@@ -625,6 +1091,23 @@ namespace slib
 		maxRequestHeadersSize = 0x10000; // 64KB
 		maxRequestBodySize = 0x2000000; // 32MB
 		
+		maxPipelinedRequestsCount = 16;
+		
+		headerTimeout = 20000;
+		bodyTimeout = 60000;
+		keepAliveTimeout = 15000;
+		sendTimeout = 60000;
+		
+		outputHighWatermark = 0x100000; // 1MB
+		outputLowWatermark = 0x40000; // 256KB
+		
+		maxConnectionsCount = 0;
+		
+		flagUseWebSocket = sl_false;
+		
+		flagProcessConnect = sl_false;
+		tunnelIdleTimeout = 300000;
+		
 		flagAllowCrossOrigin = sl_false;
 		
 		flagUseCacheControl = sl_true;
@@ -640,6 +1123,8 @@ namespace slib
 	{
 	}
 	
+	HttpServerParam& HttpServerParam::operator=(const HttpServerParam& other) = default;
+	
 	void HttpServerParam::setJson(const Json& conf)
 	{
 		port = (sl_uint16)(conf["port"].getUint32(port));
@@ -672,6 +1157,17 @@ namespace slib
 			cacheControlMaxAge = cacheControl["max_age"].getUint32(cacheControlMaxAge);
 		}
 		
+		headerTimeout = conf["header_timeout"].getUint32(headerTimeout);
+		bodyTimeout = conf["body_timeout"].getUint32(bodyTimeout);
+		keepAliveTimeout = conf["keep_alive_timeout"].getUint32(keepAliveTimeout);
+		sendTimeout = conf["send_timeout"].getUint32(sendTimeout);
+		outputHighWatermark = conf["output_high_watermark"].getUint32(outputHighWatermark);
+		outputLowWatermark = conf["output_low_watermark"].getUint32(outputLowWatermark);
+		maxConnectionsCount = conf["max_connections"].getUint32(maxConnectionsCount);
+		
+		flagProcessConnect = conf["process_connect"].getBoolean(flagProcessConnect);
+		tunnelIdleTimeout = conf["tunnel_idle_timeout"].getUint32(tunnelIdleTimeout);
+		
 		{
 			sl_uint32 n;
 			if (conf["max_request_body"].getString().parseUint32(10, &n)) {
@@ -694,9 +1190,25 @@ namespace slib
 
 	SLIB_DEFINE_OBJECT(HttpServer, Object)
 
+	HttpServerCounters::HttpServerCounters()
+	{
+		connectionsAccepted = 0;
+		connectionsRejected = 0;
+		headerTimeouts = 0;
+		bodyTimeouts = 0;
+		keepAliveTimeouts = 0;
+		sendTimeouts = 0;
+		inputPauses = 0;
+	}
+
 	HttpServer::HttpServer()
 	{
 		m_flagRunning = sl_true;
+		for (sl_uint32 i = 0; i < SLIB_HTTP_SERVER_TIMER_WHEEL_SIZE; i++) {
+			m_timerWheel[i] = sl_null;
+		}
+		m_tickTimerWheel = 0;
+		m_durationTimerTick = 0;
 	}
 
 	HttpServer::~HttpServer()
@@ -719,6 +1231,27 @@ namespace slib
 				m_ioLoop = ioLoop;
 				m_threadPool = threadPool;
 				m_param = param;
+				
+				// the tick of the timer wheel is adjusted to the shortest timeout
+				sl_uint32 timeoutMin = 0;
+				sl_uint32 timeouts[] = {param.headerTimeout, param.bodyTimeout, param.keepAliveTimeout, param.sendTimeout};
+				for (sl_uint32 i = 0; i < 4; i++) {
+					if (timeouts[i] && (!timeoutMin || timeouts[i] < timeoutMin)) {
+						timeoutMin = timeouts[i];
+					}
+				}
+				if (timeoutMin) {
+					sl_uint32 duration = timeoutMin / 8;
+					if (duration < 50) {
+						duration = 50;
+					}
+					if (duration > 1000) {
+						duration = 1000;
+					}
+					m_durationTimerTick = duration;
+					m_timer = Timer::start(SLIB_FUNCTION_WEAKREF(HttpServer, _onTimerWheel, this), duration);
+				}
+				
 				if (param.port) {
 					if (! (addHttpServer(param.addressBind, param.port))) {
 						return sl_false;
@@ -762,6 +1295,11 @@ namespace slib
 		}
 		m_connectionProviders.removeAll();
 		
+		if (m_timer.isNotNull()) {
+			m_timer->stop();
+			m_timer.setNull();
+		}
+		
 		Ref<AsyncIoLoop> ioLoop = m_ioLoop;
 		if (ioLoop.isNotNull()) {
 			ioLoop->release();
@@ -781,6 +1319,16 @@ namespace slib
 		return m_flagRunning;
 	}
 
+	sl_size HttpServer::getConnectionsCount()
+	{
+		return m_connections.getCount();
+	}
+
+	void HttpServer::getCounters(HttpServerCounters& _out)
+	{
+		_out = m_counters;
+	}
+
 	Ref<AsyncIoLoop> HttpServer::getAsyncIoLoop()
 	{
 		return m_ioLoop;
@@ -1082,6 +1630,20 @@ namespace slib
 		return onRequest(context);
 	}
 	
+	sl_bool HttpServer::onConnect(HttpServerContext* context)
+	{
+		// the server does not work as an open proxy unless the tunnels are accepted explicitly
+		return sl_false;
+	}
+	
+	sl_bool HttpServer::dispatchConnect(HttpServerContext* context)
+	{
+		if (m_param.onConnect.isNotNull()) {
+			return m_param.onConnect(this, context);
+		}
+		return onConnect(context);
+	}
+	
 	void HttpServer::onPostRequest(HttpServerContext* context, sl_bool flagProcessed)
 	{
 	}
@@ -1103,6 +1665,20 @@ namespace slib
 
 	Ref<HttpServerConnection> HttpServer::addConnection(const Ref<AsyncStream>& stream, const SocketAddress& remoteAddress, const SocketAddress& localAddress)
 	{
+		if (m_param.maxConnectionsCount && m_connections.getCount() >= m_param.maxConnectionsCount) {
+			_increaseCounter(m_counters.connectionsRejected);
+			if (m_param.flagLogDebug) {
+				Log(SERVER_TAG, "Connection Rejected - Address: %s", remoteAddress.toString());
+			}
+			SLIB_STATIC_STRING(s, "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\nRetry-After: 1\r\n\r\n");
+			Ref<AsyncStream> io = stream;
+			if (!(stream->writeFromMemory(Memory::create(s.getData(), s.getLength()), [io](AsyncStreamResult*) {
+				io->close();
+			}))) {
+				stream->close();
+			}
+			return sl_null;
+		}
 		Ref<HttpServerConnection> connection = HttpServerConnection::create(this, stream.get());
 		if (connection.isNotNull()) {
 			if (m_param.flagLogDebug) {
@@ -1113,6 +1689,7 @@ namespace slib
 			connection->setRemoteAddress(remoteAddress);
 			connection->setLocalAddress(localAddress);
 			m_connections.put(connection.get(), connection);
+			_increaseCounter(m_counters.connectionsAccepted);
 			connection->start();
 		}
 		return connection;
@@ -1126,6 +1703,135 @@ namespace slib
 		m_connections.remove(connection);
 	}
 
+	void HttpServer::_setConnectionTimeout(HttpServerConnection* connection, sl_bool flagInput, sl_uint32 timeout, sl_uint32 type)
+	{
+		SpinLocker lock(&m_lockTimerWheel);
+		if (connection->m_flagClosed) {
+			return;
+		}
+		sl_uint64 tick = 0;
+		if (timeout && m_durationTimerTick) {
+			tick = m_tickTimerWheel + 1 + (timeout + m_durationTimerTick - 1) / m_durationTimerTick;
+		}
+		if (flagInput) {
+			connection->m_tickInputExpire = tick;
+			connection->m_typeInputTimeout = type;
+		} else {
+			connection->m_tickOutputExpire = tick;
+		}
+		_linkTimer(connection);
+	}
+
+	void HttpServer::_removeConnectionTimeout(HttpServerConnection* connection)
+	{
+		SpinLocker lock(&m_lockTimerWheel);
+		connection->m_tickInputExpire = 0;
+		connection->m_tickOutputExpire = 0;
+		_unlinkTimer(connection);
+	}
+
+	void HttpServer::_linkTimer(HttpServerConnection* connection)
+	{
+		sl_uint64 tickExpire = connection->m_tickInputExpire;
+		sl_uint64 tickOutput = connection->m_tickOutputExpire;
+		if (tickOutput && (!tickExpire || tickOutput < tickExpire)) {
+			tickExpire = tickOutput;
+		}
+		if (connection->m_tickTimerSlot) {
+			if (tickExpire && tickExpire >= connection->m_tickTimerSlot) {
+				// postponed deadlines are moved when the slot is processed
+				return;
+			}
+			_unlinkTimer(connection);
+		}
+		if (!tickExpire) {
+			return;
+		}
+		HttpServerConnection*& head = m_timerWheel[tickExpire % SLIB_HTTP_SERVER_TIMER_WHEEL_SIZE];
+		connection->m_tickTimerSlot = tickExpire;
+		connection->m_timerPrev = sl_null;
+		connection->m_timerNext = head;
+		if (head) {
+			head->m_timerPrev = connection;
+		}
+		head = connection;
+	}
+
+	void HttpServer::_unlinkTimer(HttpServerConnection* connection)
+	{
+		if (!(connection->m_tickTimerSlot)) {
+			return;
+		}
+		HttpServerConnection* prev = connection->m_timerPrev;
+		HttpServerConnection* next = connection->m_timerNext;
+		if (prev) {
+			prev->m_timerNext = next;
+		} else {
+			m_timerWheel[connection->m_tickTimerSlot % SLIB_HTTP_SERVER_TIMER_WHEEL_SIZE] = next;
+		}
+		if (next) {
+			next->m_timerPrev = prev;
+		}
+		connection->m_tickTimerSlot = 0;
+		connection->m_timerPrev = sl_null;
+		connection->m_timerNext = sl_null;
+	}
+
+	void HttpServer::_onTimerWheel(Timer* timer)
+	{
+		// the connections are timed out on the I/O loop
+		Ref<AsyncIoLoop> ioLoop = m_ioLoop;
+		if (ioLoop.isNotNull()) {
+			ioLoop->addTask(SLIB_FUNCTION_WEAKREF(HttpServer, _processTimerWheel, this));
+		}
+	}
+
+	void HttpServer::_processTimerWheel()
+	{
+		List< Ref<HttpServerConnection> > connections;
+		List<sl_uint32> types;
+		{
+			SpinLocker lock(&m_lockTimerWheel);
+			sl_uint64 tick = ++m_tickTimerWheel;
+			HttpServerConnection*& head = m_timerWheel[tick % SLIB_HTTP_SERVER_TIMER_WHEEL_SIZE];
+			HttpServerConnection* connection = head;
+			head = sl_null;
+			while (connection) {
+				HttpServerConnection* next = connection->m_timerNext;
+				connection->m_tickTimerSlot = 0;
+				connection->m_timerPrev = sl_null;
+				connection->m_timerNext = sl_null;
+				sl_uint32 type = TIMEOUT_NONE;
+				if (connection->m_tickInputExpire && connection->m_tickInputExpire <= tick) {
+					type = connection->m_typeInputTimeout;
+				} else if (connection->m_tickOutputExpire && connection->m_tickOutputExpire <= tick) {
+					type = TIMEOUT_SEND;
+				}
+				if (type != TIMEOUT_NONE) {
+					connection->m_tickInputExpire = 0;
+					connection->m_tickOutputExpire = 0;
+					Ref<HttpServerConnection> ref;
+					if (m_connections.get(connection, &ref)) {
+						connections.add_NoLock(ref);
+						types.add_NoLock(type);
+					}
+				} else {
+					_linkTimer(connection);
+				}
+				connection = next;
+			}
+		}
+		sl_size n = connections.getCount();
+		for (sl_size i = 0; i < n; i++) {
+			connections[i]->_onTimeout(types[i]);
+		}
+	}
+
+	void HttpServer::_increaseCounter(sl_uint64& counter)
+	{
+		Base::interlockedIncrement64((sl_int64*)&counter);
+	}
+
 	void HttpServer::addConnectionProvider(const Ref<HttpServerConnectionProvider>& provider)
 	{
 		m_connectionProviders.add(provider);
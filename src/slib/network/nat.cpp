@@ -23,6 +23,10 @@
 #include "slib/network/nat.h"
 
 #include "slib/core/new_helper.h"
+#include "slib/core/system.h"
+
+#define NAT_TIMER_WHEEL_SIZE 64
+#define NAT_INVALID_INDEX 0xFFFFFFFF
 
 namespace slib
 {
@@ -38,6 +42,11 @@ namespace slib
 		udpPortEnd = 60000;
 
 		icmpEchoIdentifier = 30000;
+		
+		tcpIdleTimeout = 3600;
+		udpIdleTimeout = 300;
+		
+		countShards = 16;
 	}
 
 	NatTableParam::~NatTableParam()
@@ -62,8 +71,8 @@ namespace slib
 	{
 		ObjectLocker lock(this);
 		m_param = param;
-		m_mappingTcp.setup(param.tcpPortBegin, param.tcpPortEnd);
-		m_mappingUdp.setup(param.udpPortBegin, param.udpPortEnd);
+		m_mappingTcp.setup(param.tcpPortBegin, param.tcpPortEnd, param.countShards, param.tcpIdleTimeout);
+		m_mappingUdp.setup(param.udpPortBegin, param.udpPortEnd, param.countShards, param.udpIdleTimeout);
 	}
 
 	sl_bool NatTable::translateOutgoingPacket(IPv4Packet* ipHeader, void* ipContent, sl_uint32 sizeContent)
@@ -77,11 +86,13 @@ namespace slib
 			TcpSegment* tcp = (TcpSegment*)(ipContent);
 			if (tcp->check(ipHeader, sizeContent)) {
 				sl_uint16 targetPort;
-				if (m_mappingTcp.mapToExternalPort(SocketAddress(ipHeader->getSourceAddress(), tcp->getSourcePort()), targetPort)) {
+				IPv4Address addressSource = ipHeader->getSourceAddress();
+				sl_uint16 portSource = tcp->getSourcePort();
+				if (m_mappingTcp.mapToExternalPort(SocketAddress(addressSource, portSource), targetPort)) {
 					tcp->setSourcePort(targetPort);
 					ipHeader->setSourceAddress(addressTarget);
-					tcp->updateChecksum(ipHeader, sizeContent);
-					ipHeader->updateChecksum();
+					tcp->adjustChecksum(addressSource, addressTarget, portSource, targetPort);
+					ipHeader->adjustChecksum(addressSource, addressTarget);
 					return sl_true;
 				}
 			}
@@ -89,11 +100,13 @@ namespace slib
 			UdpDatagram* udp = (UdpDatagram*)(ipContent);
 			if (udp->check(ipHeader, sizeContent)) {
 				sl_uint16 targetPort;
-				if (m_mappingUdp.mapToExternalPort(SocketAddress(ipHeader->getSourceAddress(), udp->getSourcePort()), targetPort)) {
+				IPv4Address addressSource = ipHeader->getSourceAddress();
+				sl_uint16 portSource = udp->getSourcePort();
+				if (m_mappingUdp.mapToExternalPort(SocketAddress(addressSource, portSource), targetPort)) {
 					udp->setSourcePort(targetPort);
 					ipHeader->setSourceAddress(addressTarget);
-					udp->updateChecksum(ipHeader);
-					ipHeader->updateChecksum();
+					udp->adjustChecksum(addressSource, addressTarget, portSource, targetPort);
+					ipHeader->adjustChecksum(addressSource, addressTarget);
 					return sl_true;
 				}
 			}
@@ -132,11 +145,13 @@ namespace slib
 			TcpSegment* tcp = (TcpSegment*)(ipContent);
 			if (tcp->check(ipHeader, sizeContent)) {
 				SocketAddress addressSource;
-				if (m_mappingTcp.mapToInternalAddress(tcp->getDestinationPort(), addressSource)) {
-					ipHeader->setDestinationAddress(addressSource.ip.getIPv4());
+				sl_uint16 portTarget = tcp->getDestinationPort();
+				if (m_mappingTcp.mapToInternalAddress(portTarget, addressSource)) {
+					IPv4Address addressInternal = addressSource.ip.getIPv4();
+					ipHeader->setDestinationAddress(addressInternal);
 					tcp->setDestinationPort(addressSource.port);
-					tcp->updateChecksum(ipHeader, sizeContent);
-					ipHeader->updateChecksum();
+					tcp->adjustChecksum(addressTarget, addressInternal, portTarget, addressSource.port);
+					ipHeader->adjustChecksum(addressTarget, addressInternal);
 					return sl_true;
 				}
 			}
@@ -144,11 +159,13 @@ namespace slib
 			UdpDatagram* udp = (UdpDatagram*)(ipHeader->getContent());
 			if (udp->check(ipHeader, sizeContent)) {
 				SocketAddress addressSource;
-				if (m_mappingUdp.mapToInternalAddress(udp->getDestinationPort(), addressSource)) {
-					ipHeader->setDestinationAddress(addressSource.ip.getIPv4());
+				sl_uint16 portTarget = udp->getDestinationPort();
+				if (m_mappingUdp.mapToInternalAddress(portTarget, addressSource)) {
+					IPv4Address addressInternal = addressSource.ip.getIPv4();
+					ipHeader->setDestinationAddress(addressInternal);
 					udp->setDestinationPort(addressSource.port);
-					udp->updateChecksum(ipHeader);
-					ipHeader->updateChecksum();
+					udp->adjustChecksum(addressTarget, addressInternal, portTarget, addressSource.port);
+					ipHeader->adjustChecksum(addressTarget, addressInternal);
 					return sl_true;
 				}
 			}
@@ -159,7 +176,9 @@ namespace slib
 				if (type == IcmpType::EchoReply) {
 					if (icmp->getEchoIdentifier() == m_param.icmpEchoIdentifier) {
 						IcmpEchoElement element;
-						if (m_mapIcmpEchoIncoming.get(icmp->getEchoSequenceNumber(), &element)) {
+						SpinLocker lock(&m_lockIcmpEcho);
+						if (m_mapIcmpEchoIncoming.get_NoLock(icmp->getEchoSequenceNumber(), &element)) {
+							lock.unlock();
 							ipHeader->setDestinationAddress(element.addressSource.ip);
 							icmp->setEchoIdentifier(element.addressSource.identifier);
 							icmp->setEchoSequenceNumber(element.addressSource.sequenceNumber);
@@ -208,36 +227,223 @@ namespace slib
 
 	sl_uint16 NatTable::getMappedIcmpEchoSequenceNumber(const IcmpEchoAddress& address)
 	{
+		SpinLocker lock(&m_lockIcmpEcho);
 		IcmpEchoElement element;
-		if (m_mapIcmpEchoOutgoing.get(address, &element)) {
+		if (m_mapIcmpEchoOutgoing.get_NoLock(address, &element)) {
 			return element.sequenceNumberTarget;
 		}
 		sl_uint16 sn = ++ m_icmpEchoSequenceCurrent;
-		if (m_mapIcmpEchoIncoming.get(sn, &element)) {
-			m_mapIcmpEchoOutgoing.removeItems(element.addressSource);
+		if (m_mapIcmpEchoIncoming.get_NoLock(sn, &element)) {
+			m_mapIcmpEchoOutgoing.removeItems_NoLock(element.addressSource);
 		}
 		element.addressSource = address;
 		element.sequenceNumberTarget = sn;
-		m_mapIcmpEchoOutgoing.put(address, element);
-		m_mapIcmpEchoIncoming.put(sn, element);
+		m_mapIcmpEchoOutgoing.put_NoLock(address, element);
+		m_mapIcmpEchoIncoming.put_NoLock(sn, element);
 		return sn;
 	}
 
-	_priv_NatTablePort::_priv_NatTablePort()
+	class _priv_NatTablePort
 	{
-		flagActive = sl_false;
-		timeLastAccess.setZero();
-	}
-
-	_priv_NatTablePort::~_priv_NatTablePort()
+	public:
+		SocketAddress addressSource;
+		sl_uint32 timeLastAccess; // tick count in milliseconds
+		sl_uint32 next; // next port in the free list or in the slot of timer wheel
+		sl_bool flagActive;
+		
+	public:
+		_priv_NatTablePort()
+		{
+			timeLastAccess = 0;
+			next = NAT_INVALID_INDEX;
+			flagActive = sl_false;
+		}
+		
+	};
+	
+	class _priv_NatTableMappingShard
 	{
-	}
-
+	public:
+		SpinLock m_lock;
+		CHashMap<SocketAddress, sl_uint32> m_mapPorts;
+		
+		_priv_NatTablePort* m_ports;
+		sl_uint32 m_nPorts;
+		// released ports are reused last
+		sl_uint32 m_firstFree;
+		sl_uint32 m_lastFree;
+		
+		// idle mappings are checked when their slot is passed, and rescheduled if they were accessed in the meantime
+		sl_uint32 m_wheel[NAT_TIMER_WHEEL_SIZE];
+		sl_uint32 m_tickCurrent;
+		sl_uint32 m_timeout;
+		sl_uint32 m_durationTick;
+		
+	public:
+		_priv_NatTableMappingShard()
+		{
+			m_ports = sl_null;
+			m_nPorts = 0;
+			m_firstFree = NAT_INVALID_INDEX;
+			m_lastFree = NAT_INVALID_INDEX;
+			for (sl_uint32 i = 0; i < NAT_TIMER_WHEEL_SIZE; i++) {
+				m_wheel[i] = NAT_INVALID_INDEX;
+			}
+			m_tickCurrent = 0;
+			m_timeout = 0;
+			m_durationTick = 1;
+		}
+		
+		~_priv_NatTableMappingShard()
+		{
+			if (m_ports) {
+				NewHelper<_priv_NatTablePort>::free(m_ports, m_nPorts);
+			}
+		}
+		
+	public:
+		sl_bool setup(sl_uint32 nPorts, sl_uint32 timeout)
+		{
+			m_ports = NewHelper<_priv_NatTablePort>::create(nPorts);
+			if (!m_ports) {
+				return sl_false;
+			}
+			m_nPorts = nPorts;
+			for (sl_uint32 i = 0; i < nPorts; i++) {
+				m_ports[i].next = i + 1 < nPorts ? i + 1 : NAT_INVALID_INDEX;
+			}
+			if (nPorts) {
+				m_firstFree = 0;
+				m_lastFree = nPorts - 1;
+			}
+			if (timeout < 1) {
+				timeout = 1;
+			} else if (timeout > 0xFFFFFFFF / 1000) {
+				// the timeout is stored in milliseconds
+				timeout = 0xFFFFFFFF / 1000;
+			}
+			m_timeout = timeout * 1000;
+			m_durationTick = (m_timeout + NAT_TIMER_WHEEL_SIZE - 2) / (NAT_TIMER_WHEEL_SIZE - 1);
+			m_tickCurrent = System::getTickCount() / m_durationTick;
+			return sl_true;
+		}
+		
+		void schedule(sl_uint32 index)
+		{
+			_priv_NatTablePort& port = m_ports[index];
+			sl_uint32 slot = ((port.timeLastAccess + m_timeout) / m_durationTick) % NAT_TIMER_WHEEL_SIZE;
+			port.next = m_wheel[slot];
+			m_wheel[slot] = index;
+		}
+		
+		void release(sl_uint32 index)
+		{
+			_priv_NatTablePort& port = m_ports[index];
+			m_mapPorts.remove_NoLock(port.addressSource);
+			port.flagActive = sl_false;
+			port.next = NAT_INVALID_INDEX;
+			if (m_lastFree != NAT_INVALID_INDEX) {
+				m_ports[m_lastFree].next = index;
+			} else {
+				m_firstFree = index;
+			}
+			m_lastFree = index;
+		}
+		
+		void processSlot(sl_uint32 slot, sl_uint32 now, sl_bool flagForce)
+		{
+			sl_uint32 index = m_wheel[slot];
+			m_wheel[slot] = NAT_INVALID_INDEX;
+			while (index != NAT_INVALID_INDEX) {
+				sl_uint32 next = m_ports[index].next;
+				if (flagForce || now - m_ports[index].timeLastAccess >= m_timeout) {
+					release(index);
+				} else {
+					schedule(index);
+				}
+				index = next;
+			}
+		}
+		
+		void expire(sl_uint32 now)
+		{
+			sl_uint32 tickNow = now / m_durationTick;
+			sl_uint32 n = tickNow - m_tickCurrent;
+			if (!n) {
+				return;
+			}
+			if (n > NAT_TIMER_WHEEL_SIZE) {
+				n = NAT_TIMER_WHEEL_SIZE;
+			}
+			// processes only the passed ticks
+			for (sl_uint32 i = 0; i < n; i++) {
+				processSlot((m_tickCurrent + i) % NAT_TIMER_WHEEL_SIZE, now, sl_false);
+			}
+			m_tickCurrent = tickNow;
+		}
+		
+		// releases the mappings which are closest to expiration
+		void evict(sl_uint32 now)
+		{
+			for (sl_uint32 i = 0; i < NAT_TIMER_WHEEL_SIZE; i++) {
+				processSlot((m_tickCurrent + i) % NAT_TIMER_WHEEL_SIZE, now, sl_true);
+				if (m_firstFree != NAT_INVALID_INDEX) {
+					return;
+				}
+			}
+		}
+		
+		sl_bool map(const SocketAddress& address, sl_uint32& _index)
+		{
+			SpinLocker lock(&m_lock);
+			sl_uint32 now = System::getTickCount();
+			expire(now);
+			sl_uint32 index;
+			if (m_mapPorts.get_NoLock(address, &index)) {
+				m_ports[index].timeLastAccess = now;
+				_index = index;
+				return sl_true;
+			}
+			if (m_firstFree == NAT_INVALID_INDEX) {
+				evict(now);
+				if (m_firstFree == NAT_INVALID_INDEX) {
+					return sl_false;
+				}
+			}
+			index = m_firstFree;
+			_priv_NatTablePort& port = m_ports[index];
+			m_firstFree = port.next;
+			if (m_firstFree == NAT_INVALID_INDEX) {
+				m_lastFree = NAT_INVALID_INDEX;
+			}
+			port.flagActive = sl_true;
+			port.addressSource = address;
+			port.timeLastAccess = now;
+			schedule(index);
+			m_mapPorts.put_NoLock(address, index);
+			_index = index;
+			return sl_true;
+		}
+		
+		sl_bool getAddress(sl_uint32 index, SocketAddress& address)
+		{
+			SpinLocker lock(&m_lock);
+			sl_uint32 now = System::getTickCount();
+			_priv_NatTablePort& port = m_ports[index];
+			if (port.flagActive) {
+				port.timeLastAccess = now;
+				address = port.addressSource;
+				return sl_true;
+			}
+			return sl_false;
+		}
+		
+	};
+	
 	_priv_NatTableMapping::_priv_NatTableMapping()
 	{
-		m_ports = sl_null;
-		m_nPorts = 0;
-		m_pos = 0;
+		m_shards = sl_null;
+		m_nShards = 0;
 
 		m_portBegin = 0;
 		m_portEnd = 0;
@@ -245,108 +451,73 @@ namespace slib
 
 	_priv_NatTableMapping::~_priv_NatTableMapping()
 	{
-		NewHelper<_priv_NatTablePort>::free(m_ports, m_nPorts);
+		_free();
 	}
-
-	void _priv_NatTableMapping::setup(sl_uint16 portBegin, sl_uint16 portEnd)
+	
+	void _priv_NatTableMapping::_free()
 	{
-		ObjectLocker lock(this);
-
-		m_mapPorts.removeAll_NoLock();
-
-		if (m_ports) {
-			NewHelper<_priv_NatTablePort>::free(m_ports, m_nPorts);
-			m_ports = sl_null;
+		if (m_shards) {
+			NewHelper<_priv_NatTableMappingShard>::free(m_shards, m_nShards);
+			m_shards = sl_null;
 		}
-		m_pos = 0;
-		m_nPorts = 0;
+		m_nShards = 0;
+	}
 
+	void _priv_NatTableMapping::setup(sl_uint16 portBegin, sl_uint16 portEnd, sl_uint32 nShards, sl_uint32 timeout)
+	{
+		_free();
+		
 		m_portBegin = portBegin;
 		m_portEnd = portEnd;
-		if (portEnd >= portBegin) {
-			m_nPorts = portEnd - portBegin + 1;
-			m_ports = NewHelper<_priv_NatTablePort>::create(m_nPorts);
+		if (portEnd < portBegin) {
+			return;
 		}
-	}
-
-	sl_bool _priv_NatTableMapping::mapToExternalPort(const SocketAddress& address, sl_uint16& _port)
-	{
-		ObjectLocker lock(this);
-
-		if (!m_ports) {
-			return sl_false;
+		sl_uint32 nPorts = portEnd - portBegin + 1;
+		if (nShards < 1) {
+			nShards = 1;
 		}
-		sl_uint32 n = m_nPorts;
-		if (!n) {
-			return sl_false;
+		if (nShards > nPorts) {
+			nShards = nPorts;
 		}
-
-		sl_uint16 port;
-		if (m_mapPorts.get_NoLock(address, &port)) {
-			if (port >= m_portBegin && port <= m_portEnd) {
-				m_ports[port - m_portBegin].timeLastAccess = Time::now();
-				_port = port;
-				return sl_true;
-			} else {
-				m_mapPorts.remove_NoLock(address);
+		_priv_NatTableMappingShard* shards = NewHelper<_priv_NatTableMappingShard>::create(nShards);
+		if (!shards) {
+			return;
+		}
+		// port `portBegin + index * nShards + k` belongs to the shard `k`
+		for (sl_uint32 k = 0; k < nShards; k++) {
+			if (!(shards[k].setup((nPorts - k + nShards - 1) / nShards, timeout))) {
+				NewHelper<_priv_NatTableMappingShard>::free(shards, nShards);
+				return;
 			}
 		}
+		m_shards = shards;
+		m_nShards = nShards;
+	}
 
-		sl_uint16 pos = m_pos;
-		n *= 2;
-		sl_int64 timeAccessMin = 0;
-		sl_int64 timeAccessMax = 0;
-		for (sl_uint32 i = 0; i < n; i++) {
-			if (!(m_ports[pos].flagActive)) {
-				port = pos + m_portBegin;
-				m_ports[pos].flagActive = sl_true;
-				m_ports[pos].addressSource = address;
-				m_ports[pos].timeLastAccess = Time::now();
-				m_mapPorts.put_NoLock(address, port);
-				_port = port;
-				m_pos = (pos + 1) % m_nPorts;
-				return sl_true;
-			} else {
-				sl_int64 t = m_ports[pos].timeLastAccess.toInt();
-				if (t > timeAccessMax) {
-					timeAccessMax = t;
-				}
-				if (timeAccessMin == 0 || t < timeAccessMin) {
-					timeAccessMin = t;
-				}
-			}
-			pos = (pos + 1) % m_nPorts;
-			if (i == m_nPorts) {
-				sl_int64 mid = (timeAccessMin + timeAccessMax) / 2;
-				for (sl_uint16 k = 0; k < m_nPorts; k++) {
-					if (m_ports[k].flagActive) {
-						if (m_ports[k].timeLastAccess.toInt() <= mid) {
-							m_ports[k].flagActive = sl_false;
-							m_mapPorts.remove_NoLock(m_ports[k].addressSource);
-						}
-					}
-				}
-			}
+	sl_bool _priv_NatTableMapping::mapToExternalPort(const SocketAddress& address, sl_uint16& port)
+	{
+		sl_uint32 nShards = m_nShards;
+		if (!nShards) {
+			return sl_false;
+		}
+		sl_uint32 k = (sl_uint32)(address.hashCode() % nShards);
+		sl_uint32 index;
+		if (m_shards[k].map(address, index)) {
+			port = (sl_uint16)(m_portBegin + index * nShards + k);
+			return sl_true;
 		}
 		return sl_false;
 	}
 
 	sl_bool _priv_NatTableMapping::mapToInternalAddress(sl_uint16 port, SocketAddress& address)
 	{
-		ObjectLocker lock(this);
-		if (!m_ports) {
-			return sl_false;
-		}
-		if (!m_nPorts) {
+		sl_uint32 nShards = m_nShards;
+		if (!nShards) {
 			return sl_false;
 		}
 		if (port >= m_portBegin && port <= m_portEnd) {
-			sl_uint32 k = port - m_portBegin;
-			if (m_ports[k].flagActive) {
-				m_ports[k].timeLastAccess = Time::now();
-				address = m_ports[k].addressSource;
-				return sl_true;
-			}
+			sl_uint32 offset = port - m_portBegin;
+			return m_shards[offset % nShards].getAddress(offset / nShards, address);
 		}
 		return sl_false;
 	}
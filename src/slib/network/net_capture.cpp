@@ -31,9 +31,20 @@
 #include "slib/network/tcpip.h"
 #include "slib/network/ethernet.h"
 
+#if defined(SLIB_PLATFORM_IS_LINUX) && !defined(SLIB_PLATFORM_IS_ANDROID)
+#	define NET_CAPTURE_USE_PACKET_RING
+#	include <sys/mman.h>
+#	include <sys/socket.h>
+#	include <unistd.h>
+#	include <arpa/inet.h>
+#	include <linux/if_packet.h>
+#	include <linux/if_ether.h>
+#endif
+
 #define TAG "NetCapture"
 
 #define MAX_PACKET_SIZE 65535
+#define PACKET_RING_FRAME_SIZE 2048
 
 namespace slib
 {
@@ -63,6 +74,11 @@ namespace slib
 		
 		preferedLinkDeviceType = NetworkLinkDeviceType::Ethernet;
 		
+		sizeRing = 0;
+		sizeRingBlock = 0x100000; // 1MB
+		timeoutRingBlock = 10;
+		countFanoutThreads = 1;
+		
 		flagAutoStart = sl_true;
 	}
 	
@@ -102,6 +118,89 @@ namespace slib
 	}
 	
 	
+#if defined(NET_CAPTURE_USE_PACKET_RING)
+	class _priv_NetPacketRing : public Referable
+	{
+	public:
+		Ref<Socket> socket;
+		sl_uint8* blocks;
+		sl_uint32 sizeBlock;
+		sl_uint32 countBlocks;
+		Ref<Thread> thread;
+		
+	public:
+		_priv_NetPacketRing()
+		{
+			blocks = sl_null;
+			sizeBlock = 0;
+			countBlocks = 0;
+		}
+		
+		~_priv_NetPacketRing()
+		{
+			if (blocks) {
+				munmap(blocks, (size_t)sizeBlock * countBlocks);
+			}
+		}
+		
+	public:
+		static Ref<_priv_NetPacketRing> create(const Ref<Socket>& socket, sl_uint32 iface, const NetCaptureParam& param)
+		{
+			sl_socket handle = socket->getHandle();
+			int version = TPACKET_V3;
+			if (setsockopt(handle, SOL_PACKET, PACKET_VERSION, &version, sizeof(version))) {
+				LogError(TAG, "TPACKET_V3 is not supported");
+				return sl_null;
+			}
+			sl_uint32 sizeBlock = (param.sizeRingBlock + 4095) & ~((sl_uint32)4095);
+			if (!sizeBlock) {
+				sizeBlock = 4096;
+			}
+			sl_uint32 countBlocks = param.sizeRing / sizeBlock;
+			if (!countBlocks) {
+				countBlocks = 1;
+			}
+			tpacket_req3 req;
+			Base::zeroMemory(&req, sizeof(req));
+			req.tp_block_size = sizeBlock;
+			req.tp_block_nr = countBlocks;
+			req.tp_frame_size = PACKET_RING_FRAME_SIZE;
+			req.tp_frame_nr = (sizeBlock / PACKET_RING_FRAME_SIZE) * countBlocks;
+			req.tp_retire_blk_tov = param.timeoutRingBlock;
+			req.tp_feature_req_word = TP_FT_REQ_FILL_RXHASH;
+			if (setsockopt(handle, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req))) {
+				LogError(TAG, "Failed to create the packet ring: %d blocks of %d bytes", countBlocks, sizeBlock);
+				return sl_null;
+			}
+			void* blocks = mmap(sl_null, (size_t)sizeBlock * countBlocks, PROT_READ | PROT_WRITE, MAP_SHARED, handle, 0);
+			if (blocks == MAP_FAILED) {
+				LogError(TAG, "Failed to map the packet ring");
+				return sl_null;
+			}
+			Ref<_priv_NetPacketRing> ret = new _priv_NetPacketRing;
+			if (ret.isNull()) {
+				munmap(blocks, (size_t)sizeBlock * countBlocks);
+				return sl_null;
+			}
+			ret->socket = socket;
+			ret->blocks = (sl_uint8*)blocks;
+			ret->sizeBlock = sizeBlock;
+			ret->countBlocks = countBlocks;
+			sockaddr_ll addr;
+			Base::zeroMemory(&addr, sizeof(addr));
+			addr.sll_family = AF_PACKET;
+			addr.sll_protocol = htons(ETH_P_ALL);
+			addr.sll_ifindex = (int)iface;
+			if (bind(handle, (sockaddr*)&addr, sizeof(addr))) {
+				LogError(TAG, "Failed to bind the packet socket");
+				return sl_null;
+			}
+			return ret;
+		}
+		
+	};
+#endif
+	
 	class _priv_NetRawPacketCapture : public NetCapture
 	{
 	public:
@@ -111,6 +210,9 @@ namespace slib
 		sl_uint32 m_ifaceIndex;
 		Memory m_bufPacket;
 		Ref<Thread> m_thread;
+#if defined(NET_CAPTURE_USE_PACKET_RING)
+		List< Ref<_priv_NetPacketRing> > m_rings;
+#endif
 		
 		sl_bool m_flagInit;
 		sl_bool m_flagRunning;
@@ -162,6 +264,13 @@ namespace slib
 						Log(TAG, "Failed to bind the network device: %s", deviceName);
 					}
 				}
+				if (param.sizeRing) {
+#if defined(NET_CAPTURE_USE_PACKET_RING)
+					return _createRing(param, socket, deviceType, iface);
+#else
+					Log(TAG, "Packet ring is not supported on this platform");
+#endif
+				}
 				Memory mem = Memory::create(MAX_PACKET_SIZE);
 				if (mem.isNotNull()) {
 					Ref<_priv_NetRawPacketCapture> ret = new _priv_NetRawPacketCapture;
@@ -189,6 +298,67 @@ namespace slib
 			return sl_null;
 		}
 		
+#if defined(NET_CAPTURE_USE_PACKET_RING)
+		static Ref<_priv_NetRawPacketCapture> _createRing(const NetCaptureParam& param, const Ref<Socket>& socket, NetworkLinkDeviceType deviceType, sl_uint32 iface)
+		{
+			Ref<_priv_NetRawPacketCapture> ret = new _priv_NetRawPacketCapture;
+			if (ret.isNull()) {
+				return sl_null;
+			}
+			ret->_initWithParam(param);
+			ret->m_socket = socket;
+			ret->m_deviceType = deviceType;
+			ret->m_ifaceIndex = iface;
+			
+			sl_uint32 nThreads = param.countFanoutThreads;
+			if (nThreads < 1) {
+				nThreads = 1;
+			}
+			static sl_int32 lastFanoutGroup = 0;
+			sl_uint32 fanoutGroup = ((sl_uint32)getpid() + (sl_uint32)(Base::interlockedIncrement32(&lastFanoutGroup))) & 0xFFFF;
+			for (sl_uint32 i = 0; i < nThreads; i++) {
+				Ref<Socket> socketRing = socket;
+				if (i) {
+					if (deviceType == NetworkLinkDeviceType::Raw) {
+						socketRing = Socket::openPacketDatagram(NetworkLinkProtocol::All);
+					} else {
+						socketRing = Socket::openPacketRaw(NetworkLinkProtocol::All);
+					}
+					if (socketRing.isNull()) {
+						LogError(TAG, "Failed to create Packet socket");
+						return sl_null;
+					}
+				}
+				Ref<_priv_NetPacketRing> ring = _priv_NetPacketRing::create(socketRing, iface, param);
+				if (ring.isNull()) {
+					return sl_null;
+				}
+				if (nThreads > 1) {
+					int fanout = (int)(fanoutGroup | (PACKET_FANOUT_HASH << 16));
+					if (setsockopt(socketRing->getHandle(), SOL_PACKET, PACKET_FANOUT, &fanout, sizeof(fanout))) {
+						LogError(TAG, "Failed to join the packet fanout group");
+						return sl_null;
+					}
+				}
+				_priv_NetRawPacketCapture* capture = ret.get();
+				_priv_NetPacketRing* pRing = ring.get();
+				ring->thread = Thread::create([capture, pRing]() {
+					capture->_runRing(pRing);
+				});
+				if (ring->thread.isNull()) {
+					LogError(TAG, "Failed to create thread");
+					return sl_null;
+				}
+				ret->m_rings.add_NoLock(ring);
+			}
+			ret->m_flagInit = sl_true;
+			if (param.flagAutoStart) {
+				ret->start();
+			}
+			return ret;
+		}
+#endif
+		
 		void release()
 		{
 			ObjectLocker lock(this);
@@ -202,6 +372,15 @@ namespace slib
 				m_thread->finishAndWait();
 				m_thread.setNull();
 			}
+#if defined(NET_CAPTURE_USE_PACKET_RING)
+			for (auto& ring : m_rings) {
+				ring->thread->finish();
+			}
+			for (auto& ring : m_rings) {
+				ring->thread->finishAndWait();
+			}
+			m_rings.removeAll_NoLock();
+#endif
 			m_socket.setNull();
 		}
 		
@@ -220,6 +399,13 @@ namespace slib
 					m_flagRunning = sl_true;
 				}
 			}
+#if defined(NET_CAPTURE_USE_PACKET_RING)
+			for (auto& ring : m_rings) {
+				if (ring->thread->start()) {
+					m_flagRunning = sl_true;
+				}
+			}
+#endif
 		}
 		
 		sl_bool isRunning()
@@ -261,6 +447,45 @@ namespace slib
 			}
 		}
 		
+#if defined(NET_CAPTURE_USE_PACKET_RING)
+		void _runRing(_priv_NetPacketRing* ring)
+		{
+			NetCapturePacket packet;
+			
+			Ref<Socket>& socket = ring->socket;
+			socket->setNonBlockingMode(sl_true);
+			Ref<SocketEvent> event = SocketEvent::createRead(socket);
+			if (event.isNull()) {
+				return;
+			}
+			sl_bool flagDatagram = m_deviceType == NetworkLinkDeviceType::Raw;
+			sl_uint32 indexBlock = 0;
+			
+			while (Thread::isNotStoppingCurrent()) {
+				tpacket_block_desc* block = (tpacket_block_desc*)(ring->blocks + (sl_size)indexBlock * ring->sizeBlock);
+				if (!(__atomic_load_n(&(block->hdr.bh1.block_status), __ATOMIC_ACQUIRE) & TP_STATUS_USER)) {
+					event->wait();
+					continue;
+				}
+				sl_uint32 nPackets = block->hdr.bh1.num_pkts;
+				tpacket3_hdr* header = (tpacket3_hdr*)((sl_uint8*)block + block->hdr.bh1.offset_to_first_pkt);
+				for (sl_uint32 i = 0; i < nPackets; i++) {
+					packet.data = (sl_uint8*)header + (flagDatagram ? header->tp_net : header->tp_mac);
+					packet.length = header->tp_snaplen;
+					packet.time.setUnixTime(header->tp_sec);
+					packet.time.addMicroseconds(header->tp_nsec / 1000);
+					_onCapturePacket(&packet);
+					header = (tpacket3_hdr*)((sl_uint8*)header + header->tp_next_offset);
+				}
+				__atomic_store_n(&(block->hdr.bh1.block_status), TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+				indexBlock++;
+				if (indexBlock >= ring->countBlocks) {
+					indexBlock = 0;
+				}
+			}
+		}
+#endif
+		
 		NetworkLinkDeviceType getLinkType()
 		{
 			return m_deviceType;
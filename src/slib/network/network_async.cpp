@@ -24,6 +24,8 @@
 
 #include "network_async.h"
 
+#include "slib/network/dns.h"
+
 namespace slib
 {
 
@@ -152,6 +154,20 @@ namespace slib
 							}
 							return sl_null;
 						}
+					} else if (param.connectHostAddress.isNotEmpty()) {
+						String host = param.connectHostAddress;
+						sl_uint16 port = 0;
+						sl_reg index = host.lastIndexOf(':');
+						if (index > 0) {
+							port = (sl_uint16)(host.substring(index + 1).parseUint32());
+							host = host.substring(0, index);
+						}
+						if (!(ret->connect(host, port))) {
+							if (param.flagLogError) {
+								LogError(TAG, "AsyncTcpSocket connect error: %s", param.connectHostAddress);
+							}
+							return sl_null;
+						}
 					}
 					return ret;
 				}
@@ -212,6 +228,35 @@ namespace slib
 		return sl_false;
 	}
 
+	sl_bool AsyncTcpSocket::connect(const String& hostName, sl_uint16 port)
+	{
+		IPAddress ip;
+		if (ip.parse(hostName)) {
+			return connect(SocketAddress(ip, port));
+		}
+		Ref<DnsResolver> resolver = DnsResolver::getDefault();
+		if (resolver.isNull()) {
+			// no name server is configured. the resolver of the system is not used, because it would block the I/O loop
+			return sl_false;
+		}
+		WeakRef<AsyncTcpSocket> thiz = this;
+		resolver->resolve(hostName, [thiz, port](const List<IPAddress>& addresses) {
+			Ref<AsyncTcpSocket> socket = thiz;
+			if (socket.isNull()) {
+				return;
+			}
+			SocketAddress address;
+			address.port = port;
+			if (addresses.getAt(0, &(address.ip))) {
+				if (socket->connect(address)) {
+					return;
+				}
+			}
+			socket->_onConnect(address, sl_true);
+		});
+		return sl_true;
+	}
+
 	sl_bool AsyncTcpSocket::receive(void* data, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject)
 	{
 		return AsyncStreamBase::read(data, size, callback, userObject);
@@ -472,6 +517,7 @@ namespace slib
 	AsyncUdpSocketInstance::AsyncUdpSocketInstance()
 	{
 		m_flagRunning = sl_false;
+		m_flagGsoUnsupported = sl_false;
 	}
 
 	AsyncUdpSocketInstance::~AsyncUdpSocketInstance()
@@ -505,13 +551,14 @@ namespace slib
 
 #define UDP_QUEUE_MAX_SIZE 1024000
 
-	sl_bool AsyncUdpSocketInstance::sendTo(const SocketAddress& addressTo, const Memory& data)
+	sl_bool AsyncUdpSocketInstance::sendTo(const SocketAddress& addressTo, const Memory& data, sl_uint32 sizeSegment)
 	{
 		if (isOpened()) {
 			if (data.isNotNull()) {
 				SendRequest request;
 				request.addressTo = addressTo;
 				request.data = data;
+				request.sizeSegment = sizeSegment;
 				if (m_queueSendRequests.getCount() < UDP_QUEUE_MAX_SIZE) {
 					if (m_queueSendRequests.push(request)) {
 						return sl_true;
@@ -530,6 +577,109 @@ namespace slib
 		}
 	}
 
+	void AsyncUdpSocketInstance::_onReceive(SocketDatagram* datagrams, sl_uint32 count)
+	{
+		Ref<AsyncUdpSocket> object = Ref<AsyncUdpSocket>::from(getObject());
+		if (object.isNotNull()) {
+			object->_onReceive(datagrams, count);
+		}
+	}
+
+	// returns 1 when all segments are sent, 0 when the socket buffer is full, and negative value on error.
+	// `datagram` is advanced to the segments which are not sent
+	static sl_int32 _priv_AsyncUdpSocket_sendSegments(Socket* socket, SocketDatagram& datagram)
+	{
+		SocketDatagram segments[SLIB_SOCKET_DATAGRAM_BATCH_MAX];
+		while (datagram.size) {
+			sl_uint32 offset = 0;
+			sl_uint32 n = 0;
+			while (n < SLIB_SOCKET_DATAGRAM_BATCH_MAX && offset < datagram.size) {
+				SocketDatagram& segment = segments[n];
+				segment.address = datagram.address;
+				segment.data = (sl_uint8*)(datagram.data) + offset;
+				segment.size = datagram.size - offset;
+				if (segment.size > datagram.sizeSegment) {
+					segment.size = datagram.sizeSegment;
+				}
+				segment.sizeSegment = 0;
+				offset += segment.size;
+				n++;
+			}
+			sl_int32 nSent = socket->sendToBatch(segments, n);
+			if (nSent <= 0) {
+				return nSent;
+			}
+			sl_uint32 sizeSent = 0;
+			for (sl_int32 i = 0; i < nSent; i++) {
+				sizeSent += segments[i].size;
+			}
+			datagram.data = (sl_uint8*)(datagram.data) + sizeSent;
+			datagram.size -= sizeSent;
+		}
+		return 1;
+	}
+
+	void AsyncUdpSocketInstance::_processSendRequests(Socket* socket, sl_bool flagKeepBlocked)
+	{
+		SendRequest requests[SLIB_SOCKET_DATAGRAM_BATCH_MAX];
+		SocketDatagram datagrams[SLIB_SOCKET_DATAGRAM_BATCH_MAX];
+		while (Thread::isNotStoppingCurrent()) {
+			sl_uint32 n = 0;
+			while (n < SLIB_SOCKET_DATAGRAM_BATCH_MAX && m_queueSendRequests.pop(requests + n)) {
+				SendRequest& request = requests[n];
+				SocketDatagram& datagram = datagrams[n];
+				datagram.address = request.addressTo;
+				datagram.data = request.data.getData();
+				datagram.size = (sl_uint32)(request.data.getSize());
+				datagram.sizeSegment = request.sizeSegment;
+				n++;
+			}
+			if (!n) {
+				break;
+			}
+			sl_uint32 k = 0;
+			sl_bool flagBlocked = sl_false;
+			while (k < n) {
+				SocketDatagram& datagram = datagrams[k];
+				sl_bool flagSegments = datagram.sizeSegment && datagram.size > datagram.sizeSegment;
+				sl_int32 nSent;
+				if (flagSegments && m_flagGsoUnsupported) {
+					nSent = _priv_AsyncUdpSocket_sendSegments(socket, datagram);
+				} else {
+					nSent = socket->sendToBatch(datagrams + k, n - k);
+					if (nSent < 0 && flagSegments && socket->getLastError() == SocketError::SendSegmentsIsNotSupported) {
+						// UDP GSO is not supported by the kernel or the device, so the segments of this datagram, which is not sent at all, are sent one by one
+						m_flagGsoUnsupported = sl_true;
+						continue;
+					}
+				}
+				if (nSent > 0) {
+					k += nSent;
+				} else if (nSent == 0 && flagKeepBlocked) {
+					flagBlocked = sl_true;
+					break;
+				} else {
+					// drops the datagram which is not sent
+					k++;
+				}
+			}
+			if (flagBlocked) {
+				// the socket buffer is full, so the remaining requests are sent when the socket becomes writable
+				sl_size offset = (sl_uint8*)(datagrams[k].data) - (sl_uint8*)(requests[k].data.getData());
+				if (offset) {
+					requests[k].data = requests[k].data.sub(offset);
+				}
+				for (sl_uint32 i = n; i > k; i--) {
+					m_queueSendRequests.pushFront(requests[i - 1]);
+				}
+				return;
+			}
+			for (sl_uint32 i = 0; i < n; i++) {
+				requests[i].data.setNull();
+			}
+		}
+	}
+
 
 	AsyncUdpSocketParam::AsyncUdpSocketParam()
 	{
@@ -538,6 +688,8 @@ namespace slib
 		flagAutoStart = sl_false;
 		flagLogError = sl_false;
 		packetSize = 65536;
+		receiveBatchCount = 1;
+		flagGro = sl_false;
 	}
 
 	AsyncUdpSocketParam::~AsyncUdpSocketParam()
@@ -596,8 +748,17 @@ namespace slib
 		if (param.flagBroadcast) {
 			socket->setOption_Broadcast(sl_true);
 		}
+		if (param.flagGro) {
+			socket->setOption_UdpGro(sl_true);
+		}
 		
-		Ref<AsyncUdpSocketInstance> instance = _createInstance(socket, param.packetSize);
+		sl_uint32 batchCount = param.receiveBatchCount;
+		if (batchCount < 1) {
+			batchCount = 1;
+		} else if (batchCount > SLIB_SOCKET_DATAGRAM_BATCH_MAX) {
+			batchCount = SLIB_SOCKET_DATAGRAM_BATCH_MAX;
+		}
+		Ref<AsyncUdpSocketInstance> instance = _createInstance(socket, param.packetSize, batchCount);
 		if (instance.isNotNull()) {
 			Ref<AsyncIoLoop> loop = param.ioLoop;
 			if (loop.isNull()) {
@@ -609,10 +770,11 @@ namespace slib
 			Ref<AsyncUdpSocket> ret = new AsyncUdpSocket;
 			if (ret.isNotNull()) {
 				ret->m_onReceiveFrom = param.onReceiveFrom;
+				ret->m_onReceiveBatch = param.onReceiveBatch;
 				instance->setObject(ret.get());
 				ret->setIoInstance(instance.get());
 				ret->setIoLoop(loop);
-				if (loop->attachInstance(instance.get(), AsyncIoMode::In)) {
+				if (loop->attachInstance(instance.get(), AsyncIoMode::InOut)) {
 					if (param.flagAutoStart) {
 						ret->start();
 					}
@@ -705,6 +867,41 @@ namespace slib
 		return sl_false;
 	}
 
+	sl_bool AsyncUdpSocket::sendSegmentsTo(const SocketAddress& addressTo, const Memory& mem, sl_uint32 sizeSegment)
+	{
+		if (!sizeSegment) {
+			return sendTo(addressTo, mem);
+		}
+		Ref<AsyncIoLoop> loop = getIoLoop();
+		if (loop.isNull()) {
+			return sl_false;
+		}
+		Ref<AsyncUdpSocketInstance> instance = _getIoInstance();
+		if (instance.isNull()) {
+			return sl_false;
+		}
+		// one UDP GSO send is limited to 64 segments in one IP packet
+		sl_size nSegmentsPerSend = 65000 / sizeSegment;
+		if (nSegmentsPerSend > 64) {
+			nSegmentsPerSend = 64;
+		} else if (nSegmentsPerSend < 1) {
+			nSegmentsPerSend = 1;
+		}
+		sl_size sizePerSend = nSegmentsPerSend * sizeSegment;
+		sl_size size = mem.getSize();
+		for (sl_size offset = 0; offset < size; offset += sizePerSend) {
+			sl_size n = size - offset;
+			if (n > sizePerSend) {
+				n = sizePerSend;
+			}
+			if (!(instance->sendTo(addressTo, mem.sub(offset, n), sizeSegment))) {
+				return sl_false;
+			}
+		}
+		loop->requestOrder(instance.get());
+		return sl_true;
+	}
+
 	Ref<AsyncUdpSocketInstance> AsyncUdpSocket::_getIoInstance()
 	{
 		return Ref<AsyncUdpSocketInstance>::from(AsyncIoObject::getIoInstance());
@@ -712,7 +909,39 @@ namespace slib
 
 	void AsyncUdpSocket::_onReceive(const SocketAddress& address, void* data, sl_uint32 sizeReceived)
 	{
-		m_onReceiveFrom(this, address, data, sizeReceived);
+		if (m_onReceiveBatch.isNotNull()) {
+			SocketDatagram datagram;
+			datagram.address = address;
+			datagram.data = data;
+			datagram.size = sizeReceived;
+			datagram.sizeSegment = 0;
+			m_onReceiveBatch(this, &datagram, 1);
+		} else {
+			m_onReceiveFrom(this, address, data, sizeReceived);
+		}
+	}
+
+	void AsyncUdpSocket::_onReceive(SocketDatagram* datagrams, sl_uint32 count)
+	{
+		if (m_onReceiveBatch.isNotNull()) {
+			m_onReceiveBatch(this, datagrams, count);
+			return;
+		}
+		for (sl_uint32 i = 0; i < count; i++) {
+			SocketDatagram& datagram = datagrams[i];
+			sl_uint8* data = (sl_uint8*)(datagram.data);
+			sl_uint32 size = datagram.size;
+			sl_uint32 sizeSegment = datagram.sizeSegment;
+			if (!sizeSegment || sizeSegment > size) {
+				sizeSegment = size;
+			}
+			while (size > 0) {
+				sl_uint32 n = size > sizeSegment ? sizeSegment : size;
+				m_onReceiveFrom(this, datagram.address, data, n);
+				data += n;
+				size -= n;
+			}
+		}
 	}
 
 }
@@ -31,6 +31,9 @@
 
 #define ASYNC_UDP_PACKET_SIZE 65535
 
+// maximum number of write requests gathered into one system call
+#define ASYNC_TCP_WRITE_VECTOR_MAX 64
+
 namespace slib
 {
 
@@ -109,21 +112,28 @@ namespace slib
 		
 		Ref<Socket> getSocket();
 		
-		sl_bool sendTo(const SocketAddress& address, const Memory& data);
+		sl_bool sendTo(const SocketAddress& address, const Memory& data, sl_uint32 sizeSegment = 0);
 		
 	protected:
 		void _onReceive(const SocketAddress& address, sl_uint32 size);
 		
+		void _onReceive(SocketDatagram* datagrams, sl_uint32 count);
+		
+		// `flagKeepBlocked`: keeps the requests which are blocked by the full socket buffer, instead of dropping them
+		void _processSendRequests(Socket* socket, sl_bool flagKeepBlocked);
+		
 	protected:
 		AtomicRef<Socket> m_socket;
 
 		sl_bool m_flagRunning;
 		Memory m_buffer;
+		sl_bool m_flagGsoUnsupported;
 		
 		struct SendRequest
 		{
 			SocketAddress addressTo;
 			Memory data;
+			sl_uint32 sizeSegment;
 		};
 		LinkedQueue<SendRequest> m_queueSendRequests;
 		
@@ -33,7 +33,8 @@ namespace slib
 	{
 	public:
 		AtomicRef<AsyncStreamRequest> m_requestReading;
-		AtomicRef<AsyncStreamRequest> m_requestWriting;
+		Ref<AsyncStreamRequest> m_requestsWriting[ASYNC_TCP_WRITE_VECTOR_MAX];
+		sl_uint32 m_countRequestsWriting;
 		sl_uint32 m_sizeWritten;
 		
 		sl_bool m_flagConnecting;
@@ -41,6 +42,7 @@ namespace slib
 	public:
 		_priv_Unix_AsyncTcpSocketInstance()
 		{
+			m_countRequestsWriting = 0;
 			m_sizeWritten = 0;
 			m_flagConnecting = sl_false;
 		}
@@ -100,7 +102,8 @@ namespace slib
 				if (request->data && request->size) {
 					sl_int32 n = socket->receive((char*)(request->data), request->size);
 					if (n > 0) {
-						_onReceive(request.get(), n, flagError);
+						// more data can be left after the peer shuts down, and the end is reported by the next receiving
+						_onReceive(request.get(), n, sl_false);
 					} else if (n < 0) {
 						_onReceive(request.get(), 0, sl_true);
 						return;
@@ -119,54 +122,89 @@ namespace slib
 			}
 		}
 
-		void processWrite(sl_bool flagError)
+		// the error flag of the event is not used, because it is also set when the peer shuts down only its sending side
+		void processWrite()
 		{
 			Ref<Socket> socket = m_socket;
 			if (socket.isNull()) {
 				return;
 			}
-			Ref<AsyncStreamRequest> request = m_requestWriting;
-			m_requestWriting.setNull();
-			sl_size nQueue = getWriteRequestsCount();
 			if (Thread::isNotStoppingCurrent()) {
-				if (request.isNull()) {
-					if (nQueue > 0) {
-						nQueue--;
-						popWriteRequest(request);
-						if (request.isNull()) {
-							return;
-						} else {
+				// collect the queued requests, so that they are sent by one gather write
+				while (m_countRequestsWriting < ASYNC_TCP_WRITE_VECTOR_MAX) {
+					Ref<AsyncStreamRequest> request;
+					if (popWriteRequest(request) && request.isNotNull()) {
+						if (m_countRequestsWriting == 0) {
 							m_sizeWritten = 0;
 						}
+						m_requestsWriting[m_countRequestsWriting] = request;
+						m_countRequestsWriting++;
 					} else {
-						return;
+						break;
 					}
 				}
-				if (request->data && request->size) {
-					sl_uint32 size = request->size - m_sizeWritten;
-					sl_int32 n = socket->send((char*)(request->data) + m_sizeWritten, size);
-					if (n > 0) {
-						m_sizeWritten += n;
-						if (m_sizeWritten >= request->size) {
-							_onSend(request.get(), request->size, flagError);
-						} else {
-							m_requestWriting = request;
+				sl_uint32 nRequests = m_countRequestsWriting;
+				if (!nRequests) {
+					return;
+				}
+				SocketBuffer buffers[ASYNC_TCP_WRITE_VECTOR_MAX];
+				sl_uint32 nBuffers = 0;
+				sl_uint32 i;
+				for (i = 0; i < nRequests; i++) {
+					AsyncStreamRequest* request = m_requestsWriting[i].get();
+					if (request->data && request->size) {
+						sl_uint32 offset = i ? 0 : m_sizeWritten;
+						buffers[nBuffers].data = (char*)(request->data) + offset;
+						buffers[nBuffers].size = request->size - offset;
+						nBuffers++;
+					}
+				}
+				sl_uint32 sizeSent = 0;
+				if (nBuffers) {
+					sl_int32 n = socket->sendVector(buffers, nBuffers);
+					if (n < 0) {
+						Ref<AsyncStreamRequest> requests[ASYNC_TCP_WRITE_VECTOR_MAX];
+						for (i = 0; i < nRequests; i++) {
+							requests[i] = Move(m_requestsWriting[i]);
+						}
+						sl_uint32 sizeWritten = m_sizeWritten;
+						m_countRequestsWriting = 0;
+						m_sizeWritten = 0;
+						for (i = 0; i < nRequests; i++) {
+							_onSend(requests[i].get(), i ? 0 : sizeWritten, sl_true);
 						}
-					} else if (n < 0) {
-						_onSend(request.get(), m_sizeWritten, sl_true);
 						return;
-					} else {
-						if (flagError) {
-							_onSend(request.get(), m_sizeWritten, sl_true);
+					}
+					sizeSent = (sl_uint32)n;
+				}
+				// pick up the completed requests
+				Ref<AsyncStreamRequest> requestsCompleted[ASYNC_TCP_WRITE_VECTOR_MAX];
+				sl_uint32 nCompleted = 0;
+				for (i = 0; i < nRequests; i++) {
+					AsyncStreamRequest* request = m_requestsWriting[i].get();
+					if (request->data && request->size) {
+						sl_uint32 sizeRemain = request->size - m_sizeWritten;
+						if (sizeSent >= sizeRemain) {
+							sizeSent -= sizeRemain;
+							m_sizeWritten = 0;
 						} else {
-							m_requestWriting = request;
+							m_sizeWritten += sizeSent;
+							break;
 						}
-						return;
 					}
-				} else {
-					_onSend(request.get(), request->size, sl_false);
+					requestsCompleted[nCompleted] = Move(m_requestsWriting[i]);
+					nCompleted++;
+				}
+				if (nCompleted) {
+					for (i = nCompleted; i < nRequests; i++) {
+						m_requestsWriting[i - nCompleted] = Move(m_requestsWriting[i]);
+					}
+					m_countRequestsWriting = nRequests - nCompleted;
+					for (i = 0; i < nCompleted; i++) {
+						AsyncStreamRequest* request = requestsCompleted[i].get();
+						_onSend(request, request->size, sl_false);
+					}
 				}
-				request.setNull();
 			}
 		}
 		
@@ -189,7 +227,7 @@ namespace slib
 				return;
 			}
 			processRead(sl_false);
-			processWrite(sl_false);
+			processWrite();
 		}
 		
 		void onEvent(EventDesc* pev)
@@ -208,7 +246,7 @@ namespace slib
 						_onConnect(sl_false);
 					}
 				} else {
-					processWrite(pev->flagError);
+					processWrite();
 				}
 				flagProcessed = sl_true;
 			}
@@ -219,7 +257,7 @@ namespace slib
 						_onConnect(sl_true);
 					} else {
 						processRead(sl_true);
-						processWrite(sl_true);
+						processWrite();
 					}
 				}
 			}
@@ -314,9 +352,16 @@ namespace slib
 
 	class _priv_Unix_AsyncUdpSocketInstance : public AsyncUdpSocketInstance
 	{
+	public:
+		sl_uint32 m_sizePacket;
+		sl_uint32 m_countBatch;
+		SocketDatagram m_datagrams[SLIB_SOCKET_DATAGRAM_BATCH_MAX];
+		
 	public:
 		_priv_Unix_AsyncUdpSocketInstance()
 		{
+			m_sizePacket = 0;
+			m_countBatch = 1;
 		}
 		
 		~_priv_Unix_AsyncUdpSocketInstance()
@@ -325,7 +370,7 @@ namespace slib
 		}
 		
 	public:
-		static Ref<_priv_Unix_AsyncUdpSocketInstance> create(const Ref<Socket>& socket, const Memory& buffer)
+		static Ref<_priv_Unix_AsyncUdpSocketInstance> create(const Ref<Socket>& socket, const Memory& buffer, sl_uint32 packetSize, sl_uint32 batchCount)
 		{
 			Ref<_priv_Unix_AsyncUdpSocketInstance> ret;
 			if (socket.isNotNull()) {
@@ -337,6 +382,8 @@ namespace slib
 							ret->m_socket = socket;
 							ret->setHandle(handle);
 							ret->m_buffer = buffer;
+							ret->m_sizePacket = packetSize;
+							ret->m_countBatch = batchCount;
 							return ret;
 						}
 					}
@@ -363,6 +410,9 @@ namespace slib
 			if (pev->flagIn) {
 				processReceive();
 			}
+			if (pev->flagOut) {
+				processSend();
+			}
 		}
 		
 		void processSend()
@@ -374,14 +424,7 @@ namespace slib
 			if (!(socket->isOpened())) {
 				return;
 			}
-			while (Thread::isNotStoppingCurrent()) {
-				SendRequest request;
-				if (m_queueSendRequests.pop(&request)) {
-					socket->sendTo(request.addressTo, request.data.getData(), (sl_uint32)(request.data.getSize()));
-				} else {
-					break;
-				}
-			}
+			_processSendRequests(socket.get(), sl_true);
 		}
 		
 		void processReceive()
@@ -393,13 +436,16 @@ namespace slib
 			if (!(socket->isOpened())) {
 				return;
 			}
-			void* buf = m_buffer.getData();
-			sl_uint32 sizeBuf = (sl_uint32)(m_buffer.getSize());
+			sl_uint8* buf = (sl_uint8*)(m_buffer.getData());
+			sl_uint32 nBatch = m_countBatch;
 			while (Thread::isNotStoppingCurrent()) {
-				SocketAddress addr;
-				sl_int32 n = socket->receiveFrom(addr, buf, sizeBuf);
+				for (sl_uint32 i = 0; i < nBatch; i++) {
+					m_datagrams[i].data = buf + i * m_sizePacket;
+					m_datagrams[i].size = m_sizePacket;
+				}
+				sl_int32 n = socket->receiveFromBatch(m_datagrams, nBatch);
 				if (n > 0) {
-					_onReceive(addr, n);
+					_onReceive(m_datagrams, n);
 				} else {
 					break;
 				}
@@ -408,11 +454,11 @@ namespace slib
 
 	};
 
-	Ref<AsyncUdpSocketInstance> AsyncUdpSocket::_createInstance(const Ref<Socket>& socket, sl_uint32 packetSize)
+	Ref<AsyncUdpSocketInstance> AsyncUdpSocket::_createInstance(const Ref<Socket>& socket, sl_uint32 packetSize, sl_uint32 batchCount)
 	{
-		Memory buffer = Memory::create(packetSize);
+		Memory buffer = Memory::create(packetSize * batchCount);
 		if (buffer.isNotNull()) {
-			return _priv_Unix_AsyncUdpSocketInstance::create(socket, buffer);
+			return _priv_Unix_AsyncUdpSocketInstance::create(socket, buffer, packetSize, batchCount);
 		}
 		return sl_null;
 	}
@@ -562,14 +562,7 @@ namespace slib
 			if (!(socket->isOpened())) {
 				return;
 			}
-			while (Thread::isNotStoppingCurrent()) {
-				SendRequest request;
-				if (m_queueSendRequests.pop(&request)) {
-					socket->sendTo(request.addressTo, request.data.getData(), (sl_uint32)(request.data.getSize()));
-				} else {
-					break;
-				}
-			}
+			_processSendRequests(socket.get(), sl_false);
 		}
 
 		void processReceive()
@@ -613,7 +606,7 @@ namespace slib
 
 	};
 
-	Ref<AsyncUdpSocketInstance> AsyncUdpSocket::_createInstance(const Ref<Socket>& socket, sl_uint32 packetSize)
+	Ref<AsyncUdpSocketInstance> AsyncUdpSocket::_createInstance(const Ref<Socket>& socket, sl_uint32 packetSize, sl_uint32 batchCount)
 	{
 		Memory buffer = Memory::create(packetSize);
 		if (buffer.isNotNull()) {
@@ -0,0 +1,763 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#include "slib/network/rpc.h"
+
+#include "slib/network/socket.h"
+#include "slib/core/mio.h"
+#include "slib/core/dispatch.h"
+
+#define RPC_DEFAULT_MAX_PAYLOAD_SIZE 0x1000000
+#define RPC_READ_BUFFER_SIZE 0x10000
+
+namespace slib
+{
+	
+/******************************************************
+						RpcFrame
+******************************************************/
+	
+	RpcFrame::RpcFrame()
+	{
+		id = 0;
+	}
+	
+	RpcFrame::~RpcFrame()
+	{
+	}
+	
+	Memory RpcFrame::build(sl_uint32 id, const void* payload, sl_size size)
+	{
+		if (size > 0xFFFFFFFF) {
+			return sl_null;
+		}
+		Memory ret = Memory::create(SLIB_RPC_FRAME_HEADER_SIZE + size);
+		if (ret.isNotNull()) {
+			sl_uint8* p = (sl_uint8*)(ret.getData());
+			MIO::writeUint32BE(p, (sl_uint32)size);
+			MIO::writeUint32BE(p + 4, id);
+			if (size) {
+				Base::copyMemory(p + SLIB_RPC_FRAME_HEADER_SIZE, payload, size);
+			}
+		}
+		return ret;
+	}
+	
+	Memory RpcFrame::build(sl_uint32 id, const Memory& payload)
+	{
+		return build(id, payload.getData(), payload.getSize());
+	}
+	
+	Memory RpcFrame::buildHeader(sl_uint32 id, sl_size sizePayload)
+	{
+		if (sizePayload > 0xFFFFFFFF) {
+			return sl_null;
+		}
+		sl_uint8 header[SLIB_RPC_FRAME_HEADER_SIZE];
+		MIO::writeUint32BE(header, (sl_uint32)sizePayload);
+		MIO::writeUint32BE(header + 4, id);
+		return Memory::create(header, SLIB_RPC_FRAME_HEADER_SIZE);
+	}
+	
+/******************************************************
+					RpcFrameReader
+******************************************************/
+	
+	RpcFrameReader::RpcFrameReader()
+	{
+		m_maxPayloadSize = RPC_DEFAULT_MAX_PAYLOAD_SIZE;
+		m_sizeHeader = 0;
+		m_idPayload = 0;
+		m_sizePayloadReceived = 0;
+	}
+	
+	RpcFrameReader::~RpcFrameReader()
+	{
+	}
+	
+	sl_uint32 RpcFrameReader::getMaxPayloadSize()
+	{
+		return m_maxPayloadSize;
+	}
+	
+	void RpcFrameReader::setMaxPayloadSize(sl_uint32 size)
+	{
+		m_maxPayloadSize = size;
+	}
+	
+	sl_bool RpcFrameReader::add(const void* _data, sl_size size)
+	{
+		const sl_uint8* data = (const sl_uint8*)_data;
+		while (size > 0) {
+			if (m_sizeHeader < SLIB_RPC_FRAME_HEADER_SIZE) {
+				sl_size n = SLIB_RPC_FRAME_HEADER_SIZE - m_sizeHeader;
+				if (n > size) {
+					n = size;
+				}
+				Base::copyMemory(m_header + m_sizeHeader, data, n);
+				m_sizeHeader += (sl_uint32)n;
+				data += n;
+				size -= n;
+				if (m_sizeHeader < SLIB_RPC_FRAME_HEADER_SIZE) {
+					return sl_true;
+				}
+				sl_uint32 sizePayload = MIO::readUint32BE(m_header);
+				if (sizePayload > m_maxPayloadSize) {
+					return sl_false;
+				}
+				m_idPayload = MIO::readUint32BE(m_header + 4);
+				m_sizePayloadReceived = 0;
+				if (sizePayload) {
+					m_payload = Memory::create(sizePayload);
+					if (m_payload.isNull()) {
+						return sl_false;
+					}
+				} else {
+					m_payload.setNull();
+				}
+			}
+			sl_size sizePayload = m_payload.getSize();
+			sl_size n = sizePayload - m_sizePayloadReceived;
+			if (n > size) {
+				n = size;
+			}
+			if (n) {
+				Base::copyMemory((sl_uint8*)(m_payload.getData()) + m_sizePayloadReceived, data, n);
+				m_sizePayloadReceived += n;
+				data += n;
+				size -= n;
+			}
+			if (m_sizePayloadReceived >= sizePayload) {
+				RpcFrame frame;
+				frame.id = m_idPayload;
+				frame.payload = m_payload;
+				m_queueFrames.push_NoLock(frame);
+				m_payload.setNull();
+				m_sizeHeader = 0;
+			}
+		}
+		return sl_true;
+	}
+	
+	sl_bool RpcFrameReader::pop(RpcFrame& _out)
+	{
+		return m_queueFrames.pop_NoLock(&_out);
+	}
+	
+	void RpcFrameReader::clear()
+	{
+		m_sizeHeader = 0;
+		m_payload.setNull();
+		m_sizePayloadReceived = 0;
+		m_queueFrames.removeAll_NoLock();
+	}
+	
+/******************************************************
+					AsyncTcpRpcClient
+******************************************************/
+	
+	class AsyncTcpRpcClient::Connection : public Referable
+	{
+	public:
+		Ref<AsyncTcpSocket> socket;
+		RpcFrameReader reader;
+		Memory bufRead;
+		sl_uint32 nPending;
+		sl_bool flagReading;
+		// set when a call timed out, because its late response would be read by the next user of the pooled socket
+		sl_bool flagDiscard;
+		
+	public:
+		Connection()
+		{
+			nPending = 0;
+			flagReading = sl_false;
+			flagDiscard = sl_false;
+		}
+		
+	};
+	
+	class AsyncTcpRpcClient::Call : public Referable
+	{
+	public:
+		sl_uint32 id;
+		Memory frame;
+		Function<void(const Memory&, sl_bool)> callback;
+		Ref<Connection> connection;
+		
+	};
+	
+	AsyncTcpRpcClientParam::AsyncTcpRpcClientParam()
+	{
+		maxConnectionsCount = 4;
+		maxPendingCallsPerConnection = 32;
+		timeout = 30000;
+		maxPayloadSize = RPC_DEFAULT_MAX_PAYLOAD_SIZE;
+	}
+	
+	AsyncTcpRpcClientParam::~AsyncTcpRpcClientParam()
+	{
+	}
+	
+	SLIB_DEFINE_OBJECT(AsyncTcpRpcClient, Object)
+	
+	AsyncTcpRpcClient::AsyncTcpRpcClient()
+	{
+		m_flagClosed = sl_false;
+		m_lastId = 0;
+		m_nAcquiring = 0;
+	}
+	
+	AsyncTcpRpcClient::~AsyncTcpRpcClient()
+	{
+		close();
+	}
+	
+	Ref<AsyncTcpRpcClient> AsyncTcpRpcClient::create(const AsyncTcpRpcClientParam& param)
+	{
+		if (param.address.isInvalid() && param.hostAddress.isEmpty()) {
+			return sl_null;
+		}
+		Ref<AsyncTcpSocketPool> pool = param.pool;
+		if (pool.isNull()) {
+			AsyncTcpSocketPoolParam pp;
+			pool = AsyncTcpSocketPool::create(pp);
+			if (pool.isNull()) {
+				return sl_null;
+			}
+		}
+		Ref<AsyncTcpRpcClient> ret = new AsyncTcpRpcClient;
+		if (ret.isNotNull()) {
+			ret->m_param = param;
+			if (!(ret->m_param.maxConnectionsCount)) {
+				ret->m_param.maxConnectionsCount = 1;
+			}
+			if (!(ret->m_param.maxPendingCallsPerConnection)) {
+				ret->m_param.maxPendingCallsPerConnection = 1;
+			}
+			ret->m_pool = pool;
+			return ret;
+		}
+		return sl_null;
+	}
+	
+	void AsyncTcpRpcClient::call(const Memory& request, const Function<void(const Memory&, sl_bool)>& callback)
+	{
+		Memory frame;
+		Ref<Call> call = new Call;
+		if (call.isNotNull()) {
+			call->callback = callback;
+			ObjectLocker lock(this);
+			if (!m_flagClosed) {
+				do {
+					m_lastId++;
+				} while (!m_lastId || m_calls.find_NoLock(m_lastId));
+				call->id = m_lastId;
+				call->frame = RpcFrame::build(call->id, request);
+				if (call->frame.isNotNull()) {
+					m_calls.put_NoLock(call->id, call);
+					m_queueWaiting.push_NoLock(call);
+					frame = call->frame;
+				}
+			}
+		}
+		if (frame.isNull()) {
+			callback(sl_null, sl_true);
+			return;
+		}
+		if (m_param.timeout) {
+			WeakRef<AsyncTcpRpcClient> thiz = this;
+			sl_uint32 id = call->id;
+			Dispatch::setTimeout([thiz, id]() {
+				Ref<AsyncTcpRpcClient> client = thiz;
+				if (client.isNotNull()) {
+					client->_onTimeout(id);
+				}
+			}, m_param.timeout);
+		}
+		_dispatchWaitingCalls();
+	}
+	
+	void AsyncTcpRpcClient::close()
+	{
+		ObjectLocker lock(this);
+		if (m_flagClosed) {
+			return;
+		}
+		m_flagClosed = sl_true;
+		ListElements< Ref<Connection> > connections(m_connections.duplicate_NoLock());
+		m_connections.setNull();
+		List< Ref<Call> > calls;
+		for (auto& item : m_calls) {
+			calls.add_NoLock(item.value);
+		}
+		m_calls.removeAll_NoLock();
+		m_queueWaiting.removeAll_NoLock();
+		lock.unlock();
+		for (sl_size i = 0; i < connections.count; i++) {
+			m_pool->discard(connections[i]->socket.get());
+		}
+		ListElements< Ref<Call> > elements(calls);
+		for (sl_size i = 0; i < elements.count; i++) {
+			elements[i]->callback(sl_null, sl_true);
+		}
+		if (m_param.pool.isNull()) {
+			m_pool->close();
+		}
+	}
+	
+	sl_uint32 AsyncTcpRpcClient::getPendingCallsCount()
+	{
+		return (sl_uint32)(m_calls.getCount());
+	}
+	
+	const AsyncTcpRpcClientParam& AsyncTcpRpcClient::getParam()
+	{
+		return m_param;
+	}
+	
+	sl_bool AsyncTcpRpcClient::_send(Connection* connection, Call* call)
+	{
+		call->connection = connection;
+		connection->nPending++;
+		if (!(connection->socket->writeFromMemory(call->frame, sl_null))) {
+			return sl_false;
+		}
+		call->frame.setNull();
+		if (!(connection->flagReading)) {
+			return _read(connection);
+		}
+		return sl_true;
+	}
+	
+	void AsyncTcpRpcClient::_dispatchWaitingCalls()
+	{
+		List< Ref<Connection> > listError;
+		sl_uint32 nAcquire = 0;
+		{
+			ObjectLocker lock(this);
+			if (m_flagClosed) {
+				return;
+			}
+			Ref<Call> call;
+			while (m_queueWaiting.pop_NoLock(&call)) {
+				if (!(m_calls.find_NoLock(call->id))) {
+					// timed out while waiting
+					continue;
+				}
+				Connection* connection = sl_null;
+				sl_uint32 nMinPending = m_param.maxPendingCallsPerConnection;
+				ListElements< Ref<Connection> > connections(m_connections);
+				for (sl_size i = 0; i < connections.count; i++) {
+					Connection* c = connections[i].get();
+					if (!(c->flagDiscard) && c->nPending < nMinPending) {
+						connection = c;
+						nMinPending = c->nPending;
+					}
+				}
+				if (connection) {
+					if (!(_send(connection, call.get()))) {
+						listError.add_NoLock(connection);
+					}
+				} else {
+					m_queueWaiting.pushFront_NoLock(call);
+					break;
+				}
+			}
+			sl_size nWaiting = m_queueWaiting.getCount();
+			if (nWaiting) {
+				sl_size nConnections = m_connections.getCount();
+				while (nConnections + m_nAcquiring < m_param.maxConnectionsCount && (sl_size)(m_nAcquiring) * m_param.maxPendingCallsPerConnection < nWaiting) {
+					m_nAcquiring++;
+					nAcquire++;
+				}
+			}
+		}
+		ListElements< Ref<Connection> > errors(listError);
+		for (sl_size i = 0; i < errors.count; i++) {
+			_onError(errors[i].get());
+		}
+		// the callback can be called before returning from `acquire()`
+		for (sl_uint32 i = 0; i < nAcquire; i++) {
+			if (m_param.hostAddress.isNotEmpty()) {
+				m_pool->acquire(m_param.hostAddress, SLIB_FUNCTION_WEAKREF(AsyncTcpRpcClient, _onAcquire, this));
+			} else {
+				m_pool->acquire(m_param.address, SLIB_FUNCTION_WEAKREF(AsyncTcpRpcClient, _onAcquire, this));
+			}
+		}
+	}
+	
+	void AsyncTcpRpcClient::_onAcquire(AsyncTcpSocket* socket)
+	{
+		ObjectLocker lock(this);
+		m_nAcquiring--;
+		if (!socket) {
+			if (m_connections.isEmpty() && !m_nAcquiring) {
+				lock.unlock();
+				_failWaitingCalls();
+			}
+			return;
+		}
+		if (m_flagClosed) {
+			lock.unlock();
+			m_pool->release(socket);
+			return;
+		}
+		Ref<Connection> connection = new Connection;
+		if (connection.isNull()) {
+			lock.unlock();
+			m_pool->release(socket);
+			return;
+		}
+		connection->bufRead = Memory::create(RPC_READ_BUFFER_SIZE);
+		if (connection->bufRead.isNull()) {
+			lock.unlock();
+			m_pool->release(socket);
+			return;
+		}
+		connection->socket = socket;
+		connection->reader.setMaxPayloadSize(m_param.maxPayloadSize);
+		m_connections.add_NoLock(connection);
+		lock.unlock();
+		_dispatchWaitingCalls();
+		lock.lock(this);
+		if (!(connection->nPending) && !(connection->flagReading) && m_connections.remove_NoLock(connection)) {
+			lock.unlock();
+			m_pool->release(socket);
+		}
+	}
+	
+	sl_bool AsyncTcpRpcClient::_read(Connection* connection)
+	{
+		connection->flagReading = sl_true;
+		WeakRef<AsyncTcpRpcClient> thiz = this;
+		Ref<Connection> ref = connection;
+		if (connection->socket->readToMemory(connection->bufRead, [thiz, ref](AsyncStreamResult* result) {
+			Ref<AsyncTcpRpcClient> client = thiz;
+			if (client.isNotNull()) {
+				client->_onRead(ref.get(), result);
+			}
+		})) {
+			return sl_true;
+		}
+		connection->flagReading = sl_false;
+		return sl_false;
+	}
+	
+	void AsyncTcpRpcClient::_onRead(Connection* connection, AsyncStreamResult* result)
+	{
+		if (result->flagError) {
+			_onError(connection);
+			return;
+		}
+		ObjectLocker lock(this);
+		connection->flagReading = sl_false;
+		if (!(connection->reader.add(result->data, result->size))) {
+			lock.unlock();
+			_onError(connection);
+			return;
+		}
+		List< Ref<Call> > listCompleted;
+		List<Memory> listResponses;
+		RpcFrame frame;
+		while (connection->reader.pop(frame)) {
+			Ref<Call> call;
+			if (m_calls.get_NoLock(frame.id, &call) && call->connection == connection) {
+				m_calls.remove_NoLock(frame.id);
+				connection->nPending--;
+				listCompleted.add_NoLock(call);
+				listResponses.add_NoLock(frame.payload);
+			}
+		}
+		sl_bool flagRelease = sl_false;
+		sl_bool flagDiscard = sl_false;
+		if (connection->nPending) {
+			if (!(_read(connection))) {
+				lock.unlock();
+				_onError(connection);
+				return;
+			}
+		} else {
+			if (connection->flagDiscard) {
+				flagDiscard = m_connections.remove_NoLock(connection);
+			} else {
+				flagRelease = sl_true;
+			}
+		}
+		lock.unlock();
+		ListElements< Ref<Call> > calls(listCompleted);
+		ListElements<Memory> responses(listResponses);
+		for (sl_size i = 0; i < calls.count; i++) {
+			calls[i]->callback(responses[i], sl_false);
+		}
+		if (flagDiscard) {
+			m_pool->discard(connection->socket.get());
+		}
+		if (flagRelease) {
+			_dispatchWaitingCalls();
+			lock.lock(this);
+			if (!(connection->nPending) && !(connection->flagReading) && m_connections.remove_NoLock(connection)) {
+				lock.unlock();
+				m_pool->release(connection->socket.get());
+			}
+		}
+	}
+	
+	void AsyncTcpRpcClient::_onError(Connection* connection)
+	{
+		ObjectLocker lock(this);
+		Ref<Connection> ref = connection;
+		sl_bool flagRemoved = m_connections.remove_NoLock(ref);
+		connection->flagReading = sl_false;
+		List< Ref<Call> > listFailed;
+		for (auto& item : m_calls) {
+			if (item.value->connection == connection) {
+				listFailed.add_NoLock(item.value);
+			}
+		}
+		ListElements< Ref<Call> > calls(listFailed);
+		for (sl_size i = 0; i < calls.count; i++) {
+			m_calls.remove_NoLock(calls[i]->id);
+		}
+		connection->nPending = 0;
+		lock.unlock();
+		if (flagRemoved) {
+			m_pool->discard(connection->socket.get());
+		}
+		for (sl_size i = 0; i < calls.count; i++) {
+			calls[i]->callback(sl_null, sl_true);
+		}
+		_dispatchWaitingCalls();
+	}
+	
+	void AsyncTcpRpcClient::_failWaitingCalls()
+	{
+		ObjectLocker lock(this);
+		List< Ref<Call> > listFailed;
+		Ref<Call> call;
+		while (m_queueWaiting.pop_NoLock(&call)) {
+			if (m_calls.remove_NoLock(call->id)) {
+				listFailed.add_NoLock(call);
+			}
+		}
+		lock.unlock();
+		ListElements< Ref<Call> > calls(listFailed);
+		for (sl_size i = 0; i < calls.count; i++) {
+			calls[i]->callback(sl_null, sl_true);
+		}
+	}
+	
+	void AsyncTcpRpcClient::_onTimeout(sl_uint32 id)
+	{
+		ObjectLocker lock(this);
+		Ref<Call> call;
+		if (!(m_calls.remove_NoLock(id, &call))) {
+			return;
+		}
+		Ref<Connection> connection = call->connection;
+		sl_bool flagDiscard = sl_false;
+		if (connection.isNotNull()) {
+			connection->nPending--;
+			connection->flagDiscard = sl_true;
+			if (!(connection->nPending)) {
+				flagDiscard = m_connections.remove_NoLock(connection);
+			}
+		}
+		lock.unlock();
+		if (flagDiscard) {
+			m_pool->discard(connection->socket.get());
+		}
+		call->callback(sl_null, sl_true);
+		if (connection.isNotNull()) {
+			// calls can be waiting for a connection which is not acceptable any more
+			_dispatchWaitingCalls();
+		}
+	}
+	
+/******************************************************
+					AsyncTcpRpcServer
+******************************************************/
+	
+	class AsyncTcpRpcServer::Connection : public Referable
+	{
+	public:
+		Ref<AsyncTcpSocket> socket;
+		RpcFrameReader reader;
+		Memory bufRead;
+		
+	};
+	
+	AsyncTcpRpcServerParam::AsyncTcpRpcServerParam()
+	{
+		maxPayloadSize = RPC_DEFAULT_MAX_PAYLOAD_SIZE;
+	}
+	
+	AsyncTcpRpcServerParam::~AsyncTcpRpcServerParam()
+	{
+	}
+	
+	SLIB_DEFINE_OBJECT(AsyncTcpRpcServer, Object)
+	
+	AsyncTcpRpcServer::AsyncTcpRpcServer()
+	{
+		m_flagClosed = sl_false;
+	}
+	
+	AsyncTcpRpcServer::~AsyncTcpRpcServer()
+	{
+		close();
+	}
+	
+	Ref<AsyncTcpRpcServer> AsyncTcpRpcServer::create(const AsyncTcpRpcServerParam& param)
+	{
+		Ref<AsyncIoLoop> ioLoop = param.ioLoop;
+		if (ioLoop.isNull()) {
+			ioLoop = AsyncIoLoop::getDefault();
+			if (ioLoop.isNull()) {
+				return sl_null;
+			}
+		}
+		Ref<AsyncTcpRpcServer> ret = new AsyncTcpRpcServer;
+		if (ret.isNotNull()) {
+			ret->m_param = param;
+			ret->m_ioLoop = ioLoop;
+			AsyncTcpServerParam sp;
+			sp.bindAddress = param.bindAddress;
+			sp.flagIPv6 = param.bindAddress.ip.isIPv6();
+			sp.ioLoop = ioLoop;
+			sp.onAccept = SLIB_FUNCTION_WEAKREF(AsyncTcpRpcServer, _onAccept, ret);
+			ret->m_server = AsyncTcpServer::create(sp);
+			if (ret->m_server.isNotNull()) {
+				return ret;
+			}
+		}
+		return sl_null;
+	}
+	
+	void AsyncTcpRpcServer::close()
+	{
+		ObjectLocker lock(this);
+		if (m_flagClosed) {
+			return;
+		}
+		m_flagClosed = sl_true;
+		Ref<AsyncTcpServer> server = m_server;
+		List< Ref<Connection> > connections = m_connections.getAllValues_NoLock();
+		m_connections.removeAll_NoLock();
+		lock.unlock();
+		if (server.isNotNull()) {
+			server->close();
+		}
+		ListElements< Ref<Connection> > elements(connections);
+		for (sl_size i = 0; i < elements.count; i++) {
+			elements[i]->socket->close();
+		}
+	}
+	
+	sl_bool AsyncTcpRpcServer::isOpened()
+	{
+		return !m_flagClosed;
+	}
+	
+	sl_uint32 AsyncTcpRpcServer::getConnectionsCount()
+	{
+		return (sl_uint32)(m_connections.getCount());
+	}
+	
+	void AsyncTcpRpcServer::_onAccept(AsyncTcpServer* server, Socket* socket, const SocketAddress& address)
+	{
+		if (m_flagClosed) {
+			return;
+		}
+		socket->setOption_TcpNoDelay(sl_true);
+		Ref<Connection> connection = new Connection;
+		if (connection.isNull()) {
+			return;
+		}
+		connection->bufRead = Memory::create(RPC_READ_BUFFER_SIZE);
+		if (connection->bufRead.isNull()) {
+			return;
+		}
+		connection->reader.setMaxPayloadSize(m_param.maxPayloadSize);
+		AsyncTcpSocketParam cp;
+		cp.socket = socket;
+		cp.ioLoop = m_ioLoop;
+		connection->socket = AsyncTcpSocket::create(cp);
+		if (connection->socket.isNull()) {
+			return;
+		}
+		m_connections.put(connection.get(), connection);
+		if (!(_read(connection.get()))) {
+			_closeConnection(connection.get());
+		}
+	}
+	
+	sl_bool AsyncTcpRpcServer::_read(Connection* connection)
+	{
+		WeakRef<AsyncTcpRpcServer> thiz = this;
+		Ref<Connection> ref = connection;
+		return connection->socket->readToMemory(connection->bufRead, [thiz, ref](AsyncStreamResult* result) {
+			Ref<AsyncTcpRpcServer> server = thiz;
+			if (server.isNotNull()) {
+				server->_onRead(ref.get(), result);
+			}
+		});
+	}
+	
+	void AsyncTcpRpcServer::_onRead(Connection* connection, AsyncStreamResult* result)
+	{
+		if (result->flagError || m_flagClosed) {
+			_closeConnection(connection);
+			return;
+		}
+		if (!(connection->reader.add(result->data, result->size))) {
+			_closeConnection(connection);
+			return;
+		}
+		RpcFrame frame;
+		while (connection->reader.pop(frame)) {
+			WeakRef<AsyncTcpSocket> weakSocket = connection->socket;
+			sl_uint32 id = frame.id;
+			m_param.onRequest(this, frame.payload, [weakSocket, id](const Memory& response) {
+				Ref<AsyncTcpSocket> socket = weakSocket;
+				if (socket.isNotNull()) {
+					// one write for each frame, so that the responses from the different threads are not interleaved
+					Memory mem = RpcFrame::build(id, response);
+					if (mem.isNotNull()) {
+						socket->writeFromMemory(mem, sl_null);
+					}
+				}
+			});
+		}
+		if (!(_read(connection))) {
+			_closeConnection(connection);
+		}
+	}
+	
+	void AsyncTcpRpcServer::_closeConnection(Connection* connection)
+	{
+		connection->socket->close();
+		m_connections.remove(connection);
+	}
+	
+}
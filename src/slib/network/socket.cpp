@@ -34,6 +34,7 @@
 #else
 #	include <unistd.h>
 #	include <sys/socket.h>
+#	include <sys/uio.h>
 #	if defined(SLIB_PLATFORM_IS_LINUX)
 #		include <linux/tcp.h>
 #		include <linux/if.h>
@@ -49,6 +50,19 @@ typedef int SOCKET;
 #	define SOCKET_ERROR -1
 #endif
 
+#if defined(SLIB_PLATFORM_IS_LINUX) && !defined(SLIB_PLATFORM_IS_ANDROID)
+#	define SOCKET_USE_MMSG
+#	if !defined(SOL_UDP)
+#		define SOL_UDP 17
+#	endif
+#	if !defined(UDP_SEGMENT)
+#		define UDP_SEGMENT 103
+#	endif
+#	if !defined(UDP_GRO)
+#		define UDP_GRO 104
+#	endif
+#endif
+
 namespace slib
 {
 
@@ -541,6 +555,68 @@ namespace slib
 		}
 	}
 
+	sl_int32 Socket::sendVector(const SocketBuffer* buffers, sl_uint32 count)
+	{
+		if (isOpened()) {
+			if (count == 0) {
+				return 0;
+			}
+			if (count == 1) {
+				return send(buffers->data, buffers->size);
+			}
+			if (!(isStream())) {
+				_setError(SocketError::SendIsNotSupported);
+				return -1;
+			}
+#if defined(SLIB_PLATFORM_IS_WINDOWS)
+			WSABUF bufs[64];
+			if (count > 64) {
+				count = 64;
+			}
+			for (sl_uint32 i = 0; i < count; i++) {
+				bufs[i].buf = (CHAR*)(buffers[i].data);
+				bufs[i].len = (ULONG)(buffers[i].size);
+			}
+			DWORD dwSent = 0;
+			int iRet = ::WSASend((SOCKET)(m_socket), bufs, (DWORD)count, &dwSent, 0, NULL, NULL);
+			sl_int32 ret = iRet == 0 ? (sl_int32)dwSent : -1;
+#else
+			iovec bufs[64];
+			if (count > 64) {
+				count = 64;
+			}
+			for (sl_uint32 i = 0; i < count; i++) {
+				bufs[i].iov_base = (void*)(buffers[i].data);
+				bufs[i].iov_len = (size_t)(buffers[i].size);
+			}
+			msghdr msg;
+			Base::zeroMemory(&msg, sizeof(msg));
+			msg.msg_iov = bufs;
+			msg.msg_iovlen = count;
+#	if defined(SLIB_PLATFORM_IS_LINUX)
+			sl_int32 ret = (sl_int32)(::sendmsg((SOCKET)(m_socket), &msg, MSG_NOSIGNAL));
+#	else
+			sl_int32 ret = (sl_int32)(::sendmsg((SOCKET)(m_socket), &msg, 0));
+#	endif
+#endif
+			if (ret >= 0) {
+				if (ret == 0) {
+					ret = -1;
+				}
+				return ret;
+			} else {
+				if (_checkError() == SocketError::WouldBlock) {
+					return 0;
+				} else {
+					return -1;
+				}
+			}
+		} else {
+			_setClosedError();
+			return -1;
+		}
+	}
+
 	sl_int32 Socket::receive(void* buf, sl_uint32 size)
 	{
 		if (isOpened()) {
@@ -570,6 +646,35 @@ namespace slib
 		}
 	}
 
+	sl_int32 Socket::peek(void* buf, sl_uint32 size)
+	{
+		if (isOpened()) {
+			if (size == 0) {
+				return 0;
+			}
+			if (!(isStream())) {
+				_setError(SocketError::ReceiveIsNotSupported);
+				return -1;
+			}
+			sl_int32 ret = (sl_int32)(::recv((SOCKET)(m_socket), (char*)buf, size, MSG_PEEK));
+			if (ret >= 0) {
+				if (ret == 0) {
+					return -1;
+				}
+				return ret;
+			} else {
+				if (_checkError() == SocketError::WouldBlock) {
+					return 0;
+				} else {
+					return -1;
+				}
+			}
+		} else {
+			_setClosedError();
+			return -1;
+		}
+	}
+
 	sl_int32 Socket::sendTo(const SocketAddress& address, const void* buf, sl_uint32 size)
 	{
 		if (isOpened()) {
@@ -642,6 +747,173 @@ namespace slib
 		}
 	}
 
+	sl_int32 Socket::sendToBatch(const SocketDatagram* datagrams, sl_uint32 count)
+	{
+		if (isOpened()) {
+			if (count == 0) {
+				return 0;
+			}
+			if (!(isDatagram() || isRaw())) {
+				_setError(SocketError::SendToIsNotSupported);
+				return -1;
+			}
+			if (count > SLIB_SOCKET_DATAGRAM_BATCH_MAX) {
+				count = SLIB_SOCKET_DATAGRAM_BATCH_MAX;
+			}
+#if defined(SOCKET_USE_MMSG)
+			mmsghdr msgs[SLIB_SOCKET_DATAGRAM_BATCH_MAX];
+			iovec bufs[SLIB_SOCKET_DATAGRAM_BATCH_MAX];
+			sockaddr_storage addrs[SLIB_SOCKET_DATAGRAM_BATCH_MAX];
+			char controls[SLIB_SOCKET_DATAGRAM_BATCH_MAX][CMSG_SPACE(sizeof(sl_uint16))];
+			for (sl_uint32 i = 0; i < count; i++) {
+				const SocketDatagram& datagram = datagrams[i];
+				sl_uint32 sizeAddr = _priv_Socket_apply_address(m_type, addrs[i], datagram.address);
+				if (!sizeAddr) {
+					if (i) {
+						count = i;
+						break;
+					}
+					_setError(SocketError::SendToInvalidAddress);
+					return -1;
+				}
+				bufs[i].iov_base = datagram.data;
+				bufs[i].iov_len = (size_t)(datagram.size);
+				msghdr& msg = msgs[i].msg_hdr;
+				Base::zeroMemory(&msg, sizeof(msg));
+				msg.msg_name = &(addrs[i]);
+				msg.msg_namelen = (socklen_t)sizeAddr;
+				msg.msg_iov = bufs + i;
+				msg.msg_iovlen = 1;
+				if (datagram.sizeSegment && datagram.size > datagram.sizeSegment) {
+					msg.msg_control = controls[i];
+					msg.msg_controllen = sizeof(controls[i]);
+					cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+					cmsg->cmsg_level = SOL_UDP;
+					cmsg->cmsg_type = UDP_SEGMENT;
+					cmsg->cmsg_len = CMSG_LEN(sizeof(sl_uint16));
+					*((sl_uint16*)(CMSG_DATA(cmsg))) = (sl_uint16)(datagram.sizeSegment);
+				}
+				msgs[i].msg_len = 0;
+			}
+			sl_int32 ret = (sl_int32)(::sendmmsg((SOCKET)(m_socket), msgs, count, MSG_NOSIGNAL));
+			if (ret >= 0) {
+				return ret;
+			} else {
+				// the first datagram is failed. UDP GSO is refused by EINVAL on old kernels, and by EIO on the devices without checksum offload
+				int err = errno;
+				if ((err == EINVAL || err == EIO) && msgs[0].msg_hdr.msg_control) {
+					_setError(SocketError::SendSegmentsIsNotSupported);
+					return -1;
+				}
+				if (_checkError() == SocketError::WouldBlock) {
+					return 0;
+				} else {
+					return -1;
+				}
+			}
+#else
+			sl_uint32 i;
+			for (i = 0; i < count; i++) {
+				const SocketDatagram& datagram = datagrams[i];
+				if (datagram.sizeSegment && datagram.size > datagram.sizeSegment) {
+					// a datagram can not be sent partially, so the segments are sent by the caller one by one
+					if (i) {
+						return i;
+					}
+					_setError(SocketError::SendSegmentsIsNotSupported);
+					return -1;
+				}
+				sl_int32 ret = sendTo(datagram.address, datagram.data, datagram.size);
+				if (ret <= 0) {
+					if (i) {
+						return i;
+					}
+					return ret;
+				}
+			}
+			return i;
+#endif
+		} else {
+			_setClosedError();
+			return -1;
+		}
+	}
+
+	sl_int32 Socket::receiveFromBatch(SocketDatagram* datagrams, sl_uint32 count)
+	{
+		if (isOpened()) {
+			if (count == 0) {
+				return 0;
+			}
+			if (!(isDatagram() || isRaw())) {
+				_setError(SocketError::ReceiveFromIsNotSupported);
+				return -1;
+			}
+			if (count > SLIB_SOCKET_DATAGRAM_BATCH_MAX) {
+				count = SLIB_SOCKET_DATAGRAM_BATCH_MAX;
+			}
+#if defined(SOCKET_USE_MMSG)
+			mmsghdr msgs[SLIB_SOCKET_DATAGRAM_BATCH_MAX];
+			iovec bufs[SLIB_SOCKET_DATAGRAM_BATCH_MAX];
+			sockaddr_storage addrs[SLIB_SOCKET_DATAGRAM_BATCH_MAX];
+			char controls[SLIB_SOCKET_DATAGRAM_BATCH_MAX][CMSG_SPACE(sizeof(int))];
+			for (sl_uint32 i = 0; i < count; i++) {
+				bufs[i].iov_base = datagrams[i].data;
+				bufs[i].iov_len = (size_t)(datagrams[i].size);
+				msghdr& msg = msgs[i].msg_hdr;
+				Base::zeroMemory(&msg, sizeof(msg));
+				msg.msg_name = &(addrs[i]);
+				msg.msg_namelen = sizeof(sockaddr_storage);
+				msg.msg_iov = bufs + i;
+				msg.msg_iovlen = 1;
+				msg.msg_control = controls[i];
+				msg.msg_controllen = sizeof(controls[i]);
+				msgs[i].msg_len = 0;
+			}
+			sl_int32 ret = (sl_int32)(::recvmmsg((SOCKET)(m_socket), msgs, count, 0, sl_null));
+			if (ret >= 0) {
+				for (sl_int32 i = 0; i < ret; i++) {
+					SocketDatagram& datagram = datagrams[i];
+					msghdr& msg = msgs[i].msg_hdr;
+					datagram.address.setSystemSocketAddress(&(addrs[i]), (sl_uint32)(msg.msg_namelen));
+					datagram.size = (sl_uint32)(msgs[i].msg_len);
+					datagram.sizeSegment = 0;
+					for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+						if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+							datagram.sizeSegment = (sl_uint32)(*((int*)(CMSG_DATA(cmsg))));
+						}
+					}
+				}
+				return ret;
+			} else {
+				if (_checkError() == SocketError::WouldBlock) {
+					return 0;
+				} else {
+					return -1;
+				}
+			}
+#else
+			sl_uint32 i;
+			for (i = 0; i < count; i++) {
+				SocketDatagram& datagram = datagrams[i];
+				sl_int32 ret = receiveFrom(datagram.address, datagram.data, datagram.size);
+				if (ret <= 0) {
+					if (i) {
+						return i;
+					}
+					return ret;
+				}
+				datagram.size = (sl_uint32)ret;
+				datagram.sizeSegment = 0;
+			}
+			return i;
+#endif
+		} else {
+			_setClosedError();
+			return -1;
+		}
+	}
+
 	sl_int32 Socket::sendPacket(const void* buf, sl_uint32 size, const L2PacketInfo& info)
 	{
 #if defined(SLIB_PLATFORM_IS_LINUX)
@@ -985,6 +1257,24 @@ namespace slib
 		return getOption(IPPROTO_TCP, TCP_NODELAY) != 0;
 	}
 
+	sl_bool Socket::setOption_UdpGro(sl_bool flagEnable)
+	{
+#if defined(SOCKET_USE_MMSG)
+		return setOption(SOL_UDP, UDP_GRO, flagEnable ? 1 : 0);
+#else
+		return sl_false;
+#endif
+	}
+
+	sl_bool Socket::getOption_UdpGro() const
+	{
+#if defined(SOCKET_USE_MMSG)
+		return getOption(SOL_UDP, UDP_GRO) != 0;
+#else
+		return sl_false;
+#endif
+	}
+
 
 	sl_bool Socket::setOption_IpTTL(sl_uint32 ttl)
 	{
@@ -1324,6 +1614,8 @@ namespace slib
 				return "SendPacket to invalid address";
 			case SocketError::ReceivePacketIsNotSupported:
 				return "ReceivePacket is not supported";
+			case SocketError::SendSegmentsIsNotSupported:
+				return "Sending segments is not supported";
 			default:
 				break;
 		}
@@ -0,0 +1,520 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#include "slib/network/tcp_pool.h"
+
+#include "slib/network/socket.h"
+#include "slib/core/system.h"
+#include "slib/core/dispatch.h"
+#include "slib/core/queue.h"
+
+namespace slib
+{
+	
+	class AsyncTcpSocketPool::Host : public Referable
+	{
+	public:
+		SocketAddress address;
+		String hostName; // used when `address` is not valid
+		
+		struct Idle
+		{
+			Ref<AsyncTcpSocket> socket;
+			sl_uint32 timeLastUsed;
+		};
+		// most recently released connections are placed at back
+		List<Idle> listIdle;
+		
+		sl_uint32 nConnections;
+		HashMap< AsyncTcpSocket*, Function<void(AsyncTcpSocket*)> > connecting;
+		LinkedQueue< Function<void(AsyncTcpSocket*)> > queueWaiting;
+		sl_bool flagWarmedUp;
+		
+	public:
+		Host()
+		{
+			nConnections = 0;
+			flagWarmedUp = sl_false;
+		}
+		
+	};
+	
+	AsyncTcpSocketPoolParam::AsyncTcpSocketPoolParam()
+	{
+		maxConnectionsPerHost = 64;
+		maxIdleConnectionsPerHost = 8;
+		maxIdleTime = 60000;
+		connectTimeout = 10000;
+		warmUpCount = 0;
+		flagTcpNoDelay = sl_true;
+	}
+	
+	AsyncTcpSocketPoolParam::~AsyncTcpSocketPoolParam()
+	{
+	}
+	
+	SLIB_DEFINE_OBJECT(AsyncTcpSocketPool, Object)
+	
+	AsyncTcpSocketPool::AsyncTcpSocketPool()
+	{
+		m_flagClosed = sl_false;
+		m_nIdle = 0;
+	}
+	
+	AsyncTcpSocketPool::~AsyncTcpSocketPool()
+	{
+		close();
+	}
+	
+	Ref<AsyncTcpSocketPool> AsyncTcpSocketPool::create(const AsyncTcpSocketPoolParam& param)
+	{
+		Ref<AsyncIoLoop> ioLoop = param.ioLoop;
+		if (ioLoop.isNull()) {
+			ioLoop = AsyncIoLoop::getDefault();
+			if (ioLoop.isNull()) {
+				return sl_null;
+			}
+		}
+		Ref<AsyncTcpSocketPool> ret = new AsyncTcpSocketPool;
+		if (ret.isNotNull()) {
+			ret->m_param = param;
+			ret->m_ioLoop = ioLoop;
+			if (param.maxIdleTime) {
+				sl_uint32 interval = param.maxIdleTime / 2;
+				if (interval < 1000) {
+					interval = 1000;
+				}
+				ret->m_timerIdle = Timer::start(SLIB_FUNCTION_WEAKREF(AsyncTcpSocketPool, _onIdleTimer, ret), interval);
+			}
+			return ret;
+		}
+		return sl_null;
+	}
+	
+	void AsyncTcpSocketPool::acquire(const SocketAddress& address, const Function<void(AsyncTcpSocket*)>& callback)
+	{
+		Ref<Host> host = _getHost(address.toString(), address);
+		if (host.isNull()) {
+			callback(sl_null);
+			return;
+		}
+		_acquire(host.get(), callback);
+	}
+	
+	void AsyncTcpSocketPool::acquire(const String& hostAddress, const Function<void(AsyncTcpSocket*)>& callback)
+	{
+		Ref<Host> host = _getHost(hostAddress, SocketAddress::none());
+		if (host.isNull()) {
+			callback(sl_null);
+			return;
+		}
+		_acquire(host.get(), callback);
+	}
+	
+	void AsyncTcpSocketPool::release(AsyncTcpSocket* socket)
+	{
+		if (!socket) {
+			return;
+		}
+		ObjectLocker lock(this);
+		Connection connection;
+		if (!(m_sockets.get(socket, &connection))) {
+			lock.unlock();
+			socket->close();
+			return;
+		}
+		Host* host = connection.host.get();
+		if (!m_flagClosed && socket->isOpened()) {
+			Function<void(AsyncTcpSocket*)> callback;
+			if (host->queueWaiting.popFront(&callback)) {
+				// hands over to the waiting request directly
+				lock.unlock();
+				callback(socket);
+				return;
+			}
+			if (host->listIdle.getCount() < m_param.maxIdleConnectionsPerHost) {
+				Host::Idle idle;
+				idle.socket = socket;
+				idle.timeLastUsed = System::getTickCount();
+				host->listIdle.add_NoLock(idle);
+				m_nIdle++;
+				return;
+			}
+		}
+		m_sockets.remove(socket);
+		host->nConnections--;
+		lock.unlock();
+		socket->close();
+		// the slot of the closed connection can be used by the waiting request
+		_processWaiting(host);
+	}
+	
+	void AsyncTcpSocketPool::discard(AsyncTcpSocket* socket)
+	{
+		if (!socket) {
+			return;
+		}
+		ObjectLocker lock(this);
+		Connection connection;
+		if (m_sockets.remove(socket, &connection)) {
+			connection.host->nConnections--;
+		}
+		lock.unlock();
+		socket->close();
+		if (connection.host.isNotNull()) {
+			_processWaiting(connection.host.get());
+		}
+	}
+	
+	void AsyncTcpSocketPool::warmUp(const SocketAddress& address, sl_uint32 count)
+	{
+		Ref<Host> host = _getHost(address.toString(), address);
+		if (host.isNotNull()) {
+			_warmUp(host.get(), count);
+		}
+	}
+	
+	void AsyncTcpSocketPool::warmUp(const String& hostAddress, sl_uint32 count)
+	{
+		Ref<Host> host = _getHost(hostAddress, SocketAddress::none());
+		if (host.isNotNull()) {
+			_warmUp(host.get(), count);
+		}
+	}
+	
+	void AsyncTcpSocketPool::close()
+	{
+		ObjectLocker lock(this);
+		if (m_flagClosed) {
+			return;
+		}
+		m_flagClosed = sl_true;
+		if (m_timerIdle.isNotNull()) {
+			m_timerIdle->stop();
+			m_timerIdle.setNull();
+		}
+		List< Function<void(AsyncTcpSocket*)> > callbacks;
+		for (auto& item : m_hosts) {
+			Host* host = item.value.get();
+			Function<void(AsyncTcpSocket*)> callback;
+			while (host->queueWaiting.popFront(&callback)) {
+				callbacks.add_NoLock(callback);
+			}
+			for (auto& connecting : host->connecting) {
+				if (connecting.value.isNotNull()) {
+					callbacks.add_NoLock(connecting.value);
+				}
+			}
+			host->connecting.removeAll_NoLock();
+			host->listIdle.removeAll_NoLock();
+			host->nConnections = 0;
+		}
+		List< Ref<AsyncTcpSocket> > sockets;
+		for (auto& item : m_sockets) {
+			sockets.add_NoLock(item.value.socket);
+		}
+		m_sockets.removeAll_NoLock();
+		m_nIdle = 0;
+		lock.unlock();
+		for (auto& socket : sockets) {
+			socket->close();
+		}
+		for (auto& callback : callbacks) {
+			callback(sl_null);
+		}
+	}
+	
+	sl_uint32 AsyncTcpSocketPool::getConnectionsCount()
+	{
+		return (sl_uint32)(m_sockets.getCount());
+	}
+	
+	sl_uint32 AsyncTcpSocketPool::getIdleConnectionsCount()
+	{
+		return m_nIdle;
+	}
+	
+	Ref<AsyncIoLoop> AsyncTcpSocketPool::getIoLoop()
+	{
+		return m_ioLoop;
+	}
+	
+	const AsyncTcpSocketPoolParam& AsyncTcpSocketPool::getParam()
+	{
+		return m_param;
+	}
+	
+	Ref<AsyncTcpSocketPool::Host> AsyncTcpSocketPool::_getHost(const String& key, const SocketAddress& address)
+	{
+		ObjectLocker lock(this);
+		Ref<Host> host;
+		if (m_hosts.get_NoLock(key, &host)) {
+			return host;
+		}
+		host = new Host;
+		if (host.isNull()) {
+			return sl_null;
+		}
+		if (address.isValid()) {
+			host->address = address;
+		} else {
+			sl_reg index = key.lastIndexOf(':');
+			sl_uint32 port;
+			if (index <= 0 || !(key.substring(index + 1).parseUint32(10, &port)) || !port || port > 0xFFFF) {
+				return sl_null;
+			}
+			String hostName = key.substring(0, index);
+			if (hostName.startsWith('[') && hostName.endsWith(']')) {
+				hostName = hostName.substring(1, hostName.getLength() - 1);
+			}
+			IPAddress ip;
+			if (ip.parse(hostName)) {
+				host->address = SocketAddress(ip, (sl_uint16)port);
+			} else {
+				host->address.port = (sl_uint16)port;
+				host->hostName = hostName;
+			}
+		}
+		m_hosts.put_NoLock(key, host);
+		return host;
+	}
+	
+	void AsyncTcpSocketPool::_acquire(Host* host, const Function<void(AsyncTcpSocket*)>& callback)
+	{
+		ObjectLocker lock(this);
+		if (m_flagClosed) {
+			lock.unlock();
+			callback(sl_null);
+			return;
+		}
+		sl_uint32 now = System::getTickCount();
+		Host::Idle idle;
+		while (host->listIdle.popBack_NoLock(&idle)) {
+			m_nIdle--;
+			if (now - idle.timeLastUsed <= m_param.maxIdleTime || !(m_param.maxIdleTime)) {
+				if (_isHealthy(idle.socket.get())) {
+					lock.unlock();
+					callback(idle.socket.get());
+					return;
+				}
+			}
+			m_sockets.remove(idle.socket.get());
+			host->nConnections--;
+			idle.socket->close();
+		}
+		sl_bool flagWarmUp = !(host->flagWarmedUp);
+		host->flagWarmedUp = sl_true;
+		if (m_param.maxConnectionsPerHost && host->nConnections >= m_param.maxConnectionsPerHost) {
+			host->queueWaiting.pushBack(callback);
+			return;
+		}
+		lock.unlock();
+		_connect(host, callback);
+		if (flagWarmUp && m_param.warmUpCount > 1) {
+			// lazy warm-up: the other connections are prepared for the following requests (the connection above is also counted as connecting)
+			_warmUp(host, m_param.warmUpCount);
+		}
+	}
+	
+	void AsyncTcpSocketPool::_warmUp(Host* host, sl_uint32 count)
+	{
+		ObjectLocker lock(this);
+		host->flagWarmedUp = sl_true;
+		sl_uint32 nIdle = (sl_uint32)(host->listIdle.getCount() + host->connecting.getCount());
+		sl_uint32 n = 0;
+		while (nIdle + n < count) {
+			if (m_param.maxConnectionsPerHost && host->nConnections + n >= m_param.maxConnectionsPerHost) {
+				break;
+			}
+			if (m_param.maxIdleConnectionsPerHost && nIdle + n >= m_param.maxIdleConnectionsPerHost) {
+				break;
+			}
+			n++;
+		}
+		lock.unlock();
+		for (sl_uint32 i = 0; i < n; i++) {
+			_connect(host, sl_null);
+		}
+	}
+	
+	void AsyncTcpSocketPool::_connect(Host* host, const Function<void(AsyncTcpSocket*)>& callback)
+	{
+		AsyncTcpSocketParam cp;
+		cp.ioLoop = m_ioLoop;
+		cp.flagIPv6 = host->hostName.isEmpty() && host->address.ip.isIPv6();
+		cp.onConnect = SLIB_FUNCTION_WEAKREF(AsyncTcpSocketPool, _onConnect, this);
+		Ref<AsyncTcpSocket> socket = AsyncTcpSocket::create(cp);
+		if (socket.isNull()) {
+			callback(sl_null);
+			return;
+		}
+		{
+			ObjectLocker lock(this);
+			if (m_flagClosed) {
+				lock.unlock();
+				socket->close();
+				callback(sl_null);
+				return;
+			}
+			// registered before connecting, because the failure can be notified immediately
+			Connection connection;
+			connection.socket = socket;
+			connection.host = host;
+			m_sockets.put(socket.get(), connection);
+			host->connecting.put_NoLock(socket.get(), callback);
+			host->nConnections++;
+		}
+		if (m_param.connectTimeout) {
+			WeakRef<AsyncTcpSocketPool> thiz = this;
+			WeakRef<AsyncTcpSocket> weakSocket = socket;
+			Dispatch::setTimeout([thiz, weakSocket]() {
+				Ref<AsyncTcpSocketPool> pool = thiz;
+				if (pool.isNotNull()) {
+					pool->_onConnectTimeout(weakSocket);
+				}
+			}, m_param.connectTimeout);
+		}
+		sl_bool flagConnecting;
+		if (host->hostName.isNotEmpty()) {
+			flagConnecting = socket->connect(host->hostName, host->address.port);
+		} else {
+			flagConnecting = socket->connect(host->address);
+		}
+		if (!flagConnecting) {
+			_onConnect(socket.get(), host->address, sl_true);
+		}
+	}
+	
+	void AsyncTcpSocketPool::_onConnect(AsyncTcpSocket* socket, const SocketAddress& address, sl_bool flagError)
+	{
+		ObjectLocker lock(this);
+		Connection connection;
+		if (!(m_sockets.get(socket, &connection))) {
+			return;
+		}
+		Ref<Host> host = connection.host;
+		Function<void(AsyncTcpSocket*)> callback;
+		if (!(host->connecting.remove_NoLock(socket, &callback))) {
+			// already timed out
+			return;
+		}
+		if (flagError) {
+			m_sockets.remove(socket);
+			host->nConnections--;
+			lock.unlock();
+			socket->close();
+			callback(sl_null);
+			_processWaiting(host.get());
+			return;
+		}
+		lock.unlock();
+		if (m_param.flagTcpNoDelay) {
+			Ref<Socket> s = socket->getSocket();
+			if (s.isNotNull()) {
+				s->setOption_TcpNoDelay(sl_true);
+			}
+		}
+		if (callback.isNotNull()) {
+			callback(socket);
+		} else {
+			// warmed-up connection
+			release(socket);
+		}
+	}
+	
+	void AsyncTcpSocketPool::_onConnectTimeout(const WeakRef<AsyncTcpSocket>& weakSocket)
+	{
+		Ref<AsyncTcpSocket> socket = weakSocket;
+		if (socket.isNotNull()) {
+			_onConnect(socket.get(), SocketAddress::none(), sl_true);
+		}
+	}
+	
+	void AsyncTcpSocketPool::_processWaiting(Host* host)
+	{
+		ObjectLocker lock(this);
+		if (m_flagClosed) {
+			return;
+		}
+		if (m_param.maxConnectionsPerHost && host->nConnections >= m_param.maxConnectionsPerHost) {
+			return;
+		}
+		Function<void(AsyncTcpSocket*)> callback;
+		if (host->queueWaiting.popFront(&callback)) {
+			lock.unlock();
+			_connect(host, callback);
+		}
+	}
+	
+	sl_bool AsyncTcpSocketPool::_isHealthy(AsyncTcpSocket* socket)
+	{
+		if (!(socket->isOpened())) {
+			return sl_false;
+		}
+		Ref<Socket> s = socket->getSocket();
+		if (s.isNull()) {
+			return sl_false;
+		}
+		// an idle connection should have no data to read: closed by peer, or unexpected data is remaining
+		char c;
+		return s->peek(&c, 1) == 0;
+	}
+	
+	void AsyncTcpSocketPool::_onIdleTimer(Timer* timer)
+	{
+		List< Ref<AsyncTcpSocket> > sockets;
+		{
+			ObjectLocker lock(this);
+			if (m_flagClosed) {
+				return;
+			}
+			sl_uint32 now = System::getTickCount();
+			for (auto& item : m_hosts) {
+				Host* host = item.value.get();
+				sl_size n = host->listIdle.getCount();
+				Host::Idle* idles = host->listIdle.getData();
+				sl_size k = 0;
+				for (sl_size i = 0; i < n; i++) {
+					if (now - idles[i].timeLastUsed <= m_param.maxIdleTime && _isHealthy(idles[i].socket.get())) {
+						if (k != i) {
+							idles[k] = idles[i];
+						}
+						k++;
+					} else {
+						sockets.add_NoLock(idles[i].socket);
+						m_sockets.remove(idles[i].socket.get());
+						host->nConnections--;
+						m_nIdle--;
+					}
+				}
+				if (k < n) {
+					host->listIdle.setCount_NoLock(k);
+				}
+			}
+		}
+		for (auto& socket : sockets) {
+			socket->close();
+		}
+	}
+	
+}
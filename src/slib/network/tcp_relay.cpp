@@ -0,0 +1,873 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#include "slib/network/tcp_relay.h"
+
+#include "slib/network/socket.h"
+#include "slib/core/system.h"
+#include "slib/core/mutex.h"
+
+#if defined(SLIB_PLATFORM_IS_LINUX)
+#	define ASYNC_TCP_RELAY_USE_SPLICE
+#	include <fcntl.h>
+#	include <unistd.h>
+#	include <errno.h>
+#	include <signal.h>
+#	include <time.h>
+#	include <pthread.h>
+#	include <sys/socket.h>
+#endif
+
+#define ASYNC_TCP_RELAY_MAX_STEPS 64
+
+namespace slib
+{
+
+#if defined(ASYNC_TCP_RELAY_USE_SPLICE)
+
+	class _priv_AsyncTcpRelay_Splice;
+
+	class _priv_AsyncTcpRelay_SpliceInstance : public AsyncIoInstance
+	{
+	public:
+		Ref<_priv_AsyncTcpRelay_Splice> m_splice;
+		Ref<Socket> m_socket;
+
+	public:
+		_priv_AsyncTcpRelay_SpliceInstance(_priv_AsyncTcpRelay_Splice* splice, const Ref<Socket>& socket)
+		{
+			m_splice = splice;
+			m_socket = socket;
+			setHandle((sl_file)(socket->getHandle()));
+		}
+
+		~_priv_AsyncTcpRelay_SpliceInstance()
+		{
+			close();
+		}
+
+	public:
+		void close() override
+		{
+			// the socket is released after the instance is detached from the loop
+			setHandle(SLIB_FILE_INVALID_HANDLE);
+			m_splice.setNull();
+			m_socket.setNull();
+		}
+
+	protected:
+		void onOrder() override;
+
+		void onEvent(EventDesc* pev) override;
+
+	};
+
+	class _priv_AsyncTcpRelay_Splice : public Referable
+	{
+	public:
+		struct Direction
+		{
+			int fdSource;
+			int fdTarget;
+			int pipe[2];
+			sl_uint32 capacity;
+			sl_uint32 sizePipe;
+			Memory pending;
+			sl_uint32 offsetPending;
+			sl_bool flagEndOfSource;
+			sl_bool flagShutdown;
+			sl_uint64 sizeTransferred;
+		};
+
+		Mutex m_lock;
+		Ref<AsyncTcpRelay> m_relay;
+		Ref<AsyncIoLoop> m_loop;
+		Ref<Socket> m_sockets[2];
+		Ref<_priv_AsyncTcpRelay_SpliceInstance> m_instances[2];
+		Direction m_directions[2];
+		sl_bool m_flagClosed;
+
+	public:
+		_priv_AsyncTcpRelay_Splice()
+		{
+			for (sl_uint32 i = 0; i < 2; i++) {
+				Direction& d = m_directions[i];
+				d.fdSource = -1;
+				d.fdTarget = -1;
+				d.pipe[0] = -1;
+				d.pipe[1] = -1;
+				d.capacity = 0;
+				d.sizePipe = 0;
+				d.offsetPending = 0;
+				d.flagEndOfSource = sl_false;
+				d.flagShutdown = sl_false;
+				d.sizeTransferred = 0;
+			}
+			m_flagClosed = sl_false;
+		}
+
+		~_priv_AsyncTcpRelay_Splice()
+		{
+			_closePipes();
+		}
+
+	public:
+		sl_bool init(const Ref<Socket>& socket1, const Ref<Socket>& socket2, sl_uint32 bufferSize, const Memory& initialData)
+		{
+			m_sockets[0] = socket1;
+			m_sockets[1] = socket2;
+			for (sl_uint32 i = 0; i < 2; i++) {
+				Direction& d = m_directions[i];
+				if (::pipe2(d.pipe, O_NONBLOCK | O_CLOEXEC)) {
+					d.pipe[0] = -1;
+					d.pipe[1] = -1;
+					return sl_false;
+				}
+				int n = ::fcntl(d.pipe[1], F_SETPIPE_SZ, (int)bufferSize);
+				if (n <= 0) {
+					n = ::fcntl(d.pipe[1], F_GETPIPE_SZ);
+				}
+				d.capacity = n > 0 ? (sl_uint32)n : 0x10000;
+				d.fdSource = (int)(m_sockets[i]->getHandle());
+				d.fdTarget = (int)(m_sockets[1 - i]->getHandle());
+			}
+			if (initialData.isNotNull()) {
+				m_directions[0].pending = initialData;
+			}
+			return sl_true;
+		}
+
+		// called on the I/O loop, after the instances of the streams are detached
+		void attach()
+		{
+			MutexLocker lock(&m_lock);
+			if (m_flagClosed) {
+				return;
+			}
+			for (sl_uint32 i = 0; i < 2; i++) {
+				Ref<_priv_AsyncTcpRelay_SpliceInstance> instance = new _priv_AsyncTcpRelay_SpliceInstance(this, m_sockets[i]);
+				if (instance.isNull() || !(m_loop->attachInstance(instance.get(), AsyncIoMode::InOut))) {
+					if (instance.isNotNull()) {
+						instance->close();
+					}
+					lock.unlock();
+					_end(sl_true);
+					return;
+				}
+				m_instances[i] = instance;
+			}
+			lock.unlock();
+			// readiness before attaching is reported by the first events, but the initial data should be sent anyway
+			pump();
+		}
+
+		void pump()
+		{
+			sl_int32 result[2];
+			sl_bool flagDone = sl_false;
+			{
+				MutexLocker lock(&m_lock);
+				if (m_flagClosed) {
+					return;
+				}
+				// writing to the socket closed by the peer should not raise SIGPIPE
+				sigset_t sigPipe, sigOld;
+				sigemptyset(&sigPipe);
+				sigaddset(&sigPipe, SIGPIPE);
+				pthread_sigmask(SIG_BLOCK, &sigPipe, &sigOld);
+				sl_bool flagPipeError = sl_false;
+				for (sl_uint32 i = 0; i < 2; i++) {
+					result[i] = _pump(m_directions[i], flagPipeError);
+				}
+				if (flagPipeError) {
+					struct timespec ts = {0, 0};
+					sigtimedwait(&sigPipe, sl_null, &ts);
+				}
+				pthread_sigmask(SIG_SETMASK, &sigOld, sl_null);
+				if (result[0] >= 0 && result[1] >= 0) {
+					flagDone = m_directions[0].flagShutdown && m_directions[1].flagShutdown;
+				}
+			}
+			if (result[0] < 0 || result[1] < 0) {
+				_end(sl_true);
+				return;
+			}
+			if (result[0] > 0 || result[1] > 0) {
+				Ref<AsyncTcpRelay> relay = m_relay;
+				if (relay.isNotNull()) {
+					relay->_onActive();
+				}
+			}
+			if (flagDone) {
+				_end(sl_false);
+				return;
+			}
+			if (result[0] > 1 || result[1] > 1) {
+				// yields to other instances on the loop, the remaining data does not trigger new edge
+				Ref<_priv_AsyncTcpRelay_Splice> thiz = this;
+				m_loop->addTask([thiz]() {
+					thiz->pump();
+				});
+			}
+		}
+
+		void close()
+		{
+			MutexLocker lock(&m_lock);
+			if (m_flagClosed) {
+				return;
+			}
+			m_flagClosed = sl_true;
+			for (sl_uint32 i = 0; i < 2; i++) {
+				m_sockets[i]->shutdown(SocketShutdownMode::Both);
+				Ref<_priv_AsyncTcpRelay_SpliceInstance> instance = m_instances[i];
+				if (instance.isNotNull()) {
+					m_loop->closeInstance(instance.get());
+					m_instances[i].setNull();
+				}
+			}
+			_closePipes();
+			m_relay.setNull();
+		}
+
+		sl_uint64 getTransferredSize(sl_uint32 index)
+		{
+			MutexLocker lock(&m_lock);
+			return m_directions[index].sizeTransferred;
+		}
+
+	protected:
+		// returns -1 on error, 0 when nothing is moved, 1 when some data is moved, 2 when the step limit is reached
+		static sl_int32 _pump(Direction& d, sl_bool& flagPipeError)
+		{
+			sl_bool flagMoved = sl_false;
+			for (sl_uint32 step = 0; step < ASYNC_TCP_RELAY_MAX_STEPS; step++) {
+				sl_bool flagStep = sl_false;
+				if (d.pending.isNotNull()) {
+					sl_uint32 size = (sl_uint32)(d.pending.getSize());
+					ssize_t n = ::write(d.pipe[1], (sl_uint8*)(d.pending.getData()) + d.offsetPending, size - d.offsetPending);
+					if (n > 0) {
+						d.offsetPending += (sl_uint32)n;
+						d.sizePipe += (sl_uint32)n;
+						if (d.offsetPending >= size) {
+							d.pending.setNull();
+						}
+						flagStep = sl_true;
+					} else if (n < 0 && errno != EAGAIN) {
+						return -1;
+					}
+				} else if (!(d.flagEndOfSource) && d.sizePipe < d.capacity) {
+					// the pipe is filled only while the target drains it
+					ssize_t n = ::splice(d.fdSource, sl_null, d.pipe[1], sl_null, d.capacity - d.sizePipe, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+					if (n > 0) {
+						d.sizePipe += (sl_uint32)n;
+						flagStep = sl_true;
+					} else if (!n) {
+						d.flagEndOfSource = sl_true;
+						flagStep = sl_true;
+					} else if (errno != EAGAIN) {
+						return -1;
+					}
+				}
+				if (d.sizePipe) {
+					ssize_t n = ::splice(d.pipe[0], sl_null, d.fdTarget, sl_null, d.sizePipe, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+					if (n > 0) {
+						d.sizePipe -= (sl_uint32)n;
+						d.sizeTransferred += n;
+						flagStep = sl_true;
+					} else if (n < 0 && errno != EAGAIN) {
+						if (errno == EPIPE) {
+							flagPipeError = sl_true;
+						}
+						return -1;
+					}
+				}
+				if (d.flagEndOfSource && !(d.sizePipe) && d.pending.isNull() && !(d.flagShutdown)) {
+					::shutdown(d.fdTarget, SHUT_WR);
+					d.flagShutdown = sl_true;
+				}
+				if (!flagStep) {
+					return flagMoved ? 1 : 0;
+				}
+				flagMoved = sl_true;
+			}
+			return 2;
+		}
+
+		void _end(sl_bool flagError)
+		{
+			Ref<AsyncTcpRelay> relay = m_relay;
+			if (relay.isNotNull()) {
+				relay->_onEnd(flagError);
+			}
+		}
+
+		void _closePipes()
+		{
+			for (sl_uint32 i = 0; i < 2; i++) {
+				Direction& d = m_directions[i];
+				for (sl_uint32 k = 0; k < 2; k++) {
+					if (d.pipe[k] >= 0) {
+						::close(d.pipe[k]);
+						d.pipe[k] = -1;
+					}
+				}
+				d.pending.setNull();
+			}
+		}
+
+	};
+
+	void _priv_AsyncTcpRelay_SpliceInstance::onOrder()
+	{
+	}
+
+	void _priv_AsyncTcpRelay_SpliceInstance::onEvent(EventDesc* pev)
+	{
+		Ref<_priv_AsyncTcpRelay_Splice> splice = m_splice;
+		if (splice.isNotNull()) {
+			splice->pump();
+		}
+	}
+
+#endif
+
+
+	AsyncTcpRelayParam::AsyncTcpRelayParam()
+	{
+		bufferSize = 0x10000;
+		idleTimeout = 0;
+		flagUseSplice = sl_true;
+		flagAutoStart = sl_true;
+	}
+
+	AsyncTcpRelayParam::~AsyncTcpRelayParam()
+	{
+	}
+
+
+	SLIB_DEFINE_OBJECT(AsyncTcpRelay, Object)
+
+	AsyncTcpRelay::AsyncTcpRelay()
+	{
+		m_flagStarted = sl_false;
+		m_flagClosed = sl_false;
+		m_flagSplice = sl_false;
+		m_nCopiesEnded = 0;
+		m_sizeTransferred1 = 0;
+		m_sizeTransferred2 = 0;
+		m_timeLastActive = 0;
+	}
+
+	AsyncTcpRelay::~AsyncTcpRelay()
+	{
+		_close();
+	}
+
+	Ref<AsyncTcpRelay> AsyncTcpRelay::create(const AsyncTcpRelayParam& param)
+	{
+		if (param.stream1.isNull() || param.stream2.isNull()) {
+			return sl_null;
+		}
+		Ref<AsyncTcpRelay> ret = new AsyncTcpRelay;
+		if (ret.isNotNull()) {
+			ret->m_param = param;
+			if (ret->m_param.bufferSize < 0x1000) {
+				ret->m_param.bufferSize = 0x1000;
+			}
+			if (param.flagAutoStart) {
+				if (!(ret->start())) {
+					return sl_null;
+				}
+			}
+			return ret;
+		}
+		return sl_null;
+	}
+
+	sl_bool AsyncTcpRelay::start()
+	{
+		ObjectLocker lock(this);
+		if (m_flagClosed) {
+			return sl_false;
+		}
+		if (m_flagStarted) {
+			return sl_true;
+		}
+		m_timeLastActive = System::getTickCount();
+		sl_bool flagStarted = sl_false;
+#if defined(ASYNC_TCP_RELAY_USE_SPLICE)
+		if (m_param.flagUseSplice) {
+			flagStarted = _startSplice();
+		}
+#endif
+		if (!flagStarted) {
+			flagStarted = _startCopy();
+		}
+		if (!flagStarted) {
+			return sl_false;
+		}
+		m_flagStarted = sl_true;
+		if (m_param.idleTimeout) {
+			sl_uint32 interval = m_param.idleTimeout / 4;
+			if (interval < 100) {
+				interval = 100;
+			}
+			m_timerIdle = Timer::start(SLIB_FUNCTION_WEAKREF(AsyncTcpRelay, _onIdleTimer, this), interval);
+		}
+		return sl_true;
+	}
+
+	void AsyncTcpRelay::close()
+	{
+		_close();
+	}
+
+	sl_bool AsyncTcpRelay::isRunning()
+	{
+		return m_flagStarted && !m_flagClosed;
+	}
+
+	sl_bool AsyncTcpRelay::isUsingSplice()
+	{
+		return m_flagSplice;
+	}
+
+	Ref<AsyncStream> AsyncTcpRelay::getStream1()
+	{
+		return m_param.stream1;
+	}
+
+	Ref<AsyncStream> AsyncTcpRelay::getStream2()
+	{
+		return m_param.stream2;
+	}
+
+	sl_uint64 AsyncTcpRelay::getTransferredSize1()
+	{
+		ObjectLocker lock(this);
+#if defined(ASYNC_TCP_RELAY_USE_SPLICE)
+		if (m_splice.isNotNull()) {
+			return ((_priv_AsyncTcpRelay_Splice*)(m_splice.get()))->getTransferredSize(0);
+		}
+#endif
+		if (m_copy1.isNotNull()) {
+			return m_copy1->getWrittenSize();
+		}
+		return m_sizeTransferred1;
+	}
+
+	sl_uint64 AsyncTcpRelay::getTransferredSize2()
+	{
+		ObjectLocker lock(this);
+#if defined(ASYNC_TCP_RELAY_USE_SPLICE)
+		if (m_splice.isNotNull()) {
+			return ((_priv_AsyncTcpRelay_Splice*)(m_splice.get()))->getTransferredSize(1);
+		}
+#endif
+		if (m_copy2.isNotNull()) {
+			return m_copy2->getWrittenSize();
+		}
+		return m_sizeTransferred2;
+	}
+
+	sl_bool AsyncTcpRelay::_close()
+	{
+		ObjectLocker lock(this);
+		if (m_flagClosed) {
+			return sl_false;
+		}
+		m_flagClosed = sl_true;
+		Ref<Referable> splice = m_splice;
+		Ref<AsyncCopy> copy1 = m_copy1;
+		Ref<AsyncCopy> copy2 = m_copy2;
+		Ref<Timer> timer = m_timerIdle;
+		m_timerIdle.setNull();
+		lock.unlock();
+		
+		if (timer.isNotNull()) {
+			timer->stop();
+		}
+#if defined(ASYNC_TCP_RELAY_USE_SPLICE)
+		if (splice.isNotNull()) {
+			_priv_AsyncTcpRelay_Splice* p = (_priv_AsyncTcpRelay_Splice*)(splice.get());
+			p->close();
+			m_sizeTransferred1 = p->getTransferredSize(0);
+			m_sizeTransferred2 = p->getTransferredSize(1);
+		}
+#endif
+		if (copy1.isNotNull()) {
+			copy1->close();
+			m_sizeTransferred1 = copy1->getWrittenSize();
+		}
+		if (copy2.isNotNull()) {
+			copy2->close();
+			m_sizeTransferred2 = copy2->getWrittenSize();
+		}
+		// breaks the references from the copies to the relay
+		{
+			ObjectLocker lock2(this);
+			m_splice.setNull();
+			m_copy1.setNull();
+			m_copy2.setNull();
+		}
+		m_param.stream1->close();
+		m_param.stream2->close();
+		return sl_true;
+	}
+
+	sl_bool AsyncTcpRelay::_startSplice()
+	{
+#if defined(ASYNC_TCP_RELAY_USE_SPLICE)
+		AsyncTcpSocket* stream1 = CastInstance<AsyncTcpSocket>(m_param.stream1.get());
+		AsyncTcpSocket* stream2 = CastInstance<AsyncTcpSocket>(m_param.stream2.get());
+		if (!stream1 || !stream2) {
+			return sl_false;
+		}
+		Ref<AsyncIoLoop> loop = stream1->getIoLoop();
+		if (loop.isNull() || loop != stream2->getIoLoop()) {
+			return sl_false;
+		}
+		Ref<Socket> socket1 = stream1->getSocket();
+		Ref<Socket> socket2 = stream2->getSocket();
+		if (socket1.isNull() || socket2.isNull()) {
+			return sl_false;
+		}
+		Ref<_priv_AsyncTcpRelay_Splice> splice = new _priv_AsyncTcpRelay_Splice;
+		if (splice.isNull()) {
+			return sl_false;
+		}
+		if (!(splice->init(socket1, socket2, m_param.bufferSize, m_param.initialData))) {
+			return sl_false;
+		}
+		splice->m_relay = this;
+		splice->m_loop = loop;
+		// takes over the sockets: the instances of the streams are detached at the end of this loop step, and the sockets are attached in the next step
+		Ref<AsyncTcpSocket> refStream1 = stream1;
+		Ref<AsyncTcpSocket> refStream2 = stream2;
+		sl_bool flagAdded = loop->addTask([splice, refStream1, refStream2]() {
+			refStream1->closeIoInstance();
+			refStream2->closeIoInstance();
+			Ref<_priv_AsyncTcpRelay_Splice> _splice = splice;
+			if (!(splice->m_loop->addTask([_splice]() {
+				_splice->attach();
+			}))) {
+				_splice->close();
+			}
+		});
+		if (!flagAdded) {
+			splice->m_relay.setNull();
+			return sl_false;
+		}
+		m_splice = splice;
+		m_flagSplice = sl_true;
+		return sl_true;
+#else
+		return sl_false;
+#endif
+	}
+
+	sl_bool AsyncTcpRelay::_startCopy()
+	{
+		Ref<AsyncStream> stream1 = m_param.stream1;
+		Ref<AsyncStream> stream2 = m_param.stream2;
+		if (m_param.initialData.isNotNull()) {
+			if (!(stream2->writeFromMemory(m_param.initialData, sl_null))) {
+				return sl_false;
+			}
+		}
+		AsyncCopyParam cp;
+		cp.bufferSize = m_param.bufferSize / 2;
+		cp.bufferCount = 2;
+		cp.flagAutoStart = sl_false;
+		// the relay is kept alive by the copies until it is closed
+		cp.onWrite = SLIB_FUNCTION_REF(AsyncTcpRelay, _onCopyWrite, this);
+		cp.onEnd = SLIB_FUNCTION_REF(AsyncTcpRelay, _onCopyEnd, this);
+		cp.source = stream1;
+		cp.target = stream2;
+		Ref<AsyncCopy> copy1 = AsyncCopy::create(cp);
+		cp.source = stream2;
+		cp.target = stream1;
+		Ref<AsyncCopy> copy2 = AsyncCopy::create(cp);
+		if (copy1.isNull() || copy2.isNull()) {
+			return sl_false;
+		}
+		m_copy1 = copy1;
+		m_copy2 = copy2;
+		if (copy1->start() && copy2->start()) {
+			return sl_true;
+		}
+		copy1->close();
+		copy2->close();
+		m_copy1.setNull();
+		m_copy2.setNull();
+		return sl_false;
+	}
+
+	void AsyncTcpRelay::_onActive()
+	{
+		m_timeLastActive = System::getTickCount();
+	}
+
+	void AsyncTcpRelay::_onEnd(sl_bool flagError)
+	{
+		if (_close()) {
+			m_param.onEnd(this, flagError);
+		}
+	}
+
+	void AsyncTcpRelay::_onCopyWrite(AsyncCopy* copy)
+	{
+		_onActive();
+	}
+
+	// the end of the stream is also reported as a reading error, so the error of the source socket is checked
+	static sl_bool _priv_AsyncTcpRelay_isReadingError(AsyncCopy* copy)
+	{
+		if (!(copy->isReadingErrorOccured())) {
+			return sl_false;
+		}
+		Ref<AsyncStream> source = copy->getSource();
+		if (IsInstanceOf<AsyncTcpSocket>(source)) {
+			Ref<Socket> socket = ((AsyncTcpSocket*)(source.get()))->getSocket();
+			if (socket.isNotNull()) {
+				SocketError error = socket->getLastError();
+				return error != SocketError::None && error != SocketError::WouldBlock;
+			}
+		}
+		return sl_true;
+	}
+
+	void AsyncTcpRelay::_onCopyEnd(AsyncCopy* copy, sl_bool flagError)
+	{
+		if (copy->isWritingErrorOccured() || _priv_AsyncTcpRelay_isReadingError(copy)) {
+			_onEnd(sl_true);
+			return;
+		}
+		// all data read from the source is written, so the finish is passed to the target
+		Ref<Socket> socket;
+		Ref<AsyncStream> target = copy->getTarget();
+		if (IsInstanceOf<AsyncTcpSocket>(target)) {
+			socket = ((AsyncTcpSocket*)(target.get()))->getSocket();
+		}
+		if (socket.isNull()) {
+			// the stream can not be half-closed
+			_onEnd(flagError);
+			return;
+		}
+		socket->shutdown(SocketShutdownMode::Send);
+		if (Base::interlockedIncrement32(&m_nCopiesEnded) == 2) {
+			_onEnd(sl_false);
+		}
+	}
+
+	void AsyncTcpRelay::_onIdleTimer(Timer* timer)
+	{
+		if (!(isRunning())) {
+			return;
+		}
+		if (System::getTickCount() - m_timeLastActive >= m_param.idleTimeout) {
+			_onEnd(sl_true);
+		}
+	}
+
+
+	AsyncTcpForwarderParam::AsyncTcpForwarderParam()
+	{
+		bufferSize = 0x10000;
+		idleTimeout = 0;
+		flagUseSplice = sl_true;
+		flagAutoStart = sl_true;
+	}
+
+	AsyncTcpForwarderParam::~AsyncTcpForwarderParam()
+	{
+	}
+
+
+	SLIB_DEFINE_OBJECT(AsyncTcpForwarder, Object)
+
+	AsyncTcpForwarder::AsyncTcpForwarder()
+	{
+		m_flagClosed = sl_false;
+	}
+
+	AsyncTcpForwarder::~AsyncTcpForwarder()
+	{
+		close();
+	}
+
+	Ref<AsyncTcpForwarder> AsyncTcpForwarder::create(const AsyncTcpForwarderParam& param)
+	{
+		if (param.targetAddress.isInvalid() && param.targetHostAddress.isEmpty()) {
+			return sl_null;
+		}
+		Ref<AsyncIoLoop> loop = param.ioLoop;
+		if (loop.isNull()) {
+			loop = AsyncIoLoop::getDefault();
+			if (loop.isNull()) {
+				return sl_null;
+			}
+		}
+		Ref<AsyncTcpForwarder> ret = new AsyncTcpForwarder;
+		if (ret.isNotNull()) {
+			ret->m_param = param;
+			ret->m_ioLoop = loop;
+			AsyncTcpServerParam sp;
+			sp.bindAddress = param.bindAddress;
+			sp.flagAutoStart = param.flagAutoStart;
+			sp.ioLoop = loop;
+			sp.onAccept = SLIB_FUNCTION_WEAKREF(AsyncTcpForwarder, _onAccept, ret);
+			Ref<AsyncTcpServer> server = AsyncTcpServer::create(sp);
+			if (server.isNotNull()) {
+				ret->m_server = server;
+				return ret;
+			}
+		}
+		return sl_null;
+	}
+
+	void AsyncTcpForwarder::close()
+	{
+		ObjectLocker lock(this);
+		if (m_flagClosed) {
+			return;
+		}
+		m_flagClosed = sl_true;
+		lock.unlock();
+		if (m_server.isNotNull()) {
+			m_server->close();
+		}
+		for (auto& item : m_socketsConnecting.getAllValues()) {
+			item->close();
+		}
+		m_socketsConnecting.removeAll();
+		for (auto& item : m_socketsAccepted.getAllValues()) {
+			item->close();
+		}
+		m_socketsAccepted.removeAll();
+		for (auto& item : m_relays.getAllValues()) {
+			item->close();
+		}
+		m_relays.removeAll();
+	}
+
+	sl_bool AsyncTcpForwarder::isOpened()
+	{
+		return !m_flagClosed;
+	}
+
+	void AsyncTcpForwarder::start()
+	{
+		if (m_server.isNotNull()) {
+			m_server->start();
+		}
+	}
+
+	sl_size AsyncTcpForwarder::getRelaysCount()
+	{
+		return m_relays.getCount();
+	}
+
+	void AsyncTcpForwarder::_onAccept(AsyncTcpServer* server, Socket* socket, const SocketAddress& address)
+	{
+		if (m_flagClosed) {
+			return;
+		}
+		AsyncTcpSocketParam cp;
+		cp.socket = socket;
+		cp.ioLoop = m_ioLoop;
+		Ref<AsyncTcpSocket> accepted = AsyncTcpSocket::create(cp);
+		if (accepted.isNull()) {
+			return;
+		}
+		AsyncTcpSocketParam up;
+		up.ioLoop = m_ioLoop;
+		up.flagIPv6 = m_param.targetAddress.ip.isIPv6();
+		up.onConnect = SLIB_FUNCTION_WEAKREF(AsyncTcpForwarder, _onConnect, this);
+		Ref<AsyncTcpSocket> upstream = AsyncTcpSocket::create(up);
+		if (upstream.isNull()) {
+			accepted->close();
+			return;
+		}
+		// registered before connecting, because the failure can be notified immediately
+		m_socketsConnecting.put(upstream.get(), upstream);
+		m_socketsAccepted.put(upstream.get(), accepted);
+		sl_bool flagConnecting = sl_false;
+		if (m_param.targetAddress.isValid()) {
+			flagConnecting = upstream->connect(m_param.targetAddress);
+		} else {
+			String host = m_param.targetHostAddress;
+			sl_reg index = host.lastIndexOf(':');
+			sl_uint32 port;
+			if (index > 0 && host.substring(index + 1).parseUint32(10, &port) && port && port < 0x10000) {
+				flagConnecting = upstream->connect(host.substring(0, index), (sl_uint16)port);
+			}
+		}
+		if (!flagConnecting) {
+			_onConnect(upstream.get(), SocketAddress::none(), sl_true);
+		}
+	}
+
+	void AsyncTcpForwarder::_onConnect(AsyncTcpSocket* socket, const SocketAddress& address, sl_bool flagError)
+	{
+		Ref<AsyncTcpSocket> upstream;
+		Ref<AsyncTcpSocket> accepted;
+		if (!(m_socketsConnecting.get(socket, &upstream))) {
+			return;
+		}
+		m_socketsAccepted.get(socket, &accepted);
+		m_socketsConnecting.remove(socket);
+		m_socketsAccepted.remove(socket);
+		if (accepted.isNull()) {
+			upstream->close();
+			return;
+		}
+		if (!flagError && !m_flagClosed) {
+			AsyncTcpRelayParam rp;
+			rp.stream1 = accepted;
+			rp.stream2 = upstream;
+			rp.bufferSize = m_param.bufferSize;
+			rp.idleTimeout = m_param.idleTimeout;
+			rp.flagUseSplice = m_param.flagUseSplice;
+			rp.flagAutoStart = sl_false;
+			rp.onEnd = SLIB_FUNCTION_WEAKREF(AsyncTcpForwarder, _onEndRelay, this);
+			Ref<AsyncTcpRelay> relay = AsyncTcpRelay::create(rp);
+			if (relay.isNotNull()) {
+				m_relays.put(relay.get(), relay);
+				if (relay->start()) {
+					return;
+				}
+				m_relays.remove(relay.get());
+			}
+		}
+		accepted->close();
+		upstream->close();
+	}
+
+	void AsyncTcpForwarder::_onEndRelay(AsyncTcpRelay* relay, sl_bool flagError)
+	{
+		m_relays.remove(relay);
+	}
+
+}
@@ -24,29 +24,104 @@
 
 #include "slib/core/mio.h"
 
+#if defined(SLIB_ARCH_IS_X64) || (defined(SLIB_ARCH_IS_X86) && defined(__SSE2__))
+#	define TCPIP_CHECKSUM_USE_SSE2
+#	include <emmintrin.h>
+#elif defined(SLIB_ARCH_IS_ARM64) || defined(__ARM_NEON)
+#	define TCPIP_CHECKSUM_USE_NEON
+#	include <arm_neon.h>
+#endif
+
 namespace slib
 {
 
+	SLIB_INLINE static sl_uint32 _priv_TCP_IP_foldSum(sl_uint64 sum)
+	{
+		sum = (sum >> 32) + (sum & 0xffffffff);
+		sum = (sum >> 32) + (sum & 0xffffffff);
+		sum = (sum >> 16) + (sum & 0xffff);
+		sum = (sum >> 16) + (sum & 0xffff);
+		return (sl_uint32)sum;
+	}
+	
+	SLIB_INLINE static sl_uint16 _priv_TCP_IP_swapOnLittleEndian(sl_uint32 v)
+	{
+#if defined(SLIB_ARCH_IS_LITTLE_ENDIAN)
+		return (sl_uint16)((v >> 8) | (v << 8));
+#else
+		return (sl_uint16)v;
+#endif
+	}
+
+	// 1's complement sum can be computed in either byte order and word size (RFC 1071), so the words are summed in native order and the result is swapped at the end
 	sl_uint16 TCP_IP::calculateOneComplementSum(const void* data, sl_size size, sl_uint32 add)
 	{
-		sl_uint32 sum = add;
-		sl_uint8* p = (sl_uint8*)data;
-		while (size > 1) {
-			sl_uint16 w = *((sl_uint8*)(p));
-			w = (w << 8) | *((sl_uint8*)(p + 1));
-			sum += w; // can be computed in either byte order
+		const sl_uint8* p = (const sl_uint8*)data;
+		sl_uint64 sum = _priv_TCP_IP_swapOnLittleEndian(_priv_TCP_IP_foldSum(add));
+#if defined(TCPIP_CHECKSUM_USE_SSE2)
+		if (size >= 64) {
+			__m128i zero = _mm_setzero_si128();
+			__m128i acc0 = zero;
+			__m128i acc1 = zero;
+			while (size >= 32) {
+				__m128i v0 = _mm_loadu_si128((const __m128i*)p);
+				__m128i v1 = _mm_loadu_si128((const __m128i*)(p + 16));
+				acc0 = _mm_add_epi64(acc0, _mm_unpacklo_epi32(v0, zero));
+				acc1 = _mm_add_epi64(acc1, _mm_unpackhi_epi32(v0, zero));
+				acc0 = _mm_add_epi64(acc0, _mm_unpacklo_epi32(v1, zero));
+				acc1 = _mm_add_epi64(acc1, _mm_unpackhi_epi32(v1, zero));
+				p += 32;
+				size -= 32;
+			}
+			acc0 = _mm_add_epi64(acc0, acc1);
+			sl_uint64 t[2];
+			_mm_storeu_si128((__m128i*)t, acc0);
+			sum += _priv_TCP_IP_foldSum(t[0]);
+			sum += _priv_TCP_IP_foldSum(t[1]);
+		}
+#elif defined(TCPIP_CHECKSUM_USE_NEON)
+		if (size >= 64) {
+			uint64x2_t acc0 = vdupq_n_u64(0);
+			uint64x2_t acc1 = vdupq_n_u64(0);
+			while (size >= 32) {
+				acc0 = vpadalq_u32(acc0, vld1q_u32((const uint32_t*)p));
+				acc1 = vpadalq_u32(acc1, vld1q_u32((const uint32_t*)(p + 16)));
+				p += 32;
+				size -= 32;
+			}
+			acc0 = vaddq_u64(acc0, acc1);
+			sum += _priv_TCP_IP_foldSum(vgetq_lane_u64(acc0, 0));
+			sum += _priv_TCP_IP_foldSum(vgetq_lane_u64(acc0, 1));
+		}
+#endif
+		while (size >= 8) {
+			sl_uint64 w;
+			Base::copyMemory(&w, p, 8);
+			sum += (w >> 32) + (w & 0xffffffff);
+			p += 8;
+			size -= 8;
+		}
+		if (size >= 4) {
+			sl_uint32 w;
+			Base::copyMemory(&w, p, 4);
+			sum += w;
+			p += 4;
+			size -= 4;
+		}
+		if (size >= 2) {
+			sl_uint16 w;
+			Base::copyMemory(&w, p, 2);
+			sum += w;
 			p += 2;
 			size -= 2;
 		}
 		if (size) {
-			sl_uint16 w = *((sl_uint8*)p);
-			w = w << 8;
+			sl_uint8 t[2] = {*p, 0};
+			sl_uint16 w;
+			Base::copyMemory(&w, t, 2);
 			sum += w;
 		}
-		while (sum >> 16) {
-			sum = (sum >> 16) + (sum & 0xffff); // 1's complement sum
-		}
-		return sum;
+		return _priv_TCP_IP_swapOnLittleEndian(_priv_TCP_IP_foldSum(sum));
 	}
 	
 	// Referenced from RFC 1071
@@ -56,6 +131,25 @@ namespace slib
 		return (sl_uint16)(~sum); // 1's complement
 	}
 	
+	// HC' = ~(~HC + ~m + m')
+	sl_uint16 TCP_IP::adjustChecksum16(sl_uint16 checksum, sl_uint16 valueOld, sl_uint16 valueNew)
+	{
+		sl_uint32 sum = (sl_uint16)(~checksum);
+		sum += (sl_uint16)(~valueOld);
+		sum += valueNew;
+		return (sl_uint16)(~(_priv_TCP_IP_foldSum(sum)));
+	}
+	
+	sl_uint16 TCP_IP::adjustChecksum32(sl_uint16 checksum, sl_uint32 valueOld, sl_uint32 valueNew)
+	{
+		sl_uint32 sum = (sl_uint16)(~checksum);
+		sum += (sl_uint16)(~(valueOld >> 16));
+		sum += (sl_uint16)(~valueOld);
+		sum += valueNew >> 16;
+		sum += valueNew & 0xffff;
+		return (sl_uint16)(~(_priv_TCP_IP_foldSum(sum)));
+	}
+	
 	
 	void IPv4Packet::updateChecksum()
 	{
@@ -73,6 +167,11 @@ namespace slib
 		return checksum == 0;
 	}
 	
+	void IPv4Packet::adjustChecksum(const IPv4Address& addressOld, const IPv4Address& addressNew)
+	{
+		setChecksum(TCP_IP::adjustChecksum32(getChecksum(), addressOld.getInt(), addressNew.getInt()));
+	}
+	
 	sl_uint16 IPv4Packet::getChecksumForContent(const void* content, sl_uint16 sizeContent) const
 	{
 		sl_uint32 sum = 0;
@@ -234,6 +333,12 @@ namespace slib
 		return checkSize(sizeTcp) && checkChecksum(ip, sizeTcp);
 	}
 	
+	void TcpSegment::adjustChecksum(const IPv4Address& addressOld, const IPv4Address& addressNew, sl_uint16 portOld, sl_uint16 portNew)
+	{
+		sl_uint16 checksum = TCP_IP::adjustChecksum32(getChecksum(), addressOld.getInt(), addressNew.getInt());
+		setChecksum(TCP_IP::adjustChecksum16(checksum, portOld, portNew));
+	}
+	
 	
 	sl_bool UdpDatagram::checkSize(sl_size sizeUdp) const
 	{
@@ -271,6 +376,21 @@ namespace slib
 		return checkSize(sizeUdp) && checkChecksum(ip);
 	}
 	
+	void UdpDatagram::adjustChecksum(const IPv4Address& addressOld, const IPv4Address& addressNew, sl_uint16 portOld, sl_uint16 portNew)
+	{
+		sl_uint16 checksum = getChecksum();
+		if (!checksum) {
+			// checksum is not used
+			return;
+		}
+		checksum = TCP_IP::adjustChecksum32(checksum, addressOld.getInt(), addressNew.getInt());
+		checksum = TCP_IP::adjustChecksum16(checksum, portOld, portNew);
+		if (!checksum) {
+			checksum = 0xFFFF;
+		}
+		setChecksum(checksum);
+	}
+	
 	
 	sl_bool IPv4PacketIdentifier::operator==(const IPv4PacketIdentifier& other) const
 	{
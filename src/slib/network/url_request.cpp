@@ -373,6 +373,7 @@ namespace slib
 		
 		m_timeout = param.timeout;
 		m_flagAllowInsecureConnection = param.flagAllowInsecureConnection;
+		m_dnsResolver = param.dnsResolver;
 		
 		if (m_flagSelfAlive) {
 			_priv_UrlRequestMap* map = _getUrlRequestMap();
@@ -21,6 +21,7 @@
  */
 
 #include "slib/network/curl.h"
+#include "slib/network/url.h"
 
 #include "slib/core/file.h"
 #include "slib/core/system.h"
@@ -123,6 +124,31 @@ namespace slib
 			String url = m_url;
 			::curl_easy_setopt(curl, CURLOPT_URL, url.getData());
 
+			curl_slist* resolveChunk = sl_null;
+			Ref<DnsResolver> resolver = m_dnsResolver;
+			if (resolver.isNotNull()) {
+				Url _url;
+				_url.parse(url);
+				String host = _url.host;
+				sl_uint16 port = _url.scheme.equalsIgnoreCase("https") ? 443 : 80;
+				sl_reg indexPort = host.lastIndexOf(':');
+				if (indexPort > 0 && host.indexOf(']', indexPort) < 0) {
+					sl_uint32 n;
+					if (host.substring(indexPort + 1).parseUint32(10, &n)) {
+						port = (sl_uint16)n;
+					}
+					host = host.substring(0, indexPort);
+				}
+				if (host.isNotEmpty() && !(IPAddress::parse(host, sl_null)) && !(host.startsWith('['))) {
+					List<IPAddress> addresses = resolver->resolveAndWait(host);
+					if (addresses.isNotEmpty()) {
+						String s = host + ":" + String::fromUint32(port) + ":" + addresses.getValueAt(0).toString();
+						resolveChunk = ::curl_slist_append(resolveChunk, s.getData());
+						::curl_easy_setopt(curl, CURLOPT_RESOLVE, resolveChunk);
+					}
+				}
+			}
+
 			::curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
 			::curl_easy_setopt(curl, CURLOPT_MAXREDIRS, 10L);
 			
@@ -214,6 +240,9 @@ namespace slib
 			if (headerChunk) {
 				::curl_slist_free_all(headerChunk);
 			}
+			if (resolveChunk) {
+				::curl_slist_free_all(resolveChunk);
+			}
 
 			::curl_easy_cleanup(curl);
 #if defined(SLIB_PLATFORM_IS_TIZEN)
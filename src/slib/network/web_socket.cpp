@@ -0,0 +1,882 @@
+/*
+ *   Copyright (c) 2008-2018 SLIBIO <https://github.com/SLIBIO>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *   THE SOFTWARE.
+ */
+
+
+#include "slib/network/web_socket.h"
+
+#include "slib/network/http_server.h"
+#include "slib/crypto/sha1.h"
+#include "slib/crypto/base64.h"
+#include "slib/crypto/zlib.h"
+#include "slib/core/mio.h"
+
+#define SIZE_DECOMPRESS_CHUNK 0x4000
+
+namespace slib
+{
+
+/******************************************************
+					WebSocketFrame
+******************************************************/
+
+	Memory WebSocketFrame::buildHeader(WebSocketOpcode opcode, sl_uint64 sizePayload, sl_bool flagCompressed, sl_bool flagFinal)
+	{
+		sl_uint8 header[10];
+		sl_uint32 sizeHeader;
+		header[0] = (sl_uint8)(opcode) & 0x0F;
+		if (flagFinal) {
+			header[0] |= 0x80;
+		}
+		if (flagCompressed) {
+			header[0] |= 0x40;
+		}
+		if (sizePayload < 126) {
+			header[1] = (sl_uint8)sizePayload;
+			sizeHeader = 2;
+		} else if (sizePayload < 0x10000) {
+			header[1] = 126;
+			MIO::writeUint16BE(header + 2, (sl_uint16)sizePayload);
+			sizeHeader = 4;
+		} else {
+			header[1] = 127;
+			MIO::writeUint64BE(header + 2, sizePayload);
+			sizeHeader = 10;
+		}
+		return Memory::create(header, sizeHeader);
+	}
+
+	Memory WebSocketFrame::build(WebSocketOpcode opcode, const void* payload, sl_size size, sl_bool flagCompressed, sl_bool flagFinal)
+	{
+		Memory header = buildHeader(opcode, size, flagCompressed, flagFinal);
+		if (header.isNull()) {
+			return sl_null;
+		}
+		sl_size sizeHeader = header.getSize();
+		Memory ret = Memory::create(sizeHeader + size);
+		if (ret.isNotNull()) {
+			sl_uint8* p = (sl_uint8*)(ret.getData());
+			Base::copyMemory(p, header.getData(), sizeHeader);
+			if (size) {
+				Base::copyMemory(p + sizeHeader, payload, size);
+			}
+		}
+		return ret;
+	}
+
+	Memory WebSocketFrame::compress(const void* data, sl_size size)
+	{
+		// The raw deflate stream is finished by a block with BFINAL bit set, which is allowed by RFC 7692 (Section 7.2.3.6).
+		// A 0x00 octet is appended after it, so that the stream stays valid while the receiver appends 0x00 0x00 0xff 0xff
+		Memory mem = Zlib::compressRaw(data, size);
+		if (mem.isNull()) {
+			return sl_null;
+		}
+		sl_size n = mem.getSize();
+		Memory ret = Memory::create(n + 1);
+		if (ret.isNotNull()) {
+			sl_uint8* p = (sl_uint8*)(ret.getData());
+			Base::copyMemory(p, mem.getData(), n);
+			p[n] = 0;
+		}
+		return ret;
+	}
+
+	static sl_bool _priv_WebSocket_inflate(ZlibDecompress& zlib, const void* _data, sl_size size, sl_uint8* chunk, MemoryBuffer& output, sl_bool& flagEnd, sl_uint64 maxSize, sl_bool& flagExceeded)
+	{
+		const sl_uint8* data = (const sl_uint8*)_data;
+		while (size > 0 && !flagEnd) {
+			sl_uint32 sizeInput = (sl_uint32)(SLIB_MIN(size, 0x40000000));
+			for (;;) {
+				sl_uint32 sizeInputPassed = 0, sizeOutputUsed = 0;
+				sl_int32 iRet = zlib.decompress(data, sizeInput, sizeInputPassed, chunk, SIZE_DECOMPRESS_CHUNK, sizeOutputUsed);
+				if (iRet < 0) {
+					return sl_false;
+				}
+				if (sizeOutputUsed > 0) {
+					if (maxSize && output.getSize() + sizeOutputUsed > maxSize) {
+						flagExceeded = sl_true;
+						return sl_false;
+					}
+					if (!(output.add(Memory::create(chunk, sizeOutputUsed)))) {
+						return sl_false;
+					}
+				}
+				data += sizeInputPassed;
+				size -= sizeInputPassed;
+				sizeInput -= sizeInputPassed;
+				if (iRet == 0) {
+					flagEnd = sl_true;
+					return sl_true;
+				}
+				if (!sizeInput && sizeOutputUsed < SIZE_DECOMPRESS_CHUNK) {
+					break;
+				}
+			}
+		}
+		return sl_true;
+	}
+
+	sl_bool WebSocketFrame::decompress(const void* data, sl_size size, Memory& output, sl_uint64 maxSize, sl_bool* pFlagExceeded)
+	{
+		sl_bool flagExceeded = sl_false;
+		if (pFlagExceeded) {
+			*pFlagExceeded = sl_false;
+		}
+		ZlibDecompress zlib;
+		if (!(zlib.startRaw())) {
+			return sl_false;
+		}
+		sl_uint8 chunk[SIZE_DECOMPRESS_CHUNK];
+		MemoryBuffer buf;
+		sl_bool flagEnd = sl_false;
+		static const sl_uint8 tail[4] = {0x00, 0x00, 0xFF, 0xFF};
+		if (!(_priv_WebSocket_inflate(zlib, data, size, chunk, buf, flagEnd, maxSize, flagExceeded)) || !(_priv_WebSocket_inflate(zlib, tail, 4, chunk, buf, flagEnd, maxSize, flagExceeded))) {
+			if (pFlagExceeded) {
+				*pFlagExceeded = flagExceeded;
+			}
+			return sl_false;
+		}
+		if (buf.getSize()) {
+			output = buf.merge();
+			return output.isNotNull();
+		}
+		output.setNull();
+		return sl_true;
+	}
+
+	sl_bool WebSocketFrame::isValidUtf8(const void* _data, sl_size size)
+	{
+		const sl_uint8* data = (const sl_uint8*)_data;
+		sl_size i = 0;
+		while (i < size) {
+			sl_uint32 c = data[i];
+			if (c < 0x80) {
+				i++;
+				continue;
+			}
+			sl_uint32 n, min;
+			if ((c & 0xE0) == 0xC0) {
+				n = 1;
+				c &= 0x1F;
+				min = 0x80;
+			} else if ((c & 0xF0) == 0xE0) {
+				n = 2;
+				c &= 0x0F;
+				min = 0x800;
+			} else if ((c & 0xF8) == 0xF0) {
+				n = 3;
+				c &= 0x07;
+				min = 0x10000;
+			} else {
+				return sl_false;
+			}
+			if (size - i <= n) {
+				return sl_false;
+			}
+			for (sl_uint32 k = 1; k <= n; k++) {
+				sl_uint32 t = data[i + k];
+				if ((t & 0xC0) != 0x80) {
+					return sl_false;
+				}
+				c = (c << 6) | (t & 0x3F);
+			}
+			// overlong encodings, surrogates and code points above U+10FFFF are invalid
+			if (c < min || (c >= 0xD800 && c < 0xE000) || c > 0x10FFFF) {
+				return sl_false;
+			}
+			i += n + 1;
+		}
+		return sl_true;
+	}
+
+	String WebSocketFrame::getAcceptKey(const String& key)
+	{
+		SLIB_STATIC_STRING(guid, "258EAFA5-E914-47DA-95CA-C5AB0DC85B11")
+		sl_uint8 hash[20];
+		SHA1::hash(key + guid, hash);
+		return Base64::encode(hash, 20);
+	}
+
+/******************************************************
+					WebSocketMessage
+******************************************************/
+
+	WebSocketMessage::WebSocketMessage()
+	{
+		opcode = WebSocketOpcode::Binary;
+	}
+
+	WebSocketMessage::~WebSocketMessage()
+	{
+	}
+
+	sl_bool WebSocketMessage::isText() const
+	{
+		return opcode == WebSocketOpcode::Text;
+	}
+
+	sl_bool WebSocketMessage::isBinary() const
+	{
+		return opcode == WebSocketOpcode::Binary;
+	}
+
+	String WebSocketMessage::getText() const
+	{
+		return String::fromUtf8(data);
+	}
+
+/******************************************************
+					WebSocketParam
+******************************************************/
+
+	WebSocketParam::WebSocketParam()
+	{
+		flagDeflate = sl_true;
+		maxMessageSize = 0x1000000; // 16MB
+		minCompressSize = 256;
+	}
+
+	WebSocketParam::WebSocketParam(const WebSocketParam& other) = default;
+
+	WebSocketParam::~WebSocketParam()
+	{
+	}
+
+	WebSocketParam& WebSocketParam::operator=(const WebSocketParam& other) = default;
+
+/******************************************************
+					WebSocketConnection
+******************************************************/
+
+	SLIB_DEFINE_OBJECT(WebSocketConnection, Object)
+
+	WebSocketConnection::WebSocketConnection()
+	{
+		m_flagOpened = sl_false;
+		m_flagClosed = sl_false;
+		m_flagCloseSent = sl_false;
+		m_flagDeflate = sl_false;
+		m_flagReading = sl_false;
+		m_codeClose = (sl_uint16)(WebSocketCloseCode::AbnormalClosure);
+		
+		m_sizeFrameHeader = 0;
+		m_sizeFrameHeaderRequired = 2;
+		m_sizeFramePayload = 0;
+		m_sizeFramePayloadReceived = 0;
+		
+		m_flagMessageStarted = sl_false;
+		m_messageOpcode = WebSocketOpcode::Binary;
+		m_flagMessageCompressed = sl_false;
+	}
+
+	WebSocketConnection::~WebSocketConnection()
+	{
+	}
+
+	Ref<WebSocketConnection> WebSocketConnection::create(HttpServerConnection* connection, const WebSocketParam& param)
+	{
+		if (connection) {
+			Ref<WebSocketConnection> ret = new WebSocketConnection;
+			if (ret.isNotNull()) {
+				ret->m_connection = connection;
+				ret->m_io = connection->m_io;
+				ret->m_output = connection->m_output;
+				ret->m_bufRead = connection->m_bufRead;
+				ret->m_param = param;
+				ret->setRemoteAddress(connection->getRemoteAddress());
+				return ret;
+			}
+		}
+		return sl_null;
+	}
+
+	static sl_bool _priv_WebSocket_containsToken(const String& value, const String& token)
+	{
+		ListElements<String> items(HttpHeaders::splitValueToList(value));
+		for (sl_size i = 0; i < items.count; i++) {
+			if (items[i].trim().equalsIgnoreCase(token)) {
+				return sl_true;
+			}
+		}
+		return sl_false;
+	}
+
+	// returns the response accepting the offer of permessage-deflate (RFC 7692), or null to decline the offer
+	static String _priv_WebSocket_acceptDeflateOffer(const String& offer)
+	{
+		ListElements<String> params(offer.split(";"));
+		SLIB_STATIC_STRING(strDeflate, "permessage-deflate")
+		if (!(params.count) || params[0].trim() != strDeflate) {
+			return sl_null;
+		}
+		SLIB_STATIC_STRING(strServerNoContextTakeover, "server_no_context_takeover")
+		SLIB_STATIC_STRING(strClientNoContextTakeover, "client_no_context_takeover")
+		SLIB_STATIC_STRING(strServerMaxWindowBits, "server_max_window_bits")
+		SLIB_STATIC_STRING(strClientMaxWindowBits, "client_max_window_bits")
+		sl_bool flagServerNoContextTakeover = sl_false;
+		sl_bool flagClientNoContextTakeover = sl_false;
+		sl_bool flagServerMaxWindowBits = sl_false;
+		sl_bool flagClientMaxWindowBits = sl_false;
+		for (sl_size i = 1; i < params.count; i++) {
+			String name = params[i].trim();
+			String value;
+			sl_bool flagValue = sl_false;
+			sl_reg indexValue = name.indexOf('=');
+			if (indexValue >= 0) {
+				value = name.substring(indexValue + 1).trim();
+				name = name.substring(0, indexValue).trim();
+				if (value.getLength() >= 2 && value.startsWith('\"') && value.endsWith('\"')) {
+					value = value.substring(1, value.getLength() - 1);
+				}
+				flagValue = sl_true;
+			}
+			sl_uint32 bits = 15;
+			if (flagValue) {
+				if (!(value.parseUint32(10, &bits)) || bits < 8 || bits > 15) {
+					return sl_null;
+				}
+			}
+			if (name == strServerNoContextTakeover) {
+				if (flagValue || flagServerNoContextTakeover) {
+					return sl_null;
+				}
+				flagServerNoContextTakeover = sl_true;
+			} else if (name == strClientNoContextTakeover) {
+				if (flagValue || flagClientNoContextTakeover) {
+					return sl_null;
+				}
+				flagClientNoContextTakeover = sl_true;
+			} else if (name == strServerMaxWindowBits) {
+				// frames are compressed with the full window, so that they can be shared by broadcasting
+				if (!flagValue || flagServerMaxWindowBits || bits != 15) {
+					return sl_null;
+				}
+				flagServerMaxWindowBits = sl_true;
+			} else if (name == strClientMaxWindowBits) {
+				// the received messages are decompressed with the full window, so the window of the client is not limited
+				if (flagClientMaxWindowBits) {
+					return sl_null;
+				}
+				flagClientMaxWindowBits = sl_true;
+			} else {
+				return sl_null;
+			}
+		}
+		// every message is compressed independently, so that the frame can be shared by broadcasting
+		if (flagServerMaxWindowBits) {
+			SLIB_RETURN_STRING("permessage-deflate; server_no_context_takeover; client_no_context_takeover; server_max_window_bits=15")
+		} else {
+			SLIB_RETURN_STRING("permessage-deflate; server_no_context_takeover; client_no_context_takeover")
+		}
+	}
+
+	sl_bool WebSocketConnection::isUpgradeRequest(HttpServerContext* context)
+	{
+		if (context->getMethod() != HttpMethod::GET) {
+			return sl_false;
+		}
+		SLIB_STATIC_STRING(strWebSocket, "websocket")
+		if (!(_priv_WebSocket_containsToken(context->getRequestHeader(HttpHeaders::Upgrade), strWebSocket))) {
+			return sl_false;
+		}
+		SLIB_STATIC_STRING(strUpgrade, "Upgrade")
+		if (!(_priv_WebSocket_containsToken(context->getRequestHeader(HttpHeaders::Connection), strUpgrade))) {
+			return sl_false;
+		}
+		return context->getRequestHeader(HttpHeaders::SecWebSocketKey).isNotEmpty();
+	}
+
+	sl_bool WebSocketConnection::accept(HttpServerContext* context, const void* data, sl_uint32 size)
+	{
+		Ref<HttpServerConnection> connection = m_connection;
+		if (connection.isNull()) {
+			return sl_false;
+		}
+		if (m_param.onAccept.isNotNull()) {
+			if (!(m_param.onAccept(this, context))) {
+				SLIB_STATIC_STRING(s, "HTTP/1.1 403 Forbidden\r\nContent-Length: 0\r\n\r\n");
+				connection->sendResponseAndClose(Memory::create(s.getData(), s.getLength()));
+				return sl_false;
+			}
+		}
+		SLIB_STATIC_STRING(strVersion, "13")
+		if (context->getRequestHeader(HttpHeaders::SecWebSocketVersion).trim() != strVersion) {
+			SLIB_STATIC_STRING(s, "HTTP/1.1 426 Upgrade Required\r\nSec-WebSocket-Version: 13\r\nContent-Length: 0\r\n\r\n");
+			connection->sendResponseAndClose(Memory::create(s.getData(), s.getLength()));
+			return sl_false;
+		}
+		
+		context->setResponseCode(HttpStatus::SwitchingProtocols);
+		SLIB_STATIC_STRING(strWebSocket, "websocket")
+		context->setResponseHeader(HttpHeaders::Upgrade, strWebSocket);
+		SLIB_STATIC_STRING(strUpgrade, "Upgrade")
+		context->setResponseHeader(HttpHeaders::Connection, strUpgrade);
+		context->setResponseHeader(HttpHeaders::SecWebSocketAccept, WebSocketFrame::getAcceptKey(context->getRequestHeader(HttpHeaders::SecWebSocketKey).trim()));
+		if (m_param.flagDeflate) {
+			// the offers are listed in the order of the preference of the client
+			ListElements<String> extensions(context->getRequestHeader(HttpHeaders::SecWebSocketExtensions).split(","));
+			for (sl_size i = 0; i < extensions.count; i++) {
+				String response = _priv_WebSocket_acceptDeflateOffer(extensions[i]);
+				if (response.isNotNull()) {
+					context->setResponseHeader(HttpHeaders::SecWebSocketExtensions, response);
+					m_flagDeflate = sl_true;
+					break;
+				}
+			}
+		}
+		Memory header = context->makeResponsePacket();
+		if (header.isNull()) {
+			return sl_false;
+		}
+		if (!(m_output->write(header))) {
+			return sl_false;
+		}
+		m_output->startWriting();
+		
+		m_flagOpened = sl_true;
+		m_param.onOpen(this);
+		
+		if (data && size) {
+			_processInput(data, size);
+		} else {
+			_read();
+		}
+		return sl_true;
+	}
+
+	void WebSocketConnection::close()
+	{
+		ObjectLocker lock(this);
+		if (m_flagClosed) {
+			return;
+		}
+		m_flagClosed = sl_true;
+		lock.unlock();
+		if (m_flagOpened) {
+			m_param.onClose(this, m_codeClose);
+		}
+		Ref<HttpServerConnection> connection = m_connection;
+		if (connection.isNotNull()) {
+			connection->close();
+		}
+	}
+
+	sl_bool WebSocketConnection::isOpened()
+	{
+		return m_flagOpened && !m_flagClosed;
+	}
+
+	Ref<HttpServerConnection> WebSocketConnection::getConnection()
+	{
+		return m_connection;
+	}
+
+	Ref<AsyncStream> WebSocketConnection::getIO()
+	{
+		return m_io;
+	}
+
+	sl_bool WebSocketConnection::isDeflateEnabled()
+	{
+		return m_flagDeflate;
+	}
+
+	sl_bool WebSocketConnection::sendText(const String& text)
+	{
+		return sendMessage(WebSocketOpcode::Text, text.toMemory());
+	}
+
+	sl_bool WebSocketConnection::sendBinary(const void* data, sl_size size)
+	{
+		return sendMessage(WebSocketOpcode::Binary, Memory::create(data, size));
+	}
+
+	sl_bool WebSocketConnection::sendBinary(const Memory& data)
+	{
+		return sendMessage(WebSocketOpcode::Binary, data);
+	}
+
+	sl_bool WebSocketConnection::sendMessage(WebSocketOpcode opcode, const Memory& data)
+	{
+		sl_size size = data.getSize();
+		if (m_flagDeflate && size >= m_param.minCompressSize) {
+			Memory compressed = WebSocketFrame::compress(data.getData(), size);
+			if (compressed.isNotNull()) {
+				return _sendFrame(WebSocketFrame::buildHeader(opcode, compressed.getSize(), sl_true), compressed);
+			}
+		}
+		return _sendFrame(WebSocketFrame::buildHeader(opcode, size), data);
+	}
+
+	sl_bool WebSocketConnection::sendPing(const Memory& payload)
+	{
+		if (payload.getSize() > 125) {
+			return sl_false;
+		}
+		return _sendFrame(WebSocketFrame::buildHeader(WebSocketOpcode::Ping, payload.getSize()), payload);
+	}
+
+	void WebSocketConnection::sendClose(sl_uint16 code, const String& reason)
+	{
+		ObjectLocker lock(this);
+		if (m_flagCloseSent || m_flagClosed) {
+			return;
+		}
+		m_flagCloseSent = sl_true;
+		if (m_codeClose == (sl_uint16)(WebSocketCloseCode::AbnormalClosure)) {
+			m_codeClose = code;
+		}
+		sl_uint8 payload[125];
+		MIO::writeUint16BE(payload, code);
+		sl_size sizeReason = reason.getLength();
+		if (sizeReason > 123) {
+			sizeReason = 123;
+		}
+		Base::copyMemory(payload + 2, reason.getData(), sizeReason);
+		Memory frame = WebSocketFrame::build(WebSocketOpcode::Close, payload, 2 + sizeReason);
+		lock.unlock();
+		Ref<HttpServerConnection> connection = m_connection;
+		if (connection.isNull()) {
+			return;
+		}
+		if (frame.isNotNull() && m_output->write(frame)) {
+			// `onAsyncOutputEnd` closes the connection after the frame is written
+			connection->m_flagKeepAlive = sl_false;
+			m_output->startWriting();
+		} else {
+			close();
+		}
+	}
+
+	void WebSocketConnection::broadcast(const List< Ref<WebSocketConnection> >& connections, WebSocketOpcode opcode, const Memory& data)
+	{
+		ListElements< Ref<WebSocketConnection> > items(connections);
+		if (!(items.count)) {
+			return;
+		}
+		sl_size size = data.getSize();
+		Memory header = WebSocketFrame::buildHeader(opcode, size);
+		Memory headerCompressed, payloadCompressed;
+		sl_bool flagCompressTried = sl_false;
+		for (sl_size i = 0; i < items.count; i++) {
+			WebSocketConnection* connection = items[i].get();
+			if (!connection) {
+				continue;
+			}
+			if (connection->m_flagDeflate && size >= connection->m_param.minCompressSize) {
+				if (!flagCompressTried) {
+					flagCompressTried = sl_true;
+					payloadCompressed = WebSocketFrame::compress(data.getData(), size);
+					if (payloadCompressed.isNotNull()) {
+						headerCompressed = WebSocketFrame::buildHeader(opcode, payloadCompressed.getSize(), sl_true);
+					}
+				}
+				if (headerCompressed.isNotNull()) {
+					connection->_sendFrame(headerCompressed, payloadCompressed);
+					continue;
+				}
+			}
+			connection->_sendFrame(header, data);
+		}
+	}
+
+	void WebSocketConnection::broadcastText(const List< Ref<WebSocketConnection> >& connections, const String& text)
+	{
+		broadcast(connections, WebSocketOpcode::Text, text.toMemory());
+	}
+
+	void WebSocketConnection::broadcastBinary(const List< Ref<WebSocketConnection> >& connections, const Memory& data)
+	{
+		broadcast(connections, WebSocketOpcode::Binary, data);
+	}
+
+	void WebSocketConnection::_read()
+	{
+		ObjectLocker lock(this);
+		if (m_flagClosed) {
+			return;
+		}
+		if (m_flagReading) {
+			return;
+		}
+		m_flagReading = sl_true;
+		if (!(m_io->readToMemory(m_bufRead, SLIB_FUNCTION_WEAKREF(WebSocketConnection, onReadStream, this)))) {
+			m_flagReading = sl_false;
+			close();
+		}
+	}
+
+	void WebSocketConnection::onReadStream(AsyncStreamResult* result)
+	{
+		m_flagReading = sl_false;
+		if (result->flagError) {
+			close();
+		} else {
+			_processInput(result->data, result->size);
+		}
+	}
+
+	void WebSocketConnection::_processInput(const void* _data, sl_uint32 size)
+	{
+		const sl_uint8* data = (const sl_uint8*)_data;
+		while (size > 0) {
+			if (m_flagClosed || m_flagCloseSent) {
+				return;
+			}
+			if (m_sizeFrameHeader < m_sizeFrameHeaderRequired) {
+				sl_uint32 n = m_sizeFrameHeaderRequired - m_sizeFrameHeader;
+				if (n > size) {
+					n = size;
+				}
+				Base::copyMemory(m_frameHeader + m_sizeFrameHeader, data, n);
+				m_sizeFrameHeader += n;
+				data += n;
+				size -= n;
+				if (m_sizeFrameHeader == 2) {
+					sl_uint32 sizeRequired = 2;
+					sl_uint32 len = m_frameHeader[1] & 0x7F;
+					if (len == 126) {
+						sizeRequired += 2;
+					} else if (len == 127) {
+						sizeRequired += 8;
+					}
+					if (m_frameHeader[1] & 0x80) {
+						sizeRequired += 4;
+					}
+					m_sizeFrameHeaderRequired = sizeRequired;
+				}
+				if (m_sizeFrameHeader < m_sizeFrameHeaderRequired) {
+					continue;
+				}
+				if (!(_processFrameHeader())) {
+					return;
+				}
+				if (m_sizeFramePayload == 0) {
+					if (!(_processFrame())) {
+						return;
+					}
+				}
+			} else {
+				sl_uint64 n = m_sizeFramePayload - m_sizeFramePayloadReceived;
+				if (n > size) {
+					n = size;
+				}
+				// unmask the payload
+				sl_uint8* mask = m_frameHeader + m_sizeFrameHeaderRequired - 4;
+				sl_uint8* payload = (sl_uint8*)(m_framePayload.getData()) + m_sizeFramePayloadReceived;
+				sl_uint32 k = (sl_uint32)(m_sizeFramePayloadReceived & 3);
+				for (sl_uint32 i = 0; i < (sl_uint32)n; i++) {
+					payload[i] = data[i] ^ mask[k];
+					k = (k + 1) & 3;
+				}
+				m_sizeFramePayloadReceived += n;
+				data += n;
+				size -= (sl_uint32)n;
+				if (m_sizeFramePayloadReceived >= m_sizeFramePayload) {
+					if (!(_processFrame())) {
+						return;
+					}
+				}
+			}
+		}
+		_read();
+	}
+
+	sl_bool WebSocketConnection::_processFrameHeader()
+	{
+		sl_uint8* header = m_frameHeader;
+		sl_bool flagFinal = (header[0] & 0x80) != 0;
+		WebSocketOpcode opcode = (WebSocketOpcode)(header[0] & 0x0F);
+		if (header[0] & 0x30) {
+			// RSV2, RSV3 are not negotiated
+			_onError(WebSocketCloseCode::ProtocolError);
+			return sl_false;
+		}
+		if (header[0] & 0x40) {
+			// RSV1 is allowed only on the first frame of compressed message
+			if (!m_flagDeflate || opcode == WebSocketOpcode::Continuation || ((sl_uint32)opcode & 8)) {
+				_onError(WebSocketCloseCode::ProtocolError);
+				return sl_false;
+			}
+		}
+		if (!(header[1] & 0x80)) {
+			// client frames must be masked
+			_onError(WebSocketCloseCode::ProtocolError);
+			return sl_false;
+		}
+		sl_uint64 len = header[1] & 0x7F;
+		if (len == 126) {
+			len = MIO::readUint16BE(header + 2);
+		} else if (len == 127) {
+			len = MIO::readUint64BE(header + 2);
+		}
+		if ((sl_uint32)opcode & 8) {
+			// control frame
+			if (!flagFinal || len > 125) {
+				_onError(WebSocketCloseCode::ProtocolError);
+				return sl_false;
+			}
+		} else {
+			sl_uint64 sizeMessage = len;
+			if (opcode == WebSocketOpcode::Continuation) {
+				sizeMessage += m_bufMessage.getSize();
+			}
+			if (sizeMessage > m_param.maxMessageSize) {
+				_onError(WebSocketCloseCode::MessageTooBig);
+				return sl_false;
+			}
+		}
+		m_sizeFramePayload = len;
+		m_sizeFramePayloadReceived = 0;
+		if (len) {
+			m_framePayload = Memory::create((sl_size)len);
+			if (m_framePayload.isNull()) {
+				_onError(WebSocketCloseCode::InternalError);
+				return sl_false;
+			}
+		} else {
+			m_framePayload.setNull();
+		}
+		return sl_true;
+	}
+
+	sl_bool WebSocketConnection::_processFrame()
+	{
+		sl_bool flagFinal = (m_frameHeader[0] & 0x80) != 0;
+		sl_bool flagCompressed = (m_frameHeader[0] & 0x40) != 0;
+		WebSocketOpcode opcode = (WebSocketOpcode)(m_frameHeader[0] & 0x0F);
+		Memory payload = m_framePayload;
+		m_framePayload.setNull();
+		m_sizeFrameHeader = 0;
+		m_sizeFrameHeaderRequired = 2;
+		m_sizeFramePayload = 0;
+		m_sizeFramePayloadReceived = 0;
+		
+		switch (opcode) {
+			case WebSocketOpcode::Continuation:
+				if (!m_flagMessageStarted) {
+					_onError(WebSocketCloseCode::ProtocolError);
+					return sl_false;
+				}
+				if (!(m_bufMessage.add(payload))) {
+					_onError(WebSocketCloseCode::InternalError);
+					return sl_false;
+				}
+				if (flagFinal) {
+					m_flagMessageStarted = sl_false;
+					Memory data = m_bufMessage.merge();
+					m_bufMessage.clear();
+					return _processMessage(m_messageOpcode, data, m_flagMessageCompressed);
+				}
+				return sl_true;
+			case WebSocketOpcode::Text:
+			case WebSocketOpcode::Binary:
+				if (m_flagMessageStarted) {
+					_onError(WebSocketCloseCode::ProtocolError);
+					return sl_false;
+				}
+				if (flagFinal) {
+					return _processMessage(opcode, payload, flagCompressed);
+				}
+				m_flagMessageStarted = sl_true;
+				m_messageOpcode = opcode;
+				m_flagMessageCompressed = flagCompressed;
+				if (!(m_bufMessage.add(payload))) {
+					_onError(WebSocketCloseCode::InternalError);
+					return sl_false;
+				}
+				return sl_true;
+			case WebSocketOpcode::Close:
+				{
+					sl_uint16 code = (sl_uint16)(WebSocketCloseCode::NoStatus);
+					if (payload.getSize() >= 2) {
+						code = MIO::readUint16BE(payload.getData());
+					}
+					m_codeClose = code;
+					sendClose(code == (sl_uint16)(WebSocketCloseCode::NoStatus) ? (sl_uint16)(WebSocketCloseCode::Normal) : code);
+					return sl_false;
+				}
+			case WebSocketOpcode::Ping:
+				_sendFrame(WebSocketFrame::buildHeader(WebSocketOpcode::Pong, payload.getSize()), payload);
+				return sl_true;
+			case WebSocketOpcode::Pong:
+				m_param.onPong(this, payload);
+				return sl_true;
+			default:
+				break;
+		}
+		_onError(WebSocketCloseCode::ProtocolError);
+		return sl_false;
+	}
+
+	sl_bool WebSocketConnection::_processMessage(WebSocketOpcode opcode, const Memory& data, sl_bool flagCompressed)
+	{
+		WebSocketMessage message;
+		message.opcode = opcode;
+		if (flagCompressed) {
+			sl_bool flagExceeded = sl_false;
+			if (!(WebSocketFrame::decompress(data.getData(), data.getSize(), message.data, m_param.maxMessageSize, &flagExceeded))) {
+				_onError(flagExceeded ? WebSocketCloseCode::MessageTooBig : WebSocketCloseCode::InvalidPayload);
+				return sl_false;
+			}
+		} else {
+			message.data = data;
+		}
+		if (opcode == WebSocketOpcode::Text && !(WebSocketFrame::isValidUtf8(message.data.getData(), message.data.getSize()))) {
+			_onError(WebSocketCloseCode::InvalidPayload);
+			return sl_false;
+		}
+		m_param.onMessage(this, message);
+		return sl_true;
+	}
+
+	sl_bool WebSocketConnection::_sendFrame(const Memory& header, const Memory& payload)
+	{
+		if (m_flagClosed || m_flagCloseSent) {
+			return sl_false;
+		}
+		if (header.isNull()) {
+			return sl_false;
+		}
+		{
+			// header and payload should not be interleaved with the frames written by other threads
+			ObjectLocker lock(m_output.get());
+			if (!(m_output->write(header))) {
+				return sl_false;
+			}
+			if (payload.isNotNull()) {
+				if (!(m_output->write(payload))) {
+					return sl_false;
+				}
+			}
+		}
+		m_output->startWriting();
+		return sl_true;
+	}
+
+	void WebSocketConnection::_onError(WebSocketCloseCode code)
+	{
+		m_codeClose = (sl_uint16)code;
+		sendClose((sl_uint16)code);
+	}
+
+}
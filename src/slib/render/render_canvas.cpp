@@ -33,6 +33,8 @@
 
 #define MAX_PROGRAM_COUNT 256
 #define MAX_SHADER_CLIP 8
+// maximum count of glyphs drawn by one draw call
+#define MAX_TEXT_BATCH_GLYPHS 512
 
 namespace slib
 {
@@ -84,10 +86,25 @@ namespace slib
 	SLIB_RENDER_PROGRAM_STATE_ATTRIBUTE_FLOAT(position, a_Position)
 	SLIB_RENDER_PROGRAM_STATE_END
 	
+	// glyph quads with the texture coordinates in the vertices
+	SLIB_RENDER_PROGRAM_STATE_BEGIN(RenderCanvasTextProgramState, RenderVertex2D_PositionTexture)
+	SLIB_RENDER_PROGRAM_STATE_UNIFORM_MATRIX3(Transform, u_Transform)
+	SLIB_RENDER_PROGRAM_STATE_UNIFORM_VECTOR4(Color, u_Color)
+	SLIB_RENDER_PROGRAM_STATE_UNIFORM_TEXTURE(Texture, u_Texture)
+	SLIB_RENDER_PROGRAM_STATE_UNIFORM_FLOAT(DistanceFieldSmoothing, u_DistanceFieldSmoothing)
+	SLIB_RENDER_PROGRAM_STATE_UNIFORM_MATRIX3_ARRAY(ClipTransform, u_ClipTransform)
+	SLIB_RENDER_PROGRAM_STATE_UNIFORM_VECTOR4_ARRAY(ClipRect, u_ClipRect)
+	
+	SLIB_RENDER_PROGRAM_STATE_ATTRIBUTE_FLOAT(position, a_Position)
+	SLIB_RENDER_PROGRAM_STATE_ATTRIBUTE_FLOAT(texCoord, a_TexCoord)
+	SLIB_RENDER_PROGRAM_STATE_END
+	
 	class RenderCanvasProgramParam
 	{
 	public:
 		sl_bool flagUseTexture;
+		sl_bool flagUseVertexTexCoord;
+		sl_bool flagUseDistanceField;
 		sl_bool flagUseColorFilter;
 		RenderCanvasClip* clips[MAX_SHADER_CLIP + 1];
 		sl_uint32 countClips;
@@ -96,6 +113,8 @@ namespace slib
 		RenderCanvasProgramParam()
 		{
 			flagUseTexture = sl_false;
+			flagUseVertexTexCoord = sl_false;
+			flagUseDistanceField = sl_false;
 			flagUseColorFilter = sl_false;
 			countClips = 0;
 		}
@@ -125,7 +144,8 @@ namespace slib
 			countClips++;
 		}
 		
-		void applyToProgramState(RenderCanvasProgramState* state, const Matrix3& transform)
+		template <class STATE>
+		void applyToProgramState(STATE* state, const Matrix3& transform)
 		{
 			Matrix3 clipTransforms[MAX_SHADER_CLIP + 1];
 			Vector4 clipRects[MAX_SHADER_CLIP + 1];
@@ -259,21 +279,51 @@ namespace slib
 				if (signatures) {
 					*(signatures++) = 'T';
 				}
+				if (param.flagUseVertexTexCoord) {
+					if (signatures) {
+						*(signatures++) = 'V';
+					}
+					if (bufVertexShader) {
+						bufVBHeader.add(SLIB_STRINGIFY(
+													   attribute vec2 a_TexCoord;
+													   varying vec2 v_TexCoord;
+													   ));
+						bufVBContent.add(SLIB_STRINGIFY(
+														v_TexCoord = a_TexCoord;
+														));
+					}
+				} else {
+					if (bufVertexShader) {
+						bufVBHeader.add(SLIB_STRINGIFY(
+													   uniform vec4 u_RectSrc;
+													   varying vec2 v_TexCoord;
+													   ));
+						bufVBContent.add(SLIB_STRINGIFY(
+														v_TexCoord = a_Position * u_RectSrc.zw + u_RectSrc.xy;
+														));
+					}
+				}
 				if (bufVertexShader) {
-					bufVBHeader.add(SLIB_STRINGIFY(
-												   uniform vec4 u_RectSrc;
-												   varying vec2 v_TexCoord;
-												   ));
-					bufVBContent.add(SLIB_STRINGIFY(
-													v_TexCoord = a_Position * u_RectSrc.zw + u_RectSrc.xy;
-													));
 					bufFBHeader.add(SLIB_STRINGIFY(
 												   uniform sampler2D u_Texture;
 												   varying vec2 v_TexCoord;
 												   ));
 				}
 				
-				if (param.flagUseColorFilter) {
+				if (param.flagUseDistanceField) {
+					if (signatures) {
+						*(signatures++) = 'D';
+					}
+					if (bufVertexShader) {
+						bufFBHeader.add(SLIB_STRINGIFY(
+													   uniform float u_DistanceFieldSmoothing;
+													   ));
+						bufFBContent.add(SLIB_STRINGIFY(
+														float l_Distance = texture2D(u_Texture, v_TexCoord).w;
+														vec4 color = vec4(l_Color.xyz, l_Color.w * smoothstep(0.5 - u_DistanceFieldSmoothing, 0.5 + u_DistanceFieldSmoothing, l_Distance));
+														));
+					}
+				} else if (param.flagUseColorFilter) {
 					if (signatures) {
 						*(signatures++) = 'F';
 					}
@@ -321,7 +371,8 @@ namespace slib
 			
 		}
 		
-		static Ref<RenderCanvasProgram> create(const RenderCanvasProgramParam& param)
+		template <class PROGRAM>
+		static Ref<RenderProgram> create(const RenderCanvasProgramParam& param)
 		{
 			StringBuffer sbVB;
 			StringBuffer sbFB;
@@ -329,7 +380,7 @@ namespace slib
 			String vertexShader = sbVB.merge();
 			String fragmentShader = sbFB.merge();
 			if (vertexShader.isNotEmpty() && fragmentShader.isNotEmpty()) {
-				Ref<RenderCanvasProgram> ret = new RenderCanvasProgram;
+				Ref<PROGRAM> ret = new PROGRAM;
 				if (ret.isNotNull()) {
 					ret->m_vertexShader = vertexShader;
 					ret->m_fragmentShader = fragmentShader;
@@ -341,11 +392,31 @@ namespace slib
 		
 	};
 	
+	class RenderCanvasTextProgram : public RenderProgramT<RenderCanvasTextProgramState>
+	{
+	public:
+		String m_vertexShader;
+		String m_fragmentShader;
+		
+	public:
+		String getGLSLVertexShader(RenderEngine* engine) override
+		{
+			return m_vertexShader;
+		}
+		
+		String getGLSLFragmentShader(RenderEngine* engine) override
+		{
+			return m_fragmentShader;
+		}
+		
+	};
+	
 	class _priv_RenderCanvas_Shared
 	{
 	public:
-		CHashMap< String, Ref<RenderCanvasProgram> > programs;
+		CHashMap< String, Ref<RenderProgram> > programs;
 		Ref<VertexBuffer> vbRectangle;
+		Ref<IndexBuffer> ibText;
 		
 	public:
 		_priv_RenderCanvas_Shared()
@@ -357,15 +428,33 @@ namespace slib
 				, { { 1, 1 } }
 			};
 			vbRectangle = VertexBuffer::create(v, sizeof(v));
+			
+			// two triangles per glyph, in the order of the triangle strip of `vbRectangle`
+			sl_uint16 indices[MAX_TEXT_BATCH_GLYPHS * 6];
+			for (sl_uint32 i = 0; i < MAX_TEXT_BATCH_GLYPHS; i++) {
+				sl_uint16 k = (sl_uint16)(i << 2);
+				sl_uint16* p = indices + i * 6;
+				p[0] = k;
+				p[1] = k + 1;
+				p[2] = k + 2;
+				p[3] = k + 2;
+				p[4] = k + 1;
+				p[5] = k + 3;
+			}
+			ibText = IndexBuffer::create(indices, sizeof(indices));
 		}
 		
-		Ref<RenderCanvasProgram> getProgram(const RenderCanvasProgramParam& param)
+		Ref<RenderProgram> getProgram(const RenderCanvasProgramParam& param)
 		{
 			char sig[64] = {0};
 			RenderCanvasProgram::generateShaderSources(param, sig, sl_null, sl_null);
-			Ref<RenderCanvasProgram> program;
+			Ref<RenderProgram> program;
 			if (!(programs.get_NoLock(sig, &program))) {
-				program = RenderCanvasProgram::create(param);
+				if (param.flagUseVertexTexCoord) {
+					program = RenderCanvasProgram::create<RenderCanvasTextProgram>(param);
+				} else {
+					program = RenderCanvasProgram::create<RenderCanvasProgram>(param);
+				}
 				if (program.isNull()) {
 					return sl_null;
 				}
@@ -606,7 +695,11 @@ namespace slib
 			return Size::zero();
 		}
 		
-		Ref<FontAtlas> fa = font->getSharedAtlas();
+		Ref<FontAtlas> fa = FontAtlas::getSharedDistanceField(font);
+		if (fa.isNotNull()) {
+			return fa->measureText(text, flagMultiLine) * (font->getSize() / fa->getDistanceFieldSize());
+		}
+		fa = font->getSharedAtlas();
 		if (fa.isNull()) {
 			return Size::zero();
 		}
@@ -615,6 +708,20 @@ namespace slib
 		
 	}
 	
+	static void _priv_RenderCanvas_flushText(RenderEngine* engine, RenderProgramScope<RenderCanvasTextProgramState>& scope, const Ref<VertexBuffer>& vb, const Ref<IndexBuffer>& ib, const Ref<Texture>& texture, Ref<Texture>& textureBefore, sl_uint32 nGlyphs)
+	{
+		if (!nGlyphs) {
+			return;
+		}
+		Ref<TextureInstance> textureInstance = engine->linkTexture(texture);
+		if (textureBefore != texture || (textureInstance.isNotNull() && textureInstance->_isUpdated())) {
+			scope->setTexture(texture);
+			textureBefore = texture;
+		}
+		vb->update(0, nGlyphs * 4 * sizeof(RenderVertex2D_PositionTexture));
+		engine->drawPrimitive(nGlyphs * 6, vb, ib, PrimitiveType::Triangle);
+	}
+	
 	void RenderCanvas::drawText(const String& text, sl_real x, sl_real y, const Ref<Font>& font, const Color& color)
 	{
 		RenderCanvas::drawText16(text, x, y, font, color);
@@ -636,12 +743,24 @@ namespace slib
 		
 		sl_char16* arrChar = text.getData();
 		sl_size len = text.getLength();
-		sl_real fontHeight = font->getFontHeight();
 		sl_bool fontItalic = font->isItalic();
 		
-		Ref<FontAtlas> fa = font->getSharedAtlas();
-		if (fa.isNull()) {
-			return;
+		sl_real fontHeight;
+		// scale and padding of the glyphs in the distance field atlas
+		sl_real scale = 1;
+		sl_real padding = 0;
+		Ref<FontAtlas> fa = FontAtlas::getSharedDistanceField(font);
+		sl_bool flagDistanceField = fa.isNotNull();
+		if (flagDistanceField) {
+			scale = font->getSize() / fa->getDistanceFieldSize();
+			padding = (sl_real)(fa->getDistanceFieldSpread()) * scale;
+			fontHeight = fa->getFontHeight() * scale;
+		} else {
+			fa = font->getSharedAtlas();
+			if (fa.isNull()) {
+				return;
+			}
+			fontHeight = font->getFontHeight();
 		}
 		
 		_priv_RenderCanvas_Shared* shared = _priv_RenderCanvas_getShared();
@@ -659,32 +778,53 @@ namespace slib
 		RenderCanvasProgramParam pp;
 		pp.prepare(state, !fontItalic);
 		pp.flagUseTexture = sl_true;
+		pp.flagUseVertexTexCoord = sl_true;
+		pp.flagUseDistanceField = flagDistanceField;
 		
-		RenderProgramScope<RenderCanvasProgramState> scope;
+		// glyph quads are written to the buffer of the engine, because the canvases are created for every frame
+		Ref<VertexBuffer> vbText = m_engine->getDynamicVertexBufferForDrawText2D(MAX_TEXT_BATCH_GLYPHS * 4 * sizeof(RenderVertex2D_PositionTexture));
+		if (vbText.isNull()) {
+			return;
+		}
+		RenderVertex2D_PositionTexture* vertices = (RenderVertex2D_PositionTexture*)(vbText->getBuffer());
+		sl_uint32 nGlyphs = 0;
+		
+		RenderProgramScope<RenderCanvasTextProgramState> scope;
 		sl_bool flagBeginScope = sl_false;
+		Ref<Texture> textureBatch;
 		Ref<Texture> textureBefore;
 		
+		fa->prepareText(text);
+		
 		FontAtlasChar fac;
 		Color4f color = _color;
 		sl_real fx = x;
 		
-		for (sl_size i = 0; i < len; i++) {
+		sl_size i = 0;
+		while (i < len) {
 			
-			sl_char16 ch = arrChar[i];
+			sl_char32 ch = FontAtlas::readChar(arrChar, len, i);
 			
 			if (fa->getChar(ch, fac)) {
 				
-				sl_real fw = fac.fontWidth;
-				sl_real fh = fac.fontHeight;
+				sl_real fw = fac.fontWidth * scale;
+				sl_real fh = fac.fontHeight * scale;
 				sl_real fxn = fx + fw;
 				
 				if (fac.bitmap.isNotNull()) {
 					
 					Rectangle rcDst;
-					rcDst.left = fx;
-					rcDst.right = fxn;
-					rcDst.top = y + (fontHeight - fh);
-					rcDst.bottom  = rcDst.top + fh;
+					if (flagDistanceField) {
+						rcDst.left = fx - padding;
+						rcDst.right = rcDst.left + (sl_real)(fac.region.right - fac.region.left) * scale;
+						rcDst.top = y + (fontHeight - fh) - padding;
+						rcDst.bottom = rcDst.top + (sl_real)(fac.region.bottom - fac.region.top) * scale;
+					} else {
+						rcDst.left = fx;
+						rcDst.right = fxn;
+						rcDst.top = y + (fontHeight - fh);
+						rcDst.bottom  = rcDst.top + fh;
+					}
 					
 					Rectangle rcClip;
 					
@@ -693,6 +833,7 @@ namespace slib
 					
 					if (state->flagClipRect) {
 						if (state->clipRect.right <= fx) {
+							_priv_RenderCanvas_flushText(m_engine.get(), scope, vbText, shared->ibText, textureBatch, textureBefore, nGlyphs);
 							return;
 						}
 						if (state->clipRect.intersectRectangle(rcDst, &rcClip)) {
@@ -717,8 +858,22 @@ namespace slib
 										return;
 									}
 									scope->setColor(Color4f(color.x, color.y, color.z, color.w * getAlpha()));
+									// glyph quads are positioned in the canvas coordinates
+									pp.applyToProgramState(scope.getState(), Matrix3::identity());
+									scope->setTransform(state->matrix * m_matViewport);
+									if (flagDistanceField) {
+										// about one pixel on the screen around the outline
+										sl_real pixels = (sl_real)(fa->getDistanceFieldSpread()) * scale * Vector2(state->matrix.m00, state->matrix.m01).getLength();
+										sl_real smoothing = pixels > 0.5f ? 0.25f / pixels : 0.5f;
+										scope->setDistanceFieldSmoothing(smoothing);
+									}
 									flagBeginScope = sl_true;
 								}
+								if (textureBatch != texture || nGlyphs >= MAX_TEXT_BATCH_GLYPHS) {
+									_priv_RenderCanvas_flushText(m_engine.get(), scope, vbText, shared->ibText, textureBatch, textureBefore, nGlyphs);
+									textureBatch = texture;
+									nGlyphs = 0;
+								}
 								
 								Rectangle rcSrc;
 								rcSrc.left = (sl_real)(fac.region.left) / sw;
@@ -732,25 +887,24 @@ namespace slib
 								Matrix3 mat;
 								if (fontItalic) {
 									float ratio = 0.2f;
-									mat.m00 = fw; mat.m10 = -ratio * fh; mat.m20 = ratio * fh + rcDst.left;
-									mat.m01 = 0; mat.m11 = fh; mat.m21 = rcDst.top;
-									mat.m02 = 0; mat.m12 = 0; mat.m22 = 1;
+									sl_real w = rcDst.getWidth();
+									sl_real h = rcDst.getHeight();
+									mat.m00 = w; mat.m10 = -ratio * h; mat.m20 = ratio * h + rcDst.left;
+									mat.m01 = 0; mat.m11 = h; mat.m21 = rcDst.top;
 								} else {
 									mat.m00 = rcDst.getWidth(); mat.m10 = 0; mat.m20 = rcDst.left;
 									mat.m01 = 0; mat.m11 = rcDst.getHeight(); mat.m21 = rcDst.top;
-									mat.m02 = 0; mat.m12 = 0; mat.m22 = 1;
 								}
-								pp.applyToProgramState(scope.getState(), mat);
-								mat *= state->matrix;
-								mat *= m_matViewport;
-								scope->setTransform(mat);
-								Ref<TextureInstance> textureInstance = m_engine->linkTexture(texture);
-								if (textureBefore != texture || (textureInstance.isNotNull() && textureInstance->_isUpdated())) {
-									scope->setTexture(texture);
-									textureBefore = texture;
+								RenderVertex2D_PositionTexture* v = vertices + (nGlyphs << 2);
+								for (sl_uint32 k = 0; k < 4; k++) {
+									sl_real u = (sl_real)(k & 1);
+									sl_real t = (sl_real)(k >> 1);
+									v[k].position.x = u * mat.m00 + t * mat.m10 + mat.m20;
+									v[k].position.y = u * mat.m01 + t * mat.m11 + mat.m21;
+									v[k].texCoord.x = rcSrc.left + u * rcSrc.getWidth();
+									v[k].texCoord.y = rcSrc.top + t * rcSrc.getHeight();
 								}
-								scope->setRectSrc(Vector4(rcSrc.left, rcSrc.top, rcSrc.getWidth(), rcSrc.getHeight()));
-								m_engine->drawPrimitive(4, shared->vbRectangle, PrimitiveType::TriangleStrip);
+								nGlyphs++;
 							}
 						}
 					}
@@ -759,6 +913,8 @@ namespace slib
 			}
 		}
 		
+		_priv_RenderCanvas_flushText(m_engine.get(), scope, vbText, shared->ibText, textureBatch, textureBefore, nGlyphs);
+		
 		if (font->isStrikeout() || font->isUnderline()) {
 			Ref<Pen> pen = Pen::createSolidPen(1, _color);
 			FontMetrics fm;
@@ -665,6 +665,20 @@ namespace slib
 		return ret;
 	}
 	
+	Ref<VertexBuffer> RenderEngine::getDynamicVertexBufferForDrawText2D(sl_size size)
+	{
+		Ref<VertexBuffer> ret = m_dynamicVertexBufferForDrawText2D;
+		if (ret.isNull() || ret->getSize() < size) {
+			ret = VertexBuffer::create(Memory::create(size));
+			if (ret.isNull()) {
+				return sl_null;
+			}
+			ret->setStatic(sl_false);
+			m_dynamicVertexBufferForDrawText2D = ret;
+		}
+		return ret;
+	}
+	
 #define DEBUG_WIDTH 512
 #define DEBUG_HEIGHT 30
 	